@@ -0,0 +1,410 @@
+// asterix_bench.cpp – Throughput benchmarks for the ASTERIX codec.
+//
+//   ./build/asterix_bench [--filter=<substring>] [--min-time=<seconds>] [specs_dir]
+//
+// For every supported category two corpora are measured: a small block (the
+// real frames of tests/test_cat01.cpp and tests/test_cat48.cpp, synthetic
+// records elsewhere) and a synthetic block filled up to the 65535-byte LEN
+// limit.  CAT048 and CAT062 also get a block of TrafficGenerator reports, with
+// the item mix of a live feed.  Each corpus is decoded through every front end,
+// exported as JSON / CSV text and re-encoded;
+// micro-benchmarks pin BitReader::readU, FSPEC parsing and UAP selection.
+//
+// Reported per benchmark: ns per iteration, records/s, MB/s of wire bytes and
+// heap allocations per record (global operator new is counted).  Build with
+// -DASTERIX_BUILD_BENCH=ON and CMAKE_BUILD_TYPE=Release.
+
+#include "ASTERIXCodec/BitStream.hpp"
+#include "ASTERIXCodec/Codec.hpp"
+#include "ASTERIXCodec/Export.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+#include "ASTERIXCodec/Traffic.hpp"
+#include "Walker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace asterix;
+
+// ─── Heap allocation counter (global operator new replacement) ──────────────
+static std::atomic<size_t> g_allocations{0};
+
+// The replacement pair is malloc/free throughout; GCC cannot see that.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t n) {
+    ++g_allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// ─── Harness ──────────────────────────────────────────────────────────────────
+
+// Keep a computed value alive without emitting code for it.
+template <class T>
+static void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const volatile void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchConfig {
+    std::string filter;
+    double      min_time{0.25}; // seconds per benchmark
+};
+
+// Time op (one iteration = `records` records, `bytes` wire bytes) until
+// min_time has elapsed, after one warm-up call, and print one result row.
+static void run(const BenchConfig& cfg, const std::string& name, size_t records, size_t bytes,
+                const std::function<void()>& op) {
+    if (!cfg.filter.empty() && name.find(cfg.filter) == std::string::npos) return;
+    using clock = std::chrono::steady_clock;
+
+    op(); // warm-up: caches, context pools, output buffers
+    size_t iters = 1;
+    double secs  = 0;
+    size_t allocs = 0;
+    for (;;) {
+        const size_t a0 = g_allocations;
+        const auto   t0 = clock::now();
+        for (size_t i = 0; i < iters; ++i) op();
+        secs   = std::chrono::duration<double>(clock::now() - t0).count();
+        allocs = g_allocations - a0;
+        if (secs >= cfg.min_time || iters >= (size_t{1} << 30)) break;
+        iters = secs <= 0 ? iters * 16
+                          : std::max(iters * 2, static_cast<size_t>(iters * cfg.min_time * 1.2 / secs));
+    }
+
+    const double per_iter = secs / static_cast<double>(iters);
+    const double n_recs   = static_cast<double>(records) * static_cast<double>(iters);
+    std::printf("%-40s %12.1f ns %10.2f Mrec/s %9.1f MB/s %9.2f alloc/rec\n", name.c_str(),
+                per_iter * 1e9,
+                records ? n_recs / secs / 1e6 : 0.0,
+                static_cast<double>(bytes) * static_cast<double>(iters) / secs / 1e6,
+                records ? static_cast<double>(allocs) / n_recs : 0.0);
+}
+
+// ─── Corpora ──────────────────────────────────────────────────────────────────
+
+// clang-format off
+// tests/test_cat01.cpp testRealMessage(): 4 CAT01 track records
+static const std::vector<uint8_t> kCat01Frame = {
+    0x01, 0x00, 0x53,
+    0xF7, 0x84, 0x08, 0x11, 0xA8, 0x00, 0x4A, 0x46, 0xD7, 0xEA, 0x2E, 0x08, 0x43, 0xA2, 0xF8,
+    0x0F, 0x82, 0x05, 0xC8, 0x48,
+    0xF7, 0x84, 0x08, 0x11, 0xA8, 0x05, 0x28, 0x29, 0x0F, 0xEB, 0x01, 0x08, 0x86, 0x51, 0x8B,
+    0x01, 0x72, 0x06, 0x18, 0x48,
+    0xF7, 0x84, 0x08, 0x11, 0xA8, 0x03, 0x21, 0x2A, 0x26, 0xE9, 0xFE, 0x08, 0x90, 0x51, 0x38,
+    0x01, 0x6B, 0x05, 0xC8, 0x48,
+    0xF7, 0x84, 0x08, 0x11, 0xA8, 0x05, 0x07, 0x19, 0x80, 0xEB, 0x54, 0x08, 0x3E, 0x0C, 0x38,
+    0x02, 0x00, 0x06, 0x40, 0x48,
+};
+
+// tests/test_cat48.cpp kRealFrame: 9 operational CAT48 target reports
+static const std::vector<uint8_t> kCat48Frame = {
+    0x30, 0x01, 0x3e,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x72, 0xba, 0xd1, 0x6e,
+    0x04, 0x62, 0x05, 0xc8, 0x60, 0x02, 0xc0, 0x48, 0x4f, 0x6d, 0x51, 0x20,
+    0x75, 0xdf, 0x0c, 0x60, 0x00, 0xdb, 0x08, 0x03, 0x96, 0xd4, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xed, 0xa8, 0x49, 0x8f, 0xd7, 0x58,
+    0x0b, 0x49, 0x05, 0x52, 0x60, 0x02, 0xc2, 0x4d, 0x23, 0x5a, 0x15, 0x71,
+    0xf3, 0x55, 0x98, 0x20, 0x02, 0xed, 0x08, 0x80, 0x33, 0x79, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe6, 0xa8, 0x69, 0xc6, 0xd5, 0xb9,
+    0x02, 0x00, 0x01, 0xc5, 0x60, 0x02, 0xb5, 0xab, 0xaf, 0x47, 0x18, 0x46,
+    0x32, 0xc6, 0x08, 0x20, 0x07, 0xb6, 0x05, 0xe4, 0xb0, 0xd0, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xda, 0xa8, 0x8a, 0x7a, 0xd2, 0x9c,
+    0x0a, 0xed, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x4d, 0x21, 0xfe, 0x49, 0x94,
+    0xb3, 0x0c, 0x28, 0x20, 0x01, 0xee, 0x07, 0xb4, 0x1e, 0xcd, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe0, 0xa8, 0xc4, 0xa1, 0xd3, 0x83,
+    0x0c, 0xe7, 0x04, 0x38, 0x60, 0x06, 0xba, 0x40, 0x09, 0xd8, 0x08, 0x15,
+    0xf3, 0xdb, 0x26, 0x60, 0x04, 0xd3, 0x08, 0x5d, 0x68, 0x26, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd9, 0xa8, 0x66, 0xf7, 0xd2, 0x88,
+    0x02, 0x00, 0x01, 0xb8, 0x60, 0x02, 0xba, 0x39, 0xd3, 0x06, 0x51, 0x61,
+    0xb9, 0xd4, 0xc5, 0x60, 0x07, 0x98, 0x05, 0xee, 0xb8, 0x73, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xec, 0xa8, 0xa8, 0xcd, 0xd6, 0xfc,
+    0x0b, 0xe0, 0x05, 0xa0, 0x60, 0x02, 0xba, 0x4d, 0x22, 0x8f, 0x49, 0x94,
+    0xb6, 0xe5, 0x63, 0xa0, 0x03, 0x76, 0x06, 0x39, 0xe3, 0xc2, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd8, 0xa8, 0xb8, 0x49, 0xd2, 0x39,
+    0x01, 0x5b, 0x04, 0x9f, 0x60, 0x02, 0xb7, 0x40, 0x0c, 0xeb, 0x08, 0x15,
+    0xf1, 0xd3, 0x13, 0x60, 0x00, 0x27, 0x09, 0x42, 0x69, 0xad, 0x40,
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x73, 0xe9, 0xd1, 0x63,
+    0x0d, 0xea, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x48, 0x41, 0xaa, 0x51, 0x20,
+    0x78, 0xd9, 0x58, 0x20, 0x03, 0x5a, 0x06, 0xa5, 0xee, 0xa4, 0x40,
+};
+// clang-format on
+
+// Deterministic value stream for synthetic records (splitmix64).
+struct Mixer {
+    uint64_t state;
+
+    uint64_t next() noexcept {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    uint64_t bits(unsigned n) noexcept { return n >= 64 ? next() : next() & ((uint64_t{1} << n) - 1); }
+};
+
+static void fill(const std::vector<ElementDef>& elems, std::map<std::string, uint64_t>& out, Mixer& mix) {
+    for (const auto& e : elems)
+        if (!e.is_spare) out[e.name] = mix.bits(e.bits);
+}
+
+// One record of variation var with every UAP item present and random values.
+// The UAP discriminator, if any, is set to select var.
+static DecodedRecord syntheticRecord(const CategoryPlan& plan, uint16_t var, Mixer& mix) {
+    const PlanVariation& uap = plan.variations[var];
+    DecodedRecord rec;
+    rec.uap_variation = *uap.name;
+
+    for (ItemIndex idx : uap.slots) {
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        const DataItemDef& def = *plan.items[idx].def;
+        DecodedItem& di = rec.items[def.id];
+        di.item_id = def.id;
+        di.type    = def.type;
+
+        switch (def.type) {
+        case ItemType::Fixed:
+            fill(def.elements, di.fields, mix);
+            break;
+        case ItemType::Extended:
+            for (const auto& oct : def.octets) fill(oct.elements, di.fields, mix);
+            break;
+        case ItemType::Repetitive:
+            for (int i = 0; i < 3; ++i) di.repetitions.push_back(mix.bits(def.rep_element.bits));
+            break;
+        case ItemType::RepetitiveGroup:
+        case ItemType::RepetitiveGroupFX:
+            for (int i = 0; i < 2; ++i) fill(def.rep_group_elements, di.group_repetitions.emplace_back(), mix);
+            break;
+        case ItemType::Explicit:
+        case ItemType::SP:
+            for (int i = 0; i < 4; ++i) di.raw_bytes.push_back(static_cast<uint8_t>(mix.next()));
+            break;
+        case ItemType::Compound:
+            for (const auto& si : def.compound_sub_items)
+                if (si.name != "-") fill(si.elements, di.compound_sub_fields[si.name], mix);
+            break;
+        }
+    }
+
+    if (const auto& uc = plan.def.uap_case) {
+        for (const auto& [value, name] : uc->value_to_variation)
+            if (name == *uap.name) rec.items.at(uc->item_id).fields[uc->field] = value;
+    }
+    return rec;
+}
+
+struct Corpus {
+    std::string                name;
+    std::vector<uint8_t>       block;
+    std::vector<DecodedRecord> records; // decode(block).records, for the encoders
+};
+
+// Synthetic records (cycling through the UAP variations) encoded into one
+// block; full = as many as fit under the 65535-byte LEN limit, else n.
+static Corpus syntheticCorpus(const Codec& codec, uint8_t cat, bool full, size_t n) {
+    const CategoryPlan& plan = codec.plan(cat);
+    Mixer mix{cat};
+    std::vector<DecodedRecord> recs;
+    size_t len = 3;
+    for (size_t i = 0; full || i < n; ++i) {
+        DecodedRecord rec = syntheticRecord(plan, static_cast<uint16_t>(i % plan.variations.size()), mix);
+        const size_t rec_len = codec.encode(cat, {rec}).size() - 3;
+        if (len + rec_len > 0xFFFF) break;
+        len += rec_len;
+        recs.push_back(std::move(rec));
+    }
+    char name[32];
+    std::snprintf(name, sizeof name, "cat%03u/%s", cat, full ? "max" : "synthetic");
+    return {name, codec.encode(cat, recs), {}};
+}
+
+// 64 reports of a 400-target TrafficGenerator (default item mix).
+static Corpus trafficCorpus(const Codec& codec, uint8_t cat) {
+    TrafficOptions opts;
+    opts.cat               = cat;
+    opts.targets           = 400;
+    opts.records_per_block = 64;
+    TrafficGenerator gen{codec, std::move(opts)};
+    std::vector<uint8_t> block;
+    gen.nextBlock(block);
+    char name[32];
+    std::snprintf(name, sizeof name, "cat%03u/traffic", cat);
+    return {name, std::move(block), {}};
+}
+
+// ─── Benchmarks ───────────────────────────────────────────────────────────────
+
+static void benchCorpus(const BenchConfig& cfg, const Codec& codec, Corpus& c) {
+    const DecodedBlock ref = codec.decode(c.block);
+    if (!ref.valid) {
+        std::fprintf(stderr, "%s: corpus does not decode: %s\n", c.name.c_str(), ref.error.c_str());
+        std::exit(1);
+    }
+    c.records = ref.records;
+    const std::span<const uint8_t> buf = c.block;
+    const size_t recs  = c.records.size();
+    const size_t bytes = c.block.size();
+
+    DecodeContext ctx;
+    BlockView     view;
+    RecordIndex   index;
+    std::vector<uint8_t> out;
+    ColumnarBatch cols(codec.plan(ref.cat), std::vector<FieldId>{0});
+    ExportOptions csv_opts;
+    csv_opts.format = ExportFormat::Csv;
+    RecordExporter json(codec.plan(ref.cat));
+    RecordExporter csv(codec.plan(ref.cat), csv_opts);
+
+    run(cfg, c.name + "/decode",         recs, bytes, [&] { keep(codec.decode(buf)); });
+    run(cfg, c.name + "/decodeInto",     recs, bytes, [&] { keep(codec.decodeInto(buf, ctx)); });
+    run(cfg, c.name + "/decodeCompact",  recs, bytes, [&] { keep(codec.decodeCompactInto(buf, ctx)); });
+    run(cfg, c.name + "/view",           recs, bytes, [&] { codec.view(buf, view); keep(view); });
+    run(cfg, c.name + "/scanRecords",    recs, bytes, [&] { codec.scanRecords(buf, index); keep(index); });
+    run(cfg, c.name + "/decodeColumns",  recs, bytes, [&] {
+        cols.clear();
+        keep(codec.decodeColumns(buf, cols));
+    });
+    run(cfg, c.name + "/exportJson",     recs, bytes, [&] {
+        json.clear();
+        json.write(codec.decodeCompactInto(buf, ctx));
+        keep(json.size());
+    });
+    run(cfg, c.name + "/exportJsonView", recs, bytes, [&] {
+        codec.view(buf, view);
+        json.clear();
+        json.write(view);
+        keep(json.size());
+    });
+    run(cfg, c.name + "/exportCsv",      recs, bytes, [&] {
+        codec.view(buf, view);
+        csv.clear();
+        csv.write(view);
+        keep(csv.size());
+    });
+    run(cfg, c.name + "/encode",         recs, bytes, [&] { keep(codec.encode(ref.cat, c.records)); });
+    run(cfg, c.name + "/encodeAppend",   recs, bytes, [&] {
+        out.clear();
+        codec.encodeAppend(ref.cat, c.records, out);
+        keep(out);
+    });
+}
+
+// BitReader::readU over a 64 KiB buffer at a fixed field width.
+static void benchBitReader(const BenchConfig& cfg) {
+    std::vector<uint8_t> buf(64 * 1024);
+    Mixer mix{1};
+    for (auto& b : buf) b = static_cast<uint8_t>(mix.next());
+
+    for (unsigned width : {1u, 3u, 8u, 12u, 16u, 24u, 32u}) {
+        const size_t reads = buf.size() * 8 / width;
+        run(cfg, "bitreader/readU/" + std::to_string(width), 0, buf.size(), [&] {
+            BitReader br{buf};
+            uint64_t acc = 0;
+            for (size_t i = 0; i < reads; ++i) acc += br.readU(width);
+            keep(acc);
+        });
+    }
+}
+
+// FSPEC parsing alone: readFspec() + the present slots through the dispatch
+// table (SlotCursor, as walkRecord() does), for each record of a corpus
+// (boundaries from scanRecords()).  fspec-slots/ tests every UAP slot instead.
+static void benchFspec(const BenchConfig& cfg, const Codec& codec, const Corpus& c) {
+    const RecordIndex index = codec.scanRecords(c.block);
+    const PlanVariation& uap = index.plan->variations[index.plan->default_variation];
+    const std::span<const uint8_t> buf = c.block;
+    run(cfg, "fspec/" + c.name, index.records.size(), c.block.size(), [&] {
+        size_t present = 0;
+        for (const RecordOffset& r : index.records) {
+            detail::SlotCursor cursor{uap, detail::readFspec(buf.subspan(r.offset, r.length))};
+            for (PlanSlot s; cursor.next(s);) present += s.item;
+        }
+        keep(present);
+    });
+    run(cfg, "fspec-slots/" + c.name, index.records.size(), c.block.size(), [&] {
+        size_t present = 0;
+        for (const RecordOffset& r : index.records) {
+            const detail::Fspec fspec = detail::readFspec(buf.subspan(r.offset, r.length));
+            for (size_t s = 0; s < uap.slots.size(); ++s)
+                if (uap.slots[s] != kNoItem && fspec.present(s)) present += uap.slots[s];
+        }
+        keep(present);
+    });
+}
+
+// UAP selection: resolveVariation() on the discriminator item (CAT01 I020)
+// of every record of a corpus.
+static void benchUapSelection(const BenchConfig& cfg, const Codec& codec, const Corpus& c) {
+    const CategoryPlan& plan = codec.plan(c.block[0]);
+    if (!plan.uap_case) return;
+    const BlockView view = codec.view(c.block);
+    std::vector<std::span<const uint8_t>> items;
+    for (size_t i = 0; i < view.size(); ++i)
+        if (auto item = view.record(i).item(plan.uap_case->item); item.present()) items.push_back(item.bytes());
+    run(cfg, "uap/" + c.name, items.size(), 0, [&] {
+        uint32_t sum = 0;
+        for (const auto& bytes : items) sum += detail::resolveVariation(plan, bytes);
+        keep(sum);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    fs::path specs = fs::path(__FILE__).parent_path().parent_path() / "specs";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.starts_with("--filter="))        cfg.filter   = arg.substr(9);
+        else if (arg.starts_with("--min-time=")) cfg.min_time = std::atof(arg.c_str() + 11);
+        else if (!arg.starts_with("--"))         specs        = arg;
+        else {
+            std::fprintf(stderr, "usage: %s [--filter=<substring>] [--min-time=<s>] [specs_dir]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Codec codec;
+    for (const char* file : {"CAT01.xml", "CAT02.xml", "CAT34.xml", "CAT48.xml", "CAT62.xml"})
+        codec.registerCategory(loadSpec(specs / file));
+
+    std::vector<Corpus> corpora;
+    corpora.push_back({"cat001/real", kCat01Frame, {}});
+    corpora.push_back(syntheticCorpus(codec, 1, true, 0));
+    for (uint8_t cat : {2, 34}) {
+        corpora.push_back(syntheticCorpus(codec, cat, false, 16));
+        corpora.push_back(syntheticCorpus(codec, cat, true, 0));
+    }
+    corpora.push_back({"cat048/real", kCat48Frame, {}});
+    corpora.push_back(syntheticCorpus(codec, 48, true, 0));
+    corpora.push_back(trafficCorpus(codec, 48));
+    corpora.push_back(syntheticCorpus(codec, 62, false, 16));
+    corpora.push_back(syntheticCorpus(codec, 62, true, 0));
+    corpora.push_back(trafficCorpus(codec, 62));
+
+    std::printf("%-40s %15s %17s %14s %19s\n", "benchmark", "time/iter", "records", "bytes", "allocations");
+    for (auto& c : corpora) benchCorpus(cfg, codec, c);
+    benchBitReader(cfg);
+    for (const auto& c : corpora) benchFspec(cfg, codec, c);
+    for (const auto& c : corpora) benchUapSelection(cfg, codec, c);
+    return 0;
+}
@@ -0,0 +1,200 @@
+#pragma once
+// Archive.hpp – Chunked columnar archive files for long-term recordings.
+//
+// An ArchiveWriter takes Data Blocks (of any registered categories), decodes
+// their records and stores them per category in chunks of about chunk_rows
+// records, column by column:
+//   • one presence bitmap per item, and per field of an Extended / Compound
+//     item (over the rows that carry the item);
+//   • one value stream per field – every repetition, for Repetitive /
+//     RepetitiveGroup[FX] fields, with the repetition counts beside them –
+//     and the payload bytes of Explicit / SP items;
+//   • block boundaries and the variation of each record.
+// Each value stream is stored as the smallest of: bit-packed offsets from the
+// chunk minimum, zig-zag varint deltas, a dictionary of the distinct values
+// plus bit-packed indices, or runs of one value.  Widths and signedness come
+// from the element definitions (bits, SignedQuantity), so time of day comes
+// out as small deltas and table fields as dictionaries of a few entries.
+//
+// With group_tracks, the records of a CAT048 / CAT062 chunk are stored track
+// by track – (I010, I161 / I040), each track's records in arrival order – and
+// the track of each record kept to restore the order on reading.  A track's
+// identity items then come out as runs and its positions as small deltas.
+//
+// The archive is lossless: blocks read back are byte-identical to the blocks
+// written.  A record is rebuilt from its columns and re-encoded with
+// Codec::encodeAppend(); the writer checks this at write time and keeps, next
+// to the columns, the wire bytes of any record that would not come back
+// identical (non-zero spares, trailing all-zero Extended octets, ...).
+//
+// Each chunk has min / max statistics per field, in the directory at the end
+// of the file, so a reader can skip chunks without reading them, then decode
+// only the columns it needs into a ColumnarBatch (see Columnar.hpp).
+//
+// Blocks that do not decode (header or record length errors) are not
+// archived: add() returns their fault.  Little-endian layout:
+//   "ASXA" version | chunk… | directory | directory offset (8 bytes) "ASXA"
+//
+// Usage:
+//   ArchiveWriter out{codec, "2024-05-01.asxa"};
+//   for (const auto& block : RecordingReader{"2024-05-01.ff", codec}) (void)out.add(block.bytes);
+//   out.close();
+//
+//   ArchiveReader in{codec, "2024-05-01.asxa"};
+//   ColumnarBatch cols(codec.plan(48), {{"140"}, {"040", {"RHO"}}});
+//   const FieldId rho = findField(codec.category(48), "040", "RHO");
+//   for (size_t c = 0; c < in.chunks().size(); ++c)
+//       if (const auto* s = in.chunks()[c].stats(rho); in.chunks()[c].cat == 48 && s && s->max > 256 * 100)
+//           in.readColumns(c, cols);
+
+#include "Codec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace asterix {
+
+namespace detail {
+struct ArchiveLayout;   // per-category field / item tables (Archive.cpp)
+struct ArchiveBuilder;  // columns of the chunk being filled (Archive.cpp)
+}
+
+struct ArchiveOptions {
+    size_t chunk_rows{16384};  // records per chunk; a chunk always ends with a block
+    bool   group_tracks{true}; // CAT048 / CAT062: store a chunk's records track by track
+};
+
+// Range of one field's values in a chunk: raw values, sign-extended for
+// SignedQuantity fields.
+struct ArchiveFieldStats {
+    FieldId  field{kNoField};
+    uint32_t count{0}; // values (repetitions included)
+    int64_t  min{0};
+    int64_t  max{0};
+};
+
+// Directory entry of one chunk.
+struct ArchiveChunk {
+    uint8_t  cat{0};
+    uint64_t offset{0};      // in the file
+    uint64_t bytes{0};
+    uint32_t rows{0};        // records
+    uint32_t blocks{0};
+    uint64_t first_block{0}; // sequence numbers of the blocks, in write order
+    uint64_t last_block{0};
+    std::vector<ArchiveFieldStats> fields; // fields with a value in the chunk, by FieldId
+
+    // Statistics of a field, or nullptr if no record of the chunk has it.
+    [[nodiscard]] const ArchiveFieldStats* stats(FieldId id) const noexcept;
+};
+
+// A Data Block read back, with its position in the written sequence.
+struct ArchivedBlock {
+    uint64_t             seq{0};
+    std::vector<uint8_t> bytes;
+};
+
+class ArchiveWriter {
+public:
+    // The codec must outlive the writer.  Throws std::runtime_error if the
+    // file cannot be created or chunk_rows is 0.
+    ArchiveWriter(const Codec& codec, const std::filesystem::path& path, ArchiveOptions opts = {});
+    // Closes the archive; errors are swallowed, call close() to see them.
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&)            = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    // Archive the records of one Data Block.  Returns the block's fault, the
+    // block being skipped, if it does not decode (length rules only: records
+    // that miss mandatory items are kept).  Throws std::runtime_error on a
+    // write error.
+    DecodeError add(std::span<const uint8_t> block);
+
+    // Write the pending chunks and the directory.  Later add() calls throw.
+    void close();
+
+    [[nodiscard]] uint64_t blocks() const noexcept { return blocks_; }     // archived
+    [[nodiscard]] uint64_t records() const noexcept { return records_; }
+    [[nodiscard]] uint64_t rejected() const noexcept { return rejected_; } // blocks skipped
+    [[nodiscard]] uint64_t verbatim() const noexcept { return verbatim_; } // records kept as wire bytes
+
+private:
+    const Codec*              codec_;
+    ArchiveOptions            opts_;
+    std::ofstream             out_;
+    uint64_t                  offset_{0};
+    bool                      closed_{false};
+    std::vector<ArchiveChunk> chunks_;
+    std::vector<std::unique_ptr<detail::ArchiveBuilder>> builders_; // one per category seen
+
+    DecodeContext        ctx_;
+    Projection           structural_;
+    RecordIndex          index_;
+    std::vector<DecodedRecord> one_; // a record being checked
+    std::vector<uint8_t> check_;     // its re-encoding
+
+    uint64_t blocks_{0};
+    uint64_t records_{0};
+    uint64_t rejected_{0};
+    uint64_t verbatim_{0};
+
+    detail::ArchiveBuilder& builder(const CategoryPlan& plan);
+    void flush(detail::ArchiveBuilder& b);
+    void write(std::span<const uint8_t> bytes);
+};
+
+class ArchiveReader {
+public:
+    // Reads the directory.  The codec must outlive the reader and have every
+    // archived category registered with the same spec (edition, items and
+    // fields) as when it was written.  Throws std::runtime_error otherwise, or
+    // if the file is not an archive.
+    ArchiveReader(const Codec& codec, const std::filesystem::path& path);
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader&)            = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    // Chunks in file order; those of one category are in block order.
+    [[nodiscard]] std::span<const ArchiveChunk> chunks() const noexcept { return chunks_; }
+
+    // The read functions throw std::out_of_range for i past chunks(), and
+    // std::runtime_error for a corrupt chunk.
+
+    // The records of chunk i, in order (out is resized; its storage reused).
+    void readRecords(size_t i, std::vector<CompactRecord>& out);
+
+    // Append the records of chunk i as rows of cols (only its columns are
+    // decoded; repeated fields give their first repetition, as with
+    // Codec::decodeColumns()).  Throws std::runtime_error if cols was built
+    // for another category than the chunk's.
+    void readColumns(size_t i, ColumnarBatch& cols);
+
+    // The Data Blocks of chunk i, byte-identical to those written (out is
+    // resized; its storage reused).
+    void readBlocks(size_t i, std::vector<ArchivedBlock>& out);
+
+    // Every archived block, in the order they were written.
+    void forEachBlock(const std::function<void(std::span<const uint8_t> block)>& on_block);
+
+private:
+    const Codec*              codec_;
+    std::ifstream             in_;
+    std::vector<ArchiveChunk> chunks_;
+    std::vector<std::unique_ptr<detail::ArchiveLayout>> layouts_; // by category, as archived
+    std::vector<uint8_t>      buf_;     // the chunk being read
+    std::vector<CompactRecord> records_; // readBlocks() scratch
+    std::vector<DecodedRecord> run_;
+
+    const detail::ArchiveLayout& layout(uint8_t cat) const;
+    std::span<const uint8_t> load(size_t i);
+};
+
+} // namespace asterix
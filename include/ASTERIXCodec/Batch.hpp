@@ -0,0 +1,43 @@
+#pragma once
+// Batch.hpp – Options and scheduler for Codec::decodeBatch().
+//
+// A batch is an index range of independent Data Blocks.  Workers (the calling
+// thread plus threads-1 std::threads) claim contiguous chunks of it from one
+// shared atomic cursor, so a fast worker simply claims more chunks; blocks are
+// never reordered in the results.  forEachDecoded*() give each worker its own
+// DecodeContext for the whole batch; decodeBatch() returns fresh blocks.
+//
+// Usage:
+//   std::vector<std::span<const uint8_t>> frames = …;
+//   std::vector<DecodedBlock> blocks = codec.decodeBatch(frames);
+//
+//   // Zero-copy consumption, one reusable context per worker:
+//   codec.forEachDecoded(frames, [&](size_t i, const DecodedBlock& block) { … });
+
+#include <cstddef>
+#include <functional>
+
+namespace asterix {
+
+class Projection;
+
+struct BatchOptions {
+    unsigned          threads{0};          // 0 ⇒ std::thread::hardware_concurrency()
+    size_t            chunk{0};            // blocks per claim; 0 ⇒ chosen from the batch size
+    const Projection* projection{nullptr}; // decode only the selection (see Projection.hpp)
+};
+
+namespace detail {
+
+// Number of workers parallelFor() would use for n items.
+[[nodiscard]] unsigned batchWorkers(size_t n, const BatchOptions& opts) noexcept;
+
+// Call run(worker, begin, end) over [0, n) in chunks, worker < batchWorkers().
+// Calls for one worker are sequential.  The first exception thrown by run
+// stops further claims and is rethrown once every worker has finished.
+void parallelFor(size_t n, const BatchOptions& opts,
+                 const std::function<void(unsigned, size_t, size_t)>& run);
+
+} // namespace detail
+
+} // namespace asterix
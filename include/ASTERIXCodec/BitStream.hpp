@@ -8,9 +8,15 @@
 //     and Repetitive items.
 //   • Data Items are always byte-aligned relative to the Data Record start;
 //     sub-elements within an item are bit-packed MSB-first.
+//
+// BitReader reads a field with one big-endian 8-byte load and a shift, not
+// bit by bit.  readU() / skip() validate every call; readUnchecked() /
+// skipUnchecked() are for callers that have already validated the span
+// (e.g. the decode walker, which checks each item's length before reading).
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <span>
 #include <stdexcept>
 #include <vector>
@@ -46,28 +52,26 @@ public:
     // ── Fundamental read operations ──────────────────────────────────────────
 
     // Read n bits as an unsigned 64-bit integer, MSB of the field first.
-    // Preconditions: 1 ≤ n ≤ 64 and canRead(n).
+    // Throws unless 1 ≤ n ≤ 64 and canRead(n).
     [[nodiscard]] uint64_t readU(size_t n) {
         boundsCheck(n);
-        uint64_t result = 0;
-        size_t   left   = n;
-        while (left > 0) {
-            const size_t byte_idx     = pos_ / 8;
-            const size_t bit_in_byte  = pos_ % 8;           // 0 = MSB side
-            const size_t avail        = 8 - bit_in_byte;
-            const size_t chunk        = std::min(left, avail);
-
-            // Mask the 'chunk' bits starting from bit_in_byte (MSB side).
-            // e.g. bit_in_byte=0, chunk=3 → mask = 0b11100000 → shift right by 5
-            const uint8_t shift  = static_cast<uint8_t>(avail - chunk);
-            const uint8_t mask   = static_cast<uint8_t>(((1u << chunk) - 1u) << shift);
-            const uint8_t bits   = (buf_[byte_idx] & mask) >> shift;
-
-            result = (result << chunk) | bits;
-            pos_  += chunk;
-            left  -= chunk;
-        }
-        return result;
+        return readUnchecked(n);
+    }
+
+    // readU() without validation.
+    // Preconditions: 1 ≤ n ≤ 64 and canRead(n).
+    [[nodiscard]] uint64_t readUnchecked(size_t n) noexcept {
+        const size_t byte_idx    = pos_ / 8;
+        const size_t bit_in_byte = pos_ % 8; // 0 = MSB side
+
+        // Left-align the field: drop the bits already consumed in the first byte.
+        uint64_t word = loadBE(byte_idx) << bit_in_byte;
+        // A field starting mid-byte can spill into a 9th byte.
+        if (bit_in_byte + n > 64)
+            word |= static_cast<uint64_t>(buf_[byte_idx + 8]) >> (8 - bit_in_byte);
+
+        pos_ += n;
+        return word >> (64 - n);
     }
 
     // Read n bits as a signed 64-bit integer (two's complement), MSB first.
@@ -96,6 +100,9 @@ public:
         pos_ += n;
     }
 
+    // skip() without validation.  Precondition: canRead(n).
+    void skipUnchecked(size_t n) noexcept { pos_ += n; }
+
     // Advance to the next byte boundary (no-op if already aligned).
     void alignToByte() {
         if (!byteAligned()) pos_ = (pos_ + 7) & ~size_t{7};
@@ -135,6 +142,24 @@ private:
     std::span<const uint8_t> buf_;
     size_t pos_{0};
 
+    // Up to 8 bytes from byte i, big-endian, left-aligned; bytes past the end
+    // of the buffer read as 0.  Precondition: i < buf_.size().
+    [[nodiscard]] uint64_t loadBE(size_t i) const noexcept {
+        const uint8_t* p    = buf_.data() + i;
+        const size_t  avail = buf_.size() - i;
+        if (avail >= 8) {
+            // Compilers fold this into a single load + byte swap
+            return (static_cast<uint64_t>(p[0]) << 56) | (static_cast<uint64_t>(p[1]) << 48) |
+                   (static_cast<uint64_t>(p[2]) << 40) | (static_cast<uint64_t>(p[3]) << 32) |
+                   (static_cast<uint64_t>(p[4]) << 24) | (static_cast<uint64_t>(p[5]) << 16) |
+                   (static_cast<uint64_t>(p[6]) <<  8) |  static_cast<uint64_t>(p[7]);
+        }
+        uint64_t word = 0;
+        for (size_t k = 0; k < avail; ++k)
+            word |= static_cast<uint64_t>(p[k]) << (56 - 8 * k);
+        return word;
+    }
+
     void boundsCheck(size_t n) const {
         if (n == 0 || n > 64)
             throw std::invalid_argument("BitReader: bit count must be 1–64");
@@ -152,38 +177,53 @@ private:
 // ─────────────────────────────────────────────────────────────────────────────
 //  BitWriter
 // ─────────────────────────────────────────────────────────────────────────────
-// Appends bits MSB-first into an internal byte buffer that grows as needed.
+// Appends bits MSB-first, either into a byte vector that grows as needed or,
+// in fixed-capacity mode, straight into a caller-provided span (writing past
+// its end throws std::out_of_range).  Byte-aligned writeBytes() is a memcpy.
+//
+//   BitWriter bw;                      // growing, owns its buffer
+//   BitWriter bw{std::move(vec)};      // growing, appends after vec's bytes
+//   BitWriter bw{std::span{arr}};      // fixed capacity, no allocation
 class BitWriter {
 public:
     BitWriter() = default;
 
+    // Growing mode, appending after the existing contents of buf (whose
+    // capacity is reused).  Get the buffer back with take().
+    explicit BitWriter(std::vector<uint8_t>&& buf) noexcept
+        : buf_(std::move(buf)), pos_(buf_.size() * 8) {}
+
+    // Fixed-capacity mode: bytes are written to out[0 …].
+    explicit BitWriter(std::span<uint8_t> out) noexcept
+        : fixed_(out.data()), cap_(out.size()) {}
+
     // Write n bits from value, MSB first.  Only the low n bits of value are used.
     void writeU(uint64_t value, size_t n) {
         if (n == 0 || n > 64)
             throw std::invalid_argument("BitWriter: bit count must be 1–64");
         if (n < 64) value &= (uint64_t{1} << n) - 1u; // mask to n bits
 
-        size_t left = n;
-        while (left > 0) {
-            if (buf_.empty() || (pos_ % 8) == 0)
-                buf_.push_back(0);
-
-            const size_t bit_in_byte = pos_ % 8;
-            const size_t avail       = 8 - bit_in_byte;
-            const size_t chunk       = std::min(left, avail);
-
-            // The top 'chunk' bits of the remaining 'left' bits of value
-            const uint64_t field_shift = left - chunk;
-            const uint8_t  bits = static_cast<uint8_t>(
-                (value >> field_shift) & ((1u << chunk) - 1u));
-
-            // Place them at the correct position in the current byte
-            const uint8_t byte_shift = static_cast<uint8_t>(avail - chunk);
-            buf_.back() |= static_cast<uint8_t>(bits << byte_shift);
+        uint8_t* out  = grow((pos_ + n + 7) / 8);
+        size_t   byte = pos_ / 8;
+        size_t   bit  = pos_ % 8;
+        size_t   left = n;
+        pos_ += n;
 
-            pos_  += chunk;
-            left  -= chunk;
+        // Top up a partially written byte
+        if (bit != 0) {
+            const size_t chunk = std::min(left, 8 - bit);
+            const auto   bits  = static_cast<uint8_t>((value >> (left - chunk)) & ((1u << chunk) - 1u));
+            out[byte++] |= static_cast<uint8_t>(bits << (8 - bit - chunk));
+            left -= chunk;
         }
+        // Whole bytes
+        while (left >= 8) {
+            left -= 8;
+            out[byte++] = static_cast<uint8_t>(value >> left);
+        }
+        // Leading bits of a fresh byte
+        if (left != 0)
+            out[byte] = static_cast<uint8_t>((value & ((1u << left) - 1u)) << (8 - left));
     }
 
     // Write n bits of a two's-complement signed integer.
@@ -194,22 +234,70 @@ public:
     // Write a single bit.
     void writeBit(bool b) { writeU(b ? 1u : 0u, 1); }
 
-    // Append raw bytes (byte-aligned assumed by caller).
+    // Append raw bytes (memcpy when byte-aligned).
     void writeBytes(std::span<const uint8_t> data) {
-        for (uint8_t b : data) writeU(b, 8);
+        if (!byteAligned()) {
+            for (uint8_t b : data) writeU(b, 8);
+            return;
+        }
+        if (data.empty()) return;
+        uint8_t* out = grow(pos_ / 8 + data.size());
+        std::memcpy(out + pos_ / 8, data.data(), data.size());
+        pos_ += data.size() * 8;
     }
 
     // Write a whole byte.
     void writeByte(uint8_t b) { writeU(b, 8); }
 
+    // ── Random access to bytes already written (for length / FSPEC patching) ─
+
+    // Overwrite byte i (i < bytesWritten()).
+    void patchByte(size_t i, uint8_t b) noexcept { data()[i] = b; }
+
+    // Remove n bytes at offset i, shifting the tail down (requires alignment).
+    void eraseBytes(size_t i, size_t n) {
+        if (!byteAligned() || i + n > bytesWritten())
+            throw std::logic_error("BitWriter::eraseBytes – unaligned or out of range");
+        uint8_t* d = data();
+        std::memmove(d + i, d + i + n, bytesWritten() - i - n);
+        pos_ -= n * 8;
+        if (!fixed_) buf_.resize(bytesWritten());
+    }
+
+    // Bytes written so far (a partial last byte counts).
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept {
+        return {fixed_ ? fixed_ : buf_.data(), bytesWritten()};
+    }
+
+    // Growing mode only.
     [[nodiscard]] const std::vector<uint8_t>& buffer()  const noexcept { return buf_; }
     [[nodiscard]] std::vector<uint8_t>        take()          noexcept { return std::move(buf_); }
+
     [[nodiscard]] size_t bitsWritten()         const noexcept { return pos_; }
+    [[nodiscard]] size_t bytesWritten()        const noexcept { return (pos_ + 7) / 8; }
     [[nodiscard]] bool   byteAligned()         const noexcept { return (pos_ % 8) == 0; }
 
 private:
     std::vector<uint8_t> buf_;
-    size_t pos_{0};
+    uint8_t* fixed_{nullptr}; // fixed-capacity mode target
+    size_t   cap_{0};
+    size_t   pos_{0};
+
+    [[nodiscard]] uint8_t* data() noexcept { return fixed_ ? fixed_ : buf_.data(); }
+
+    // Make room for `bytes` bytes in total; new bytes start zeroed.
+    uint8_t* grow(size_t bytes) {
+        const size_t have = bytesWritten();
+        if (bytes <= have) return data();
+        if (fixed_) {
+            if (bytes > cap_)
+                throw std::out_of_range("BitWriter: write past end of buffer");
+            std::memset(fixed_ + have, 0, bytes - have);
+            return fixed_;
+        }
+        buf_.resize(bytes, 0);
+        return buf_.data();
+    }
 };
 
 } // namespace asterix
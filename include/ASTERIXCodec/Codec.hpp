@@ -12,59 +12,217 @@
 //   auto& rec = block.records[0];
 //   uint64_t sac = rec.items.at("010").fields.at("SAC");
 
+#include "Batch.hpp"
+#include "Columnar.hpp"
+#include "Compact.hpp"
+#include "DecodeContext.hpp"
+#include "Metrics.hpp"
+#include "Plan.hpp"
+#include "Projection.hpp"
+#include "Registry.hpp"
 #include "Types.hpp"
+#include "View.hpp"
+#include <memory>
 #include <span>
-#include <unordered_map>
 #include <vector>
 
 namespace asterix {
 
+class BitWriter;
+
 class Codec {
 public:
+    Codec();
+
     // Register a category definition (loaded from XML via loadSpec()).
     // Multiple categories can be registered; each is keyed by its cat number.
+    // Registering a cat again replaces it, and may be done while other
+    // threads decode (see Registry.hpp): each Data Block is decoded with
+    // either the old or the new plan, never a mix.  The replaced plan is kept,
+    // so results built on it stay valid, until reclaimRetired() or the
+    // Codec's destruction: a Codec that re-registers on a schedule without
+    // reclaiming grows by one plan per reload.  A Projection's selection for
+    // the category goes stale: decoding the category with it fails the block
+    // (DecodeErrc::StaleProjection) until it is select()ed again.
     void registerCategory(CategoryDef cat);
 
+    // Free the plans replaced by registerCategory(); returns how many were
+    // dropped (a plan shared with a copy of this Codec lives on in the copy).
+    // Call it only once no decode started before the replacement can still
+    // be running, and no result, view, filter, packer or exporter built on a
+    // replaced plan will be used again.
+    size_t reclaimRetired();
+
     // Return a registered category definition (throws if not found).
     const CategoryDef& category(uint8_t cat) const;
 
+    // Return the compiled decode plan of a registered category (throws if not found).
+    const CategoryPlan& plan(uint8_t cat) const;
+
+    // Whether a category is registered.
+    [[nodiscard]] bool hasCategory(uint8_t cat) const noexcept { return registry_.find(cat) != nullptr; }
+
     // ── Decode ───────────────────────────────────────────────────────────────
     // Decode a single ASTERIX Data Block from the raw byte buffer.
     // The buffer must start at the first byte of the Data Block (CAT byte).
     // Returns a DecodedBlock; check .valid and .error for problems.
     [[nodiscard]] DecodedBlock decode(std::span<const uint8_t> buf) const;
 
+    // Same as decode(), but into the interned-field representation: values
+    // sit in flat arrays indexed by FieldId (see Compact.hpp).  The records
+    // point at the category's plan, which stays valid as long as the Codec.
+    [[nodiscard]] CompactBlock decodeCompact(std::span<const uint8_t> buf) const;
+
+    // Same as decode() / decodeCompact(), but into storage owned by ctx,
+    // recycling the records, map nodes and buffers of previous calls (see
+    // DecodeContext.hpp).  The returned block lives in ctx and is overwritten
+    // by the next decode into the same context.
+    const DecodedBlock& decodeInto(std::span<const uint8_t> buf, DecodeContext& ctx) const;
+    const CompactBlock& decodeCompactInto(std::span<const uint8_t> buf, DecodeContext& ctx) const;
+
+    // Projected variants of the above: for categories selected in proj, only
+    // the selected items / fields are decoded and the rest is skipped with
+    // length-only parsing (see Projection.hpp).
+    [[nodiscard]] DecodedBlock decode(std::span<const uint8_t> buf, const Projection& proj) const;
+    [[nodiscard]] CompactBlock decodeCompact(std::span<const uint8_t> buf,
+                                             const Projection& proj) const;
+    const DecodedBlock& decodeInto(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                   const Projection& proj) const;
+    const CompactBlock& decodeCompactInto(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                          const Projection& proj) const;
+
+    // ── Batch decode ─────────────────────────────────────────────────────────
+    // Decode many independent Data Blocks on a pool of worker threads (see
+    // Batch.hpp).  Results are in input order.  The Codec itself is only read,
+    // so it may be shared.  Every result is a freshly allocated block; only
+    // forEachDecoded*() below reuse storage, through one DecodeContext per
+    // worker.
+    [[nodiscard]] std::vector<DecodedBlock> decodeBatch(
+        std::span<const std::span<const uint8_t>> blocks, const BatchOptions& opts = {}) const;
+    [[nodiscard]] std::vector<CompactBlock> decodeCompactBatch(
+        std::span<const std::span<const uint8_t>> blocks, const BatchOptions& opts = {}) const;
+
+    // Same scheduling without materialising the results: on_block(i, block)
+    // is called from the worker threads, concurrently and in no particular
+    // order, with a block that lives in the worker's context until its next
+    // decode.  No allocation once every worker's context is warmed up.
+    template <class OnBlock>
+    void forEachDecoded(std::span<const std::span<const uint8_t>> blocks, OnBlock&& on_block,
+                        const BatchOptions& opts = {}) const {
+        std::vector<DecodeContext> ctxs(detail::batchWorkers(blocks.size(), opts));
+        detail::parallelFor(blocks.size(), opts, [&](unsigned w, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                on_block(i, batchDecode(blocks[i], ctxs[w], opts));
+        });
+    }
+    template <class OnBlock>
+    void forEachDecodedCompact(std::span<const std::span<const uint8_t>> blocks, OnBlock&& on_block,
+                               const BatchOptions& opts = {}) const {
+        std::vector<DecodeContext> ctxs(detail::batchWorkers(blocks.size(), opts));
+        detail::parallelFor(blocks.size(), opts, [&](unsigned w, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                on_block(i, batchDecodeCompact(blocks[i], ctxs[w], opts));
+        });
+    }
+
+    // Index a Data Block without decoding it: each record's FSPEC is walked
+    // once with the item length rules only, and field values are read lazily
+    // from buf through the returned views (see View.hpp).  buf must outlive
+    // the BlockView.  The second overload reuses block's storage.
+    [[nodiscard]] BlockView view(std::span<const uint8_t> buf) const;
+    void view(std::span<const uint8_t> buf, BlockView& block) const;
+
+    // Record boundaries of a Data Block, found with length-only parsing (no
+    // field is extracted).  The second overload reuses index's storage.
+    [[nodiscard]] RecordIndex scanRecords(std::span<const uint8_t> buf) const;
+    void scanRecords(std::span<const uint8_t> buf, RecordIndex& index) const;
+
+    // Decode record i of the block buf that index was scanned from (random
+    // access).  Throws std::out_of_range if i is past the index.
+    [[nodiscard]] DecodedRecord decodeRecordAt(std::span<const uint8_t> buf,
+                                               const RecordIndex& index, size_t i) const;
+    [[nodiscard]] CompactRecord decodeCompactRecordAt(std::span<const uint8_t> buf,
+                                                      const RecordIndex& index, size_t i) const;
+
+    // Same result as decode() / decodeCompact(), but the records of the one
+    // block are decoded in parallel: scanRecords() finds the boundaries, then
+    // the records are spread over worker threads as in decodeBatch().
+    [[nodiscard]] DecodedBlock decodeParallel(std::span<const uint8_t> buf,
+                                              const BatchOptions& opts = {}) const;
+    [[nodiscard]] CompactBlock decodeCompactParallel(std::span<const uint8_t> buf,
+                                                     const BatchOptions& opts = {}) const;
+
+    // Append the records of a Data Block to cols as rows (see Columnar.hpp).
+    // Returns the block's fault: on a header error, or for a block of another
+    // category than cols' (UnknownCategory), no row is added; on a record
+    // error the rows decoded before it are kept.
+    DecodeError decodeColumns(std::span<const uint8_t> buf, ColumnarBatch& cols) const;
+
     // ── Encode ───────────────────────────────────────────────────────────────
     // Encode a single ASTERIX Data Block from a list of pre-built records.
     // Each record must carry a uap_variation and a populated items map.
     [[nodiscard]] std::vector<uint8_t> encode(uint8_t cat,
                                               const std::vector<DecodedRecord>& records) const;
 
+    // Same as encode(), appending the block to out (whose capacity is reused,
+    // so a warmed-up buffer is not reallocated).  On error out is unchanged.
+    void encodeAppend(uint8_t cat, const std::vector<DecodedRecord>& records,
+                      std::vector<uint8_t>& out) const;
+
+    // Same as encode(), writing the block straight into out without any
+    // allocation.  Returns the block length; bytes of out past it may be used
+    // as scratch.  Throws std::out_of_range if out is too small.
+    size_t encodeInto(uint8_t cat, const std::vector<DecodedRecord>& records,
+                      std::span<uint8_t> out) const;
+
+    // ── Metrics ──────────────────────────────────────────────────────────────
+    // Snapshot of the decode counters (see Metrics.hpp); empty, with
+    // enabled = false, unless built with ASTERIX_METRICS.  Copies of a Codec
+    // share their counters.  Safe to call while other threads decode.
+    [[nodiscard]] CodecMetrics metrics() const;
+    void resetMetrics();
+
 private:
-    std::unordered_map<uint8_t, CategoryDef> cats_;
+    friend class BlockEditor; // encodes single items (Editor.hpp)
+    friend class BlockPacker; // encodes single records (Packer.hpp)
+    friend class TrackStore;  // decodes single records (TrackState.hpp)
 
-    // Internal per-record helpers
-    [[nodiscard]] DecodedRecord decodeRecord(std::span<const uint8_t> buf,
-                                             const CategoryDef& cat,
-                                             size_t& bytes_consumed) const;
+    detail::CategoryRegistry registry_;
+    std::shared_ptr<detail::CategoryCounters> rejected_; // header faults (ASTERIX_METRICS)
 
-    [[nodiscard]] std::vector<uint8_t> encodeRecord(const DecodedRecord& rec,
-                                                     const CategoryDef& cat) const;
+    // Batch worker step: decode into ctx, honouring opts.projection.
+    const DecodedBlock& batchDecode(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                    const BatchOptions& opts) const {
+        return opts.projection ? decodeInto(buf, ctx, *opts.projection) : decodeInto(buf, ctx);
+    }
+    const CompactBlock& batchDecodeCompact(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                           const BatchOptions& opts) const {
+        return opts.projection ? decodeCompactInto(buf, ctx, *opts.projection)
+                               : decodeCompactInto(buf, ctx);
+    }
 
-    // Item-level decode (returns number of bytes consumed from item_buf)
-    [[nodiscard]] DecodedItem decodeItem(const DataItemDef& def,
-                                          std::span<const uint8_t> item_buf,
-                                          size_t& consumed) const;
+    // Internal per-record helpers
+    // Decode one record into rec (its previous contents go back to pools);
+    // returns the bytes consumed, or 0 with err set.  text: fill rec.error.
+    [[nodiscard]] size_t decodeRecord(std::span<const uint8_t> buf,
+                                      const CategoryPlan& plan,
+                                      DecodedRecord& rec,
+                                      detail::RecordPools& pools,
+                                      const CategoryProjection* proj, BorrowMode borrow,
+                                      Validation validation, DecodeError& err, bool text) const;
+    [[nodiscard]] size_t decodeCompactRecord(std::span<const uint8_t> buf,
+                                             const CategoryPlan& plan,
+                                             CompactRecord& rec,
+                                             const CategoryProjection* proj, BorrowMode borrow,
+                                             Validation validation, DecodeError& err,
+                                             bool text) const;
 
-    [[nodiscard]] std::vector<uint8_t> encodeItem(const DataItemDef& def,
-                                                   const DecodedItem& val) const;
+    void encodeBlock(uint8_t cat, const std::vector<DecodedRecord>& records,
+                     BitWriter& bw) const;
 
-    // UAP selection helpers
-    [[nodiscard]] const std::vector<std::string>&
-    selectUap(const CategoryDef& cat, const DecodedRecord& partial) const;
+    void encodeRecord(const DecodedRecord& rec, const CategoryPlan& plan, BitWriter& bw) const;
 
-    [[nodiscard]] std::string
-    resolveVariation(const CategoryDef& cat, const DecodedRecord& partial) const;
+    void encodeItem(const DataItemDef& def, const DecodedItem& val, BitWriter& bw) const;
 };
 
 } // namespace asterix
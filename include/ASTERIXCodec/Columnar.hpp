@@ -0,0 +1,114 @@
+#pragma once
+// Columnar.hpp – Struct-of-arrays decode output for analytics.
+//
+// A ColumnarBatch holds one column per selected field of one category: a
+// contiguous buffer with one value per record (row) and a validity bitmap.
+// The layout is that of an Arrow primitive array – `values` is the data
+// buffer of a UInt64 array and `validity` its LSB-numbered validity bitmap –
+// so a column can be handed to Arrow, or scanned with plain loops, without
+// copying or touching a std::map.
+//
+// Rows accumulate over any number of Data Blocks until clear().  Items that
+// hold none of the selected fields are skipped with length-only parsing.
+// Repeated fields (Repetitive, RepetitiveGroup[FX]) contribute their first
+// repetition, as in CompactRecord::values.  A batch is tied to the plan it
+// was built with: after registerCategory() replaces a category, build it again.
+//
+// Usage:
+//   ColumnarBatch cols(codec.plan(48), {{"040", {"RHO", "THETA"}}, {"090"}});
+//   for (const auto& raw : blocks) (void)codec.decodeColumns(raw, cols);
+//   const Column& rho = *cols.find(findField(codec.category(48), "040", "RHO"));
+//   for (size_t r = 0; r < cols.rows(); ++r)
+//       if (rho.valid(r)) histogram.add(rho.values[r]);
+
+#include "Plan.hpp"
+#include "Projection.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace asterix {
+
+// ─── One field across all rows ────────────────────────────────────────────────
+struct Column {
+    FieldId     field{kNoField};
+    std::string name;             // "040.RHO", or "050.PSR.CHAB" for a Compound sub-item
+    uint16_t    bits{0};          // element width on the wire
+
+    std::vector<uint64_t> values;   // raw value per row; 0 where the row has none
+    std::vector<uint8_t>  validity; // bit (row % 8) of byte row / 8 set if present
+    size_t                null_count{0};
+
+    [[nodiscard]] bool valid(size_t row) const noexcept {
+        return row / 8 < validity.size() && ((validity[row / 8] >> (row % 8)) & 1u);
+    }
+};
+
+// ─── Columns for a field selection of one category ────────────────────────────
+class ColumnarBatch {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // One column per field, in the given order.
+    // Throws std::runtime_error for FieldIds outside plan's category.
+    ColumnarBatch(const CategoryPlan& plan, std::span<const FieldId> fields);
+
+    // One column per field of the selection, in selection order; an item with
+    // an empty field list contributes all of its fields (see ItemSelection).
+    // Throws std::runtime_error for unknown items or fields.
+    ColumnarBatch(const CategoryPlan& plan, const std::vector<ItemSelection>& items);
+
+    [[nodiscard]] const CategoryPlan& plan() const noexcept { return *plan_; }
+    [[nodiscard]] size_t rows() const noexcept { return rows_; }
+    [[nodiscard]] std::span<const Column> columns() const noexcept { return columns_; }
+    [[nodiscard]] const Column& column(size_t i) const { return columns_.at(i); }
+
+    // Column of a field, or nullptr if the field is not selected.
+    [[nodiscard]] const Column* find(FieldId id) const noexcept {
+        const size_t c = columnOf(id);
+        return c == npos ? nullptr : &columns_[c];
+    }
+
+    // Drop every row, keeping the buffers' capacity.
+    void clear() noexcept;
+    void reserve(size_t rows);
+
+    // ── Row building (used by Codec::decodeColumns) ──────────────────────────
+    // Whether item idx holds a selected field.
+    [[nodiscard]] bool wants(ItemIndex idx) const noexcept { return items_[idx]; }
+    [[nodiscard]] size_t columnOf(FieldId id) const noexcept {
+        return id < column_of_.size() ? column_of_[id] : npos;
+    }
+    // Append a row / n rows with every column null.
+    void appendRow();
+    void appendRows(size_t n);
+    // Remove the last row.
+    void popRow() noexcept;
+    // Set column c of the last row; a value already set in this row is kept.
+    void set(size_t c, uint64_t raw) noexcept { setAt(c, rows_ - 1, raw); }
+    // Same, for any row (used by ArchiveReader::readColumns).
+    void setAt(size_t c, size_t row, uint64_t raw) noexcept {
+        Column& col = columns_[c];
+        uint8_t& byte = col.validity[row / 8];
+        const uint8_t bit = static_cast<uint8_t>(1u << (row % 8));
+        if (byte & bit) return;
+        byte |= bit;
+        col.values[row] = raw;
+        --col.null_count;
+    }
+
+private:
+    void addColumn(FieldId id);
+
+    const CategoryPlan*        plan_;
+    std::vector<Column>        columns_;
+    std::vector<size_t>        column_of_; // FieldId → column, npos if not selected
+    std::bitset<kMaxPlanItems> items_;     // ItemIndex → holds a selected field
+    size_t                     rows_{0};
+};
+
+} // namespace asterix
@@ -0,0 +1,134 @@
+#pragma once
+// Compact.hpp – Interned-field decoded representation.
+//
+// A CompactRecord stores every decoded value in a flat array indexed by the
+// category's FieldIds (see internFields()), with presence bitmaps for fields
+// and items.  Repeated values (Repetitive, RepetitiveGroup[FX]) and Explicit
+// payloads live in two shared pools, so decoding a record costs a handful of
+// vector allocations instead of one std::map node per field.
+//
+// Usage:
+//   const CategoryDef& def = codec.category(48);
+//   const ItemIndex i040 = codec.plan(48).findItem("040");
+//   const FieldId   rho  = findField(def, "040", "RHO");
+//
+//   CompactBlock block = codec.decodeCompact(raw);
+//   for (const auto& rec : block.records)
+//       if (auto item = rec.item(i040); item.present())
+//           use(item.field(rho));
+
+#include "Plan.hpp"
+#include "Types.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace asterix {
+
+// ─── Per-item ranges into the CompactRecord pools ─────────────────────────────
+struct CompactItem {
+    uint32_t rep_first{0}; // first value in CompactRecord::rep_values
+    uint32_t rep_count{0}; // repetitions (rows of PlanItem::columns values)
+    uint32_t raw_first{0}; // first byte in CompactRecord::raw (or ::bytes, if borrowed)
+    uint16_t raw_len{0};   // Explicit / SP payload length
+};
+
+class CompactItemView;
+
+// ─── One decoded record in interned-field form ────────────────────────────────
+struct CompactRecord {
+    const CategoryPlan* plan{nullptr}; // plan the record was decoded with
+    uint16_t    variation{0};          // index into plan->variations
+    bool        valid{true};
+    std::string error;
+    DecodeError fault;                 // structured form of error
+
+    std::vector<uint64_t>    values;     // FieldId → raw value (first repetition if repeated)
+    std::vector<uint64_t>    field_bits; // FieldId presence bitmap, 64 fields per word
+    std::vector<uint64_t>    item_bits;  // ItemIndex presence bitmap, 64 items per word
+    std::vector<CompactItem> items;      // ItemIndex → pool ranges
+    std::vector<uint64_t>    rep_values; // repeated values, row-major per item
+    std::vector<uint8_t>     raw;        // Explicit / SP payload bytes
+    // The record's wire bytes, borrowed from the decoded buffer, when decoded
+    // with BorrowMode::Payloads or Items: payloads then point into it and raw
+    // stays empty.  Empty otherwise.
+    std::span<const uint8_t> bytes;
+
+    [[nodiscard]] bool hasItem(ItemIndex idx) const noexcept {
+        return idx < items.size() && ((item_bits[idx / 64] >> (idx % 64)) & 1u);
+    }
+    [[nodiscard]] bool has(FieldId id) const noexcept {
+        return id < values.size() && ((field_bits[id / 64] >> (id % 64)) & 1u);
+    }
+    // Raw value of a field, 0 if it was not decoded.
+    [[nodiscard]] uint64_t field(FieldId id) const noexcept {
+        return has(id) ? values[id] : 0;
+    }
+    [[nodiscard]] const std::string& variationName() const {
+        return *plan->variations[variation].name;
+    }
+    [[nodiscard]] CompactItemView item(ItemIndex idx) const noexcept;
+};
+
+// ─── Read-only view of one item of a CompactRecord ────────────────────────────
+class CompactItemView {
+public:
+    CompactItemView(const CompactRecord& rec, ItemIndex idx) noexcept
+        : rec_(&rec), idx_(idx) {}
+
+    [[nodiscard]] bool present() const noexcept { return rec_->hasItem(idx_); }
+    [[nodiscard]] bool has(FieldId id) const noexcept { return present() && rec_->has(id); }
+
+    // Scalar field value (first repetition for repeated fields), 0 if absent.
+    [[nodiscard]] uint64_t field(FieldId id) const noexcept {
+        return present() ? rec_->field(id) : 0;
+    }
+
+    // Repetitive / RepetitiveGroup[FX]: number of repetitions decoded.
+    [[nodiscard]] size_t repetitions() const noexcept {
+        return present() ? rec_->items[idx_].rep_count : 0;
+    }
+    // Value of a group field in repetition `rep` (0 if out of range).
+    [[nodiscard]] uint64_t field(FieldId id, size_t rep) const noexcept {
+        if (rep >= repetitions() || id >= rec_->plan->fields.size()) return 0;
+        const PlanField& pf = rec_->plan->fields[id];
+        const size_t width  = rec_->plan->items[idx_].columns;
+        if (pf.item != idx_ || pf.column >= width) return 0;
+        return rec_->rep_values[rec_->items[idx_].rep_first + rep * width + pf.column];
+    }
+    // Repetitive (single 7-bit value per repetition).
+    [[nodiscard]] uint64_t repetition(size_t rep) const noexcept {
+        if (rep >= repetitions()) return 0;
+        const size_t width = rec_->plan->items[idx_].columns;
+        return rec_->rep_values[rec_->items[idx_].rep_first + rep * width];
+    }
+    // Explicit / SP payload (length byte excluded).
+    [[nodiscard]] std::span<const uint8_t> payload() const noexcept {
+        if (!present()) return {};
+        const CompactItem& ci = rec_->items[idx_];
+        const std::span<const uint8_t> pool = rec_->bytes.empty() ? rec_->raw : rec_->bytes;
+        return pool.subspan(ci.raw_first, ci.raw_len);
+    }
+
+private:
+    const CompactRecord* rec_;
+    ItemIndex            idx_;
+};
+
+inline CompactItemView CompactRecord::item(ItemIndex idx) const noexcept {
+    return CompactItemView{*this, idx};
+}
+
+// ─── A decoded Data Block in interned-field form ──────────────────────────────
+struct CompactBlock {
+    uint8_t  cat{0};
+    uint16_t length{0};                  // as read from the wire
+    std::vector<CompactRecord> records;
+    bool        valid{true};
+    std::string error;
+    DecodeError fault;                   // structured form of error
+};
+
+} // namespace asterix
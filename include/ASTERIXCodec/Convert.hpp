@@ -0,0 +1,115 @@
+#pragma once
+// Convert.hpp – Raw value → physical value / table text / octal code.
+//
+// A FieldConverter is compiled once per element from its ElementDef:
+//   • Table elements of up to kDenseTableBits bits get a dense array of
+//     string_views indexed by the raw value (wider ones keep the map lookup);
+//   • UnsignedQuantity / SignedQuantity become scale × raw, with two's
+//     complement sign extension for the signed case;
+//   • StringOctal becomes the code written in octal digits (Mode-3/A 7602).
+// The batch overloads convert a whole buffer – e.g. a ColumnarBatch column –
+// in one branch-free loop per call.
+//
+// Converters point into the CategoryDef they were built from (the plan's, for
+// CategoryConverters) and are tied to it like a Projection or ColumnarBatch.
+//
+// Usage:
+//   const CategoryConverters conv(codec.plan(48));
+//   const FieldId rho = findField(codec.category(48), "040", "RHO");
+//   double nm = conv[rho].physical(rec.field(rho));
+//   conv[rho].toPhysical(column.values, nm_buffer);
+
+#include "Plan.hpp"
+#include "Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace asterix {
+
+// Table elements up to this width are looked up in a dense array.
+inline constexpr unsigned kDenseTableBits = 10;
+
+class FieldConverter {
+public:
+    FieldConverter() = default;
+    explicit FieldConverter(const ElementDef& e);
+
+    [[nodiscard]] Encoding encoding() const noexcept { return encoding_; }
+    [[nodiscard]] uint16_t bits() const noexcept { return bits_; }
+    [[nodiscard]] double scale() const noexcept { return scale_; }
+    [[nodiscard]] std::string_view unit() const noexcept { return unit_; }
+
+    // Two's complement value of a SignedQuantity; raw as is otherwise.
+    [[nodiscard]] int64_t signedValue(uint64_t raw) const noexcept {
+        if (encoding_ != Encoding::SignedQuantity || bits_ == 0 || bits_ >= 64)
+            return static_cast<int64_t>(raw);
+        const unsigned shift = 64u - bits_;
+        return static_cast<int64_t>(raw << shift) >> shift;
+    }
+
+    // Physical value in unit(): scale × raw for quantities, the raw value
+    // itself for every other encoding.
+    [[nodiscard]] double physical(uint64_t raw) const noexcept {
+        switch (encoding_) {
+        case Encoding::UnsignedQuantity: return static_cast<double>(raw) * scale_;
+        case Encoding::SignedQuantity:   return static_cast<double>(signedValue(raw)) * scale_;
+        default:                         return static_cast<double>(raw);
+        }
+    }
+
+    // Table description of raw; empty if raw has no entry or the element is
+    // not Table-encoded.
+    [[nodiscard]] std::string_view text(uint64_t raw) const noexcept {
+        if (!dense_.empty()) return raw < dense_.size() ? dense_[raw] : std::string_view{};
+        if (!table_) return {};
+        auto it = table_->find(raw);
+        return it == table_->end() ? std::string_view{} : std::string_view{it->second};
+    }
+
+    // Raw value read as octal digits: 0xF82 (12 bits) → 7602.
+    [[nodiscard]] static uint32_t octal(uint64_t raw, unsigned bits) noexcept {
+        uint32_t code = 0;
+        for (int shift = static_cast<int>((bits + 2) / 3 * 3) - 3; shift >= 0; shift -= 3)
+            code = code * 10 + static_cast<uint32_t>((raw >> shift) & 7u);
+        return code;
+    }
+    [[nodiscard]] uint32_t octal(uint64_t raw) const noexcept { return octal(raw, bits_); }
+
+    // Batch forms of physical() / octal(); out must hold raw.size() values.
+    // Throws std::invalid_argument if it does not.
+    void toPhysical(std::span<const uint64_t> raw, std::span<double> out) const;
+    void toOctal(std::span<const uint64_t> raw, std::span<uint32_t> out) const;
+
+private:
+    Encoding         encoding_{Encoding::Raw};
+    uint16_t         bits_{0};
+    double           scale_{1.0};
+    std::string_view unit_;
+
+    std::vector<std::string_view>          dense_; // Table ≤ kDenseTableBits: raw → text
+    const std::map<uint64_t, std::string>* table_{nullptr};
+};
+
+// ─── One converter per interned field of a category ───────────────────────────
+class CategoryConverters {
+public:
+    explicit CategoryConverters(const CategoryPlan& plan);
+
+    // Converter of field id (a Raw pass-through for an unknown id).
+    [[nodiscard]] const FieldConverter& operator[](FieldId id) const noexcept {
+        static const FieldConverter kRaw;
+        return id < fields_.size() ? fields_[id] : kRaw;
+    }
+    [[nodiscard]] size_t size() const noexcept { return fields_.size(); }
+
+private:
+    std::vector<FieldConverter> fields_;
+};
+
+} // namespace asterix
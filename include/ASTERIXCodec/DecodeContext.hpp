@@ -0,0 +1,137 @@
+#pragma once
+// DecodeContext.hpp – Reusable decode storage for allocation-free steady state.
+//
+// Codec::decode() returns a fresh DecodedBlock, so every datagram pays for a
+// new records vector, one std::map node per item and per field, and every
+// payload vector.  A DecodeContext keeps all of that between calls:
+//   • DecodedRecord / CompactRecord objects beyond the current block's record
+//     count are parked, not destroyed;
+//   • std::map nodes are recycled through node handles (extract / insert),
+//     so keys and values are overwritten in place instead of reallocated;
+//   • vectors are cleared, never shrunk.
+// Once the context has seen the largest block of a feed, decoding performs no
+// heap allocation at all.
+//
+// A context is not thread-safe: use one per decoding thread.
+//
+// Usage:
+//   DecodeContext ctx;
+//   for (auto datagram : feed) {
+//       const DecodedBlock& block = codec.decodeInto(datagram, ctx);
+//       …  // valid until the next decodeInto() on ctx
+//   }
+
+#include "Compact.hpp"
+#include "Types.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace asterix {
+
+namespace detail {
+
+// Free list of detached std::map nodes.
+template <class Map>
+class NodePool {
+public:
+    using key_type    = typename Map::key_type;
+    using mapped_type = typename Map::mapped_type;
+
+    // Detach every node of m into the pool (m ends up empty).
+    void reclaim(Map& m) {
+        while (!m.empty()) nodes_.push_back(m.extract(m.begin()));
+    }
+
+    // Insert key into m, reusing a pooled node when one is available.
+    // An existing entry with the same key is returned unchanged.
+    mapped_type& acquire(Map& m, const key_type& key) {
+        if (nodes_.empty()) return m[key];
+        auto node = std::move(nodes_.back());
+        nodes_.pop_back();
+        node.key() = key;
+        auto res = m.insert(std::move(node));
+        if (!res.inserted) nodes_.push_back(std::move(res.node));
+        return res.position->second;
+    }
+
+    void clear() noexcept { nodes_.clear(); }
+
+private:
+    std::vector<typename Map::node_type> nodes_;
+};
+
+// Node pools for every map level of a DecodedRecord.
+struct RecordPools {
+    using FieldMap = std::map<std::string, uint64_t>;
+    using ItemMap  = std::map<std::string, DecodedItem>;
+    using SubMap   = std::map<std::string, FieldMap>;
+
+    NodePool<ItemMap>  items;
+    NodePool<FieldMap> fields;
+    NodePool<SubMap>   subs;
+
+    // Return the contents of rec to the pools, leaving it empty.
+    void reclaim(DecodedRecord& rec) {
+        for (auto& [id, item] : rec.items) {
+            fields.reclaim(item.fields);
+            for (auto& grp : item.group_repetitions) fields.reclaim(grp);
+            item.group_repetitions.clear(); // empty maps own no nodes
+            for (auto& [name, sub] : item.compound_sub_fields) fields.reclaim(sub);
+            subs.reclaim(item.compound_sub_fields);
+            item.repetitions.clear();
+            item.raw_bytes.clear();
+            item.payload = {};
+            item.wire    = {};
+        }
+        items.reclaim(rec.items);
+        rec.uap_variation.clear();
+        rec.valid = true;
+        rec.error.clear();
+        rec.fault = {};
+    }
+
+    void clear() noexcept {
+        items.clear();
+        fields.clear();
+        subs.clear();
+    }
+};
+
+} // namespace detail
+
+class DecodeContext {
+public:
+    // Result of the last Codec::decodeInto() / decodeCompactInto() on this context.
+    [[nodiscard]] const DecodedBlock& block()   const noexcept { return block_; }
+    [[nodiscard]] const CompactBlock& compact() const noexcept { return compact_; }
+
+    // Whether decodes into this context fill the `error` strings of blocks and
+    // records (default).  When off, failures are reported through `fault`
+    // only and cost no allocation; see describe() in DecodeError.hpp.
+    void setErrorText(bool on) noexcept { error_text_ = on; }
+    [[nodiscard]] bool errorText() const noexcept { return error_text_; }
+
+    // Drop every retained buffer and node (the next decode starts cold).
+    void release() {
+        block_   = {};
+        compact_ = {};
+        spare_records_.clear();
+        spare_compact_.clear();
+        pools_.clear();
+    }
+
+private:
+    friend class Codec;
+
+    DecodedBlock               block_;
+    CompactBlock               compact_;
+    std::vector<DecodedRecord> spare_records_; // parked records beyond block_.records
+    std::vector<CompactRecord> spare_compact_; // parked records beyond compact_.records
+    detail::RecordPools        pools_;
+    bool                       error_text_{true};
+};
+
+} // namespace asterix
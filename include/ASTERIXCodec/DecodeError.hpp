@@ -0,0 +1,75 @@
+#pragma once
+// DecodeError.hpp – Structured decode errors.
+//
+// The decoder never throws on malformed input.  Every failure is recorded as
+// a small DecodeError (reason code, item, byte offset) in the block's or the
+// record's `fault`; the familiar `error` string is derived from it with
+// describe().  A DecodeContext can skip building those strings altogether
+// (DecodeContext::setErrorText(false)), so a burst of bad traffic costs no
+// allocation – call describe() for the ones that are actually reported.
+//
+// Usage:
+//   ctx.setErrorText(false);
+//   const DecodedBlock& block = codec.decodeInto(raw, ctx);
+//   if (block.fault && block.fault.code == DecodeErrc::UnknownCategory) …
+//   log(describe(block.fault, codec.hasCategory(block.cat) ? &codec.plan(block.cat) : nullptr));
+
+#include <cstdint>
+#include <string>
+
+namespace asterix {
+
+struct CategoryPlan;
+
+enum class DecodeErrc : uint8_t {
+    None = 0,
+
+    // ── Data Block header ──────────────────────────────────────────────────
+    ShortHeader,         // fewer than 3 bytes
+    BadBlockLength,      // LEN < 3 or past the buffer          (value = LEN)
+    UnknownCategory,     // CAT not registered                   (value = CAT)
+    StaleProjection,     // Projection compiled against a replaced plan (value = CAT)
+
+    // ── Record structure ───────────────────────────────────────────────────
+    UnknownItem,         // FSPEC slot maps to an undefined item (sub = slot, value = variation)
+    NoProgress,          // record consumed no bytes
+
+    // ── Item length rules ──────────────────────────────────────────────────
+    FixedTruncated,
+    ExtendedTruncated,
+    RepetitiveTruncated,
+    GroupCountTruncated, // RepetitiveGroup: no count byte
+    GroupTruncated,      // RepetitiveGroup: fewer than count groups
+    GroupFXTruncated,
+    ExplicitEmpty,
+    ExplicitLength,
+    PsfTruncated,
+    SubItemTruncated,    // Compound sub-item                    (sub = sub-item slot)
+    UnsupportedType,
+
+    // ── Record-level (non-fatal: the record is kept, valid = false) ────────
+    MandatoryMissing,
+    OutOfRange,          // value outside the spec's min / max   (sub = FieldId, value = raw)
+};
+
+struct DecodeError {
+    DecodeErrc code{DecodeErrc::None};
+    uint16_t   item{0xFFFF}; // ItemIndex in the category plan; kNoItem if not item-specific
+    uint16_t   sub{0};       // see DecodeErrc
+    uint32_t   offset{0};    // from the first byte of the Data Block
+    uint32_t   value{0};     // see DecodeErrc
+
+    explicit operator bool() const noexcept { return code != DecodeErrc::None; }
+};
+
+// Short reason phrase, e.g. "buffer too short for Fixed".
+[[nodiscard]] const char* toString(DecodeErrc code) noexcept;
+
+// The message Codec stores in `error` for this fault.  plan (of the block's
+// category) resolves item, sub-item and UAP slot names; without it the
+// message falls back to indices.
+[[nodiscard]] std::string describe(const DecodeError& err, const CategoryPlan* plan);
+// Same, into out (its capacity is reused).
+void describeTo(std::string& out, const DecodeError& err, const CategoryPlan* plan);
+
+} // namespace asterix
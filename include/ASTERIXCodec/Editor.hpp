@@ -0,0 +1,91 @@
+#pragma once
+// Editor.hpp – In-place editing of an encoded Data Block.
+//
+// A BlockEditor holds a copy of one Data Block together with its item index
+// (the same length-only walk as Codec::view()), and rewrites it without
+// decoding or re-encoding the records:
+//   • set() patches a field of a Fixed item, or of a present Extended octet,
+//     straight in the bytes – the block keeps its length;
+//   • put() / erase() splice one item in or out of a record: the FSPEC is
+//     rebuilt, every other item is copied as its original byte range, and the
+//     record offsets and the block LEN follow.
+// Values are raw wire values, as in DecodedItem; the low `bits` of value are
+// written.  The UAP discriminator item cannot be edited (its value selects
+// the slot order of the rest of the record), and mandatory items cannot be
+// erased.
+//
+// Usage (a gateway re-stamping SAC/SIC):
+//   const FieldId sac = findField(codec.category(48), "010", "SAC");
+//   const FieldId sic = findField(codec.category(48), "010", "SIC");
+//   BlockEditor ed{codec};
+//   for (auto datagram : feed)
+//       if (!ed.load(datagram)) {
+//           ed.set(sac, 25);
+//           ed.set(sic, 7);
+//           forward(ed.bytes());
+//       }
+
+#include "Codec.hpp"
+#include "View.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace asterix {
+
+class BlockEditor {
+public:
+    // The codec must outlive the editor.
+    explicit BlockEditor(const Codec& codec) noexcept : codec_(&codec) {}
+
+    // Copy and index the Data Block at buf[0] (bytes after its LEN are
+    // ignored).  A block that does not decode is refused: the fault is
+    // returned and the editor is left empty.  Buffers are reused across loads.
+    DecodeError load(std::span<const uint8_t> buf);
+
+    // The edited Data Block.  Spans and views into the editor are valid until
+    // the next put(), erase() or load().
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return bytes_; }
+    [[nodiscard]] const BlockView& view() const noexcept { return view_; }
+    [[nodiscard]] RecordView record(size_t r) const noexcept { return view_.record(r); }
+    [[nodiscard]] size_t size() const noexcept { return view_.size(); }
+    [[nodiscard]] const CategoryPlan* plan() const noexcept { return view_.plan; }
+
+    // ── In place ─────────────────────────────────────────────────────────────
+    // Overwrite field id of record r; false if the field is not on the wire
+    // (item absent, or its Extended octet not present).  Throws
+    // std::runtime_error for a field outside a Fixed / Extended item or of the
+    // discriminator item.
+    bool set(size_t r, FieldId id, uint64_t value);
+    // The same, in every record; returns how many were patched.
+    size_t set(FieldId id, uint64_t value);
+
+    // ── Splicing ─────────────────────────────────────────────────────────────
+    // Insert or replace item idx of record r with bytes, which must be exactly
+    // one encoding of the item.  Throws std::runtime_error if they are not, if
+    // the record's UAP has no slot for idx, for the discriminator item, or if
+    // the block would exceed 65535 bytes.
+    void put(size_t r, ItemIndex idx, std::span<const uint8_t> bytes);
+    // The same with an item encoded from its values (item.item_id names it;
+    // see Codec::encode() for how values, payload and wire are written).
+    void put(size_t r, const DecodedItem& item);
+
+    // Remove item idx from record r; false if it was absent.  Throws
+    // std::runtime_error for the discriminator item or a mandatory item.
+    bool erase(size_t r, ItemIndex idx);
+
+private:
+    const Codec*         codec_;
+    std::vector<uint8_t> bytes_;
+    BlockView            view_;    // bytes point into bytes_
+    std::vector<uint8_t> record_;  // a record being rebuilt
+    std::vector<uint8_t> encoded_; // put(DecodedItem) scratch
+    std::vector<ItemSpan> spans_;  // spans of the rebuilt record
+
+    // Replace item idx of record r with bytes (empty: remove it).
+    void splice(size_t r, ItemIndex idx, std::span<const uint8_t> bytes);
+    void checkEditable(ItemIndex idx) const;
+};
+
+} // namespace asterix
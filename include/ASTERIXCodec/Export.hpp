@@ -0,0 +1,122 @@
+#pragma once
+// Export.hpp – Streaming JSON / CSV text of decoded or viewed records.
+//
+// A RecordExporter appends records of one category to a reusable text
+// buffer, straight from a CompactRecord (see Compact.hpp) or a RecordView
+// (see View.hpp) – no DecodedRecord maps and no iostreams:
+//   • JSON: one object per line (NDJSON),
+//       {"cat":62,"010":{"SAC":1,"SIC":2},"290":{"PSR":{"PSR":12}},"SP":"0a1b"}
+//     Fixed / Extended items are objects of their fields, Compound items
+//     objects of sub-item objects, Repetitive items arrays of values,
+//     RepetitiveGroup[FX] items arrays of objects, Explicit / SP payloads hex
+//     strings.  "uap" names the variation of categories with several UAPs;
+//     "error" holds the reason of an invalid record.
+//   • CSV: one line per record, one column per selected field (named like
+//     ColumnarBatch columns, "040.RHO"); repeated fields give their first
+//     repetition, absent fields an empty cell.  header() writes the names.
+//
+// Item and field names, sub-item names and CSV column names are escaped once,
+// when the exporter is built; numbers are written with std::to_chars.  With
+// physical, quantities are written as scale × raw in their unit and octal
+// codes (Mode-3/A) as their digits ("7602"); otherwise every value is the raw
+// unsigned field value.
+//
+// The buffer only grows: write records, hand text() to the output, clear()
+// and go on, so a warmed-up exporter does not allocate.
+//
+// Usage:
+//   RecordExporter json{codec.plan(48), {.physical = true}};
+//   RecordExporter csv{codec.plan(48), {.format = ExportFormat::Csv, .items = {{"010"}, {"040", {"RHO", "THETA"}}}}};
+//   codec.view(raw, block);
+//   json.write(block);
+//   std::fwrite(json.text().data(), 1, json.text().size(), stdout);
+//   json.clear();
+
+#include "Compact.hpp"
+#include "Convert.hpp"
+#include "Plan.hpp"
+#include "Projection.hpp"
+#include "View.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace asterix {
+
+enum class ExportFormat : uint8_t { Json, Csv };
+
+struct ExportOptions {
+    ExportFormat format{ExportFormat::Json};
+    bool         physical{false}; // quantities in their unit, octal codes as digits
+    char         separator{','};  // CSV
+    // Fields to export (see ItemSelection; an item with an empty field list
+    // contributes all of its fields, and its payload).  Empty: everything.
+    std::vector<ItemSelection> items;
+};
+
+class RecordExporter {
+public:
+    // Throws std::runtime_error for unknown items or fields in opts.items.
+    explicit RecordExporter(const CategoryPlan& plan, ExportOptions opts = {});
+
+    // CSV: the line of column names.  Nothing for JSON.
+    void header();
+
+    // Append one record / every record of a block.  Throw std::runtime_error
+    // if it was not decoded or viewed with this exporter's plan.
+    void write(const CompactRecord& rec);
+    void write(const RecordView& rec);
+    void write(const CompactBlock& block);
+    void write(const BlockView& block);
+
+    [[nodiscard]] std::string_view text() const noexcept { return out_; }
+    [[nodiscard]] size_t size() const noexcept { return out_.size(); }
+    // Drop the text, keeping the buffer's capacity.
+    void clear() noexcept { out_.clear(); }
+
+    [[nodiscard]] const CategoryPlan& plan() const noexcept { return *plan_; }
+    [[nodiscard]] std::span<const FieldId> columns() const noexcept { return columns_; }
+
+private:
+    struct ItemWriter; // walker sink / item emitter (Export.cpp)
+    struct RowSink;    // CSV values of a RecordView (Export.cpp)
+
+    const CategoryPlan*      plan_;
+    ExportOptions            opts_;
+    CategoryConverters       conv_;
+    std::string              out_;
+
+    std::bitset<kMaxPlanItems> items_;      // ItemIndex → exported
+    std::vector<uint8_t>       selected_;   // FieldId → exported
+    std::vector<FieldId>       columns_;    // CSV column order
+    std::vector<uint32_t>      column_of_;  // FieldId → CSV column, kNoColumn if not selected
+    std::vector<uint32_t>      field_sub_;   // FieldId → index into plan.sub_items, or kNoSub
+
+    // Pre-escaped tokens
+    std::string              record_open_;  // {"cat":62
+    std::vector<std::string> variation_;    // ,"uap":"name"   (several UAPs only)
+    std::vector<std::string> item_key_;     // "010":
+    std::vector<std::string> field_key_;    // "SAC":
+    std::vector<std::string> sub_key_;      // "PSR":          (by plan.sub_items index; empty if none selected)
+    std::vector<std::string> column_name_;  // 040.RHO, CSV-quoted if needed
+
+    // CSV row being written
+    std::vector<uint64_t> row_values_;
+    std::vector<uint8_t>  row_set_;
+
+    static constexpr uint32_t kNoSub    = 0xFFFFFFFF;
+    static constexpr uint32_t kNoColumn = 0xFFFFFFFF;
+
+    void build();
+    void checkPlan(const CategoryPlan* plan) const;
+    void value(FieldId id, uint64_t raw);
+    void csvRow();
+    void beginRecord(uint16_t variation, bool valid, std::string_view error);
+};
+
+} // namespace asterix
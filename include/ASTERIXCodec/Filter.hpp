@@ -0,0 +1,93 @@
+#pragma once
+// Filter.hpp – Record predicates evaluated on the wire bytes.
+//
+// A RecordFilter is compiled against a category's plan and answers "would
+// this record be wanted?" straight from its bytes: it reads the FSPEC, steps
+// over the items in front of the ones it tests with the length rules only
+// (the plan's byte count for Fixed items, the FX / REP / length octets for
+// the others), and compares fields of Fixed items where they sit.  Nothing is
+// decoded or allocated.
+//
+// A filter is a disjunction of terms, each a conjunction of clauses:
+//   • equals / oneOf / between on a field of a Fixed item (false when the
+//     item is absent);
+//   • present / absent on any item, from the FSPEC.
+// orElse() starts the next term; a filter without clauses matches every record.
+//
+// Attached to a Projection (Projection::filter()), every decode call taking
+// that projection skips non-matching records with length-only parsing, so
+// they never reach the output.  Like a Projection, a filter is tied to the
+// plan it was compiled with.
+//
+// Usage:
+//   RecordFilter f(codec.plan(48));
+//   f.equals("010", "SAC", 25).equals("010", "SIC", 1)
+//    .orElse().equals("010", "SAC", 25).equals("010", "SIC", 7);
+//   Projection proj;
+//   proj.filter(std::move(f));
+//   const DecodedBlock& block = codec.decodeInto(raw, ctx, proj);
+
+#include "Plan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace asterix {
+
+// Distinct items a filter may test (fields and presence clauses together).
+inline constexpr size_t kMaxFilterItems = 16;
+
+class RecordFilter {
+public:
+    explicit RecordFilter(const CategoryPlan& plan);
+
+    // Clauses of the current term.  Throw std::runtime_error for an unknown
+    // item or field, for a field outside a Fixed item, or past kMaxFilterItems.
+    RecordFilter& equals(std::string_view item, std::string_view field, uint64_t value);
+    RecordFilter& oneOf(std::string_view item, std::string_view field, std::vector<uint64_t> values);
+    RecordFilter& between(std::string_view item, std::string_view field, uint64_t lo, uint64_t hi);
+    RecordFilter& present(std::string_view item);
+    RecordFilter& absent(std::string_view item);
+
+    // Start a new term, OR-ed with the previous ones.
+    RecordFilter& orElse();
+
+    // Whether the record starting at record[0] matches.  A record whose items
+    // in front of a tested one break the length rules does not match.
+    [[nodiscard]] bool matches(std::span<const uint8_t> record) const noexcept;
+    // Same, and when the record does not match, set length to its byte count:
+    // the walk carries on past the tested items with the length rules, so a
+    // skipped record is measured once.  length is 0 when the record matches
+    // or its items break the length rules.
+    [[nodiscard]] bool matches(std::span<const uint8_t> record, size_t& length) const noexcept;
+
+    [[nodiscard]] const CategoryPlan& plan() const noexcept { return *plan_; }
+    [[nodiscard]] bool empty() const noexcept { return terms_.size() == 1 && terms_[0].empty(); }
+
+private:
+    enum class Op : uint8_t { Present, Absent, Range, OneOf };
+
+    struct Clause {
+        Op       op{Op::Present};
+        uint8_t  slot{0};       // into the located-item table
+        uint16_t bit_offset{0}; // within the Fixed item
+        uint16_t bits{0};
+        uint64_t lo{0};
+        uint64_t hi{0};
+        std::vector<uint64_t> values; // OneOf, sorted
+    };
+
+    const CategoryPlan*              plan_;
+    std::vector<std::vector<Clause>> terms_;
+    std::vector<ItemIndex>           items_;    // tested items; index = Clause::slot
+    std::vector<uint16_t>            last_ref_; // variation → last UAP slot to walk + 1
+
+    uint8_t itemSlot(std::string_view item);
+    Clause  fieldClause(std::string_view item, std::string_view field, Op op);
+    bool    match(std::span<const uint8_t> record, size_t* length) const noexcept;
+};
+
+} // namespace asterix
@@ -0,0 +1,86 @@
+#pragma once
+// Generated.hpp – Support code for the specialised codecs of asterix_codegen.
+//
+// tools/asterix_codegen turns a specs/CATxx.xml file into a header
+// (asterix_gen/catNNN.hpp) with one typed struct per Data Item and a
+// decode / encode function per item in which every bit offset and width is a
+// template argument.  The XML stays the single source of truth: the build
+// regenerates the headers whenever a spec changes.
+//
+// Generated codecs cover categories with a single UAP.  They bridge to the
+// interpreted representation with toDecoded() / fromDecoded(), which is how
+// the tests check both paths against each other.
+
+#include "Types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace asterix::gen::detail {
+
+// Bits [Off, Off + Bits) of p, MSB first.
+template <unsigned Off, unsigned Bits>
+constexpr uint64_t getBits(const uint8_t* p) noexcept {
+    static_assert(Bits >= 1 && Bits <= 64, "element width must be 1–64 bits");
+    constexpr unsigned first = Off / 8;
+    constexpr unsigned last  = (Off + Bits - 1) / 8;
+    if constexpr (last - first + 1 > 8) {
+        // Straddles 9 bytes: split into two ≤8-byte reads
+        return (getBits<Off, Bits - 32>(p) << 32) | getBits<Off + Bits - 32, 32>(p);
+    } else {
+        constexpr unsigned tail = (last + 1) * 8 - (Off + Bits); // unused low bits
+        uint64_t acc = 0;
+        for (unsigned i = first; i <= last; ++i) acc = (acc << 8) | p[i];
+        acc >>= tail;
+        if constexpr (Bits == 64) return acc;
+        else                      return acc & ((uint64_t{1} << Bits) - 1);
+    }
+}
+
+// OR the low Bits of v into bits [Off, Off + Bits) of the zeroed buffer p.
+template <unsigned Off, unsigned Bits>
+constexpr void putBits(uint8_t* p, uint64_t v) noexcept {
+    static_assert(Bits >= 1 && Bits <= 64, "element width must be 1–64 bits");
+    constexpr unsigned first = Off / 8;
+    constexpr unsigned last  = (Off + Bits - 1) / 8;
+    if constexpr (last - first + 1 > 8) {
+        putBits<Off, Bits - 32>(p, v >> 32);
+        putBits<Off + Bits - 32, 32>(p, v);
+    } else {
+        constexpr unsigned tail = (last + 1) * 8 - (Off + Bits);
+        if constexpr (Bits < 64) v &= (uint64_t{1} << Bits) - 1;
+        v <<= tail;
+        for (unsigned i = last + 1; i-- > first; v >>= 8) p[i] |= static_cast<uint8_t>(v);
+    }
+}
+
+// Append n zero bytes to out and return a pointer to the first of them.
+inline uint8_t* grow(std::vector<uint8_t>& out, size_t n) {
+    const size_t at = out.size();
+    out.resize(at + n);
+    return out.data() + at;
+}
+
+// FSPEC / PSF slot test: slot k is bit (7 - k % 7) of octet k / 7.
+constexpr bool slotSet(std::span<const uint8_t> spec, size_t slot) noexcept {
+    return slot / 7 < spec.size() && ((spec[slot / 7] >> (7 - slot % 7)) & 0x01u);
+}
+
+// Length of the FX-terminated octet chain at the start of b, or 0 if truncated.
+constexpr size_t fxLength(std::span<const uint8_t> b) noexcept {
+    for (size_t n = 0; n < b.size(); )
+        if ((b[n++] & 0x01u) == 0) return n;
+    return 0;
+}
+
+// Named value of a decoded item (0 when absent), for fromDecoded().
+inline uint64_t value(const std::map<std::string, uint64_t>& fields, const char* name) {
+    auto it = fields.find(name);
+    return it == fields.end() ? 0 : it->second;
+}
+
+} // namespace asterix::gen::detail
@@ -0,0 +1,128 @@
+#pragma once
+// Ingest.hpp – UDP / multicast receive pipeline in front of the decoder
+// (Linux; built with -DASTERIX_ENABLE_INGEST=ON).
+//
+// One receiver thread reads datagrams with recvmmsg() into a preallocated
+// batch slab and routes each one, by source address and port, to a decode
+// worker: it is copied into the next free slot of that worker's
+// single-producer / single-consumer ring (slots are preallocated, one
+// max_datagram buffer each).  Routing by source keeps every radar's
+// datagrams in order on one worker.  Workers cut datagrams into Data Blocks
+// (StreamDecoder), decode them into their own DecodeContext / BlockView and
+// call the handler.
+//
+// Backpressure: when a worker's ring is full the datagram is dropped and
+// counted (drop_when_full), or the receiver waits and the socket buffer takes
+// the excess – the kernel's own drops are reported too (SO_RXQ_OVFL).
+// writePrometheus() exports the counters next to Codec::metrics().
+//
+// IPv4 only.
+//
+// Usage:
+//   UdpIngest ingest{codec, {.port = 8600, .groups = {"239.1.1.48"}, .workers = 2},
+//                    [&](const IngestedBlock& b) { tracker.update(*b.decoded); }};
+//   ingest.start();
+//   …
+//   ingest.stop();
+
+#include "Codec.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace asterix {
+
+// What workers hand to the handler besides the raw block.
+enum class IngestDecode : uint8_t {
+    Raw,     // bytes only
+    View,    // IngestedBlock::view   (Codec::view())
+    Decoded, // IngestedBlock::decoded (Codec::decodeInto())
+    Compact, // IngestedBlock::compact (Codec::decodeCompactInto())
+};
+
+struct IngestOptions {
+    uint16_t                 port{0};         // 0: an ephemeral port, see UdpIngest::port()
+    std::string              bind_address;    // local IPv4 address ("" = any)
+    std::vector<std::string> groups;          // multicast groups to join
+    std::string              interface;       // IPv4 address of the interface to join on ("" = default)
+    unsigned                 workers{1};
+    size_t                   ring_slots{1024}; // per worker, rounded up to a power of two
+    size_t                   max_datagram{9000}; // longer datagrams are dropped (truncated)
+    unsigned                 batch{64};       // datagrams per recvmmsg()
+    int                      socket_buffer{0}; // SO_RCVBUF bytes (0 = system default)
+    bool                     drop_when_full{true};
+    IngestDecode             decode{IngestDecode::Decoded};
+    const Projection*        projection{nullptr}; // for Decoded / Compact; must outlive the ingest
+};
+
+// One Data Block, as seen by the handler.  Everything it points to is valid
+// for the duration of the call only.
+struct IngestedBlock {
+    unsigned                              worker{0};
+    uint32_t                              source{0}; // IPv4 address, host byte order
+    uint16_t                              port{0};
+    std::chrono::steady_clock::time_point received;  // after recvmmsg() returned
+    std::span<const uint8_t>              bytes;
+    const BlockView*                      view{nullptr};
+    const DecodedBlock*                   decoded{nullptr};
+    const CompactBlock*                   compact{nullptr};
+};
+
+struct IngestWorkerStats {
+    uint64_t datagrams{0};
+    uint64_t blocks{0};
+    uint64_t bytes_skipped{0};  // not framed as Data Blocks
+    uint64_t handler_errors{0}; // exceptions thrown by the handler (swallowed)
+    uint64_t queue_depth{0};    // datagrams waiting now
+    uint64_t queue_high_water{0};
+};
+
+struct IngestStats {
+    uint64_t datagrams{0};    // accepted into a ring
+    uint64_t bytes{0};
+    uint64_t batches{0};      // recvmmsg() calls that returned datagrams
+    uint64_t truncated{0};    // longer than max_datagram
+    uint64_t ring_drops{0};   // worker ring full
+    uint64_t kernel_drops{0}; // socket buffer overflows (SO_RXQ_OVFL)
+    std::vector<IngestWorkerStats> workers;
+};
+
+class UdpIngest {
+public:
+    using Handler = std::function<void(const IngestedBlock&)>;
+
+    // Open, bind and join; nothing is received before start().  The codec
+    // must outlive the ingest; the handler runs on the worker threads,
+    // concurrently when workers > 1.  Throws std::runtime_error if the socket
+    // cannot be set up.
+    UdpIngest(const Codec& codec, IngestOptions opts, Handler handler);
+    ~UdpIngest(); // stop()s
+
+    UdpIngest(const UdpIngest&)            = delete;
+    UdpIngest& operator=(const UdpIngest&) = delete;
+
+    // Start the receiver and the workers.  An ingest runs once: later calls,
+    // after stop() too, do nothing.
+    void start();
+    // Stop receiving; workers drain what is queued, then all threads join.
+    void stop();
+
+    [[nodiscard]] uint16_t port() const noexcept; // bound port
+    // Safe to call from any thread while running.
+    [[nodiscard]] IngestStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Prometheus text exposition of s (asterix_ingest_* families), appended to out.
+void writePrometheus(std::string& out, const IngestStats& s);
+
+} // namespace asterix
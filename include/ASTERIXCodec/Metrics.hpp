@@ -0,0 +1,108 @@
+#pragma once
+// Metrics.hpp – Optional decode counters and latency histograms.
+//
+// Configured with -DASTERIX_ENABLE_METRICS=ON (which defines ASTERIX_METRICS=1
+// for the library and its users), a Codec counts per registered category:
+//   • Data Blocks, records and bytes walked by every whole-block entry point
+//     (decode*, view, scanRecords, decodeColumns, the batch forms);
+//   • items per item, when their values are extracted (items that view() or
+//     scanRecords() only measure are not counted);
+//   • faults per DecodeErrc (a block's fatal record error, a record's
+//     MandatoryMissing or OutOfRange);
+//   • a log2-bucketed histogram of the time spent on each block's records.
+// Blocks rejected before a category is known (short header, bad LEN, CAT not
+// registered) are counted per reason in `rejected`.
+//
+// Counters are relaxed atomics sharded per thread on separate cache lines, so
+// decodeBatch() workers do not contend on them.  Without the option the
+// counting code is compiled out and metrics() returns an empty snapshot with
+// enabled = false.
+//
+// Usage:
+//   std::string text;
+//   writePrometheus(text, codec.metrics()); // serve as /metrics
+
+#include "DecodeError.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef ASTERIX_METRICS
+#define ASTERIX_METRICS 0
+#endif
+
+namespace asterix {
+
+struct CategoryPlan;
+
+inline constexpr bool kMetricsEnabled = ASTERIX_METRICS != 0;
+
+// ─── Per-block decode latency ─────────────────────────────────────────────────
+// Bucket i counts blocks of at most upperBoundNs(i) = 2^(kFirstBoundLog2 + i)
+// ns (256 ns … 67 ms); the last bucket is unbounded.  Counts are per bucket,
+// not cumulative.
+struct LatencyHistogram {
+    static constexpr size_t   kBuckets        = 20;
+    static constexpr unsigned kFirstBoundLog2 = 8;
+
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t sum_ns{0};
+
+    [[nodiscard]] static constexpr size_t bucket(uint64_t ns) noexcept {
+        if (ns <= (uint64_t{1} << kFirstBoundLog2)) return 0;
+        const size_t i = static_cast<size_t>(std::bit_width(ns - 1)) - kFirstBoundLog2;
+        return i < kBuckets ? i : kBuckets - 1;
+    }
+    // UINT64_MAX for the last bucket.
+    [[nodiscard]] static constexpr uint64_t upperBoundNs(size_t i) noexcept {
+        return i + 1 < kBuckets ? uint64_t{1} << (kFirstBoundLog2 + i) : UINT64_MAX;
+    }
+    [[nodiscard]] uint64_t count() const noexcept {
+        uint64_t n = 0;
+        for (uint64_t c : counts) n += c;
+        return n;
+    }
+};
+
+// ─── Snapshot ─────────────────────────────────────────────────────────────────
+inline constexpr size_t kDecodeErrcCount = static_cast<size_t>(DecodeErrc::OutOfRange) + 1;
+
+struct CategoryMetrics {
+    uint8_t             cat{0};
+    const CategoryPlan* plan{nullptr}; // names items; valid while the category is registered
+    uint64_t            blocks{0};
+    uint64_t            records{0};
+    uint64_t            bytes{0};      // Data Block LEN, header included
+    std::vector<uint64_t> items;       // ItemIndex → items decoded
+    std::array<uint64_t, kDecodeErrcCount> faults{}; // DecodeErrc → count
+    LatencyHistogram    latency;
+};
+
+struct CodecMetrics {
+    bool enabled{kMetricsEnabled};
+    std::vector<CategoryMetrics> categories; // by category number
+    std::array<uint64_t, kDecodeErrcCount> rejected{}; // header faults, DecodeErrc → count
+
+    // Metrics of cat, or nullptr if it is not registered.
+    [[nodiscard]] const CategoryMetrics* find(uint8_t cat) const noexcept {
+        for (const auto& c : categories)
+            if (c.cat == cat) return &c;
+        return nullptr;
+    }
+};
+
+// Stable snake_case name of a reason, used as the Prometheus "reason" label
+// (e.g. "psf_truncated").
+[[nodiscard]] const char* metricLabel(DecodeErrc code) noexcept;
+
+// Append m in the Prometheus text exposition format: asterix_blocks_total,
+// asterix_records_total, asterix_bytes_total, asterix_items_total,
+// asterix_faults_total, asterix_rejected_blocks_total and the
+// asterix_block_decode_seconds histogram, labelled by cat / item / reason.
+void writePrometheus(std::string& out, const CodecMetrics& m);
+
+} // namespace asterix
@@ -0,0 +1,94 @@
+#pragma once
+// Packer.hpp – Size- and time-bounded Data Block packing for publishers.
+//
+// A BlockPacker collects records of one category, one at a time, into a
+// Data Block under a byte budget (typically what fits a UDP datagram without
+// fragmenting).  A block is closed and handed to the sink when
+//   • the next record would take it past the budget (that record opens the
+//     next block);
+//   • poll() finds its first record older than max_delay;
+//   • flush() is called.
+// Records are encoded straight into the block buffer and LEN is patched in
+// place when it closes.  Blocks live in a ring of ring_size buffers whose
+// capacity is reused, so a warmed-up packer does not allocate: the span given
+// to the sink stays valid until ring_size - 1 further blocks have closed
+// (with ring_size 1, only during the call).
+//
+// A record larger than the budget on its own is still sent, alone in its
+// block.  Records pending when the packer is destroyed are dropped: flush()
+// first.
+//
+// Usage:
+//   BlockPacker packer{codec, 48, {.max_block_bytes = 1400},
+//                      [&](std::span<const uint8_t> block) { socket.send(block); }};
+//   for (const auto& plot : plots) packer.add(plot);
+//   packer.poll();  // at every tick: closes a block left waiting too long
+
+#include "Codec.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace asterix {
+
+struct PackerOptions {
+    size_t                    max_block_bytes{1400}; // budget, 3-byte header included
+    std::chrono::microseconds max_delay{10000};      // oldest record waiting in a block
+    size_t                    ring_size{4};          // output buffers (≥ 1)
+};
+
+class BlockPacker {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Sink  = std::function<void(std::span<const uint8_t> block)>;
+
+    // The codec must outlive the packer.  Throws std::runtime_error if cat is
+    // not registered, or if the options are out of range (a budget below 4 or
+    // above 65535 bytes, an empty ring).
+    BlockPacker(const Codec& codec, uint8_t cat, PackerOptions opts, Sink sink);
+
+    // Encode rec into the open block (see Codec::encode() for rec).  Throws
+    // what encode() throws; the open block is then left as it was.
+    void add(const DecodedRecord& rec);
+    // Append one pre-encoded record of this category (FSPEC included).
+    // Throws std::runtime_error if the bytes are not exactly one record.
+    void add(std::span<const uint8_t> record);
+
+    // Close the open block if its first record was added max_delay or more
+    // before now.  Returns whether a block was closed.
+    bool poll(Clock::time_point now = Clock::now());
+    // Close the open block, if it holds any record.
+    void flush();
+
+    [[nodiscard]] size_t pending() const noexcept { return records_; } // records in the open block
+    [[nodiscard]] size_t pendingBytes() const noexcept { return ring_[cur_].size(); }
+    [[nodiscard]] uint64_t blocks() const noexcept { return blocks_; } // closed so far
+
+private:
+    const Codec*        codec_;
+    const CategoryPlan* plan_;
+    PackerOptions       opts_;
+    Sink                sink_;
+
+    std::vector<std::vector<uint8_t>> ring_;
+    size_t            cur_{0};     // ring_[cur_] is the open block
+    size_t            records_{0};
+    Clock::time_point opened_;     // when its first record was added
+    uint64_t          blocks_{0};
+    std::vector<uint8_t> carry_;   // record moving to the next block
+
+    // Account for a record just written at ring_[cur_][at …]: close the block
+    // in front of it if it went over budget.
+    void placed(size_t at);
+    // Close the open block as its first `length` bytes; bytes past them move
+    // to the next block.
+    void close(size_t length);
+    // Make ring_[cur_] an empty block followed by carry_.
+    void open();
+};
+
+} // namespace asterix
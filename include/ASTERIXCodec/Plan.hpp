@@ -0,0 +1,187 @@
+#pragma once
+// Plan.hpp – Compiled, index-based decode plan for one registered category.
+//
+// registerCategory() flattens a CategoryDef into contiguous arrays so that the
+// decode hot path never walks a std::map or compares a string:
+//   • every UAP variation becomes a vector of slot → item-index entries;
+//   • the ElementDefs of every item, Extended octet, repetition group and
+//     Compound sub-item are packed into one element array, referenced by
+//     [first, first + count) ranges.
+//
+// A plan owns its CategoryDef and points into it, so it is neither copyable
+// nor movable; it is always handed out as std::shared_ptr<const CategoryPlan>.
+
+#include "Types.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace asterix {
+
+namespace detail {
+class CategoryCounters; // Counters.hpp
+}
+
+// Index of an item inside CategoryPlan::items (same order as CategoryDef::items).
+using ItemIndex = uint16_t;
+
+inline constexpr ItemIndex kNoItem      = 0xFFFF; // "-" or "rfs" UAP slot
+inline constexpr ItemIndex kUnknownItem = 0xFFFE; // UAP references an undefined item
+
+// Upper bound on items per category (lets per-record item sets live in a std::bitset).
+inline constexpr size_t kMaxPlanItems = 512;
+
+// Half-open range into one of the CategoryPlan arrays.
+struct PlanRange {
+    uint32_t first{0};
+    uint32_t count{0};
+
+    [[nodiscard]] uint32_t end() const noexcept { return first + count; }
+};
+
+// ─── One leaf element (Spare included, for bit accounting) ────────────────────
+struct PlanElement {
+    const ElementDef* def{nullptr};
+    uint16_t bits{0};
+    uint16_t bit_offset{0}; // from the start of the enclosing octet / group / sub-item
+    bool     is_spare{false};
+    FieldId  field{kNoField};
+};
+
+// ─── One PSF slot of a Compound item ──────────────────────────────────────────
+struct PlanSubItem {
+    const CompoundSubItemDef* def{nullptr};
+    PlanRange elements;
+    uint16_t  fixed_bytes{0};
+    bool      unused{true}; // "-" slot
+};
+
+// ─── One Data Item ────────────────────────────────────────────────────────────
+struct PlanItem {
+    const DataItemDef* def{nullptr};
+    ItemType type{ItemType::Fixed};
+    bool     mandatory{false};
+
+    uint16_t  fixed_bytes{0}; // Fixed
+    uint16_t  group_bytes{0}; // RepetitiveGroup / RepetitiveGroupFX (FX bit included)
+    uint16_t  columns{0};     // non-spare values per repetition (Repetitive, groups)
+    PlanRange elements;       // Fixed, Repetitive(Group/GroupFX): into CategoryPlan::elements
+    PlanRange octets;         // Extended: into CategoryPlan::octets
+    PlanRange sub_items;      // Compound: into CategoryPlan::sub_items
+    PlanRange limits;         // into CategoryPlan::limits
+    PlanRange fields;         // its FieldIds (internFields() numbers them consecutively)
+};
+
+// ─── A min / max range of one element, in raw units ───────────────────────────
+struct PlanLimit {
+    uint32_t element{0}; // index into CategoryPlan::elements
+    bool     is_signed{false};
+    int64_t  lo{0};      // raw (sign-extended if is_signed) must be in [lo, hi]
+    int64_t  hi{0};
+};
+
+// ─── Where an interned field lives ────────────────────────────────────────────
+struct PlanField {
+    ItemIndex item{kNoItem};
+    uint16_t  column{0};   // position among the item's repeated values
+    uint32_t  element{0};  // index into CategoryPlan::elements
+};
+
+// ─── One UAP variation ────────────────────────────────────────────────────────
+// An occupied UAP slot, as listed by the FSPEC dispatch table.
+struct PlanSlot {
+    ItemIndex item{kNoItem}; // kUnknownItem if the slot names an undefined item
+    uint16_t  slot{0};
+};
+
+struct PlanVariation {
+    const std::string*              name{nullptr};
+    const std::vector<std::string>* refs{nullptr}; // original slot list, for error messages
+    std::vector<ItemIndex>          slots;         // UAP slot (0-based) → item index
+
+    // FSPEC dispatch: for FSPEC octet o and its presence bits p (octet >> 1),
+    // dispatch[o * 128 + p] is the range of dispatch_slots holding the
+    // occupied slots that p marks present, in UAP order.
+    std::vector<PlanRange> dispatch;
+    std::vector<PlanSlot>  dispatch_slots;
+
+    [[nodiscard]] size_t octets() const noexcept { return dispatch.size() / 128; }
+};
+
+// ─── Compiled UAP discriminator ───────────────────────────────────────────────
+// The discriminator field is read straight from the discriminator item's bytes:
+// bit_offset counts from the first bit of the item (FX bits included).
+//
+// When every variation it can select agrees with the default one on the slots
+// up to and including the discriminator's (CAT01: I010, I020), a record is
+// walked once, and the variation switches right after the discriminator
+// (leading).  Otherwise the items in front of it may differ in number and
+// length, so it is located per candidate: the default variation first, then
+// each selectable one, the items before the discriminator are measured with
+// the candidate's slots, and the first candidate whose discriminator value
+// selects that same candidate wins (bytes can fit more than one: this order
+// decides).  The record is then walked once with it.  If none is
+// self-consistent (or the discriminator is absent), the default variation is
+// used.
+struct PlanUapCase {
+    static constexpr uint16_t kAbsent = 0xFFFF;
+
+    ItemIndex item{kNoItem};
+    uint16_t  bit_offset{0};
+    uint16_t  bits{0};
+    bool      leading{true};
+    std::vector<uint16_t> slots; // variation → discriminator's UAP slot, or kAbsent
+    std::vector<std::pair<uint64_t, uint16_t>> value_to_variation; // sorted by value
+};
+
+// ─── Full compiled category ───────────────────────────────────────────────────
+struct CategoryPlan {
+    CategoryPlan() = default;
+    CategoryPlan(const CategoryPlan&)            = delete;
+    CategoryPlan& operator=(const CategoryPlan&) = delete;
+
+    CategoryDef def;
+
+    // Distinct for every plan compilePlan() builds: a replaced plan's address
+    // may be reused, its id never is.
+    uint64_t id{0};
+
+    std::vector<PlanItem>      items;
+    std::vector<PlanElement>   elements;
+    std::vector<PlanRange>     octets;    // Extended octets → element ranges
+    std::vector<PlanSubItem>   sub_items;
+    std::vector<PlanVariation> variations;
+    std::vector<ItemIndex>     mandatory; // in item-ID order
+    std::vector<PlanField>     fields;    // FieldId → location
+    std::vector<PlanLimit>     limits;    // ranged elements, grouped by item
+
+    std::bitset<kMaxPlanItems> mandatory_mask; // ItemIndex → mandatory
+
+    uint16_t default_variation{0};
+    std::optional<PlanUapCase> uap_case;
+
+    // Decode counters of Codec::metrics(); null unless built with ASTERIX_METRICS.
+    std::shared_ptr<detail::CategoryCounters> counters;
+
+    // Item lookup by ID string (setup-time helper; returns kNoItem if absent).
+    [[nodiscard]] ItemIndex findItem(std::string_view id) const noexcept;
+
+    // Variation lookup by name (returns default_variation if absent).
+    [[nodiscard]] uint16_t findVariation(std::string_view name) const noexcept;
+};
+
+// Compile a category definition into its decode plan.
+// Throws std::runtime_error if the UAP section is inconsistent.
+[[nodiscard]] std::shared_ptr<const CategoryPlan> compilePlan(CategoryDef def);
+
+// "CAT48" – a category as named in error messages.
+[[nodiscard]] std::string catName(uint8_t cat);
+
+} // namespace asterix
@@ -0,0 +1,138 @@
+#pragma once
+// Projection.hpp – Decode only selected items / fields.
+//
+// A Projection is compiled against a category's plan into an item bitmap and
+// a FieldId bitmap.  Items outside the selection are skipped with length-only
+// parsing (see measureItem() in Walker.hpp) and never reach the output;
+// fields outside the selection of a kept item are dropped.
+//
+// Categories without a selection decode in full.  A selection is tied to the
+// plan it was compiled with: after registerCategory() replaces a category,
+// select() / filter() it again.  Until then the selection is stale(), and
+// decoding a block of that category fails it with DecodeErrc::StaleProjection
+// rather than silently decoding in full.
+//
+// borrow() makes decode hand out spans into the decoded buffer instead of
+// copies: Explicit / SP payloads (DecodedItem::payload, CompactItemView::
+// payload()) and, with BorrowMode::Items, every kept DecodedItem's wire bytes
+// (DecodedItem::wire), ready to be forwarded or re-encoded as they are.  The
+// results then borrow the buffer and must not outlive it.
+//
+// A category may also carry a RecordFilter (see Filter.hpp): records it
+// rejects are skipped whole, before any of their items is decoded.
+//
+// validate() sets how much a record is checked beyond the length rules (which
+// always apply: they find the items).  Structural skips the mandatory-item
+// check for trusted high-rate feeds; Full adds the spec's min / max ranges
+// (a record outside them is kept with valid = false, fault OutOfRange).
+//
+// Usage:
+//   Projection proj;
+//   proj.select(codec.plan(48), {{"010"}, {"140"}, {"040", {"RHO"}}, {"070"}});
+//   DecodedBlock block = codec.decode(raw, proj);
+
+#include "Filter.hpp"
+#include "Plan.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace asterix {
+
+// How decode exposes item bytes (all categories of a Projection).
+enum class BorrowMode : uint8_t {
+    Copy,     // payloads copied into DecodedItem::raw_bytes / CompactRecord::raw
+    Payloads, // Explicit / SP payloads as spans into the decoded buffer
+    Items,    // Payloads, plus DecodedItem::wire for every kept item
+              // (a CompactRecord gets its payloads borrowed only)
+};
+
+// How much decode checks each record (all categories of a Projection).
+enum class Validation : uint8_t {
+    Structural, // length rules only
+    Mandatory,  // + mandatory items present (the default)
+    Full,       // + field values within the spec's min / max
+};
+
+// One selected item.  An empty field list keeps every field; otherwise each
+// name is an element name of the item or the name of a Compound sub-item
+// (which keeps all of that sub-item's fields).
+struct ItemSelection {
+    std::string              item;
+    std::vector<std::string> fields;
+};
+
+// The FieldIds a selection names, in selection order, each once.  Throws
+// std::runtime_error for unknown items or fields.
+[[nodiscard]] std::vector<FieldId> resolveSelection(const CategoryPlan& plan,
+                                                    const std::vector<ItemSelection>& items);
+
+// Compiled selection for one category.
+struct CategoryProjection {
+    uint8_t                    cat{0};
+    uint64_t                   plan_id{0}; // CategoryPlan::id compiled against
+    std::bitset<kMaxPlanItems> items;      // ItemIndex → decode
+    std::bitset<kMaxPlanItems> filtered;   // ItemIndex → honour `fields`
+    std::vector<uint64_t>      fields;     // FieldId bitmap, 64 fields per word
+    std::optional<RecordFilter> filter;    // records to keep (all if unset)
+
+    [[nodiscard]] bool keeps(ItemIndex idx) const noexcept { return items[idx]; }
+    [[nodiscard]] bool keeps(ItemIndex idx, FieldId id) const noexcept {
+        return !filtered[idx] ||
+               (id / 64 < fields.size() && ((fields[id / 64] >> (id % 64)) & 1u));
+    }
+};
+
+class Projection {
+public:
+    // Compile a selection for plan's category, replacing any earlier one.
+    // Throws std::runtime_error for unknown items or fields.
+    Projection& select(const CategoryPlan& plan, const std::vector<ItemSelection>& items);
+
+    // Keep only the records of f's category that f matches, replacing any
+    // earlier filter.  Without a select() for the category, kept records
+    // decode in full.
+    Projection& filter(RecordFilter f);
+
+    // Borrow payloads / item bytes from the decoded buffer (default: Copy).
+    Projection& borrow(BorrowMode mode) noexcept {
+        borrow_ = mode;
+        return *this;
+    }
+    [[nodiscard]] BorrowMode borrowMode() const noexcept { return borrow_; }
+
+    // Record checks beyond the length rules (default: Mandatory).
+    Projection& validate(Validation level) noexcept {
+        validation_ = level;
+        return *this;
+    }
+    [[nodiscard]] Validation validation() const noexcept { return validation_; }
+
+    // Selection compiled against plan, or nullptr (decode everything).
+    [[nodiscard]] const CategoryProjection* find(const CategoryPlan& plan) const noexcept {
+        for (const auto& c : cats_)
+            if (c.cat == plan.def.cat) return c.plan_id == plan.id ? &c : nullptr;
+        return nullptr;
+    }
+
+    // Whether plan's category has a selection compiled against another plan
+    // (one registerCategory() has since replaced).
+    [[nodiscard]] bool stale(const CategoryPlan& plan) const noexcept {
+        for (const auto& c : cats_)
+            if (c.cat == plan.def.cat) return c.plan_id != plan.id;
+        return false;
+    }
+
+private:
+    std::vector<CategoryProjection> cats_;
+    BorrowMode                      borrow_{BorrowMode::Copy};
+    Validation                      validation_{Validation::Mandatory};
+
+    // The entry of plan's category (an empty one, plan_id unset, if new).
+    CategoryProjection& entry(const CategoryPlan& plan);
+};
+
+} // namespace asterix
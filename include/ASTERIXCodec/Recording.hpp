@@ -0,0 +1,165 @@
+#pragma once
+// Recording.hpp – Memory-mapped ASTERIX recording files with a time index.
+//
+// A RecordingReader maps a recording read-only and hands out its Data Blocks
+// as spans into the mapping (no copy, no decode).  Two layouts are read:
+//   • Raw   – Data Blocks back to back;
+//   • Final – packets of [byte count 2B][failure 1B][line 1B][day 1B]
+//             [time 3B, 10 ms units][Data Blocks…][A5 A5 A5 A5], the byte
+//             count covering header and padding.
+//
+// Each block's time is the time of day of its first record, read from the
+// category's time item (I002/030, I034/030, I048/140, I062/070 – 1/128 s), or
+// the Final packet time for other categories.  Times are in seconds from the
+// midnight before the recording starts: a drop of more than 12 h is taken as
+// a midnight crossing, so days of recording keep increasing times.  A block
+// without a time of its own carries the latest time seen before it.
+//
+// Opening a recording builds a sparse index – one entry every index_stride
+// blocks, with the latest time and the categories seen so far – and saves it
+// next to the file (<recording>.asxi).  It is reused while the recording's
+// size and modification time are unchanged, so seek() is a binary search plus
+// a scan of at most one stride.
+//
+// Usage:
+//   RecordingReader rec{"2024-05-01.ff", codec};
+//   for (auto it = rec.seek(14 * 3600 + 2 * 60); it != rec.end() && it->time < 14 * 3600 + 5 * 60; ++it)
+//       process(codec.decodeInto(it->bytes, ctx));
+
+#include "Codec.hpp"
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace asterix {
+
+enum class RecordingFormat : uint8_t {
+    Auto, // Final if the first bytes parse as a Final packet, Raw otherwise
+    Raw,
+    Final,
+};
+
+struct RecordingOptions {
+    RecordingFormat       format{RecordingFormat::Auto};
+    uint32_t              index_stride{256}; // blocks per index entry
+    bool                  persist_index{true};
+    std::filesystem::path index_path;        // default: <recording>.asxi
+};
+
+// One Data Block of a recording.
+struct RecordedBlock {
+    std::span<const uint8_t> bytes;  // the Data Block, in the mapping
+    uint64_t                 offset{0}; // of bytes[0] in the file
+    uint8_t                  cat{0};
+    double                   time{0};   // seconds, see above
+    bool                     timed{false}; // time read from this block / its packet
+};
+
+// Index entry: iteration can resume at offset (a block, or for Final a packet
+// start) with time as the latest time seen before it.
+struct RecordingIndexEntry {
+    uint64_t        offset{0};
+    double          time{0};
+    bool            timed{false};      // time is known (a timed block precedes offset)
+    std::bitset<256> categories;       // categories of the blocks up to the next entry
+};
+
+class RecordingReader {
+public:
+    // Map path and load or build its index.  The codec resolves the time
+    // items and must outlive the reader.
+    // Throws std::runtime_error if the file cannot be opened or mapped.
+    RecordingReader(const std::filesystem::path& path, const Codec& codec,
+                    RecordingOptions opts = {});
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&)            = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = RecordedBlock;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() = default;
+
+        const RecordedBlock& operator*() const noexcept { return block_; }
+        const RecordedBlock* operator->() const noexcept { return &block_; }
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        bool operator==(std::default_sentinel_t) const noexcept { return done_; }
+
+    private:
+        friend class RecordingReader;
+        iterator(const RecordingReader& r, const RecordingIndexEntry& from);
+        void advance();
+
+        const RecordingReader* r_{nullptr};
+        uint64_t      pos_{0};        // next byte to parse
+        uint64_t      packet_end_{0}; // Final: end of the current packet's blocks
+        bool          in_packet_{false};
+        double        packet_time_{0};
+        double        latest_{0};     // latest time so far
+        bool          latest_known_{false};
+        RecordedBlock block_;
+        bool          done_{true};
+
+        // Resume point in front of block_ (set when block_ starts one): what
+        // buildIndex() records.
+        RecordingIndexEntry mark_;
+        bool                at_mark_{false};
+    };
+
+    [[nodiscard]] iterator begin() const { return iterator(*this, RecordingIndexEntry{}); }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+    // First block, in file order, at or after the last index entry before t
+    // whose time is ≥ t (end() if none).
+    [[nodiscard]] iterator seek(double t) const;
+
+    [[nodiscard]] RecordingFormat format() const noexcept { return format_; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return {data_, size_}; }
+    [[nodiscard]] const std::vector<RecordingIndexEntry>& index() const noexcept { return index_; }
+    [[nodiscard]] uint64_t blocks() const noexcept { return blocks_; }
+    // Bytes after the last block that parses (a truncated tail or garbage).
+    [[nodiscard]] uint64_t trailing() const noexcept { return trailing_; }
+    // Whether the index was read from its .asxi file rather than built.
+    [[nodiscard]] bool indexLoaded() const noexcept { return index_loaded_; }
+
+private:
+    const uint8_t*  data_{nullptr};
+    size_t          size_{0};
+    void*           mapping_{nullptr}; // platform handle
+    RecordingFormat format_{RecordingFormat::Raw};
+    uint32_t        stride_{256};
+
+    std::vector<RecordingIndexEntry> index_;
+    uint64_t blocks_{0};
+    uint64_t trailing_{0};
+    bool     index_loaded_{false};
+
+    // Plan and time item of each category with a time item (else null / kNoItem).
+    const CategoryPlan* plans_[256]{};
+    ItemIndex           time_item_[256]{};
+
+    // Time of day (s) of block's first record, if its category has a time item.
+    bool blockTime(std::span<const uint8_t> block, double& tod) const;
+
+    // stamp: the recording's mtime; timed_cats: categories with a time item
+    // (an index built with another set of time items is not reused).
+    void buildIndex();
+    bool loadIndex(const std::filesystem::path& path, uint64_t stamp,
+                   const std::bitset<256>& timed_cats);
+    void saveIndex(const std::filesystem::path& path, uint64_t stamp,
+                   const std::bitset<256>& timed_cats) const;
+};
+
+} // namespace asterix
@@ -0,0 +1,74 @@
+#pragma once
+// Registry.hpp – The Codec's table of compiled categories.
+//
+// One slot per CAT value, each an atomic pointer to an immutable
+// CategoryPlan: a decode finds its plan with a single acquire load, without
+// hashing, locking or touching a reference count, so it never waits on
+// another thread.
+//
+// publish() swaps a new plan into its slot while decoders keep running (a
+// spec edition upgrade, say).  A decode that already loaded the old plan
+// finishes with it; the next one sees the new plan.  Replaced plans are
+// retired, not freed: blocks, views, filters and packers hold plain
+// CategoryPlan pointers, which no reader-side count tracks.  So the grace
+// period is the caller's to declare: reclaimRetired() drops the retired plans
+// once no decode still runs on them and nothing built on them is used again.
+// Without it every publish() keeps one more plan for the registry's lifetime.
+// A plan shared with a copy of the registry lives on in the copy.
+//
+// A Projection names its plans by CategoryPlan::id instead, so it never
+// touches a retired plan: after publish() its selection for that category is
+// stale, and decoding the category with it fails the block with
+// DecodeErrc::StaleProjection until it is select()ed again for the new plan.
+//
+// Writers are serialised by a mutex; readers never take it.
+
+#include "Plan.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace asterix::detail {
+
+class CategoryRegistry {
+public:
+    CategoryRegistry() = default;
+    // Copies share the plans; later publish()es are not seen by the other.
+    CategoryRegistry(const CategoryRegistry& other);
+    CategoryRegistry& operator=(const CategoryRegistry& other);
+
+    // Plan registered for cat, or nullptr.  Wait-free.
+    [[nodiscard]] const CategoryPlan* find(uint8_t cat) const noexcept {
+        return slots_[cat].load(std::memory_order_acquire);
+    }
+
+    // Make plan the one registered for plan->def.cat; the plan it replaces,
+    // if any, is retired.  Safe while other threads call find().
+    void publish(std::shared_ptr<const CategoryPlan> plan);
+
+    // Call f(plan) for each registered plan, in CAT order.
+    template <class F>
+    void forEach(F&& f) const {
+        for (size_t cat = 0; cat < slots_.size(); ++cat)
+            if (const CategoryPlan* p = find(static_cast<uint8_t>(cat))) f(*p);
+    }
+
+    // Drop the retired plans; returns how many.  Only safe once no thread can
+    // still use one of them (see above).
+    size_t reclaimRetired();
+
+    // Plans kept alive, current and retired.
+    [[nodiscard]] size_t retained() const;
+
+private:
+    std::array<std::atomic<const CategoryPlan*>, 256> slots_{};
+    mutable std::mutex                                mutex_; // publish() / copies
+    std::vector<std::shared_ptr<const CategoryPlan>>  plans_; // owners, in publish order
+};
+
+} // namespace asterix::detail
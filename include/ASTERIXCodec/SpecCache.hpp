@@ -0,0 +1,41 @@
+#pragma once
+// SpecCache.hpp – Binary precompiled form of a CategoryDef.
+//
+// loadSpec() parses XML with pugixml and builds every string and table from
+// text.  A spec cache (*.asxb) holds the same CategoryDef – FieldIds included
+// – as length-prefixed little-endian records, so loading one is a single file
+// read plus a linear copy, with no XML parsing, number conversion or
+// re-interning.  Caches are a startup optimisation only: the XML remains the
+// source of truth and loadSpecDirectory() rebuilds any cache older than it.
+//
+// Usage:
+//   Codec codec;
+//   for (auto& def : loadSpecDirectory("specs", "/var/cache/asterix"))
+//       codec.registerCategory(std::move(def));
+
+#include "SpecLoader.hpp"
+#include "Types.hpp"
+
+#include <filesystem>
+#include <vector>
+
+namespace asterix {
+
+// Write cat to path (via a temporary file, so readers never see half a cache).
+// Throws SpecLoadError if the file cannot be written.
+void saveSpecCache(const CategoryDef& cat, const std::filesystem::path& path);
+
+// Read a cache written by saveSpecCache().
+// Throws SpecLoadError if the file is missing, truncated, or of another
+// format version.
+[[nodiscard]] CategoryDef loadSpecCache(const std::filesystem::path& path);
+
+// Load every CAT*.xml of dir (in file-name order).  For CATxx.xml the cache is
+// cache_dir/CATxx.asxb (cache_dir defaults to dir): it is used when it is at
+// least as new as the XML and readable; otherwise the XML is parsed and the
+// cache rewritten.  Failing to write a cache is not an error.
+// Throws SpecLoadError for an XML spec that does not load.
+[[nodiscard]] std::vector<CategoryDef> loadSpecDirectory(const std::filesystem::path& dir,
+                                                         const std::filesystem::path& cache_dir = {});
+
+} // namespace asterix
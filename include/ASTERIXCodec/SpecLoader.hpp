@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace asterix {
 
@@ -18,4 +19,17 @@ public:
 // Throws SpecLoadError on any parse or validation failure.
 CategoryDef loadSpec(const std::filesystem::path& xml_path);
 
+// Assigns a FieldId to every named element of the category, in item-ID order,
+// and rebuilds cat.fields.  loadSpec() already does this; call it again only
+// after building or editing a CategoryDef by hand.
+void internFields(CategoryDef& cat);
+
+// Name → FieldId lookup (linear; meant for setup code, not the decode path).
+// sub_item names the Compound sub-item; leave it empty for other item types.
+// Returns kNoField if no such field exists.
+[[nodiscard]] FieldId findField(const CategoryDef& cat,
+                                std::string_view item_id,
+                                std::string_view name,
+                                std::string_view sub_item = {});
+
 } // namespace asterix
@@ -0,0 +1,153 @@
+#pragma once
+// StreamDecoder.hpp – Data Block framing over an arbitrary byte stream.
+//
+// UDP datagrams and recording files concatenate Data Blocks of different
+// categories; TCP and serial links split them across reads.  A StreamDecoder
+// accepts chunks of any size, cuts them into [CAT][LEN][…] blocks and hands
+// each complete block to a callback, either raw (to decode, view() or
+// forward) or already decoded through an internal DecodeContext.
+//
+// Blocks that lie entirely within a chunk are handed out in place; only a
+// block that straddles a chunk boundary is copied (into one reusable buffer).
+//
+// A header is accepted when LEN ≥ 3, LEN ≤ max_block and, unless
+// accept_unknown is set, CAT is registered with the codec.  On a bad header
+// the decoder resynchronises by sliding forward one byte at a time.
+//
+// Usage:
+//   StreamDecoder stream{codec};
+//   while (size_t n = read(fd, buf, sizeof buf))
+//       stream.feedDecoded({buf, n}, [](const DecodedBlock& block) { … });
+//   stream.finish();
+
+#include "Codec.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace asterix {
+
+struct StreamOptions {
+    uint16_t max_block{0xFFFF};    // largest LEN accepted as genuine
+    bool     accept_unknown{false}; // frame blocks of unregistered categories too
+};
+
+struct StreamStats {
+    uint64_t blocks{0};        // blocks handed to the callback
+    uint64_t bytes_skipped{0}; // bytes dropped while resynchronising
+    uint64_t resyncs{0};       // number of resynchronisations
+    uint64_t bytes_copied{0};  // bytes buffered across chunk boundaries
+};
+
+class StreamDecoder {
+public:
+    explicit StreamDecoder(const Codec& codec, StreamOptions opts = {})
+        : codec_(&codec), opts_(opts) {}
+
+    // Feed the next chunk; on_block(std::span<const uint8_t>) is called for
+    // every complete Data Block, in stream order.  The span is valid for the
+    // duration of the call only.
+    template <class OnBlock>
+    void feed(std::span<const uint8_t> chunk, OnBlock&& on_block);
+
+    // Same as feed(), but each block is decoded first; on_block receives a
+    // const DecodedBlock& that is valid for the duration of the call only.
+    template <class OnBlock>
+    void feedDecoded(std::span<const uint8_t> chunk, OnBlock&& on_block) {
+        feed(chunk, [&](std::span<const uint8_t> block) {
+            on_block(codec_->decodeInto(block, ctx_));
+        });
+    }
+
+    // End of stream: drop any incomplete trailing block and return its size.
+    size_t finish() {
+        const size_t dropped = pending_.size();
+        stats_.bytes_skipped += dropped;
+        pending_.clear();
+        skipping_ = false;
+        return dropped;
+    }
+
+    [[nodiscard]] size_t             buffered() const noexcept { return pending_.size(); }
+    [[nodiscard]] const StreamStats& stats()    const noexcept { return stats_; }
+
+private:
+    const Codec*         codec_;
+    StreamOptions        opts_;
+    std::vector<uint8_t> pending_;  // start of a block that straddles chunks
+    DecodeContext        ctx_;      // for feedDecoded()
+    StreamStats          stats_;
+    bool                 skipping_{false};
+
+    // Block length if hdr[0..3) is an acceptable header, else 0.
+    [[nodiscard]] size_t blockLength(const uint8_t* hdr) const noexcept {
+        const size_t len = (static_cast<size_t>(hdr[1]) << 8) | hdr[2];
+        if (len < 3 || len > opts_.max_block) return 0;
+        if (!opts_.accept_unknown && !codec_->hasCategory(hdr[0])) return 0;
+        return len;
+    }
+
+    void skipByte() noexcept {
+        if (!skipping_) ++stats_.resyncs;
+        skipping_ = true;
+        ++stats_.bytes_skipped;
+    }
+
+    void take(std::span<const uint8_t>& chunk, size_t n) {
+        n = std::min(n, chunk.size());
+        pending_.insert(pending_.end(), chunk.begin(), chunk.begin() + static_cast<ptrdiff_t>(n));
+        stats_.bytes_copied += n;
+        chunk = chunk.subspan(n);
+    }
+};
+
+template <class OnBlock>
+void StreamDecoder::feed(std::span<const uint8_t> chunk, OnBlock&& on_block) {
+    // ── Finish a block carried over from earlier chunks ──────────────────────
+    while (!pending_.empty()) {
+        if (pending_.size() < 3) take(chunk, 3 - pending_.size());
+        if (pending_.size() < 3) return;
+
+        const size_t len = blockLength(pending_.data());
+        if (len == 0) {
+            // Resync inside the carried-over bytes
+            pending_.erase(pending_.begin());
+            skipByte();
+            continue;
+        }
+        if (pending_.size() < len) take(chunk, len - pending_.size());
+        if (pending_.size() < len) return;
+
+        skipping_ = false;
+        ++stats_.blocks;
+        on_block(std::span<const uint8_t>(pending_.data(), len));
+        // After a resync pending_ may hold bytes beyond this block
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<ptrdiff_t>(len));
+    }
+
+    // ── Blocks entirely inside this chunk: no copy ───────────────────────────
+    size_t pos = 0;
+    while (chunk.size() - pos >= 3) {
+        const size_t len = blockLength(chunk.data() + pos);
+        if (len == 0) {
+            ++pos;
+            skipByte();
+            continue;
+        }
+        if (chunk.size() - pos < len) break;
+
+        skipping_ = false;
+        ++stats_.blocks;
+        on_block(chunk.subspan(pos, len));
+        pos += len;
+    }
+
+    // ── Keep the incomplete tail for the next chunk ──────────────────────────
+    auto tail = chunk.subspan(pos);
+    take(tail, tail.size());
+}
+
+} // namespace asterix
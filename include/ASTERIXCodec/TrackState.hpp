@@ -0,0 +1,134 @@
+#pragma once
+// TrackState.hpp – Latest record per track, with per-update change masks.
+//
+// A TrackStore keeps, for each track of one category, its last record in
+// interned-field form (a CompactRecord, see Compact.hpp) plus that record's
+// wire bytes.  Tracks are keyed by (SAC, SIC, track number): I010 and, by
+// default, I062/040 TN or I048/161 TRN.
+//
+// update() takes a record of a BlockView (see View.hpp) and compares each
+// item's byte range with the stored one: an item whose bytes are identical is
+// unchanged, and no field of it is looked at.  Only when some item differs is
+// the record decoded, and only the fields of the differing items are compared
+// value by value.  The result is an ItemIndex and a FieldId bitmask of what
+// changed, so fusion or display clients can process deltas only.  A record
+// identical to the last one of its track is not decoded at all.
+//
+// Record and bitmap storage is kept per track and reused, so once every
+// track has been seen update() does not allocate.
+//
+// Usage:
+//   TrackStore tracks{codec, 62};
+//   const FieldId lat = findField(codec.category(62), "105", "LAT");
+//   codec.view(raw, block);
+//   for (size_t r = 0; r < block.size(); ++r)
+//       if (const TrackUpdate* u = tracks.update(block, r); u && u->fieldChanged(lat))
+//           moveSymbol(u->key, u->record->field(lat));
+
+#include "Codec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace asterix {
+
+struct TrackKey {
+    uint8_t  sac{0};
+    uint8_t  sic{0};
+    uint16_t track{0};
+
+    [[nodiscard]] uint32_t packed() const noexcept {
+        return (uint32_t{sac} << 24) | (uint32_t{sic} << 16) | track;
+    }
+    friend bool operator==(const TrackKey&, const TrackKey&) = default;
+};
+
+// What one record changed in its track.  Points into the TrackStore: valid
+// until its next update(), erase() or clear().
+struct TrackUpdate {
+    TrackKey key;
+    bool     created{false};              // first record of the track: everything present changed
+    const CompactRecord* record{nullptr};   // the track's record, now
+    const CompactRecord* previous{nullptr}; // the record it replaced (= record if nothing changed, null if created)
+    std::span<const uint64_t> changed_items;  // ItemIndex bitmap, 64 items per word
+    std::span<const uint64_t> changed_fields; // FieldId bitmap, 64 fields per word
+
+    // An item changed if it appeared, disappeared or its bytes differ.
+    [[nodiscard]] bool itemChanged(ItemIndex idx) const noexcept {
+        return idx / 64 < changed_items.size() && ((changed_items[idx / 64] >> (idx % 64)) & 1u);
+    }
+    // A field changed if it appeared, disappeared or its value differs (in
+    // any repetition, for repeated fields).  Explicit / SP payloads have no
+    // field: see itemChanged().
+    [[nodiscard]] bool fieldChanged(FieldId id) const noexcept {
+        return id / 64 < changed_fields.size() && ((changed_fields[id / 64] >> (id % 64)) & 1u);
+    }
+    [[nodiscard]] bool changed() const noexcept {
+        for (uint64_t w : changed_items)
+            if (w) return true;
+        return false;
+    }
+};
+
+class TrackStore {
+public:
+    // The codec must outlive the store.  The track number is the first field
+    // of track_item, or of I040 (CAT062) / I161 (CAT048) when empty.
+    // Throws std::runtime_error if cat is not registered, or has no I010
+    // SAC / SIC or no such track number item.
+    TrackStore(const Codec& codec, uint8_t cat, std::string_view track_item = {});
+
+    TrackStore(const TrackStore&)            = delete;
+    TrackStore& operator=(const TrackStore&) = delete;
+
+    // Store record r of block as the latest of its track and return what it
+    // changed.  Returns nullptr, leaving the store unchanged, for an invalid
+    // record or one without I010 or the track number.  Throws
+    // std::runtime_error if block was not viewed with this store's plan (another
+    // category, or the category was registered again since).
+    const TrackUpdate* update(const BlockView& block, size_t r);
+
+    // Latest record of a track, or nullptr.  Valid until the next update(),
+    // erase() or clear().
+    [[nodiscard]] const CompactRecord* find(TrackKey key) const;
+
+    // Forget a track (e.g. on a track-end flag); returns whether it was known.
+    bool erase(TrackKey key);
+    void clear();
+
+    [[nodiscard]] size_t size() const noexcept { return tracks_.size(); }
+    [[nodiscard]] uint8_t cat() const noexcept { return cat_; }
+
+private:
+    struct Track {
+        TrackKey              key;
+        std::vector<uint8_t>  bytes;  // the record's wire bytes
+        std::vector<ItemSpan> spans;  // ItemIndex → range of bytes
+        CompactRecord         rec;
+    };
+
+    const Codec*        codec_;
+    const CategoryPlan* plan_;
+    uint8_t             cat_;
+    FieldId             sac_{kNoField};
+    FieldId             sic_{kNoField};
+    FieldId             track_{kNoField};
+    ItemIndex           sac_item_{kNoItem};
+    ItemIndex           track_item_{kNoItem};
+
+    std::vector<Track>                     tracks_;
+    std::unordered_map<uint32_t, uint32_t> index_;   // packed key → tracks_ slot
+    CompactRecord                          scratch_; // the replaced record (TrackUpdate::previous)
+    std::vector<uint64_t>                  changed_items_;
+    std::vector<uint64_t>                  changed_fields_;
+    TrackUpdate                            update_;
+
+    void decode(std::span<const uint8_t> bytes, CompactRecord& rec) const;
+    void diffFields(ItemIndex idx, const CompactRecord& before, const CompactRecord& after);
+};
+
+} // namespace asterix
@@ -0,0 +1,172 @@
+#pragma once
+// Traffic.hpp – Synthetic CAT034 / CAT048 / CAT062 traffic for load and soak tests.
+//
+// A TrafficGenerator simulates one sensor and emits its reports as
+// DecodedRecords, encoded into Data Blocks with Codec::encodeInto() /
+// encodeAppend():
+//   • CAT048 – a monoradar rotating once per period: each of `targets`
+//     aircraft is reported once per scan, at the time the antenna crosses its
+//     azimuth, so a scan comes out in azimuth order;
+//   • CAT062 – an SDPS: every track is reported once per period, all with
+//     the time of the period start, in track-number order;
+//   • CAT034 – the same radar's service messages: a north marker and then
+//     one sector crossing per sector (`targets` sectors per rotation).
+// Aircraft fly straight or in rate-one turns, climb and descend between
+// flight levels, and turn back inside max_range.  Every report of a target
+// carries the same items: each target draws one number in [0, 1) and carries
+// the items whose share is above it, so items of equal share go together
+// (e.g. the Mode S items) and a smaller share picks a subset of the targets
+// of a larger one.
+//
+// Fields with a meaning the simulation knows – time of day, position,
+// velocity, flight level, track number, Mode-3/A, address, callsign, ... –
+// are set from the target's state, converted to each element's unit and
+// scale as given by the spec.  Every other field of a carried item gets a
+// value drawn from the spec once per target: a table entry, a value within
+// min / max, or random bits; Extended items get one or two octets,
+// Repetitive / Compound items one to three repetitions or sub-items.  The
+// output is deterministic for a given seed.
+//
+// After the first scan no allocation is made per block: each target's record
+// is kept and its values updated in place.
+//
+// Usage (one minute of 400 tracks, appended to a recording):
+//   TrafficGenerator gen{codec, {.cat = 62, .targets = 400, .records_per_block = 32}};
+//   std::vector<uint8_t> out;
+//   while (gen.nextTime() < gen.startTime() + 60) gen.nextBlock(out);
+
+#include "Codec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace asterix {
+
+namespace detail {
+enum class TrafficQuantity : uint8_t; // what a bound field carries (Traffic.cpp)
+}
+
+// One item of the mix, carried by the given fraction of targets.  Mandatory
+// items are always carried.
+struct TrafficItem {
+    std::string id;        // "040", "380", ...
+    double      share{1.0};
+};
+
+struct TrafficOptions {
+    uint8_t  cat{48};                   // 34, 48 or 62
+    uint32_t targets{100};              // aircraft; sectors per rotation for CAT034
+    size_t   records_per_block{16};     // at most; a block never spans two periods
+    std::vector<TrafficItem> items;     // empty: defaultTrafficItems(cat)
+    double   period{4.0};               // s: antenna rotation / track update period
+    double   start_time{12 * 3600.0};   // s after midnight of the first period
+    double   max_range{200 * 1852.0};   // m from the sensor
+    double   latitude{49.0};            // deg, sensor position (WGS-84 items)
+    double   longitude{2.5};
+    uint8_t  sac{0};
+    uint8_t  sic{1};
+    uint64_t seed{1};
+};
+
+// Default item mix of a category: the usual items of a Mode S radar / SDPS
+// feed, with aircraft-derived items on a share of the targets.
+// Throws std::runtime_error for a category without a traffic model.
+[[nodiscard]] std::vector<TrafficItem> defaultTrafficItems(uint8_t cat);
+
+class TrafficGenerator {
+public:
+    // The codec must have opts.cat registered and outlive the generator.
+    // Throws std::runtime_error for a category without a traffic model, an
+    // item not in the category's UAP, or out-of-range options (no target, no
+    // record per block, a period that is not positive).
+    TrafficGenerator(const Codec& codec, TrafficOptions opts);
+
+    // Records point into themselves (see Binding): movable, not copyable.
+    TrafficGenerator(const TrafficGenerator&)            = delete;
+    TrafficGenerator& operator=(const TrafficGenerator&) = delete;
+    TrafficGenerator(TrafficGenerator&&)                 = default;
+    TrafficGenerator& operator=(TrafficGenerator&&)      = default;
+
+    // Move the simulation to the next report and return it.  The record is
+    // the generator's own and is overwritten by the next call.
+    const DecodedRecord& next();
+
+    // Encode the next reports – records_per_block, or the rest of the period
+    // – as one Data Block.  The first form writes it into out and returns its
+    // length (throws std::out_of_range if out is too small, the reports being
+    // lost); the second appends it to out.
+    size_t nextBlock(std::span<uint8_t> out);
+    void   nextBlock(std::vector<uint8_t>& out);
+
+    // Time of the last / the next report, in seconds after midnight of the
+    // start day (not wrapped at 24 h; time items are).
+    [[nodiscard]] double time() const noexcept { return time_; }
+    [[nodiscard]] double nextTime() const noexcept;
+    [[nodiscard]] double startTime() const noexcept { return opts_.start_time; }
+
+    [[nodiscard]] uint8_t  cat() const noexcept { return opts_.cat; }
+    [[nodiscard]] uint64_t records() const noexcept { return records_; } // reports so far
+    [[nodiscard]] uint64_t blocks() const noexcept { return blocks_; }
+
+    // Sensor-relative state of target t (t < targets), as of its last report.
+    struct State {
+        double x{0}, y{0};     // m east / north of the sensor
+        double heading{0};     // deg from north, clockwise
+        double speed{0};       // m/s
+        double turn_rate{0};   // deg/s, positive clockwise
+        double altitude{0};    // m (barometric)
+        double climb{0};       // m/s
+        double target_alt{0};  // m: level being climbed / descended to
+        double at{0};          // time of this state
+    };
+    [[nodiscard]] const State& state(size_t t) const { return targets_.at(t).state; }
+    [[nodiscard]] size_t targets() const noexcept { return targets_.size(); }
+
+private:
+    // A field set from the target's state at every report.
+    struct Binding {
+        uint64_t*               value;   // in the target's record
+        const ElementDef*       element;
+        detail::TrafficQuantity quantity;
+    };
+
+    struct Target {
+        State                state;
+        DecodedRecord        rec;
+        std::vector<Binding> bindings;
+        uint64_t             rng{0};   // the target's own random stream
+        uint32_t             index{0};
+        uint32_t             address{0};
+        uint64_t             callsign{0}; // ICAO 6-bit characters
+        uint16_t             squawk{0};
+        bool                 mode_s{false}; // carries an aircraft address
+    };
+
+    const Codec*   codec_;
+    TrafficOptions opts_;
+    std::string    variation_;
+
+    std::vector<Target>        targets_;
+    std::vector<std::pair<double, uint32_t>> scan_; // this period's reports: time, target
+    size_t                     cursor_{0};
+    double                     period_start_{0};
+    double                     time_{0};
+    uint64_t                   records_{0};
+    uint64_t                   blocks_{0};
+    std::vector<DecodedRecord> block_;             // records being encoded (swapped in)
+    std::vector<uint32_t>      batch_;             // their targets
+
+    void     buildTarget(Target& t, const CategoryPlan& plan, const std::vector<TrafficItem>& mix);
+    void     startPeriod();
+    uint32_t advance();                            // next report's target, updated
+    void     move(Target& t, double to) const;
+    void     update(Target& t) const;
+    template <class Encode>
+    void     encodeNext(Encode&& encode);
+};
+
+} // namespace asterix
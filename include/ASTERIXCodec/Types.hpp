@@ -2,9 +2,13 @@
 // Types.hpp – Core metadata and decoded-value types for the ASTERIX codec.
 // All ASTERIX data flows through these structures.
 
+#include "DecodeError.hpp"
+
 #include <cstdint>
+#include <limits>
 #include <map>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -35,12 +39,19 @@ enum class ItemType {
 // ─── Mandatory / Conditional / Optional presence rule ─────────────────────────
 enum class Presence { Mandatory, Conditional, Optional };
 
+// ─── Interned field identifier ────────────────────────────────────────────────
+// Every named element of a category gets a small, category-wide integer ID at
+// loadSpec() time.  IDs index CategoryDef::fields and CompactRecord::values.
+using FieldId = uint16_t;
+inline constexpr FieldId kNoField = 0xFFFF; // spare / not interned
+
 // ─── A single leaf field inside a Data Item ───────────────────────────────────
 struct ElementDef {
     std::string name;          // Field name, e.g. "SAC", "TYP". Empty for spare.
     uint16_t    bits{0};       // Bit width
     Encoding    encoding{Encoding::Raw};
     bool        is_spare{false};
+    FieldId     field_id{kNoField}; // Interned ID (kNoField for spares)
 
     // Table encoding – raw value → description string
     std::map<uint64_t, std::string> table;
@@ -49,9 +60,10 @@ struct ElementDef {
     double      scale{1.0};
     std::string unit;
 
-    // Optional range constraints (informational)
-    double      min_val{0.0};
-    double      max_val{0.0};
+    // Optional range constraints on the physical value (scale × raw), checked
+    // with Validation::Full.  A bound the spec leaves out is infinite.
+    double      min_val{-std::numeric_limits<double>::infinity()};
+    double      max_val{std::numeric_limits<double>::infinity()};
     bool        has_range{false};
 };
 
@@ -105,6 +117,13 @@ struct UapCase {
     std::map<uint64_t, std::string> value_to_variation; // 0→"plot", 1→"track"
 };
 
+// ─── Qualified name of one interned field ─────────────────────────────────────
+struct FieldInfo {
+    std::string item_id;  // "040"
+    std::string sub_item; // Compound sub-item name ("CAL"); empty otherwise
+    std::string name;     // "RHO"
+};
+
 // ─── Full Category definition (built from one XML spec file) ──────────────────
 struct CategoryDef {
     uint8_t     cat{0};
@@ -126,6 +145,9 @@ struct CategoryDef {
 
     // Optional UAP discriminator (e.g. decode I020/TYP then pick variation)
     std::optional<UapCase> uap_case;
+
+    // Interned fields: FieldId → qualified name (filled by loadSpec)
+    std::vector<FieldInfo> fields;
 };
 
 // ─── Decoded Data Item value (one per present item in a record) ───────────────
@@ -146,6 +168,16 @@ struct DecodedItem {
     // Explicit / SP: raw payload bytes (length byte itself is NOT included).
     std::vector<uint8_t> raw_bytes;
 
+    // Borrowed from the decoded buffer when the Projection asks for it (see
+    // BorrowMode in Projection.hpp), else empty.  Valid only while that buffer
+    // is; copy them out before it is released or overwritten.
+    //   payload – Explicit / SP payload, in place of raw_bytes;
+    //   wire    – the whole item as on the wire.
+    // encode() writes a set payload instead of raw_bytes, and a set wire
+    // verbatim instead of the item's values.
+    std::span<const uint8_t> payload;
+    std::span<const uint8_t> wire;
+
     // Compound: present sub-items keyed by sub-item name.
     // Each value is a map of { field_name → raw_uint64 } for that sub-item.
     std::map<std::string, std::map<std::string, uint64_t>> compound_sub_fields;
@@ -157,6 +189,7 @@ struct DecodedRecord {
     std::string uap_variation;                // "plot" or "track"
     bool        valid{true};
     std::string error;
+    DecodeError fault;                        // structured form of error
 };
 
 // ─── A fully decoded Data Block (one per call to Codec::decode) ───────────────
@@ -166,6 +199,7 @@ struct DecodedBlock {
     std::vector<DecodedRecord> records;
     bool        valid{true};
     std::string error;
+    DecodeError fault;                    // structured form of error
 };
 
 } // namespace asterix
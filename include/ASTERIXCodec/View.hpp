@@ -0,0 +1,175 @@
+#pragma once
+// View.hpp – Lazy, zero-copy access to an encoded Data Block.
+//
+// Codec::view() walks each record's FSPEC once and applies only the item
+// length rules (fixed size, FX chains, REP counts, Explicit length byte,
+// Compound PSF), recording where every present item sits.  Nothing is
+// decoded: element values are extracted from the original bytes when they
+// are asked for, and only the requested item is walked to do so.
+//
+// The views borrow the buffer passed to Codec::view() and the category's
+// plan; both must outlive them.
+//
+// Usage:
+//   const CategoryPlan& plan = codec.plan(62);
+//   const ItemIndex i105 = plan.findItem("105");
+//   const FieldId   lat  = findField(plan.def, "105", "LAT");
+//
+//   BlockView block = codec.view(raw);
+//   for (size_t r = 0; r < block.size(); ++r)
+//       if (auto item = block.record(r).item(i105); item.present())
+//           use(item.field(lat));
+
+#include "Plan.hpp"
+#include "Types.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace asterix {
+
+// Byte range of one present item, relative to the start of its record.
+struct ItemSpan {
+    uint16_t offset{0};
+    uint16_t length{0}; // 0 ⇒ item absent (every item is at least one byte)
+};
+
+// Location of one record inside a BlockView.
+struct ViewRecord {
+    uint32_t    offset{0};    // from the first byte of the Data Block
+    uint16_t    length{0};
+    uint16_t    variation{0}; // index into plan->variations
+    uint32_t    spans_first{0}; // first of plan->items.size() entries in BlockView::spans
+    bool        valid{true};
+    std::string error;
+    DecodeError fault;
+};
+
+class RecordView;
+
+// ─── An indexed, undecoded Data Block ─────────────────────────────────────────
+struct BlockView {
+    uint8_t  cat{0};
+    uint16_t length{0};                  // as read from the wire
+    bool        valid{true};
+    std::string error;
+    DecodeError fault;
+
+    const CategoryPlan*      plan{nullptr};
+    std::span<const uint8_t> bytes;      // the whole Data Block (borrowed)
+    std::vector<ViewRecord>  records;
+    std::vector<ItemSpan>    spans;      // ItemIndex → span, per record
+
+    [[nodiscard]] size_t     size() const noexcept { return records.size(); }
+    [[nodiscard]] RecordView record(size_t i) const noexcept;
+};
+
+// ─── Record boundaries only ───────────────────────────────────────────────────
+// Result of Codec::scanRecords(): where each record of a Data Block starts,
+// found with the same length rules as view() but without per-item spans.
+struct RecordOffset {
+    uint32_t offset{0};    // from the first byte of the Data Block
+    uint16_t length{0};
+    uint16_t variation{0}; // index into plan->variations
+};
+
+struct RecordIndex {
+    uint8_t  cat{0};
+    uint16_t length{0};                  // as read from the wire
+    bool        valid{true};             // false ⇒ records holds those before the error
+    std::string error;
+    DecodeError fault;
+
+    const CategoryPlan*       plan{nullptr};
+    std::vector<RecordOffset> records;
+};
+
+// ─── Lazy view of one item ────────────────────────────────────────────────────
+// Field accessors walk this item's bytes on every call; cache the result if a
+// value is read repeatedly.
+class ItemView {
+public:
+    ItemView(const CategoryPlan& plan, ItemIndex idx, std::span<const uint8_t> bytes) noexcept
+        : plan_(&plan), idx_(idx), bytes_(bytes) {}
+
+    [[nodiscard]] bool present() const noexcept { return !bytes_.empty(); }
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return bytes_; }
+
+    // Whether a field of this item is on the wire (Extended octets and
+    // Compound sub-items are optional; group fields need ≥1 repetition).
+    [[nodiscard]] bool has(FieldId id) const;
+
+    // Raw field value (first repetition for repeated fields), 0 if absent.
+    [[nodiscard]] uint64_t field(FieldId id) const;
+
+    // Repetitive / RepetitiveGroup[FX]: number of repetitions on the wire.
+    [[nodiscard]] size_t repetitions() const;
+    // Value of a group field in repetition `rep` (0 if out of range).
+    [[nodiscard]] uint64_t field(FieldId id, size_t rep) const;
+    // Repetitive (single 7-bit value per repetition).
+    [[nodiscard]] uint64_t repetition(size_t rep) const;
+    // Explicit / SP payload (length byte excluded).
+    [[nodiscard]] std::span<const uint8_t> payload() const noexcept;
+
+private:
+    const CategoryPlan*      plan_;
+    ItemIndex                idx_;
+    std::span<const uint8_t> bytes_;
+};
+
+// ─── Lazy view of one record ──────────────────────────────────────────────────
+class RecordView {
+public:
+    RecordView(const BlockView& block, const ViewRecord& rec) noexcept
+        : block_(&block), rec_(&rec) {}
+
+    [[nodiscard]] bool               valid() const noexcept { return rec_->valid; }
+    [[nodiscard]] const std::string& error() const noexcept { return rec_->error; }
+    [[nodiscard]] const DecodeError& fault() const noexcept { return rec_->fault; }
+
+    // The encoded record (FSPEC included).
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept {
+        return block_->bytes.subspan(rec_->offset, rec_->length);
+    }
+
+    [[nodiscard]] const CategoryPlan& plan() const noexcept { return *block_->plan; }
+    [[nodiscard]] uint16_t variation() const noexcept { return rec_->variation; }
+    [[nodiscard]] const std::string& variationName() const {
+        return *block_->plan->variations[rec_->variation].name;
+    }
+
+    [[nodiscard]] bool hasItem(ItemIndex idx) const noexcept { return span(idx).length != 0; }
+
+    [[nodiscard]] ItemView item(ItemIndex idx) const noexcept {
+        const ItemSpan s = span(idx);
+        return ItemView{*block_->plan, idx, bytes().subspan(s.offset, s.length)};
+    }
+    // Convenience lookup by item ID (binary search over the plan).
+    [[nodiscard]] ItemView item(std::string_view id) const noexcept {
+        return item(block_->plan->findItem(id));
+    }
+
+    // Field value by FieldId alone (the owning item is taken from the plan).
+    [[nodiscard]] uint64_t field(FieldId id) const {
+        if (id >= block_->plan->fields.size()) return 0;
+        return item(block_->plan->fields[id].item).field(id);
+    }
+
+private:
+    const BlockView*  block_;
+    const ViewRecord* rec_;
+
+    [[nodiscard]] ItemSpan span(ItemIndex idx) const noexcept {
+        if (idx >= block_->plan->items.size()) return {};
+        return block_->spans[rec_->spans_first + idx];
+    }
+};
+
+inline RecordView BlockView::record(size_t i) const noexcept {
+    return RecordView{*this, records[i]};
+}
+
+} // namespace asterix
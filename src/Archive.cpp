@@ -0,0 +1,991 @@
+// Archive.cpp – Column builders, value stream encodings and chunk I/O.
+
+#include "ASTERIXCodec/Archive.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace asterix {
+
+namespace detail {
+
+// Interned fields of one category grouped by item, with their widths.
+struct ArchiveLayout {
+    const CategoryPlan*               plan;
+    std::vector<uint16_t>             bits;        // FieldId → element width
+    std::vector<uint8_t>              is_signed;   // FieldId → SignedQuantity
+    // Track key: I010 and the track number (I040 of CAT062, I161 of CAT048)
+    FieldId sac{kNoField};
+    FieldId sic{kNoField};
+    FieldId track{kNoField};
+
+    explicit ArchiveLayout(const CategoryPlan& p)
+        : plan(&p), bits(p.fields.size()), is_signed(p.fields.size()) {
+        for (FieldId f = 0; f < p.fields.size(); ++f) {
+            const PlanField& pf = p.fields[f];
+            if (pf.item >= p.items.size()) continue;
+            const PlanElement& e = p.elements[pf.element];
+            bits[f]      = e.bits;
+            is_signed[f] = e.def->encoding == Encoding::SignedQuantity;
+        }
+        const ItemIndex track_item = p.findItem(p.def.cat == 62 ? "040" : p.def.cat == 48 ? "161" : "");
+        if (track_item != kNoItem && p.items[track_item].fields.count != 0) {
+            sac   = findField(p.def, "010", "SAC");
+            sic   = findField(p.def, "010", "SIC");
+            track = static_cast<FieldId>(p.items[track_item].fields.first);
+        }
+    }
+
+    // FieldIds of item idx, ascending (PlanItem::fields).
+    [[nodiscard]] auto fieldsOf(ItemIndex idx) const noexcept {
+        const PlanRange r = plan->items[idx].fields;
+        return std::views::iota(r.first, r.end());
+    }
+
+    [[nodiscard]] bool tracked() const noexcept {
+        return sac != kNoField && sic != kNoField && track != kNoField;
+    }
+    // (SAC, SIC, track number) + 1, or 0 for a record without them.
+    [[nodiscard]] uint32_t trackKey(const CompactRecord& rec) const noexcept {
+        if (!rec.has(sac) || !rec.has(sic) || !rec.has(track)) return 0;
+        return ((static_cast<uint32_t>(rec.values[sac] & 0xFF) << 24) |
+                (static_cast<uint32_t>(rec.values[sic] & 0xFF) << 16) |
+                static_cast<uint32_t>(rec.values[track] & 0xFFFF)) + 1;
+    }
+
+    [[nodiscard]] bool repeated(ItemIndex idx) const noexcept {
+        const ItemType t = plan->items[idx].type;
+        return t == ItemType::Repetitive || t == ItemType::RepetitiveGroup || t == ItemType::RepetitiveGroupFX;
+    }
+    [[nodiscard]] bool payload(ItemIndex idx) const noexcept {
+        const ItemType t = plan->items[idx].type;
+        return t == ItemType::Explicit || t == ItemType::SP;
+    }
+};
+
+// Records of the chunk being filled, for one category, and their columns
+// (built at flush time, in stored row order).
+struct ArchiveBuilder {
+    ArchiveLayout layout;
+    bool          grouped;
+    uint32_t      rows{0};
+    std::vector<CompactRecord> pending;  // [0, rows); storage reused across chunks
+    std::vector<uint64_t>      groups;   // row → track group, in order of first appearance
+    std::unordered_map<uint32_t, uint64_t> group_of; // track key → group
+    std::vector<uint64_t> block_seq;
+    std::vector<uint64_t> block_records;
+    std::vector<uint64_t> variations;
+    std::vector<uint64_t> verbatim_rows;
+    std::vector<uint64_t> verbatim_lengths;
+    std::vector<uint8_t>  verbatim_bytes;
+
+    std::vector<std::vector<uint8_t>>  item_present;  // ItemIndex → flag per row
+    std::vector<std::vector<uint64_t>> item_counts;   // repetitions / payload length per present row
+    std::vector<std::vector<uint8_t>>  item_payload;
+    std::vector<std::vector<uint8_t>>  field_present; // FieldId → flag per row with the item
+    std::vector<std::vector<uint64_t>> field_keys;    // FieldId → values, as stream keys
+
+    ArchiveBuilder(const CategoryPlan& plan, bool group_tracks)
+        : layout(plan), grouped(group_tracks && layout.tracked()), item_present(plan.items.size()), item_counts(plan.items.size()),
+          item_payload(plan.items.size()), field_present(plan.fields.size()), field_keys(plan.fields.size()) {}
+
+    void add(const CompactRecord& rec);
+    std::vector<uint32_t> order() const;
+    void column(const CompactRecord& rec);
+    void clear();
+};
+
+} // namespace detail
+
+namespace {
+
+constexpr uint8_t  kMagic[4] = {'A', 'S', 'X', 'A'};
+constexpr uint8_t  kVersion  = 1;
+constexpr uint64_t kSignBit  = uint64_t{1} << 63;
+
+// ─── Values as stream keys ────────────────────────────────────────────────────
+// Signed fields are sign-extended and offset by 2^63, so that keys of every
+// field order like their values and small steps across zero stay small.
+
+uint64_t toKey(uint64_t raw, unsigned bits, bool is_signed) noexcept {
+    if (!is_signed || bits == 0 || bits >= 64) return raw;
+    const uint64_t ext = ((raw >> (bits - 1)) & 1u) ? raw | (~uint64_t{0} << bits) : raw;
+    return ext ^ kSignBit;
+}
+
+uint64_t fromKey(uint64_t key, unsigned bits, bool is_signed) noexcept {
+    if (!is_signed || bits == 0 || bits >= 64) return key;
+    return (key ^ kSignBit) & ((uint64_t{1} << bits) - 1);
+}
+
+int64_t statValue(uint64_t key, bool is_signed) noexcept {
+    return static_cast<int64_t>(is_signed ? key ^ kSignBit : key);
+}
+
+[[noreturn]] void corrupt() { throw std::runtime_error("ArchiveReader: corrupt chunk or directory"); }
+
+// ─── Byte-level encoding ──────────────────────────────────────────────────────
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+size_t varintSize(uint64_t v) noexcept {
+    size_t n = 1;
+    for (; v >= 0x80; v >>= 7) ++n;
+    return n;
+}
+
+uint64_t zigzag(int64_t v) noexcept {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) noexcept {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1u);
+}
+
+unsigned widthOf(uint64_t v) noexcept { return v ? 64u - static_cast<unsigned>(std::countl_zero(v)) : 0u; }
+
+// values[i] - base, width bits each, LSB first.
+template <class Map>
+void putPacked(std::vector<uint8_t>& out, size_t n, unsigned width, Map&& value) {
+    if (width == 0) return;
+    uint32_t cur    = 0;
+    unsigned filled = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t x    = value(i);
+        unsigned left = width;
+        while (left) {
+            const unsigned take = std::min(left, 8u - filled);
+            cur |= static_cast<uint32_t>(x & ((1u << take) - 1)) << filled;
+            x >>= take;
+            left   -= take;
+            filled += take;
+            if (filled == 8) {
+                out.push_back(static_cast<uint8_t>(cur));
+                cur    = 0;
+                filled = 0;
+            }
+        }
+    }
+    if (filled) out.push_back(static_cast<uint8_t>(cur));
+}
+
+// Presence flags: 0 none, 1 all, 2 followed by a bitmap.
+void putBitmap(std::vector<uint8_t>& out, std::span<const uint8_t> flags) {
+    const size_t set = static_cast<size_t>(std::count(flags.begin(), flags.end(), uint8_t{1}));
+    if (set == 0 || set == flags.size()) {
+        out.push_back(set == 0 ? 0 : 1);
+        return;
+    }
+    out.push_back(2);
+    putPacked(out, flags.size(), 1, [&](size_t i) { return uint64_t{flags[i]}; });
+}
+
+enum class StreamKind : uint8_t { Packed = 0, Delta = 1, Dictionary = 2, Runs = 3 };
+
+// The smallest of the four encodings of keys; nothing for an empty stream.
+void putStream(std::vector<uint8_t>& out, std::span<const uint64_t> keys, std::vector<uint64_t>& dict) {
+    if (keys.empty()) return;
+    const auto [lo, hi]  = std::minmax_element(keys.begin(), keys.end());
+    const unsigned width = widthOf(*hi - *lo);
+    const size_t packed  = varintSize(*lo) + 1 + (keys.size() * width + 7) / 8;
+
+    size_t delta = varintSize(keys[0]);
+    for (size_t i = 1; i < keys.size(); ++i)
+        delta += varintSize(zigzag(static_cast<int64_t>(keys[i] - keys[i - 1])));
+
+    dict.assign(keys.begin(), keys.end());
+    std::sort(dict.begin(), dict.end());
+    dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+    const unsigned index_width = widthOf(dict.size() - 1);
+    size_t dictionary = varintSize(dict.size()) + varintSize(dict[0]) + 1 + (keys.size() * index_width + 7) / 8;
+    for (size_t i = 1; i < dict.size(); ++i) dictionary += varintSize(dict[i] - dict[i - 1]);
+
+    // Runs of one value: (zig-zag delta from the previous run's value, length - 1)
+    size_t n_runs = 0, runs = 0;
+    for (size_t i = 0, prev = 0; i < keys.size(); prev = i) {
+        while (++i < keys.size() && keys[i] == keys[prev]) {}
+        runs += varintSize(zigzag(static_cast<int64_t>(keys[prev] - (prev ? keys[prev - 1] : 0)))) +
+                varintSize(i - prev - 1);
+        ++n_runs;
+    }
+    runs += varintSize(n_runs);
+
+    if (runs <= packed && runs <= delta && runs <= dictionary) {
+        out.push_back(static_cast<uint8_t>(StreamKind::Runs));
+        putVarint(out, n_runs);
+        for (size_t i = 0, prev = 0; i < keys.size(); prev = i) {
+            while (++i < keys.size() && keys[i] == keys[prev]) {}
+            putVarint(out, zigzag(static_cast<int64_t>(keys[prev] - (prev ? keys[prev - 1] : 0))));
+            putVarint(out, i - prev - 1);
+        }
+    } else if (dictionary < packed && dictionary < delta) {
+        out.push_back(static_cast<uint8_t>(StreamKind::Dictionary));
+        putVarint(out, dict.size());
+        putVarint(out, dict[0]);
+        for (size_t i = 1; i < dict.size(); ++i) putVarint(out, dict[i] - dict[i - 1]);
+        out.push_back(static_cast<uint8_t>(index_width));
+        putPacked(out, keys.size(), index_width, [&](size_t i) {
+            return static_cast<uint64_t>(std::lower_bound(dict.begin(), dict.end(), keys[i]) - dict.begin());
+        });
+    } else if (delta < packed) {
+        out.push_back(static_cast<uint8_t>(StreamKind::Delta));
+        putVarint(out, keys[0]);
+        for (size_t i = 1; i < keys.size(); ++i)
+            putVarint(out, zigzag(static_cast<int64_t>(keys[i] - keys[i - 1])));
+    } else {
+        out.push_back(static_cast<uint8_t>(StreamKind::Packed));
+        putVarint(out, *lo);
+        out.push_back(static_cast<uint8_t>(width));
+        putPacked(out, keys.size(), width, [&, base = *lo](size_t i) { return keys[i] - base; });
+    }
+}
+
+// Bounds-checked reader over one chunk (or directory) section.
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const uint8_t> bytes) noexcept : b_(bytes) {}
+
+    uint8_t byte() {
+        need(1);
+        return b_[pos_++];
+    }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const uint8_t c = byte();
+            v |= uint64_t{c & 0x7Fu} << shift;
+            if (!(c & 0x80)) return v;
+        }
+        corrupt();
+    }
+    std::span<const uint8_t> bytes(uint64_t n) {
+        need(n);
+        const auto s = b_.subspan(pos_, static_cast<size_t>(n));
+        pos_ += static_cast<size_t>(n);
+        return s;
+    }
+    // A varint-length-prefixed section.
+    ByteReader section() { return ByteReader{bytes(varint())}; }
+
+    // n values of width bits, LSB first, plus base.
+    void packed(size_t n, unsigned width, uint64_t base, std::vector<uint64_t>& out) {
+        if (width > 64) corrupt();
+        const auto src = bytes((static_cast<uint64_t>(n) * width + 7) / 8);
+        out.resize(n);
+        size_t bit = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t x   = 0;
+            unsigned got = 0;
+            while (got < width) {
+                const unsigned off  = bit % 8;
+                const unsigned take = std::min(width - got, 8u - off);
+                x |= static_cast<uint64_t>((src[bit / 8] >> off) & ((1u << take) - 1)) << got;
+                got += take;
+                bit += take;
+            }
+            out[i] = base + x;
+        }
+    }
+    void bitmap(size_t n, std::vector<uint8_t>& flags) {
+        const uint8_t tag = byte();
+        if (tag > 2) corrupt();
+        flags.assign(n, tag == 1);
+        if (tag != 2) return;
+        const auto src = bytes((n + 7) / 8);
+        for (size_t i = 0; i < n; ++i) flags[i] = (src[i / 8] >> (i % 8)) & 1u;
+    }
+    void stream(size_t n, std::vector<uint64_t>& keys, std::vector<uint64_t>& dict) {
+        keys.resize(n);
+        if (n == 0) return;
+        switch (static_cast<StreamKind>(byte())) {
+        case StreamKind::Packed: {
+            const uint64_t base = varint();
+            packed(n, byte(), base, keys);
+            return;
+        }
+        case StreamKind::Delta:
+            keys[0] = varint();
+            for (size_t i = 1; i < n; ++i) keys[i] = keys[i - 1] + static_cast<uint64_t>(unzigzag(varint()));
+            return;
+        case StreamKind::Dictionary: {
+            dict.resize(static_cast<size_t>(varint()));
+            if (dict.empty()) corrupt();
+            dict[0] = varint();
+            for (size_t i = 1; i < dict.size(); ++i) dict[i] = dict[i - 1] + varint();
+            packed(n, byte(), 0, keys);
+            for (auto& k : keys) {
+                if (k >= dict.size()) corrupt();
+                k = dict[static_cast<size_t>(k)];
+            }
+            return;
+        }
+        case StreamKind::Runs: {
+            size_t i = 0;
+            for (uint64_t runs = varint(), value = 0; runs > 0; --runs) {
+                value += static_cast<uint64_t>(unzigzag(varint()));
+                const uint64_t len = varint() + 1;
+                if (len > n - i) corrupt();
+                std::fill_n(keys.begin() + static_cast<std::ptrdiff_t>(i), static_cast<size_t>(len), value);
+                i += static_cast<size_t>(len);
+            }
+            if (i != n) corrupt();
+            return;
+        }
+        }
+        corrupt();
+    }
+
+private:
+    std::span<const uint8_t> b_;
+    size_t                   pos_{0};
+
+    void need(uint64_t n) const {
+        if (n > b_.size() - pos_) corrupt();
+    }
+};
+
+// The DecodedRecord that encodes to rec (see Codec::encode()).
+void expand(const detail::ArchiveLayout& lay, const CompactRecord& rec, DecodedRecord& out) {
+    const CategoryPlan& plan = *lay.plan;
+    out.items.clear();
+    out.uap_variation = *plan.variations[rec.variation].name;
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        if (!rec.hasItem(idx)) continue;
+        const PlanItem&    pi = plan.items[idx];
+        const CompactItem& ci = rec.items[idx];
+        DecodedItem& di = out.items[pi.def->id];
+        di.item_id = pi.def->id;
+        di.type    = pi.type;
+        const auto rep = [&](size_t r, FieldId f) {
+            return rec.rep_values[ci.rep_first + r * pi.columns + plan.fields[f].column];
+        };
+        switch (pi.type) {
+        case ItemType::Repetitive:
+            for (size_t r = 0; r < ci.rep_count; ++r)
+                for (FieldId f : lay.fieldsOf(idx)) di.repetitions.push_back(rep(r, f));
+            break;
+        case ItemType::RepetitiveGroup:
+        case ItemType::RepetitiveGroupFX:
+            for (size_t r = 0; r < ci.rep_count; ++r) {
+                auto& group = di.group_repetitions.emplace_back();
+                for (FieldId f : lay.fieldsOf(idx)) group[plan.def.fields[f].name] = rep(r, f);
+            }
+            break;
+        case ItemType::Explicit:
+        case ItemType::SP: {
+            const auto payload = rec.item(idx).payload();
+            di.raw_bytes.assign(payload.begin(), payload.end());
+            break;
+        }
+        case ItemType::Compound:
+            for (FieldId f : lay.fieldsOf(idx))
+                if (rec.has(f))
+                    di.compound_sub_fields[plan.def.fields[f].sub_item][plan.def.fields[f].name] = rec.values[f];
+            break;
+        default:
+            for (FieldId f : lay.fieldsOf(idx))
+                if (rec.has(f)) di.fields[plan.def.fields[f].name] = rec.values[f];
+        }
+    }
+}
+
+// Sized, zeroed CompactRecord for plan (as the decoder starts a record).
+void prepare(const CategoryPlan& plan, CompactRecord& rec) {
+    rec.plan      = &plan;
+    rec.variation = plan.default_variation;
+    rec.valid     = true;
+    rec.error.clear();
+    rec.fault     = {};
+    rec.values.assign(plan.fields.size(), 0);
+    rec.field_bits.assign((plan.fields.size() + 63) / 64, 0);
+    rec.item_bits.assign((plan.items.size() + 63) / 64, 0);
+    rec.items.assign(plan.items.size(), CompactItem{});
+    rec.rep_values.clear();
+    rec.raw.clear();
+    rec.bytes = {};
+}
+
+void setField(CompactRecord& rec, FieldId f, uint64_t raw) {
+    rec.values[f] = raw;
+    rec.field_bits[f / 64] |= uint64_t{1} << (f % 64);
+}
+
+// Stored row → row, for rows stored track by track: groups in order of first
+// appearance, rows of a group in arrival order (a stable counting sort).
+void groupOrder(std::span<const uint64_t> groups, std::vector<uint32_t>& order) {
+    std::vector<uint32_t> start;
+    for (uint64_t g : groups) {
+        if (g >= groups.size()) corrupt();
+        if (g + 2 > start.size()) start.resize(static_cast<size_t>(g) + 2, 0);
+        ++start[static_cast<size_t>(g) + 1];
+    }
+    for (size_t g = 1; g < start.size(); ++g) start[g] += start[g - 1];
+    order.resize(groups.size());
+    for (uint32_t r = 0; r < groups.size(); ++r) order[start[static_cast<size_t>(groups[r])]++] = r;
+}
+
+void identityOrder(size_t rows, std::vector<uint32_t>& order) {
+    order.resize(rows);
+    for (uint32_t r = 0; r < rows; ++r) order[r] = r;
+}
+
+// Chunk head: blocks, row order, variations, verbatim records.
+struct ChunkHead {
+    size_t rows{0};
+    std::vector<uint32_t> order;                        // stored row → row
+    std::vector<std::pair<uint64_t, size_t>> blocks;   // sequence number, records
+    std::vector<uint64_t> groups;
+    std::vector<uint64_t> variations;                   // by stored row; empty with a single UAP
+    std::vector<std::pair<size_t, std::span<const uint8_t>>> verbatim; // row, wire bytes
+};
+
+void readHead(ByteReader& in, const ArchiveChunk& chunk, const CategoryPlan& plan, ChunkHead& head,
+              std::vector<uint64_t>& dict) {
+    head.rows = static_cast<size_t>(in.varint());
+    head.blocks.resize(static_cast<size_t>(in.varint()));
+    uint64_t seq = chunk.first_block;
+    for (auto& [s, n] : head.blocks) {
+        seq += in.varint();
+        s = seq;
+        n = static_cast<size_t>(in.varint());
+    }
+    if (in.byte() != 0) {
+        in.stream(head.rows, head.groups, dict);
+        groupOrder(head.groups, head.order);
+    } else {
+        identityOrder(head.rows, head.order);
+    }
+    if (plan.variations.size() > 1) in.stream(head.rows, head.variations, dict);
+    else head.variations.clear();
+    head.verbatim.resize(static_cast<size_t>(in.varint()));
+    size_t row = 0;
+    for (auto& [r, bytes] : head.verbatim) {
+        row  += static_cast<size_t>(in.varint());
+        r     = row;
+        bytes = in.bytes(in.varint());
+    }
+}
+
+} // namespace
+
+const ArchiveFieldStats* ArchiveChunk::stats(FieldId id) const noexcept {
+    const auto it = std::lower_bound(fields.begin(), fields.end(), id,
+                                     [](const ArchiveFieldStats& s, FieldId f) { return s.field < f; });
+    return it != fields.end() && it->field == id ? &*it : nullptr;
+}
+
+// ─── Column building ──────────────────────────────────────────────────────────
+
+void detail::ArchiveBuilder::add(const CompactRecord& rec) {
+    if (pending.size() == rows) pending.emplace_back();
+    pending[rows++] = rec;
+    if (grouped) groups.push_back(group_of.try_emplace(layout.trackKey(rec), group_of.size()).first->second);
+}
+
+std::vector<uint32_t> detail::ArchiveBuilder::order() const {
+    std::vector<uint32_t> order;
+    if (grouped) groupOrder(groups, order);
+    else identityOrder(rows, order);
+    return order;
+}
+
+void detail::ArchiveBuilder::column(const CompactRecord& rec) {
+    const CategoryPlan& plan = *layout.plan;
+    variations.push_back(rec.variation);
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        const bool present = rec.hasItem(idx);
+        item_present[idx].push_back(present);
+        if (!present) continue;
+        const CompactItem& ci = rec.items[idx];
+        if (layout.payload(idx)) {
+            const auto payload = rec.item(idx).payload();
+            item_counts[idx].push_back(payload.size());
+            item_payload[idx].insert(item_payload[idx].end(), payload.begin(), payload.end());
+            continue;
+        }
+        if (layout.repeated(idx)) {
+            item_counts[idx].push_back(ci.rep_count);
+            const size_t width = plan.items[idx].columns;
+            for (FieldId f : layout.fieldsOf(idx))
+                for (size_t r = 0; r < ci.rep_count; ++r)
+                    field_keys[f].push_back(toKey(rec.rep_values[ci.rep_first + r * width + plan.fields[f].column],
+                                                  layout.bits[f], layout.is_signed[f]));
+            continue;
+        }
+        for (FieldId f : layout.fieldsOf(idx)) {
+            const bool has = rec.has(f);
+            field_present[f].push_back(has);
+            if (has) field_keys[f].push_back(toKey(rec.values[f], layout.bits[f], layout.is_signed[f]));
+        }
+    }
+}
+
+void detail::ArchiveBuilder::clear() {
+    rows = 0;
+    group_of.clear();
+    for (auto* v : {&groups, &block_seq, &block_records, &variations, &verbatim_rows, &verbatim_lengths}) v->clear();
+    verbatim_bytes.clear();
+    for (auto& v : item_present) v.clear();
+    for (auto& v : item_counts) v.clear();
+    for (auto& v : item_payload) v.clear();
+    for (auto& v : field_present) v.clear();
+    for (auto& v : field_keys) v.clear();
+}
+
+// ─── Writer ───────────────────────────────────────────────────────────────────
+
+ArchiveWriter::ArchiveWriter(const Codec& codec, const std::filesystem::path& path, ArchiveOptions opts)
+    : codec_(&codec), opts_(opts), out_(path, std::ios::binary | std::ios::trunc), one_(1) {
+    if (opts_.chunk_rows == 0) throw std::runtime_error("ArchiveWriter: chunk_rows must be at least 1");
+    if (!out_) throw std::runtime_error("ArchiveWriter: cannot create " + path.string());
+    structural_.validate(Validation::Structural);
+    write(kMagic);
+    write(std::span<const uint8_t>(&kVersion, 1));
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void ArchiveWriter::write(std::span<const uint8_t> bytes) {
+    out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out_) throw std::runtime_error("ArchiveWriter: write failed");
+    offset_ += bytes.size();
+}
+
+detail::ArchiveBuilder& ArchiveWriter::builder(const CategoryPlan& plan) {
+    for (auto& b : builders_) {
+        if (b->layout.plan->def.cat != plan.def.cat) continue;
+        if (b->layout.plan != &plan)
+            throw std::runtime_error("ArchiveWriter: " + catName(plan.def.cat) + " was registered again while archiving");
+        return *b;
+    }
+    return *builders_.emplace_back(std::make_unique<detail::ArchiveBuilder>(plan, opts_.group_tracks));
+}
+
+DecodeError ArchiveWriter::add(std::span<const uint8_t> block) {
+    if (closed_) throw std::runtime_error("ArchiveWriter: add() after close()");
+    const CompactBlock& decoded = codec_->decodeCompactInto(block, ctx_, structural_);
+    if (!decoded.valid) {
+        ++rejected_;
+        return decoded.fault;
+    }
+    codec_->scanRecords(block, index_);
+    detail::ArchiveBuilder& b = builder(*index_.plan);
+
+    // Each record goes to the columns; one that would not re-encode to its
+    // own bytes is also kept as such.
+    for (size_t r = 0; r < decoded.records.size(); ++r) {
+        const CompactRecord& rec = decoded.records[r];
+        b.add(rec);
+        const RecordOffset& at   = index_.records[r];
+        const auto          wire = block.subspan(at.offset, at.length);
+        bool exact = false;
+        try {
+            expand(b.layout, rec, one_[0]);
+            check_.clear();
+            codec_->encodeAppend(decoded.cat, one_, check_);
+            exact = std::equal(check_.begin() + 3, check_.end(), wire.begin(), wire.end());
+        } catch (const std::exception&) {
+        }
+        if (exact) continue;
+        b.verbatim_rows.push_back(b.rows - 1);
+        b.verbatim_lengths.push_back(wire.size());
+        b.verbatim_bytes.insert(b.verbatim_bytes.end(), wire.begin(), wire.end());
+        ++verbatim_;
+    }
+    b.block_seq.push_back(blocks_++);
+    b.block_records.push_back(decoded.records.size());
+    records_ += decoded.records.size();
+    if (b.rows >= opts_.chunk_rows) flush(b);
+    return {};
+}
+
+void ArchiveWriter::flush(detail::ArchiveBuilder& b) {
+    if (b.block_seq.empty()) return;
+    const CategoryPlan& plan = *b.layout.plan;
+    std::vector<uint8_t>  out, item, field;
+    std::vector<uint64_t> dict;
+    for (uint32_t r : b.order()) b.column(b.pending[r]);
+
+    putVarint(out, b.rows);
+    putVarint(out, b.block_seq.size());
+    for (size_t i = 0; i < b.block_seq.size(); ++i) {
+        putVarint(out, b.block_seq[i] - (i ? b.block_seq[i - 1] : b.block_seq[0]));
+        putVarint(out, b.block_records[i]);
+    }
+    out.push_back(b.grouped);
+    if (b.grouped) putStream(out, b.groups, dict);
+    if (plan.variations.size() > 1) putStream(out, b.variations, dict);
+    putVarint(out, b.verbatim_rows.size());
+    for (size_t i = 0, at = 0; i < b.verbatim_rows.size(); ++i) {
+        putVarint(out, b.verbatim_rows[i] - (i ? b.verbatim_rows[i - 1] : 0));
+        putVarint(out, b.verbatim_lengths[i]);
+        out.insert(out.end(), b.verbatim_bytes.begin() + static_cast<std::ptrdiff_t>(at),
+                   b.verbatim_bytes.begin() + static_cast<std::ptrdiff_t>(at + b.verbatim_lengths[i]));
+        at += b.verbatim_lengths[i];
+    }
+
+    // One section per item: presence, counts / payloads, one section per field
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        item.clear();
+        putBitmap(item, b.item_present[idx]);
+        if (!b.item_counts[idx].empty() || b.layout.payload(idx)) putStream(item, b.item_counts[idx], dict);
+        item.insert(item.end(), b.item_payload[idx].begin(), b.item_payload[idx].end());
+        for (FieldId f : b.layout.fieldsOf(idx)) {
+            field.clear();
+            if (!b.layout.repeated(idx)) putBitmap(field, b.field_present[f]);
+            putStream(field, b.field_keys[f], dict);
+            putVarint(item, field.size());
+            item.insert(item.end(), field.begin(), field.end());
+        }
+        putVarint(out, item.size());
+        out.insert(out.end(), item.begin(), item.end());
+    }
+
+    ArchiveChunk& chunk = chunks_.emplace_back();
+    chunk.cat         = plan.def.cat;
+    chunk.offset      = offset_;
+    chunk.bytes       = out.size();
+    chunk.rows        = b.rows;
+    chunk.blocks      = static_cast<uint32_t>(b.block_seq.size());
+    chunk.first_block = b.block_seq.front();
+    chunk.last_block  = b.block_seq.back();
+    for (FieldId f = 0; f < plan.fields.size(); ++f) {
+        const auto& keys = b.field_keys[f];
+        if (keys.empty()) continue;
+        const auto [lo, hi] = std::minmax_element(keys.begin(), keys.end());
+        chunk.fields.push_back({f, static_cast<uint32_t>(keys.size()), statValue(*lo, b.layout.is_signed[f]),
+                                statValue(*hi, b.layout.is_signed[f])});
+    }
+    write(out);
+    b.clear();
+}
+
+void ArchiveWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    for (auto& b : builders_) flush(*b);
+
+    std::vector<uint8_t> dir;
+    putVarint(dir, builders_.size());
+    for (const auto& b : builders_) {
+        const CategoryPlan& plan = *b->layout.plan;
+        dir.push_back(plan.def.cat);
+        putVarint(dir, plan.def.edition.size());
+        dir.insert(dir.end(), plan.def.edition.begin(), plan.def.edition.end());
+        putVarint(dir, plan.items.size());
+        putVarint(dir, plan.fields.size());
+    }
+    putVarint(dir, chunks_.size());
+    for (const auto& c : chunks_) {
+        dir.push_back(c.cat);
+        for (uint64_t v : {c.offset, c.bytes, uint64_t{c.rows}, uint64_t{c.blocks}, c.first_block, c.last_block})
+            putVarint(dir, v);
+        putVarint(dir, c.fields.size());
+        for (const auto& s : c.fields) {
+            putVarint(dir, s.field);
+            putVarint(dir, s.count);
+            putVarint(dir, zigzag(s.min));
+            putVarint(dir, zigzag(s.max));
+        }
+    }
+    const uint64_t at = offset_;
+    for (int i = 0; i < 8; ++i) dir.push_back(static_cast<uint8_t>(at >> (8 * i)));
+    dir.insert(dir.end(), std::begin(kMagic), std::end(kMagic));
+    write(dir);
+    out_.close();
+    if (!out_) throw std::runtime_error("ArchiveWriter: close failed");
+}
+
+// ─── Reader ───────────────────────────────────────────────────────────────────
+
+ArchiveReader::ArchiveReader(const Codec& codec, const std::filesystem::path& path)
+    : codec_(&codec), in_(path, std::ios::binary) {
+    if (!in_) throw std::runtime_error("ArchiveReader: cannot open " + path.string());
+    const auto not_archive = [&] { return std::runtime_error("ArchiveReader: " + path.string() + " is not an archive"); };
+
+    in_.seekg(0, std::ios::end);
+    const uint64_t size = static_cast<uint64_t>(in_.tellg());
+    if (size < 5 + 12) throw not_archive();
+    uint8_t head[5], tail[12];
+    in_.seekg(0);
+    in_.read(reinterpret_cast<char*>(head), 5);
+    in_.seekg(static_cast<std::streamoff>(size - 12));
+    in_.read(reinterpret_cast<char*>(tail), 12);
+    if (!in_ || !std::equal(kMagic, kMagic + 4, head) || !std::equal(kMagic, kMagic + 4, tail + 8))
+        throw not_archive();
+    if (head[4] != kVersion)
+        throw std::runtime_error("ArchiveReader: unsupported archive version " + std::to_string(head[4]));
+    uint64_t dir_at = 0;
+    for (int i = 0; i < 8; ++i) dir_at |= uint64_t{tail[i]} << (8 * i);
+    if (dir_at < 5 || dir_at > size - 12) throw not_archive();
+
+    buf_.resize(static_cast<size_t>(size - 12 - dir_at));
+    in_.seekg(static_cast<std::streamoff>(dir_at));
+    in_.read(reinterpret_cast<char*>(buf_.data()), static_cast<std::streamsize>(buf_.size()));
+    if (!in_) throw not_archive();
+
+    ByteReader dir{buf_};
+    for (uint64_t n = dir.varint(); n > 0; --n) {
+        const uint8_t cat = dir.byte();
+        const auto edition_bytes = dir.bytes(dir.varint());
+        const std::string edition(edition_bytes.begin(), edition_bytes.end());
+        const uint64_t items  = dir.varint();
+        const uint64_t fields = dir.varint();
+        if (!codec.hasCategory(cat))
+            throw std::runtime_error("ArchiveReader: archive holds " + catName(cat) + ", which is not registered");
+        const CategoryPlan& plan = codec.plan(cat);
+        if (plan.def.edition != edition || plan.items.size() != items || plan.fields.size() != fields)
+            throw std::runtime_error("ArchiveReader: " + catName(cat) + " was archived with edition " + edition +
+                                     ", the codec has " + plan.def.edition + " (or other items / fields)");
+        layouts_.push_back(std::make_unique<detail::ArchiveLayout>(plan));
+    }
+    chunks_.resize(static_cast<size_t>(dir.varint()));
+    for (auto& c : chunks_) {
+        c.cat = dir.byte();
+        (void)layout(c.cat);
+        c.offset      = dir.varint();
+        c.bytes       = dir.varint();
+        c.rows        = static_cast<uint32_t>(dir.varint());
+        c.blocks      = static_cast<uint32_t>(dir.varint());
+        c.first_block = dir.varint();
+        c.last_block  = dir.varint();
+        if (c.offset < 5 || c.bytes > dir_at || c.offset > dir_at - c.bytes) throw not_archive();
+        c.fields.resize(static_cast<size_t>(dir.varint()));
+        for (auto& s : c.fields) {
+            s.field = static_cast<FieldId>(dir.varint());
+            s.count = static_cast<uint32_t>(dir.varint());
+            s.min   = unzigzag(dir.varint());
+            s.max   = unzigzag(dir.varint());
+        }
+    }
+}
+
+ArchiveReader::~ArchiveReader() = default;
+
+const detail::ArchiveLayout& ArchiveReader::layout(uint8_t cat) const {
+    for (const auto& l : layouts_)
+        if (l->plan->def.cat == cat) return *l;
+    corrupt();
+}
+
+std::span<const uint8_t> ArchiveReader::load(size_t i) {
+    const ArchiveChunk& c = chunks_.at(i);
+    buf_.resize(static_cast<size_t>(c.bytes));
+    in_.clear();
+    in_.seekg(static_cast<std::streamoff>(c.offset));
+    in_.read(reinterpret_cast<char*>(buf_.data()), static_cast<std::streamsize>(buf_.size()));
+    if (!in_) throw std::runtime_error("ArchiveReader: cannot read chunk " + std::to_string(i));
+    return buf_;
+}
+
+void ArchiveReader::readRecords(size_t i, std::vector<CompactRecord>& out) {
+    ByteReader in{load(i)};
+    const detail::ArchiveLayout& lay  = layout(chunks_[i].cat);
+    const CategoryPlan&          plan = *lay.plan;
+    ChunkHead             head;
+    std::vector<uint64_t> keys, counts, dict;
+    std::vector<uint8_t>  present, has;
+    std::vector<size_t>   rows;
+    readHead(in, chunks_[i], plan, head, dict);
+
+    out.resize(head.rows);
+    for (auto& rec : out) prepare(plan, rec);
+    for (size_t r = 0; r < head.variations.size(); ++r)
+        out[head.order[r]].variation = static_cast<uint16_t>(head.variations[r]);
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        ByteReader item = in.section();
+        item.bitmap(head.rows, present);
+        rows.clear();
+        for (size_t r = 0; r < head.rows; ++r)
+            if (present[r]) rows.push_back(head.order[r]);
+        if (rows.empty()) continue;
+        for (size_t r : rows) out[r].item_bits[idx / 64] |= uint64_t{1} << (idx % 64);
+
+        if (lay.payload(idx)) {
+            item.stream(rows.size(), counts, dict);
+            for (size_t k = 0; k < rows.size(); ++k) {
+                CompactRecord& rec = out[rows[k]];
+                const auto bytes   = item.bytes(counts[k]);
+                rec.items[idx].raw_first = static_cast<uint32_t>(rec.raw.size());
+                rec.items[idx].raw_len   = static_cast<uint16_t>(bytes.size());
+                rec.raw.insert(rec.raw.end(), bytes.begin(), bytes.end());
+            }
+            continue;
+        }
+        if (lay.repeated(idx)) {
+            item.stream(rows.size(), counts, dict);
+            const size_t width = plan.items[idx].columns;
+            size_t total = 0;
+            for (size_t k = 0; k < rows.size(); ++k) {
+                CompactRecord& rec = out[rows[k]];
+                CompactItem&   ci  = rec.items[idx];
+                ci.rep_first = static_cast<uint32_t>(rec.rep_values.size());
+                ci.rep_count = static_cast<uint32_t>(counts[k]);
+                rec.rep_values.resize(rec.rep_values.size() + counts[k] * width, 0);
+                total += static_cast<size_t>(counts[k]);
+            }
+            for (FieldId f : lay.fieldsOf(idx)) {
+                ByteReader field = item.section();
+                field.stream(total, keys, dict);
+                size_t pos = 0;
+                for (size_t k = 0; k < rows.size(); ++k) {
+                    CompactRecord&     rec = out[rows[k]];
+                    const CompactItem& ci  = rec.items[idx];
+                    for (size_t rep = 0; rep < ci.rep_count; ++rep) {
+                        const uint64_t v = fromKey(keys[pos++], lay.bits[f], lay.is_signed[f]);
+                        rec.rep_values[ci.rep_first + rep * width + plan.fields[f].column] = v;
+                        if (rep == 0) setField(rec, f, v);
+                    }
+                }
+            }
+            continue;
+        }
+        for (FieldId f : lay.fieldsOf(idx)) {
+            ByteReader field = item.section();
+            field.bitmap(rows.size(), has);
+            field.stream(static_cast<size_t>(std::count(has.begin(), has.end(), uint8_t{1})), keys, dict);
+            for (size_t k = 0, pos = 0; k < rows.size(); ++k)
+                if (has[k]) setField(out[rows[k]], f, fromKey(keys[pos++], lay.bits[f], lay.is_signed[f]));
+        }
+    }
+}
+
+void ArchiveReader::readColumns(size_t i, ColumnarBatch& cols) {
+    ByteReader in{load(i)};
+    const detail::ArchiveLayout& lay  = layout(chunks_[i].cat);
+    const CategoryPlan&          plan = *lay.plan;
+    if (&cols.plan() != &plan)
+        throw std::runtime_error("ArchiveReader: ColumnarBatch is not built for the " + catName(plan.def.cat) +
+                                 " plan of chunk " + std::to_string(i));
+    ChunkHead             head;
+    std::vector<uint64_t> keys, counts, dict;
+    std::vector<uint8_t>  present, has;
+    std::vector<size_t>   rows;
+    readHead(in, chunks_[i], plan, head, dict);
+
+    const size_t base = cols.rows();
+    cols.appendRows(head.rows);
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        ByteReader item = in.section();
+        if (!cols.wants(idx)) continue;
+        item.bitmap(head.rows, present);
+        rows.clear();
+        for (size_t r = 0; r < head.rows; ++r)
+            if (present[r]) rows.push_back(head.order[r]);
+        if (rows.empty() || lay.payload(idx)) continue;
+
+        const bool repeated = lay.repeated(idx);
+        size_t total = 0;
+        if (repeated) {
+            item.stream(rows.size(), counts, dict);
+            for (uint64_t n : counts) total += static_cast<size_t>(n);
+        }
+        for (FieldId f : lay.fieldsOf(idx)) {
+            ByteReader field = item.section();
+            const size_t c = cols.columnOf(f);
+            if (c == ColumnarBatch::npos) continue;
+            if (repeated) {
+                field.stream(total, keys, dict);
+                for (size_t k = 0, pos = 0; k < rows.size(); pos += static_cast<size_t>(counts[k]), ++k)
+                    if (counts[k] != 0)
+                        cols.setAt(c, base + rows[k], fromKey(keys[pos], lay.bits[f], lay.is_signed[f]));
+                continue;
+            }
+            field.bitmap(rows.size(), has);
+            field.stream(static_cast<size_t>(std::count(has.begin(), has.end(), uint8_t{1})), keys, dict);
+            for (size_t k = 0, pos = 0; k < rows.size(); ++k)
+                if (has[k]) cols.setAt(c, base + rows[k], fromKey(keys[pos++], lay.bits[f], lay.is_signed[f]));
+        }
+    }
+}
+
+void ArchiveReader::readBlocks(size_t i, std::vector<ArchivedBlock>& out) {
+    readRecords(i, records_);
+    ByteReader in{buf_}; // still holds chunk i
+    const detail::ArchiveLayout& lay = layout(chunks_[i].cat);
+    const uint8_t cat = lay.plan->def.cat;
+    ChunkHead             head;
+    std::vector<uint64_t> dict;
+    readHead(in, chunks_[i], *lay.plan, head, dict);
+
+    out.resize(head.blocks.size());
+    size_t row = 0, verbatim = 0;
+    for (size_t b = 0; b < head.blocks.size(); ++b) {
+        ArchivedBlock& block = out[b];
+        block.seq = head.blocks[b].first;
+        block.bytes.assign({cat, 0, 0});
+        const size_t end = row + head.blocks[b].second;
+        if (end > records_.size()) corrupt();
+        while (row < end) {
+            if (verbatim < head.verbatim.size() && head.verbatim[verbatim].first == row) {
+                const auto bytes = head.verbatim[verbatim++].second;
+                block.bytes.insert(block.bytes.end(), bytes.begin(), bytes.end());
+                ++row;
+                continue;
+            }
+            // A run of records rebuilt from their columns, encoded in one go
+            size_t n = 0;
+            while (row + n < end && (verbatim == head.verbatim.size() || head.verbatim[verbatim].first != row + n))
+                ++n;
+            run_.resize(n);
+            for (size_t k = 0; k < n; ++k) expand(lay, records_[row + k], run_[k]);
+            const size_t at = block.bytes.size();
+            codec_->encodeAppend(cat, run_, block.bytes);
+            block.bytes.erase(block.bytes.begin() + static_cast<std::ptrdiff_t>(at),
+                              block.bytes.begin() + static_cast<std::ptrdiff_t>(at + 3)); // its header
+            row += n;
+        }
+        const size_t len = block.bytes.size();
+        block.bytes[1] = static_cast<uint8_t>(len >> 8);
+        block.bytes[2] = static_cast<uint8_t>(len);
+    }
+}
+
+void ArchiveReader::forEachBlock(const std::function<void(std::span<const uint8_t> block)>& on_block) {
+    // One cursor per category: its chunks are in block order, so the next
+    // block overall is the smallest sequence number among the cursors.
+    struct Cursor {
+        std::vector<size_t>        chunks;
+        size_t                     next{0};
+        std::vector<ArchivedBlock> blocks;
+        size_t                     pos{0};
+    };
+    std::vector<Cursor> cursors;
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        auto it = std::find_if(cursors.begin(), cursors.end(),
+                               [&](const Cursor& c) { return chunks_[c.chunks[0]].cat == chunks_[i].cat; });
+        if (it == cursors.end()) it = cursors.insert(cursors.end(), Cursor{});
+        it->chunks.push_back(i);
+    }
+    for (;;) {
+        Cursor* best = nullptr;
+        for (auto& c : cursors) {
+            while (c.pos == c.blocks.size() && c.next < c.chunks.size()) {
+                readBlocks(c.chunks[c.next++], c.blocks);
+                c.pos = 0;
+            }
+            if (c.pos < c.blocks.size() && (!best || c.blocks[c.pos].seq < best->blocks[best->pos].seq)) best = &c;
+        }
+        if (!best) return;
+        on_block(best->blocks[best->pos++].bytes);
+    }
+}
+
+} // namespace asterix
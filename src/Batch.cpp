@@ -0,0 +1,180 @@
+// Batch.cpp – Chunked parallel scheduling for Codec::decodeBatch().
+
+#include "ASTERIXCodec/Batch.hpp"
+#include "ASTERIXCodec/Codec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asterix {
+
+// Enough chunks per worker to even out blocks of different sizes, few enough
+// that claiming stays negligible next to decoding.
+static constexpr size_t kChunksPerWorker = 16;
+static constexpr size_t kMaxAutoChunk    = 256;
+
+static size_t chunkSize(size_t n, unsigned workers, const BatchOptions& opts) noexcept {
+    if (opts.chunk != 0) return opts.chunk;
+    return std::clamp<size_t>(n / (size_t{workers} * kChunksPerWorker), 1, kMaxAutoChunk);
+}
+
+unsigned detail::batchWorkers(size_t n, const BatchOptions& opts) noexcept {
+    unsigned threads = opts.threads != 0 ? opts.threads : std::thread::hardware_concurrency();
+    threads = std::max(threads, 1u);
+    const size_t chunk  = chunkSize(n, threads, opts);
+    const size_t chunks = (n + chunk - 1) / chunk;
+    return static_cast<unsigned>(std::max<size_t>(std::min<size_t>(threads, chunks), 1));
+}
+
+void detail::parallelFor(size_t n, const BatchOptions& opts,
+                         const std::function<void(unsigned, size_t, size_t)>& run) {
+    if (n == 0) return;
+    const unsigned workers = batchWorkers(n, opts);
+    const size_t   chunk   = chunkSize(n, workers, opts);
+    if (workers == 1) {
+        run(0, 0, n);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool>   failed{false};
+    std::exception_ptr  error;
+    std::mutex          error_mutex;
+
+    auto work = [&](unsigned worker) {
+        while (!failed.load(std::memory_order_relaxed)) {
+            const size_t begin = next.fetch_add(chunk, std::memory_order_relaxed);
+            if (begin >= n) return;
+            try {
+                run(worker, begin, std::min(begin + chunk, n));
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (auto& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+}
+
+// ─── Codec batch entry points ─────────────────────────────────────────────────
+
+// Each result is returned, so its records cannot go back to a worker's pools:
+// blocks are decoded fresh, straight into place.
+std::vector<DecodedBlock> Codec::decodeBatch(std::span<const std::span<const uint8_t>> blocks,
+                                             const BatchOptions& opts) const {
+    std::vector<DecodedBlock> out(blocks.size());
+    detail::parallelFor(blocks.size(), opts, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = opts.projection ? decode(blocks[i], *opts.projection) : decode(blocks[i]);
+    });
+    return out;
+}
+
+std::vector<CompactBlock> Codec::decodeCompactBatch(std::span<const std::span<const uint8_t>> blocks,
+                                                    const BatchOptions& opts) const {
+    std::vector<CompactBlock> out(blocks.size());
+    detail::parallelFor(blocks.size(), opts, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            out[i] = opts.projection ? decodeCompact(blocks[i], *opts.projection)
+                                     : decodeCompact(blocks[i]);
+    });
+    return out;
+}
+
+// ─── Intra-block parallel decode ──────────────────────────────────────────────
+
+// Copy the header outcome of a scan; the records are filled in by the caller.
+template <class Block>
+static Block blockFromIndex(const RecordIndex& index) {
+    Block block;
+    block.cat    = index.cat;
+    block.length = index.length;
+    block.valid  = index.valid;
+    block.error  = index.error;
+    block.fault  = index.fault;
+    block.records.resize(index.records.size());
+    return block;
+}
+
+// Fail index, dropping its records, if the projection's selection for its
+// category is stale (see Projection::stale()).
+static void checkStale(RecordIndex& index, const Projection* proj) {
+    if (!index.plan || !proj || !proj->stale(*index.plan)) return;
+    index.valid       = false;
+    index.fault       = {DecodeErrc::StaleProjection};
+    index.fault.value = index.cat;
+    describeTo(index.error, index.fault, index.plan);
+    index.records.clear();
+}
+
+// Remove the records that the projection's filter rejects from index.
+static void dropFiltered(std::span<const uint8_t> buf, RecordIndex& index,
+                         const CategoryProjection* cp) {
+    if (!cp || !cp->filter) return;
+    std::erase_if(index.records, [&](const RecordOffset& r) {
+        return !cp->filter->matches(buf.subspan(r.offset, r.length));
+    });
+}
+
+DecodedBlock Codec::decodeParallel(std::span<const uint8_t> buf, const BatchOptions& opts) const {
+    RecordIndex index = scanRecords(buf);
+    checkStale(index, opts.projection);
+    const CategoryProjection* cp =
+        index.plan && opts.projection ? opts.projection->find(*index.plan) : nullptr;
+    dropFiltered(buf, index, cp);
+    const BorrowMode borrow = opts.projection ? opts.projection->borrowMode() : BorrowMode::Copy;
+    const Validation validation =
+        opts.projection ? opts.projection->validation() : Validation::Mandatory;
+    auto block = blockFromIndex<DecodedBlock>(index);
+    if (!index.plan) return block;
+
+    detail::parallelFor(index.records.size(), opts, [&](unsigned, size_t begin, size_t end) {
+        detail::RecordPools pools; // stays empty: every record is fresh
+        for (size_t i = begin; i < end; ++i) {
+            const RecordOffset& r = index.records[i];
+            DecodeError err;       // the scan already applied the length rules
+            (void)decodeRecord(buf.subspan(r.offset, r.length), *index.plan, block.records[i],
+                               pools, cp, borrow, validation, err, true);
+            if (block.records[i].fault) block.records[i].fault.offset = r.offset;
+        }
+    });
+    return block;
+}
+
+CompactBlock Codec::decodeCompactParallel(std::span<const uint8_t> buf,
+                                          const BatchOptions& opts) const {
+    RecordIndex index = scanRecords(buf);
+    checkStale(index, opts.projection);
+    const CategoryProjection* cp =
+        index.plan && opts.projection ? opts.projection->find(*index.plan) : nullptr;
+    dropFiltered(buf, index, cp);
+    const BorrowMode borrow = opts.projection ? opts.projection->borrowMode() : BorrowMode::Copy;
+    const Validation validation =
+        opts.projection ? opts.projection->validation() : Validation::Mandatory;
+    auto block = blockFromIndex<CompactBlock>(index);
+    if (!index.plan) return block;
+
+    detail::parallelFor(index.records.size(), opts, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const RecordOffset& r = index.records[i];
+            DecodeError err;
+            (void)decodeCompactRecord(buf.subspan(r.offset, r.length), *index.plan,
+                                      block.records[i], cp, borrow, validation, err, true);
+            if (block.records[i].fault) block.records[i].fault.offset = r.offset;
+        }
+    });
+    return block;
+}
+
+} // namespace asterix
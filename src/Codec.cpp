@@ -10,7 +10,11 @@
 
 #include "ASTERIXCodec/Codec.hpp"
 #include "ASTERIXCodec/BitStream.hpp"
+#include "Counters.hpp"
+#include "Walker.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <string>
 
@@ -20,415 +24,735 @@ namespace asterix {
 //  Category registry
 // ─────────────────────────────────────────────────────────────────────────────
 
-void Codec::registerCategory(CategoryDef cat) {
-    uint8_t key = cat.cat;
-    cats_[key]  = std::move(cat);
+Codec::Codec() {
+    if constexpr (kMetricsEnabled) rejected_ = std::make_shared<detail::CategoryCounters>(0);
 }
 
-const CategoryDef& Codec::category(uint8_t cat) const {
-    auto it = cats_.find(cat);
-    if (it == cats_.end())
-        throw std::runtime_error("Category " + std::to_string(cat) + " not registered");
-    return it->second;
+namespace detail {
+
+CategoryRegistry::CategoryRegistry(const CategoryRegistry& other) {
+    *this = other;
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-//  UAP selection
-// ─────────────────────────────────────────────────────────────────────────────
+CategoryRegistry& CategoryRegistry::operator=(const CategoryRegistry& other) {
+    if (this == &other) return *this;
+    std::scoped_lock lock{mutex_, other.mutex_};
+    plans_ = other.plans_;
+    for (size_t cat = 0; cat < slots_.size(); ++cat)
+        slots_[cat].store(other.slots_[cat].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    return *this;
+}
 
-std::string Codec::resolveVariation(const CategoryDef& cat,
-                                     const DecodedRecord& partial) const {
-    if (!cat.uap_case.has_value())
-        return cat.default_variation;
+void CategoryRegistry::publish(std::shared_ptr<const CategoryPlan> plan) {
+    const std::lock_guard lock{mutex_};
+    const CategoryPlan* p = plan.get();
+    plans_.push_back(std::move(plan)); // owned before any reader can see it
+    slots_[p->def.cat].store(p, std::memory_order_release);
+}
 
-    const UapCase& uc = *cat.uap_case;
-    auto rec_it = partial.items.find(uc.item_id);
-    if (rec_it == partial.items.end())
-        return cat.default_variation;
+size_t CategoryRegistry::reclaimRetired() {
+    const std::lock_guard lock{mutex_};
+    const size_t before = plans_.size();
+    std::erase_if(plans_, [&](const auto& p) {
+        return slots_[p->def.cat].load(std::memory_order_relaxed) != p.get();
+    });
+    return before - plans_.size();
+}
 
-    auto field_it = rec_it->second.fields.find(uc.field);
-    if (field_it == rec_it->second.fields.end())
-        return cat.default_variation;
+size_t CategoryRegistry::retained() const {
+    const std::lock_guard lock{mutex_};
+    return plans_.size();
+}
 
-    auto var_it = uc.value_to_variation.find(field_it->second);
-    if (var_it == uc.value_to_variation.end())
-        return cat.default_variation;
+} // namespace detail
 
-    return var_it->second;
+void Codec::registerCategory(CategoryDef cat) {
+    registry_.publish(compilePlan(std::move(cat)));
 }
 
-const std::vector<std::string>&
-Codec::selectUap(const CategoryDef& cat, const DecodedRecord& partial) const {
-    std::string var = resolveVariation(cat, partial);
-    auto it = cat.uap_variations.find(var);
-    if (it == cat.uap_variations.end()) {
-        // fallback to the first registered variation
-        it = cat.uap_variations.begin();
-    }
-    return it->second;
+size_t Codec::reclaimRetired() {
+    return registry_.reclaimRetired();
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-//  Item-level decode helpers
-// ─────────────────────────────────────────────────────────────────────────────
-
-// Decode the sub-elements of a Fixed item from its bit-reader.
-static void decodeFixedElements(const std::vector<ElementDef>& elems,
-                                 BitReader& br,
-                                 DecodedItem& out) {
-    for (const auto& e : elems) {
-        if (e.is_spare) {
-            br.skip(e.bits);
-            continue;
-        }
-        uint64_t raw = br.readU(e.bits);
-        out.fields[e.name] = raw;
-    }
+const CategoryDef& Codec::category(uint8_t cat) const {
+    return plan(cat).def;
 }
 
-// Decode the sub-elements of one Extended octet from its bit-reader.
-static void decodeOctetElements(const OctetDef& oct, BitReader& br, DecodedItem& out) {
-    for (const auto& e : oct.elements) {
-        if (e.is_spare) { br.skip(e.bits); continue; }
-        out.fields[e.name] = br.readU(e.bits);
-    }
-    // FX bit: consume it but don't store it – the caller already checked it
-    br.skip(1); // FX
+const CategoryPlan& Codec::plan(uint8_t cat) const {
+    const CategoryPlan* p = registry_.find(cat);
+    if (!p) throw std::runtime_error("Category " + std::to_string(cat) + " not registered");
+    return *p;
 }
 
-DecodedItem Codec::decodeItem(const DataItemDef& def,
-                               std::span<const uint8_t> item_buf,
-                               size_t& consumed) const {
-    DecodedItem out;
-    out.item_id = def.id;
-    out.type    = def.type;
+// ─────────────────────────────────────────────────────────────────────────────
+//  Decode sinks
+// ─────────────────────────────────────────────────────────────────────────────
+// The wire rules live in Walker.hpp; these sinks decide where values go.
 
-    switch (def.type) {
+namespace {
 
-    // ── Fixed ─────────────────────────────────────────────────────────────
-    case ItemType::Fixed: {
-        if (item_buf.size() < def.fixed_bytes)
-            throw std::runtime_error("Item " + def.id + ": buffer too short for Fixed");
-        BitReader br{item_buf.subspan(0, def.fixed_bytes)};
-        decodeFixedElements(def.elements, br, out);
-        consumed = def.fixed_bytes;
-        break;
-    }
+// Flag a record that failed a record-level check (the record is kept).
+template <class Record>
+void invalidate(const CategoryPlan& plan, Record& rec, const DecodeError& fault, bool text) {
+    rec.valid = false;
+    rec.fault = fault;
+    if (text) describeTo(rec.error, rec.fault, &plan);
+}
 
-    // ── Extended ──────────────────────────────────────────────────────────
-    case ItemType::Extended: {
-        // Read octets until FX=0.  Each raw octet = 7 data bits + 1 FX bit.
-        size_t offset = 0;
-        for (size_t oct_idx = 0; ; ++oct_idx) {
-            if (offset >= item_buf.size())
-                throw std::runtime_error("Item " + def.id + ": unexpected end of buffer in Extended");
-            uint8_t raw_byte = item_buf[offset];
-            bool    fx       = (raw_byte & 0x01u) != 0;
-            ++offset;
-
-            if (oct_idx < def.octets.size()) {
-                // Wrap this single byte in a reader (8 bits)
-                BitReader br{item_buf.subspan(offset - 1, 1)};
-                decodeOctetElements(def.octets[oct_idx], br, out);
-            } else {
-                // Octet beyond spec definition – skip it but honour FX
-                (void)raw_byte;
-            }
-            if (!fx) break;
+// ── std::map-based DecodedRecord ────────────────────────────────────────────
+// Map nodes come from pools (DecodeContext.hpp); an empty pool simply
+// allocates, so decode() and decodeInto() share this sink.
+// filter is set only for items whose fields are narrowed by a Projection;
+// a Compound sub-item map is then created on its first kept field.
+struct MapItemSink {
+    detail::RecordPools*             pools{nullptr};
+    DecodedItem*                     out{nullptr};
+    std::map<std::string, uint64_t>* target{nullptr}; // fields / group / sub-item map
+    const CategoryProjection*        filter{nullptr};
+    ItemIndex                        idx{0};
+    const PlanSubItem*               sub{nullptr};
+    bool                             borrow{false}; // payload as a span
+
+    void field(const PlanElement& e, uint64_t raw) {
+        if (filter) {
+            if (!filter->keeps(idx, e.field)) return;
+            if (!target) target = &pools->subs.acquire(out->compound_sub_fields, sub->def->name);
         }
-        consumed = offset;
-        break;
+        pools->fields.acquire(*target, e.def->name) = raw;
     }
-
-    // ── Repetitive FX ─────────────────────────────────────────────────────
-    case ItemType::Repetitive: {
-        size_t offset = 0;
-        do {
-            if (offset >= item_buf.size())
-                throw std::runtime_error("Item " + def.id + ": buffer too short in Repetitive");
-            uint8_t raw_byte = item_buf[offset++];
-            bool    fx       = (raw_byte & 0x01u) != 0;
-            uint64_t val     = (raw_byte >> 1) & 0x7Fu;   // top 7 bits
-            out.repetitions.push_back(val);
-            if (!fx) break;
-        } while (true);
-        consumed = offset;
-        break;
+    void repetition(const PlanElement& e, uint64_t raw) {
+        if (filter && !filter->keeps(idx, e.field)) return;
+        out->repetitions.push_back(raw);
     }
-
-    // ── Repetitive count-prefixed (structured group) ───────────────────────
-    case ItemType::RepetitiveGroup: {
-        if (item_buf.empty())
-            throw std::runtime_error("Item " + def.id + ": buffer too short for RepetitiveGroup");
-        uint8_t rep_count  = item_buf[0];
-        size_t  group_bytes = static_cast<size_t>(def.rep_group_bits) / 8;
-        size_t  total_need  = 1 + static_cast<size_t>(rep_count) * group_bytes;
-        if (item_buf.size() < total_need)
-            throw std::runtime_error("Item " + def.id + ": buffer too short for RepetitiveGroup data");
-
-        size_t offset = 1;
-        for (uint8_t i = 0; i < rep_count; ++i) {
-            std::map<std::string, uint64_t> grp;
-            BitReader br{item_buf.subspan(offset, group_bytes)};
-            for (const auto& e : def.rep_group_elements) {
-                if (e.is_spare) { br.skip(e.bits); continue; }
-                grp[e.name] = br.readU(e.bits);
-            }
-            out.group_repetitions.push_back(std::move(grp));
-            offset += group_bytes;
+    void beginGroup() { target = &out->group_repetitions.emplace_back(); }
+    void beginSubItem(const PlanSubItem& si) {
+        if (filter) {
+            target = nullptr;
+            sub    = &si;
+            return;
         }
-        consumed = total_need;
-        break;
+        target = &pools->subs.acquire(out->compound_sub_fields, si.def->name);
     }
-
-    // ── Repetitive FX with structured group ───────────────────────────────
-    // Each group is (rep_group_bits + 1) / 8 bytes wide.
-    // The last bit of each group is the FX flag (1 = more groups follow).
-    case ItemType::RepetitiveGroupFX: {
-        size_t group_bytes = (static_cast<size_t>(def.rep_group_bits) + 1) / 8;
-        size_t offset = 0;
-        do {
-            if (offset + group_bytes > item_buf.size())
-                throw std::runtime_error("Item " + def.id +
-                                         ": buffer too short in RepetitiveGroupFX");
-            BitReader br{item_buf.subspan(offset, group_bytes)};
-            std::map<std::string, uint64_t> grp;
-            for (const auto& e : def.rep_group_elements) {
-                if (e.is_spare) { br.skip(e.bits); continue; }
-                grp[e.name] = br.readU(e.bits);
-            }
-            bool fx = br.readBit(); // FX is the last bit of the group
-            out.group_repetitions.push_back(std::move(grp));
-            offset += group_bytes;
-            if (!fx) break;
-        } while (true);
-        consumed = offset;
-        break;
+    void payload(std::span<const uint8_t> bytes) {
+        if (borrow) out->payload = bytes;
+        else out->raw_bytes.assign(bytes.begin(), bytes.end());
     }
-
-    // ── Explicit / SP ─────────────────────────────────────────────────────
-    case ItemType::SP: {
-        if (item_buf.empty())
-            throw std::runtime_error("Item " + def.id + ": empty buffer for Explicit");
-        uint8_t len = item_buf[0]; // first byte = payload length (including itself per ASTERIX spec)
-        // len field includes itself: payload = len-1 bytes
-        if (len < 1 || item_buf.size() < static_cast<size_t>(len))
-            throw std::runtime_error("Item " + def.id + ": Explicit length out of range");
-        out.raw_bytes.assign(item_buf.begin() + 1, item_buf.begin() + len);
-        consumed = len;
-        break;
+};
+
+struct MapRecordSink {
+    const CategoryPlan&       plan;
+    DecodedRecord&            rec;
+    detail::RecordPools&      pools;
+    const CategoryProjection* proj;
+    BorrowMode                borrow;
+    bool                      text; // build error strings
+    MapItemSink               item_sink;
+
+    bool decodes(ItemIndex idx) const { return !proj || proj->keeps(idx); }
+
+    MapItemSink& beginItem(ItemIndex idx, const PlanItem& item) {
+        DecodedItem& di = pools.items.acquire(rec.items, item.def->id);
+        di.item_id = item.def->id;
+        di.type    = item.type;
+        item_sink  = {&pools, &di, &di.fields,
+                      proj && proj->filtered[idx] ? proj : nullptr, idx, nullptr,
+                      borrow != BorrowMode::Copy};
+        return item_sink;
     }
-
-    // ── Compound ──────────────────────────────────────────────────────────
-    // Wire format: PSF byte(s) [same FX-extension as outer FSPEC] followed by
-    // the fixed-size payload of each sub-item whose PSF slot bit is set.
-    // PSF bit mapping: bit 7 = sub-item 0, bit 6 = sub-item 1, … bit 1 = sub-item 6.
-    // bit 0 of each PSF byte is the FX continuation flag.
-    case ItemType::Compound: {
-        // Read PSF byte(s)
-        size_t offset = 0;
-        std::vector<uint8_t> psf;
-        do {
-            if (offset >= item_buf.size())
-                throw std::runtime_error("Item " + def.id + ": truncated Compound PSF");
-            uint8_t b = item_buf[offset++];
-            psf.push_back(b);
-        } while (psf.back() & 0x01u); // FX=1 means more PSF bytes follow
-
-        // Decode each sub-item whose PSF slot is set
-        for (size_t slot = 0; slot < def.compound_sub_items.size(); ++slot) {
-            const auto& si = def.compound_sub_items[slot];
-            size_t psf_byte = slot / 7;
-            size_t psf_bit  = 7 - (slot % 7); // bit 7 = slot 0, bit 1 = slot 6
-            bool   present  = (psf_byte < psf.size()) &&
-                              ((psf[psf_byte] >> psf_bit) & 0x01u);
-            if (!present || si.name == "-") continue;
-
-            if (offset + si.fixed_bytes > item_buf.size())
-                throw std::runtime_error("Item " + def.id + "/" + si.name +
-                                         ": buffer too short for Compound sub-item");
-            std::map<std::string, uint64_t> sub_fields;
-            BitReader br{item_buf.subspan(offset, si.fixed_bytes)};
-            for (const auto& e : si.elements) {
-                if (e.is_spare) { br.skip(e.bits); continue; }
-                sub_fields[e.name] = br.readU(e.bits);
-            }
-            out.compound_sub_fields[si.name] = std::move(sub_fields);
-            offset += si.fixed_bytes;
+    void endItem(ItemIndex idx, std::span<const uint8_t> item_bytes) {
+        if (borrow == BorrowMode::Items && decodes(idx)) item_sink.out->wire = item_bytes;
+    }
+    void variation(uint16_t var) { rec.uap_variation = *plan.variations[var].name; }
+    void invalid(const DecodeError& fault) { invalidate(plan, rec, fault, text); }
+};
+
+// ── Interned-field CompactRecord ────────────────────────────────────────────
+// With a field filter, dropped group values are stored as 0 so that every
+// repetition row keeps PlanItem::columns entries.
+struct CompactItemSink {
+    CompactRecord*            rec{nullptr};
+    CompactItem*              entry{nullptr};
+    bool                      in_group{false};
+    const CategoryProjection* filter{nullptr};
+    ItemIndex                 idx{0};
+
+    void set(FieldId id, uint64_t raw) {
+        if (id >= rec->values.size()) return;
+        rec->values[id] = raw;
+        rec->field_bits[id / 64] |= uint64_t{1} << (id % 64);
+    }
+    void field(const PlanElement& e, uint64_t raw) {
+        const bool keep = !filter || filter->keeps(idx, e.field);
+        if (in_group) {
+            rec->rep_values.push_back(keep ? raw : 0);
+            if (entry->rep_count != 1) return; // only the first row is mirrored in values[]
         }
-        consumed = offset;
-        break;
+        if (keep) set(e.field, raw);
     }
-
-    default:
-        throw std::runtime_error("Item " + def.id + ": unsupported item type");
+    void repetition(const PlanElement& e, uint64_t raw) {
+        if (filter && !filter->keeps(idx, e.field)) return;
+        rec->rep_values.push_back(raw);
+        if (entry->rep_count++ == 0) set(e.field, raw);
     }
-
-    return out;
+    void beginGroup() {
+        in_group = true;
+        ++entry->rep_count;
+    }
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t> bytes) {
+        entry->raw_len = static_cast<uint16_t>(bytes.size());
+        if (!rec->bytes.empty()) { // borrowed: an offset into the record
+            entry->raw_first = static_cast<uint32_t>(bytes.data() - rec->bytes.data());
+            return;
+        }
+        entry->raw_first = static_cast<uint32_t>(rec->raw.size());
+        rec->raw.insert(rec->raw.end(), bytes.begin(), bytes.end());
+    }
+};
+
+struct CompactRecordSink {
+    const CategoryPlan&       plan;
+    CompactRecord&            rec;
+    const CategoryProjection* proj;
+    bool                      text;
+    CompactItemSink           item_sink;
+
+    bool decodes(ItemIndex idx) const { return !proj || proj->keeps(idx); }
+
+    CompactItemSink& beginItem(ItemIndex idx, const PlanItem&) {
+        rec.item_bits[idx / 64] |= uint64_t{1} << (idx % 64);
+        CompactItem& ci = rec.items[idx];
+        ci.rep_first    = static_cast<uint32_t>(rec.rep_values.size());
+        item_sink       = {&rec, &ci, false,
+                           proj && proj->filtered[idx] ? proj : nullptr, idx};
+        return item_sink;
+    }
+    void endItem(ItemIndex, std::span<const uint8_t>) {}
+    void variation(uint16_t var) { rec.variation = var; }
+    void invalid(const DecodeError& fault) { invalidate(plan, rec, fault, text); }
+};
+
+// ── Length-only BlockView ───────────────────────────────────────────────────
+struct ViewRecordSink {
+    const CategoryPlan&  plan;
+    ViewRecord&          rec;
+    const uint8_t*       record_start;
+    ItemSpan*            spans; // plan.items.size() entries for this record
+    bool                 text;
+    detail::SkipItemSink skip;
+
+    bool decodes(ItemIndex) const { return false; }
+    detail::SkipItemSink& beginItem(ItemIndex, const PlanItem&) { return skip; }
+    void endItem(ItemIndex idx, std::span<const uint8_t> item_bytes) {
+        spans[idx] = {static_cast<uint16_t>(item_bytes.data() - record_start),
+                      static_cast<uint16_t>(item_bytes.size())};
+    }
+    void variation(uint16_t var) { rec.variation = var; }
+    void invalid(const DecodeError& fault) { invalidate(plan, rec, fault, text); }
+};
+
+// ── Record boundaries only ──────────────────────────────────────────────────
+struct ScanRecordSink {
+    detail::SkipItemSink skip;
+    uint16_t             var;
+
+    bool decodes(ItemIndex) const { return false; }
+    detail::SkipItemSink& beginItem(ItemIndex, const PlanItem&) { return skip; }
+    void endItem(ItemIndex, std::span<const uint8_t>) {}
+    void variation(uint16_t v) { var = v; }
+    void invalid(const DecodeError&) {} // reported when the record is decoded
+};
+
+// ── Struct-of-arrays ColumnarBatch ──────────────────────────────────────────
+// The batch's last row is the record being decoded.
+struct ColumnItemSink {
+    ColumnarBatch* cols{nullptr};
+
+    void field(const PlanElement& e, uint64_t raw) {
+        if (const size_t c = cols->columnOf(e.field); c != ColumnarBatch::npos) cols->set(c, raw);
+    }
+    void repetition(const PlanElement& e, uint64_t raw) { field(e, raw); }
+    void beginGroup() {}
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t>) {}
+};
+
+struct ColumnRecordSink {
+    ColumnItemSink item_sink;
+
+    bool decodes(ItemIndex idx) const { return item_sink.cols->wants(idx); }
+    ColumnItemSink& beginItem(ItemIndex, const PlanItem&) { return item_sink; }
+    void endItem(ItemIndex, std::span<const uint8_t>) {}
+    void variation(uint16_t) {}
+    void invalid(const DecodeError&) {}
+};
+
+// Size (and zero) the flat arrays of a CompactRecord for the given plan.
+void prepareCompact(const CategoryPlan& plan, CompactRecord& rec) {
+    const size_t n_fields = plan.fields.size();
+    const size_t n_items  = plan.items.size();
+    rec.plan      = &plan;
+    rec.variation = plan.default_variation;
+    rec.valid     = true;
+    rec.error.clear();
+    rec.fault     = {};
+    rec.values.assign(n_fields, 0);
+    rec.field_bits.assign((n_fields + 63) / 64, 0);
+    rec.item_bits.assign((n_items + 63) / 64, 0);
+    rec.items.assign(n_items, CompactItem{});
+    rec.rep_values.clear();
+    rec.raw.clear();
+    rec.bytes = {};
 }
 
+} // namespace
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Record-level decode
 // ─────────────────────────────────────────────────────────────────────────────
 
-// CAT01 has two UAPs sharing the same first two slots (I010, I020).
-// Strategy:
-//   1. Read FSPEC bytes.
-//   2. Decode using default variation.
-//   3. If I020 was decoded and a Case discriminator exists, re-run with the
-//      correct variation (FSPEC is already known, only item order differs).
-//
-// Because I010 and I020 appear at FSPEC positions 1 and 2 in BOTH variations
-// of CAT01, we need only one pass.  The resolved variation is stored in the
-// record for the caller's use.
-
-DecodedRecord Codec::decodeRecord(std::span<const uint8_t> buf,
-                                   const CategoryDef& cat,
-                                   size_t& bytes_consumed) const {
-    DecodedRecord rec;
-    size_t pos = 0;
-
-    if (buf.empty()) {
-        bytes_consumed = 0;
-        rec.valid = false;
-        rec.error = "decodeRecord called on empty buffer";
-        return rec;
-    }
-
-    // ── Step 1: Read FSPEC ──────────────────────────────────────────────────
-    std::vector<uint8_t> fspec;
-    while (pos < buf.size()) {
-        uint8_t b = buf[pos++];
-        fspec.push_back(b);
-        if ((b & 0x01u) == 0) break; // FX=0 → last FSPEC byte
-    }
-    if (fspec.empty())
-        throw std::runtime_error("Record has empty FSPEC");
-
-    // ── Step 2: Collect FSPEC presence bits (MSB→bit7 = UAP slot 1) ────────
-    // UAP slot index (1-based) → bit position in FSPEC.
-    // Each FSPEC byte contributes 7 slots (bits 7..1); bit 0 is FX.
-    // Slot k (1-based) → fspec byte [(k-1)/7], bit (7 - ((k-1)%7)).
-
-    auto isPresent = [&](size_t slot_1based) -> bool {
-        if (slot_1based == 0) return false;
-        size_t idx       = (slot_1based - 1) / 7;  // which fspec byte
-        size_t bit_shift = 7 - ((slot_1based - 1) % 7); // bit within byte (7=MSB…1=next to FX)
-        if (idx >= fspec.size()) return false;
-        return ((fspec[idx] >> bit_shift) & 0x01u) != 0;
-    };
-
-    // ── Step 3: First pass – determine UAP variation ─────────────────────────
-    // Use the default variation initially; after decoding the discriminator
-    // item (e.g. I020) we can confirm / switch variation for FSPEC interpretation.
-    //
-    // For CAT01: slots 1 & 2 are I010 & I020 in BOTH variations, so a single
-    // pass with default_variation is correct (no re-interpretation needed).
-
-    const std::vector<std::string>* uap = &cat.uap_variations.at(cat.default_variation);
-
-    // ── Step 4: Decode items in UAP order ────────────────────────────────────
-    for (size_t slot = 1; slot <= uap->size(); ++slot) {
-        const std::string& item_id = (*uap)[slot - 1];
-
-        if (item_id == "-" || item_id == "rfs") continue;
-
-        if (!isPresent(slot)) continue;
-
-        auto def_it = cat.items.find(item_id);
-        if (def_it == cat.items.end())
-            throw std::runtime_error("FSPEC references unknown item: " + item_id);
-
-        const DataItemDef& def = def_it->second;
-        size_t item_consumed   = 0;
-        DecodedItem di = decodeItem(def, buf.subspan(pos), item_consumed);
-        pos += item_consumed;
-        rec.items[item_id] = std::move(di);
-
-        // After decoding the discriminator item, switch UAP if necessary.
-        // (Re-checking the same FSPEC with the new UAP pointer is safe because
-        // in CAT01 the first two slots are identical in both variations.)
-        if (cat.uap_case.has_value() && item_id == cat.uap_case->item_id) {
-            std::string var = resolveVariation(cat, rec);
-            auto it = cat.uap_variations.find(var);
-            if (it != cat.uap_variations.end()) {
-                uap = &it->second;
-                rec.uap_variation = var;
-            }
-        }
-    }
-
-    if (rec.uap_variation.empty())
-        rec.uap_variation = cat.default_variation;
-
-    // ── Step 5: Mandatory item validation ────────────────────────────────────
-    for (const auto& [id, def] : cat.items) {
-        if (def.presence == Presence::Mandatory &&
-            rec.items.find(id) == rec.items.end()) {
-            rec.valid = false;
-            rec.error = "Mandatory item " + id + " not present";
-        }
-    }
+size_t Codec::decodeRecord(std::span<const uint8_t> buf,
+                           const CategoryPlan& plan,
+                           DecodedRecord& rec,
+                           detail::RecordPools& pools,
+                           const CategoryProjection* proj, BorrowMode borrow,
+                           Validation validation, DecodeError& err, bool text) const {
+    pools.reclaim(rec);
+    MapRecordSink sink{plan, rec, pools, proj, borrow, text, {}};
+    return detail::walkRecord(plan, buf, sink, err, validation);
+}
 
-    bytes_consumed = pos;
-    return rec;
+size_t Codec::decodeCompactRecord(std::span<const uint8_t> buf,
+                                  const CategoryPlan& plan,
+                                  CompactRecord& rec,
+                                  const CategoryProjection* proj, BorrowMode borrow,
+                                  Validation validation, DecodeError& err, bool text) const {
+    prepareCompact(plan, rec);
+    if (borrow != BorrowMode::Copy) rec.bytes = buf; // payload offsets are taken from here
+    CompactRecordSink sink{plan, rec, proj, text, {}};
+    const size_t consumed = detail::walkRecord(plan, buf, sink, err, validation);
+    if (consumed != 0 && !rec.bytes.empty()) rec.bytes = buf.first(consumed);
+    return consumed;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Public decode
 // ─────────────────────────────────────────────────────────────────────────────
 
-DecodedBlock Codec::decode(std::span<const uint8_t> buf) const {
-    DecodedBlock block;
+// Record a block-level fault, and its message when text is set.
+template <class Block>
+static void failBlock(Block& block, const DecodeError& err, const CategoryPlan* plan, bool text) {
+    block.valid = false;
+    block.fault = err;
+    if (text) describeTo(block.error, err, plan);
+}
 
+// Validate the Data Block header of buf into block (cat, length, fault).
+// Returns the payload after the 3-byte header and sets plan, or returns an
+// empty span with block.valid = false (counted in rejected, if set).
+template <class Block>
+static std::span<const uint8_t> readBlockHeader(
+        std::span<const uint8_t> buf,
+        const detail::CategoryRegistry& cats,
+        detail::CategoryCounters* rejected,
+        Block& block, const CategoryPlan*& plan, bool text) {
+    const auto reject = [&](const DecodeError& err) {
+        if constexpr (kMetricsEnabled)
+            if (rejected) rejected->fault(err.code);
+        failBlock(block, err, nullptr, text);
+    };
     if (buf.size() < 3) {
-        block.valid = false;
-        block.error = "Buffer too short for Data Block header (need ≥3 bytes)";
-        return block;
+        reject({DecodeErrc::ShortHeader});
+        return {};
     }
 
     block.cat    = buf[0];
     block.length = static_cast<uint16_t>((buf[1] << 8) | buf[2]);
 
     if (block.length < 3 || static_cast<size_t>(block.length) > buf.size()) {
-        block.valid = false;
-        block.error = "Data Block LEN field (" + std::to_string(block.length) + ") is invalid";
-        return block;
+        DecodeError err{DecodeErrc::BadBlockLength};
+        err.offset = 1;
+        err.value  = block.length;
+        reject(err);
+        return {};
     }
 
-    auto cat_it = cats_.find(block.cat);
-    if (cat_it == cats_.end()) {
-        block.valid = false;
-        block.error = "Category " + std::to_string(block.cat) + " not registered";
-        return block;
+    plan = cats.find(block.cat);
+    if (!plan) {
+        DecodeError err{DecodeErrc::UnknownCategory};
+        err.value = block.cat;
+        reject(err);
+        return {};
     }
-    const CategoryDef& cat = cat_it->second;
 
     // Payload: everything after the 3-byte header
-    auto payload = buf.subspan(3, block.length - 3);
-    size_t pos   = 0;
+    return buf.subspan(3, block.length - 3);
+}
 
+// Record storage for decodeRecords(): acquire() hands out the next record,
+// drop() gives back the last one after a failed decode.
+template <class Block>
+struct FreshRecords {
+    Block& block;
+
+    auto& acquire() { return block.records.emplace_back(); }
+    void  drop() { block.records.pop_back(); }
+    void  finish() {}
+};
+
+// Reuses block.records in place.  Records past the decoded count are parked in
+// spare rather than destroyed, so their storage survives a smaller block.
+template <class Block, class Record>
+struct RecycledRecords {
+    Block&               block;
+    std::vector<Record>& spare;
+    size_t               used{0};
+
+    Record& acquire() {
+        if (used == block.records.size()) {
+            if (spare.empty()) {
+                block.records.emplace_back();
+            } else {
+                block.records.push_back(std::move(spare.back()));
+                spare.pop_back();
+            }
+        }
+        return block.records[used++];
+    }
+    void drop() { --used; }
+    void finish() {
+        while (block.records.size() > used) {
+            spare.push_back(std::move(block.records.back()));
+            block.records.pop_back();
+        }
+    }
+};
+
+// Decode consecutive records of payload into store.block.records;
+// decode_one(buf, record, err) returns the bytes consumed by one record, or 0
+// with err set.  Records that filter rejects are only measured.  Walker
+// offsets are made relative to the Data Block.
+template <class Store, class DecodeOne>
+static void decodeRecords(std::span<const uint8_t> payload, const CategoryPlan& plan, bool text,
+                          Store& store, DecodeOne&& decode_one,
+                          const RecordFilter* filter = nullptr) {
+    using clock = std::chrono::steady_clock;
+    detail::CategoryCounters* counters = kMetricsEnabled ? plan.counters.get() : nullptr;
+    const clock::time_point start = counters ? clock::now() : clock::time_point{};
+    [[maybe_unused]] uint64_t records = 0;
+
+    auto& block = store.block;
+    size_t pos = 0;
     while (pos < payload.size()) {
-        size_t consumed = 0;
-        try {
-            DecodedRecord rec = decodeRecord(payload.subspan(pos), cat, consumed);
-            block.records.push_back(std::move(rec));
-        } catch (const std::exception& ex) {
-            block.valid = false;
-            block.error = std::string("Record decode error: ") + ex.what();
-            break;
+        const auto block_offset = static_cast<uint32_t>(3 + pos);
+        DecodeError err;
+        // A record the filter rejects is skipped whole; one that breaks the
+        // length rules is left to the full decode below to report.
+        size_t skipped = 0;
+        if (filter && !filter->matches(payload.subspan(pos), skipped) && skipped != 0) {
+            pos += skipped;
+            continue;
         }
+        auto& rec = store.acquire();
+        const size_t consumed = decode_one(payload.subspan(pos), rec, err);
         if (consumed == 0) {
-            block.valid = false;
-            block.error = "Infinite loop guard: no bytes consumed decoding record";
+            store.drop();
+            if (!err) err.code = DecodeErrc::NoProgress;
+            err.offset += block_offset;
+            failBlock(block, err, &plan, text);
             break;
         }
+        if constexpr (requires { rec.fault; })
+            if (rec.fault) {
+                rec.fault.offset = block_offset;
+                if constexpr (kMetricsEnabled)
+                    if (counters) counters->fault(rec.fault.code);
+            }
+        ++records;
         pos += consumed;
     }
+    store.finish();
+
+    if constexpr (kMetricsEnabled) {
+        if (!counters) return;
+        using detail::CategoryCounters;
+        counters->add(CategoryCounters::kBlocks);
+        counters->add(CategoryCounters::kRecords, records);
+        counters->add(CategoryCounters::kBytes, payload.size() + 3);
+        if (block.fault) counters->fault(block.fault.code);
+        counters->latency(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+    }
+}
+
+// Clear the header fields of a reused block (records are handled by the store).
+template <class Block>
+static void resetBlock(Block& block) {
+    block.cat    = 0;
+    block.length = 0;
+    block.valid  = true;
+    block.error.clear();
+    block.fault  = {};
+}
+
+// Selects nothing, so every category decodes in full.
+static const Projection kFullDecode;
+
+// The record filter of a category's projection, if any.
+static const RecordFilter* recordFilter(const CategoryProjection* cp) noexcept {
+    return cp && cp->filter ? &*cp->filter : nullptr;
+}
+
+// Set cp to proj's selection for plan.  A stale selection (see
+// Projection::stale()) fails the block instead; returns false.
+template <class Block>
+static bool findProjection(const Projection& proj, const CategoryPlan& plan, Block& block,
+                           bool text, const CategoryProjection*& cp) {
+    cp = proj.find(plan);
+    if (cp || !proj.stale(plan)) return true;
+    DecodeError err{DecodeErrc::StaleProjection};
+    err.value = plan.def.cat;
+    if constexpr (kMetricsEnabled)
+        if (plan.counters) plan.counters->fault(err.code);
+    failBlock(block, err, &plan, text);
+    return false;
+}
+
+DecodedBlock Codec::decode(std::span<const uint8_t> buf) const {
+    return decode(buf, kFullDecode);
+}
+
+CompactBlock Codec::decodeCompact(std::span<const uint8_t> buf) const {
+    return decodeCompact(buf, kFullDecode);
+}
+
+const DecodedBlock& Codec::decodeInto(std::span<const uint8_t> buf, DecodeContext& ctx) const {
+    return decodeInto(buf, ctx, kFullDecode);
+}
+
+const CompactBlock& Codec::decodeCompactInto(std::span<const uint8_t> buf,
+                                             DecodeContext& ctx) const {
+    return decodeCompactInto(buf, ctx, kFullDecode);
+}
+
+DecodedBlock Codec::decode(std::span<const uint8_t> buf, const Projection& proj) const {
+    DecodedBlock block;
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, true);
+    if (!plan) return block;
+
+    const CategoryProjection* cp = nullptr;
+    if (!findProjection(proj, *plan, block, true, cp)) return block;
+    detail::RecordPools pools; // stays empty: every node is freshly allocated
+    FreshRecords<DecodedBlock> store{block};
+    decodeRecords(payload, *plan, true, store,
+                  [&](std::span<const uint8_t> rec_buf, DecodedRecord& rec, DecodeError& err) {
+        return decodeRecord(rec_buf, *plan, rec, pools, cp, proj.borrowMode(), proj.validation(),
+                            err, true);
+    }, recordFilter(cp));
+    return block;
+}
+
+CompactBlock Codec::decodeCompact(std::span<const uint8_t> buf, const Projection& proj) const {
+    CompactBlock block;
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, true);
+    if (!plan) return block;
+
+    const CategoryProjection* cp = nullptr;
+    if (!findProjection(proj, *plan, block, true, cp)) return block;
+    FreshRecords<CompactBlock> store{block};
+    decodeRecords(payload, *plan, true, store,
+                  [&](std::span<const uint8_t> rec_buf, CompactRecord& rec, DecodeError& err) {
+        return decodeCompactRecord(rec_buf, *plan, rec, cp, proj.borrowMode(), proj.validation(),
+                                   err, true);
+    }, recordFilter(cp));
+    return block;
+}
+
+const DecodedBlock& Codec::decodeInto(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                      const Projection& proj) const {
+    DecodedBlock& block = ctx.block_;
+    resetBlock(block);
+    RecycledRecords<DecodedBlock, DecodedRecord> store{block, ctx.spare_records_};
+
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, ctx.error_text_);
+    if (!plan) {
+        store.finish();
+        return block;
+    }
 
+    const CategoryProjection* cp = nullptr;
+    if (!findProjection(proj, *plan, block, ctx.error_text_, cp)) {
+        store.finish();
+        return block;
+    }
+    decodeRecords(payload, *plan, ctx.error_text_, store,
+                  [&](std::span<const uint8_t> rec_buf, DecodedRecord& rec, DecodeError& err) {
+        return decodeRecord(rec_buf, *plan, rec, ctx.pools_, cp, proj.borrowMode(), proj.validation(),
+                            err, ctx.error_text_);
+    }, recordFilter(cp));
     return block;
 }
 
+const CompactBlock& Codec::decodeCompactInto(std::span<const uint8_t> buf, DecodeContext& ctx,
+                                             const Projection& proj) const {
+    CompactBlock& block = ctx.compact_;
+    resetBlock(block);
+    RecycledRecords<CompactBlock, CompactRecord> store{block, ctx.spare_compact_};
+
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, ctx.error_text_);
+    if (!plan) {
+        store.finish();
+        return block;
+    }
+
+    const CategoryProjection* cp = nullptr;
+    if (!findProjection(proj, *plan, block, ctx.error_text_, cp)) {
+        store.finish();
+        return block;
+    }
+    decodeRecords(payload, *plan, ctx.error_text_, store,
+                  [&](std::span<const uint8_t> rec_buf, CompactRecord& rec, DecodeError& err) {
+        return decodeCompactRecord(rec_buf, *plan, rec, cp, proj.borrowMode(), proj.validation(),
+                                   err, ctx.error_text_);
+    }, recordFilter(cp));
+    return block;
+}
+
+BlockView Codec::view(std::span<const uint8_t> buf) const {
+    BlockView block;
+    view(buf, block);
+    return block;
+}
+
+void Codec::view(std::span<const uint8_t> buf, BlockView& block) const {
+    resetBlock(block);
+    block.plan = nullptr;
+    block.bytes = {};
+    block.records.clear();
+    block.spans.clear();
+
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, true);
+    if (!plan) return;
+    block.plan  = plan;
+    block.bytes = buf.subspan(0, block.length);
+
+    const size_t n_items = plan->items.size();
+    FreshRecords<BlockView> store{block};
+    decodeRecords(payload, *plan, true, store,
+                  [&](std::span<const uint8_t> rec_buf, ViewRecord& rec, DecodeError& err) {
+        const size_t index = static_cast<size_t>(&rec - block.records.data());
+        rec.offset      = static_cast<uint32_t>(rec_buf.data() - buf.data());
+        rec.spans_first = static_cast<uint32_t>(index * n_items);
+        block.spans.resize(rec.spans_first); // drops a failed record's spans
+        block.spans.resize(rec.spans_first + n_items, ItemSpan{});
+
+        rec.variation = plan->default_variation;
+        ViewRecordSink sink{*plan, rec, rec_buf.data(), block.spans.data() + rec.spans_first,
+                            true, {}};
+        const size_t consumed = detail::walkRecord(*plan, rec_buf, sink, err);
+        rec.length = static_cast<uint16_t>(consumed);
+        return consumed;
+    });
+    block.spans.resize(block.records.size() * n_items);
+}
+
+RecordIndex Codec::scanRecords(std::span<const uint8_t> buf) const {
+    RecordIndex index;
+    scanRecords(buf, index);
+    return index;
+}
+
+void Codec::scanRecords(std::span<const uint8_t> buf, RecordIndex& index) const {
+    resetBlock(index);
+    index.plan = nullptr;
+    index.records.clear();
+
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), index, plan, true);
+    if (!plan) return;
+    index.plan = plan;
+
+    FreshRecords<RecordIndex> store{index};
+    decodeRecords(payload, *plan, true, store,
+                  [&](std::span<const uint8_t> rec_buf, RecordOffset& rec, DecodeError& err) {
+        ScanRecordSink sink{{}, plan->default_variation};
+        const size_t consumed = detail::walkRecord(*plan, rec_buf, sink, err);
+        rec = {static_cast<uint32_t>(rec_buf.data() - buf.data()),
+               static_cast<uint16_t>(consumed), sink.var};
+        return consumed;
+    });
+}
+
+DecodedRecord Codec::decodeRecordAt(std::span<const uint8_t> buf,
+                                    const RecordIndex& index, size_t i) const {
+    const RecordOffset& r = index.records.at(i);
+    DecodedRecord rec;
+    detail::RecordPools pools;
+    DecodeError err;
+    (void)decodeRecord(buf.subspan(r.offset, r.length), *index.plan, rec, pools, nullptr,
+                       BorrowMode::Copy, Validation::Mandatory, err, true);
+    if (rec.fault) rec.fault.offset = r.offset;
+    return rec;
+}
+
+CompactRecord Codec::decodeCompactRecordAt(std::span<const uint8_t> buf,
+                                           const RecordIndex& index, size_t i) const {
+    const RecordOffset& r = index.records.at(i);
+    CompactRecord rec;
+    DecodeError err;
+    (void)decodeCompactRecord(buf.subspan(r.offset, r.length), *index.plan, rec, nullptr,
+                              BorrowMode::Copy, Validation::Mandatory, err, true);
+    if (rec.fault) rec.fault.offset = r.offset;
+    return rec;
+}
+
+// Header outcome of a columnar decode (the records become rows of the batch).
+struct ColumnBlock {
+    uint8_t     cat{0};
+    uint16_t    length{0};
+    bool        valid{true};
+    std::string error; // stays empty: faults only
+    DecodeError fault;
+};
+
+struct ColumnRows {
+    ColumnBlock&   block;
+    ColumnarBatch& cols;
+
+    ColumnarBatch& acquire() {
+        cols.appendRow();
+        return cols;
+    }
+    void drop() { cols.popRow(); }
+    void finish() {}
+};
+
+DecodeError Codec::decodeColumns(std::span<const uint8_t> buf, ColumnarBatch& cols) const {
+    ColumnBlock block;
+    const CategoryPlan* plan = nullptr;
+    auto payload = readBlockHeader(buf, registry_, rejected_.get(), block, plan, false);
+    if (!plan) return block.fault;
+    if (plan != &cols.plan()) {
+        DecodeError err{DecodeErrc::UnknownCategory};
+        err.value = block.cat;
+        return err;
+    }
+
+    ColumnRows store{block, cols};
+    decodeRecords(payload, *plan, false, store,
+                  [&](std::span<const uint8_t> rec_buf, ColumnarBatch&, DecodeError& err) {
+        ColumnRecordSink sink{{&cols}};
+        return detail::walkRecord(*plan, rec_buf, sink, err);
+    });
+    return block.fault;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Item-level encode helpers
 // ─────────────────────────────────────────────────────────────────────────────
@@ -448,10 +772,7 @@ static void encodeFixedElements(const std::vector<ElementDef>& elems,
     }
 }
 
-std::vector<uint8_t> Codec::encodeItem(const DataItemDef& def,
-                                         const DecodedItem& val) const {
-    BitWriter bw;
-
+void Codec::encodeItem(const DataItemDef& def, const DecodedItem& val, BitWriter& bw) const {
     switch (def.type) {
 
     case ItemType::Fixed: {
@@ -545,9 +866,11 @@ std::vector<uint8_t> Codec::encodeItem(const DataItemDef& def,
 
     case ItemType::SP: {
         // length byte (includes itself) + payload
-        uint8_t len = static_cast<uint8_t>(val.raw_bytes.size() + 1);
+        const std::span<const uint8_t> payload =
+            val.payload.empty() ? std::span<const uint8_t>(val.raw_bytes) : val.payload;
+        uint8_t len = static_cast<uint8_t>(payload.size() + 1);
         bw.writeByte(len);
-        bw.writeBytes(val.raw_bytes);
+        bw.writeBytes(payload);
         break;
     }
 
@@ -563,20 +886,18 @@ std::vector<uint8_t> Codec::encodeItem(const DataItemDef& def,
 
         // Always emit at least one PSF byte (even if nothing is present)
         size_t last_psf_byte = (last_slot >= 0) ? (static_cast<size_t>(last_slot) / 7) : 0;
-        std::vector<uint8_t> psf_bytes(last_psf_byte + 1, 0);
 
-        for (size_t i = 0; i < subs.size(); ++i) {
-            if (subs[i].name == "-") continue;
-            if (!val.compound_sub_fields.count(subs[i].name)) continue;
-            size_t pb  = i / 7;
-            size_t bit = 7 - (i % 7);
-            psf_bytes[pb] |= static_cast<uint8_t>(1u << bit);
+        for (size_t pb = 0; pb <= last_psf_byte; ++pb) {
+            uint8_t psf = 0;
+            for (size_t i = pb * 7; i < (pb + 1) * 7 && i < subs.size(); ++i) {
+                if (subs[i].name == "-") continue;
+                if (!val.compound_sub_fields.count(subs[i].name)) continue;
+                psf |= static_cast<uint8_t>(1u << (7 - (i % 7)));
+            }
+            // FX bit for all PSF bytes except the last
+            if (pb != last_psf_byte) psf |= 0x01u;
+            bw.writeByte(psf);
         }
-        // FX bit for all PSF bytes except the last
-        for (size_t i = 0; i + 1 < psf_bytes.size(); ++i)
-            psf_bytes[i] |= 0x01u;
-
-        bw.writeBytes(psf_bytes);
 
         // Write each present sub-item's fields in PSF slot order
         for (const auto& si : subs) {
@@ -598,106 +919,127 @@ std::vector<uint8_t> Codec::encodeItem(const DataItemDef& def,
     default:
         throw std::runtime_error("encodeItem: unsupported item type for " + def.id);
     }
-
-    return bw.take();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Record-level encode
 // ─────────────────────────────────────────────────────────────────────────────
+// Records are written in place: room for the longest possible FSPEC is
+// reserved, items follow in UAP order, then the FSPEC is patched and any
+// unused FSPEC bytes are squeezed out.
 
-std::vector<uint8_t> Codec::encodeRecord(const DecodedRecord& rec,
-                                           const CategoryDef& cat) const {
+void Codec::encodeRecord(const DecodedRecord& rec, const CategoryPlan& plan,
+                         BitWriter& bw) const {
     // Select UAP
-    std::string var = rec.uap_variation.empty() ? cat.default_variation : rec.uap_variation;
-    auto uap_it = cat.uap_variations.find(var);
-    if (uap_it == cat.uap_variations.end())
-        throw std::runtime_error("encodeRecord: unknown UAP variation '" + var + "'");
-    const auto& uap = uap_it->second;
-
-    // ── Build FSPEC ──────────────────────────────────────────────────────────
-    // Determine which UAP slots are present.
-    std::vector<bool> present(uap.size(), false);
-    for (size_t i = 0; i < uap.size(); ++i) {
-        const std::string& id = uap[i];
-        if (id == "-" || id == "rfs") continue;
-        if (rec.items.count(id)) present[i] = true;
-    }
-
-    // Build FSPEC bytes: groups of 7 bits, each followed by FX bit.
-    // Trim trailing empty octets (no need to send FSPEC bytes where all slots=0).
-    size_t total_slots = uap.size();
-    size_t n_fspec_octets = (total_slots + 6) / 7;
-    // Find the last octet with at least one present item
-    size_t last_fspec = 0;
-    for (size_t i = 0; i < n_fspec_octets; ++i) {
-        for (size_t s = i * 7; s < (i + 1) * 7 && s < total_slots; ++s) {
-            if (present[s]) last_fspec = i;
-        }
+    uint16_t var = plan.default_variation;
+    if (!rec.uap_variation.empty()) {
+        var = static_cast<uint16_t>(plan.variations.size());
+        for (size_t v = 0; v < plan.variations.size(); ++v)
+            if (*plan.variations[v].name == rec.uap_variation) var = static_cast<uint16_t>(v);
+        if (var == plan.variations.size())
+            throw std::runtime_error("encodeRecord: unknown UAP variation '" +
+                                     rec.uap_variation + "'");
     }
+    const PlanVariation& uap = plan.variations[var];
 
-    std::vector<uint8_t> fspec_bytes;
-    for (size_t i = 0; i <= last_fspec; ++i) {
-        uint8_t b = 0;
-        for (size_t s = i * 7; s < (i + 1) * 7 && s < total_slots; ++s) {
-            size_t bit_pos = 7 - (s % 7); // bit 7 = slot 1, bit 6 = slot 2, …
-            if (present[s]) b |= (1u << bit_pos);
-        }
-        bool is_last = (i == last_fspec);
-        if (!is_last) b |= 0x01u; // FX = 1 (more FSPEC bytes follow)
-        fspec_bytes.push_back(b);
-    }
+    // ── Reserve FSPEC ────────────────────────────────────────────────────────
+    // Groups of 7 slots, each followed by an FX bit.
+    const size_t fspec_at  = bw.bytesWritten();
+    const size_t max_fspec = std::max<size_t>((uap.slots.size() + 6) / 7, 1);
+    for (size_t i = 0; i < max_fspec; ++i) bw.writeByte(0);
 
     // ── Encode items in UAP order ────────────────────────────────────────────
-    std::vector<uint8_t> payload;
-    for (const auto& id : uap) {
-        if (id == "-" || id == "rfs") continue;
+    size_t last_fspec = 0; // last FSPEC octet with at least one present item
+    for (size_t slot = 0; slot < uap.slots.size(); ++slot) {
+        const ItemIndex idx = uap.slots[slot];
+        if (idx == kNoItem) continue;
+
+        const std::string& id = idx == kUnknownItem ? (*uap.refs)[slot] : plan.items[idx].def->id;
         auto it = rec.items.find(id);
         if (it == rec.items.end()) continue;
-
-        auto def_it = cat.items.find(id);
-        if (def_it == cat.items.end())
+        if (idx == kUnknownItem)
             throw std::runtime_error("encodeRecord: item def not found for " + id);
 
-        auto item_bytes = encodeItem(def_it->second, it->second);
-        payload.insert(payload.end(), item_bytes.begin(), item_bytes.end());
+        const DecodedItem& val = it->second;
+        if (val.wire.empty()) {
+            encodeItem(*plan.items[idx].def, val, bw);
+        } else { // passthrough, as long as it is exactly one item
+            DecodeError err;
+            if (detail::measureItem(plan, plan.items[idx], val.wire, err) != val.wire.size())
+                throw std::runtime_error("encodeRecord: wire bytes of " + id + " are not one item");
+            bw.writeBytes(val.wire);
+        }
+
+        const size_t octet = slot / 7;
+        const auto   fspec = bw.bytes()[fspec_at + octet];
+        bw.patchByte(fspec_at + octet,
+                     static_cast<uint8_t>(fspec | (1u << (7 - slot % 7)))); // bit 7 = slot 1, …
+        last_fspec = octet;
     }
 
-    // Concatenate FSPEC + items
-    std::vector<uint8_t> record_bytes;
-    record_bytes.insert(record_bytes.end(), fspec_bytes.begin(), fspec_bytes.end());
-    record_bytes.insert(record_bytes.end(), payload.begin(), payload.end());
-    return record_bytes;
+    // ── Patch FSPEC ──────────────────────────────────────────────────────────
+    // Trim trailing empty octets; FX = 1 on every octet but the last.
+    for (size_t i = 0; i < last_fspec; ++i)
+        bw.patchByte(fspec_at + i, static_cast<uint8_t>(bw.bytes()[fspec_at + i] | 0x01u));
+    if (last_fspec + 1 < max_fspec)
+        bw.eraseBytes(fspec_at + last_fspec + 1, max_fspec - last_fspec - 1);
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 //  Public encode
 // ─────────────────────────────────────────────────────────────────────────────
 
+// Write one Data Block (header, then records) into bw; LEN is patched last.
+void Codec::encodeBlock(uint8_t cat_num, const std::vector<DecodedRecord>& records,
+                        BitWriter& bw) const {
+    const CategoryPlan* found = registry_.find(cat_num);
+    if (!found)
+        throw std::runtime_error("encode: Category " + std::to_string(cat_num) + " not registered");
+    const CategoryPlan& plan = *found;
+
+    const size_t start = bw.bytesWritten();
+    bw.writeByte(cat_num);
+    bw.writeByte(0); // LEN, patched below
+    bw.writeByte(0);
+
+    for (const auto& rec : records)
+        encodeRecord(rec, plan, bw);
+
+    // Total block length = 3 (header) + records
+    const size_t total_len = bw.bytesWritten() - start;
+    if (total_len > 0xFFFFu)
+        throw std::runtime_error("encode: Data Block length " + std::to_string(total_len) +
+                                 " exceeds 65535 bytes");
+    bw.patchByte(start + 1, static_cast<uint8_t>(total_len >> 8));
+    bw.patchByte(start + 2, static_cast<uint8_t>(total_len & 0xFFu));
+}
+
 std::vector<uint8_t> Codec::encode(uint8_t cat_num,
                                     const std::vector<DecodedRecord>& records) const {
-    auto cat_it = cats_.find(cat_num);
-    if (cat_it == cats_.end())
-        throw std::runtime_error("encode: Category " + std::to_string(cat_num) + " not registered");
-    const CategoryDef& cat = cat_it->second;
+    std::vector<uint8_t> block;
+    encodeAppend(cat_num, records, block);
+    return block;
+}
 
-    // Encode all records
-    std::vector<uint8_t> records_bytes;
-    for (const auto& rec : records) {
-        auto rb = encodeRecord(rec, cat);
-        records_bytes.insert(records_bytes.end(), rb.begin(), rb.end());
+void Codec::encodeAppend(uint8_t cat_num, const std::vector<DecodedRecord>& records,
+                         std::vector<uint8_t>& out) const {
+    const size_t keep = out.size();
+    BitWriter bw{std::move(out)};
+    try {
+        encodeBlock(cat_num, records, bw);
+    } catch (...) {
+        out = bw.take();
+        out.resize(keep);
+        throw;
     }
+    out = bw.take();
+}
 
-    // Compute total block length = 3 (header) + records
-    uint16_t total_len = static_cast<uint16_t>(3 + records_bytes.size());
-
-    std::vector<uint8_t> block;
-    block.reserve(total_len);
-    block.push_back(cat_num);
-    block.push_back(static_cast<uint8_t>(total_len >> 8));
-    block.push_back(static_cast<uint8_t>(total_len & 0xFFu));
-    block.insert(block.end(), records_bytes.begin(), records_bytes.end());
-    return block;
+size_t Codec::encodeInto(uint8_t cat_num, const std::vector<DecodedRecord>& records,
+                         std::span<uint8_t> out) const {
+    BitWriter bw{out};
+    encodeBlock(cat_num, records, bw);
+    return bw.bytesWritten();
 }
 
 } // namespace asterix
@@ -0,0 +1,85 @@
+// Columnar.cpp – Column layout of a ColumnarBatch (decoding is in Codec.cpp).
+
+#include "ASTERIXCodec/Columnar.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+ColumnarBatch::ColumnarBatch(const CategoryPlan& plan, std::span<const FieldId> fields)
+    : plan_(&plan), column_of_(plan.fields.size(), npos) {
+    for (FieldId id : fields) {
+        if (id >= plan.fields.size())
+            throw std::runtime_error("ColumnarBatch for category " + std::to_string(plan.def.cat) +
+                                     ": unknown field #" + std::to_string(id));
+        addColumn(id);
+    }
+}
+
+ColumnarBatch::ColumnarBatch(const CategoryPlan& plan, const std::vector<ItemSelection>& items)
+    : ColumnarBatch(plan, resolveSelection(plan, items)) {}
+
+void ColumnarBatch::addColumn(FieldId id) {
+    if (column_of_[id] != npos) return; // listed twice
+    const FieldInfo& fi = plan_->def.fields[id];
+    const PlanField& pf = plan_->fields[id];
+
+    Column col;
+    col.field = id;
+    col.name  = fi.item_id + '.' + (fi.sub_item.empty() ? "" : fi.sub_item + '.') + fi.name;
+    col.bits  = plan_->elements[pf.element].bits;
+
+    column_of_[id]  = columns_.size();
+    items_[pf.item] = true;
+    columns_.push_back(std::move(col));
+}
+
+void ColumnarBatch::clear() noexcept {
+    for (auto& col : columns_) {
+        col.values.clear();
+        col.validity.clear();
+        col.null_count = 0;
+    }
+    rows_ = 0;
+}
+
+void ColumnarBatch::reserve(size_t rows) {
+    for (auto& col : columns_) {
+        col.values.reserve(rows);
+        col.validity.reserve((rows + 7) / 8);
+    }
+}
+
+void ColumnarBatch::appendRow() {
+    const bool new_byte = rows_ % 8 == 0;
+    for (auto& col : columns_) {
+        col.values.push_back(0);
+        if (new_byte) col.validity.push_back(0);
+        ++col.null_count;
+    }
+    ++rows_;
+}
+
+void ColumnarBatch::appendRows(size_t n) {
+    rows_ += n;
+    for (auto& col : columns_) {
+        col.values.resize(rows_, 0);
+        col.validity.resize((rows_ + 7) / 8, 0);
+        col.null_count += n;
+    }
+}
+
+void ColumnarBatch::popRow() noexcept {
+    if (rows_ == 0) return;
+    --rows_;
+    const bool last_in_byte = rows_ % 8 == 0;
+    for (auto& col : columns_) {
+        if (col.valid(rows_)) col.validity[rows_ / 8] &= static_cast<uint8_t>(~(1u << (rows_ % 8)));
+        else                  --col.null_count;
+        col.values.pop_back();
+        if (last_in_byte) col.validity.pop_back();
+    }
+}
+
+} // namespace asterix
@@ -0,0 +1,64 @@
+// Convert.cpp – Compilation and batch loops of FieldConverter.
+
+#include "ASTERIXCodec/Convert.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+FieldConverter::FieldConverter(const ElementDef& e)
+    : encoding_(e.encoding), bits_(e.bits), scale_(e.scale), unit_(e.unit) {
+    if (e.encoding != Encoding::Table) return;
+    if (e.bits <= kDenseTableBits) {
+        dense_.resize(size_t{1} << e.bits);
+        for (const auto& [raw, text] : e.table)
+            if (raw < dense_.size()) dense_[raw] = text;
+    } else {
+        table_ = &e.table;
+    }
+}
+
+static void checkSize(size_t raw, size_t out) {
+    if (out < raw)
+        throw std::invalid_argument("FieldConverter: output holds " + std::to_string(out) +
+                                    " values, need " + std::to_string(raw));
+}
+
+// One loop per encoding, so the per-value work has no branch to vectorise around.
+void FieldConverter::toPhysical(std::span<const uint64_t> raw, std::span<double> out) const {
+    checkSize(raw.size(), out.size());
+    const size_t n = raw.size();
+    if (encoding_ == Encoding::SignedQuantity && bits_ > 0 && bits_ < 64) {
+        const unsigned shift = 64u - bits_;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<double>(static_cast<int64_t>(raw[i] << shift) >> shift) * scale_;
+    } else if (encoding_ == Encoding::SignedQuantity || encoding_ == Encoding::UnsignedQuantity) {
+        const bool is_signed = encoding_ == Encoding::SignedQuantity; // 64-bit signed
+        for (size_t i = 0; i < n; ++i)
+            out[i] = (is_signed ? static_cast<double>(static_cast<int64_t>(raw[i]))
+                                : static_cast<double>(raw[i])) * scale_;
+    } else {
+        for (size_t i = 0; i < n; ++i) out[i] = static_cast<double>(raw[i]);
+    }
+}
+
+void FieldConverter::toOctal(std::span<const uint64_t> raw, std::span<uint32_t> out) const {
+    checkSize(raw.size(), out.size());
+    if (bits_ == 12) { // Mode-1/2/3/A codes: four digits, unrolled
+        for (size_t i = 0; i < raw.size(); ++i) {
+            const uint64_t v = raw[i];
+            out[i] = static_cast<uint32_t>(((v >> 9) & 7u) * 1000 + ((v >> 6) & 7u) * 100 +
+                                           ((v >> 3) & 7u) * 10 + (v & 7u));
+        }
+        return;
+    }
+    for (size_t i = 0; i < raw.size(); ++i) out[i] = octal(raw[i], bits_);
+}
+
+CategoryConverters::CategoryConverters(const CategoryPlan& plan) {
+    fields_.reserve(plan.fields.size());
+    for (const PlanField& pf : plan.fields) fields_.emplace_back(*plan.elements[pf.element].def);
+}
+
+} // namespace asterix
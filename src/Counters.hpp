@@ -0,0 +1,86 @@
+#pragma once
+// Counters.hpp – Sharded counters behind Codec::metrics() (internal).
+//
+// A CategoryCounters is a flat array of relaxed atomics, one copy (shard) per
+// kCounterShards, each shard starting on its own cache line.  A thread always
+// adds to the shard it was assigned on first use; a snapshot sums all shards.
+// Only compiled into the decode paths when kMetricsEnabled.
+
+#include "ASTERIXCodec/Metrics.hpp"
+#include "ASTERIXCodec/Plan.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace asterix::detail {
+
+inline constexpr size_t kCounterShards = 16;
+
+class CategoryCounters {
+public:
+    // Word layout of one shard.
+    static constexpr size_t kBlocks     = 0;
+    static constexpr size_t kRecords    = 1;
+    static constexpr size_t kBytes      = 2;
+    static constexpr size_t kLatencySum = 3;
+    static constexpr size_t kFaults     = 4;
+    static constexpr size_t kBuckets    = kFaults + kDecodeErrcCount;
+    static constexpr size_t kItems      = kBuckets + LatencyHistogram::kBuckets;
+
+    explicit CategoryCounters(size_t n_items)
+        : n_items_(n_items),
+          lines_per_shard_((kItems + n_items + kWordsPerLine - 1) / kWordsPerLine),
+          lines_(new Line[kCounterShards * lines_per_shard_]) {}
+
+    void add(size_t word, uint64_t n = 1) noexcept {
+        cell(shard(), word).fetch_add(n, std::memory_order_relaxed);
+    }
+    void item(ItemIndex idx) noexcept { add(kItems + idx); }
+    void fault(DecodeErrc code) noexcept { add(kFaults + static_cast<size_t>(code)); }
+    void latency(uint64_t ns) noexcept {
+        const size_t s = shard();
+        cell(s, kLatencySum).fetch_add(ns, std::memory_order_relaxed);
+        cell(s, kBuckets + LatencyHistogram::bucket(ns)).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t items() const noexcept { return n_items_; }
+
+    // Sum of word over all shards.
+    [[nodiscard]] uint64_t total(size_t word) const noexcept {
+        uint64_t n = 0;
+        for (size_t s = 0; s < kCounterShards; ++s)
+            n += cell(s, word).load(std::memory_order_relaxed);
+        return n;
+    }
+
+    void reset() noexcept {
+        for (size_t s = 0; s < kCounterShards; ++s)
+            for (size_t w = 0; w < kItems + n_items_; ++w)
+                cell(s, w).store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t kWordsPerLine = 8;
+    struct alignas(64) Line {
+        std::atomic<uint64_t> words[kWordsPerLine]{};
+    };
+
+    // Shard of the calling thread, assigned round-robin on first use.
+    static size_t shard() noexcept {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t mine = next.fetch_add(1, std::memory_order_relaxed) % kCounterShards;
+        return mine;
+    }
+
+    std::atomic<uint64_t>& cell(size_t s, size_t word) const noexcept {
+        return lines_[s * lines_per_shard_ + word / kWordsPerLine].words[word % kWordsPerLine];
+    }
+
+    size_t                  n_items_;
+    size_t                  lines_per_shard_;
+    std::unique_ptr<Line[]> lines_;
+};
+
+} // namespace asterix::detail
@@ -0,0 +1,109 @@
+// DecodeError.cpp – Reason phrases and on-demand messages for DecodeError.
+
+#include "ASTERIXCodec/DecodeError.hpp"
+#include "ASTERIXCodec/Plan.hpp"
+
+namespace asterix {
+
+const char* toString(DecodeErrc code) noexcept {
+    switch (code) {
+    case DecodeErrc::None:                return "no error";
+    case DecodeErrc::ShortHeader:         return "buffer too short for Data Block header";
+    case DecodeErrc::BadBlockLength:      return "invalid Data Block LEN";
+    case DecodeErrc::UnknownCategory:     return "category not registered";
+    case DecodeErrc::StaleProjection:     return "projection compiled against a replaced plan";
+    case DecodeErrc::UnknownItem:         return "FSPEC references unknown item";
+    case DecodeErrc::NoProgress:          return "no bytes consumed decoding record";
+    case DecodeErrc::FixedTruncated:      return "buffer too short for Fixed";
+    case DecodeErrc::ExtendedTruncated:   return "unexpected end of buffer in Extended";
+    case DecodeErrc::RepetitiveTruncated: return "buffer too short in Repetitive";
+    case DecodeErrc::GroupCountTruncated: return "buffer too short for RepetitiveGroup";
+    case DecodeErrc::GroupTruncated:      return "buffer too short for RepetitiveGroup data";
+    case DecodeErrc::GroupFXTruncated:    return "buffer too short in RepetitiveGroupFX";
+    case DecodeErrc::ExplicitEmpty:       return "empty buffer for Explicit";
+    case DecodeErrc::ExplicitLength:      return "Explicit length out of range";
+    case DecodeErrc::PsfTruncated:        return "truncated Compound PSF";
+    case DecodeErrc::SubItemTruncated:    return "buffer too short for Compound sub-item";
+    case DecodeErrc::UnsupportedType:     return "unsupported item type";
+    case DecodeErrc::MandatoryMissing:    return "mandatory item not present";
+    case DecodeErrc::OutOfRange:          return "value out of range";
+    }
+    return "unknown error";
+}
+
+// Item ID (or "#index" without a plan); appended to out.
+static void appendItem(std::string& out, const DecodeError& err, const CategoryPlan* plan) {
+    if (plan && err.item < plan->items.size())
+        out += plan->items[err.item].def->id;
+    else
+        out.append("#").append(std::to_string(err.item));
+}
+
+void describeTo(std::string& out, const DecodeError& err, const CategoryPlan* plan) {
+    out.clear();
+    switch (err.code) {
+    case DecodeErrc::None:
+        return;
+    case DecodeErrc::ShortHeader:
+        out = "Buffer too short for Data Block header (need ≥3 bytes)";
+        return;
+    case DecodeErrc::BadBlockLength:
+        out.append("Data Block LEN field (").append(std::to_string(err.value)).append(") is invalid");
+        return;
+    case DecodeErrc::UnknownCategory:
+        out.append("Category ").append(std::to_string(err.value)).append(" not registered");
+        return;
+    case DecodeErrc::StaleProjection:
+        out.append("Projection for category ").append(std::to_string(err.value))
+           .append(" was compiled against a replaced plan");
+        return;
+    case DecodeErrc::NoProgress:
+        out = "Infinite loop guard: no bytes consumed decoding record";
+        return;
+    case DecodeErrc::MandatoryMissing:
+        out = "Mandatory item ";
+        appendItem(out, err, plan);
+        out += " not present";
+        return;
+    case DecodeErrc::OutOfRange:
+        out = "Item ";
+        appendItem(out, err, plan);
+        out += '/';
+        if (plan && err.sub < plan->def.fields.size())
+            out += plan->def.fields[err.sub].name;
+        else
+            out.append("#").append(std::to_string(err.sub));
+        out.append(" raw value ").append(std::to_string(err.value)).append(" out of range");
+        return;
+    case DecodeErrc::UnknownItem:
+        out = "Record decode error: FSPEC references unknown item: ";
+        if (plan && err.value < plan->variations.size() &&
+            err.sub < plan->variations[err.value].refs->size())
+            out += (*plan->variations[err.value].refs)[err.sub];
+        else
+            out.append("slot ").append(std::to_string(err.sub + 1));
+        return;
+    default:
+        out = "Record decode error: Item ";
+        appendItem(out, err, plan);
+        if (err.code == DecodeErrc::SubItemTruncated) {
+            out += '/';
+            const PlanItem* item =
+                plan && err.item < plan->items.size() ? &plan->items[err.item] : nullptr;
+            if (item && err.sub < item->sub_items.count)
+                out += plan->sub_items[item->sub_items.first + err.sub].def->name;
+            else
+                out.append("#").append(std::to_string(err.sub));
+        }
+        out.append(": ").append(toString(err.code));
+        return;
+    }
+}
+
+std::string describe(const DecodeError& err, const CategoryPlan* plan) {
+    std::string out;
+    describeTo(out, err, plan);
+    return out;
+}
+
+} // namespace asterix
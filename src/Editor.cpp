@@ -0,0 +1,191 @@
+// Editor.cpp – Field patching and item splicing on an encoded Data Block.
+
+#include "ASTERIXCodec/Editor.hpp"
+#include "ASTERIXCodec/BitStream.hpp"
+#include "Walker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+namespace {
+
+// Overwrite bits [off, off + bits) of p, MSB first, with the low bits of v.
+void patchBits(uint8_t* p, size_t off, size_t bits, uint64_t v) noexcept {
+    for (size_t i = 0; i < bits; ++i) {
+        const size_t  bit  = off + i;
+        const uint8_t mask = static_cast<uint8_t>(0x80u >> (bit % 8));
+        if ((v >> (bits - 1 - i)) & 1u) p[bit / 8] |= mask;
+        else                            p[bit / 8] &= static_cast<uint8_t>(~mask);
+    }
+}
+
+} // namespace
+
+DecodeError BlockEditor::load(std::span<const uint8_t> buf) {
+    codec_->view(buf, view_);
+    if (!view_.valid) {
+        const DecodeError fault = view_.fault;
+        view_.records.clear();
+        view_.spans.clear();
+        view_.bytes = {};
+        bytes_.clear();
+        return fault;
+    }
+    bytes_.assign(view_.bytes.begin(), view_.bytes.end());
+    view_.bytes = bytes_;
+    return {};
+}
+
+void BlockEditor::checkEditable(ItemIndex idx) const {
+    const CategoryPlan& plan = *view_.plan;
+    if (plan.uap_case && plan.uap_case->item == idx)
+        throw std::runtime_error("BlockEditor: I" + std::to_string(plan.def.cat) + "/" +
+                                 plan.items[idx].def->id + " selects the UAP and cannot be edited");
+}
+
+// ─── In place ─────────────────────────────────────────────────────────────────
+
+bool BlockEditor::set(size_t r, FieldId id, uint64_t value) {
+    const ViewRecord&   rec  = view_.records.at(r); // first: throws on an empty editor
+    const CategoryPlan& plan = *view_.plan;
+    const PlanField&    pf   = plan.fields.at(id);
+    const PlanItem&     item = plan.items[pf.item];
+    const PlanElement&  e    = plan.elements[pf.element];
+    checkEditable(pf.item);
+
+    // Bit position of the element from the first bit of the item
+    size_t bit_offset = 0;
+    if (item.type == ItemType::Fixed) {
+        bit_offset = e.bit_offset;
+    } else if (item.type == ItemType::Extended) {
+        size_t octet = 0;
+        while (octet < item.octets.count && plan.octets[item.octets.first + octet].end() <= pf.element)
+            ++octet;
+        bit_offset = octet * 8 + e.bit_offset;
+    } else {
+        throw std::runtime_error("BlockEditor: " + plan.def.fields[id].item_id + "/" +
+                                 plan.def.fields[id].name + " is not a Fixed or Extended field");
+    }
+
+    const ItemSpan s = view_.spans[rec.spans_first + pf.item];
+    if (s.length == 0 || bit_offset + e.bits > s.length * size_t{8}) return false;
+    patchBits(bytes_.data() + rec.offset + s.offset, bit_offset, e.bits, value);
+    return true;
+}
+
+size_t BlockEditor::set(FieldId id, uint64_t value) {
+    size_t patched = 0;
+    for (size_t r = 0; r < view_.records.size(); ++r) patched += set(r, id, value);
+    return patched;
+}
+
+// ─── Splicing ─────────────────────────────────────────────────────────────────
+
+void BlockEditor::put(size_t r, ItemIndex idx, std::span<const uint8_t> bytes) {
+    (void)view_.records.at(r);
+    const CategoryPlan& plan = *view_.plan;
+    if (idx >= plan.items.size()) throw std::runtime_error("BlockEditor: item index out of range");
+    DecodeError err;
+    if (bytes.empty() || detail::measureItem(plan, plan.items[idx], bytes, err) != bytes.size())
+        throw std::runtime_error("BlockEditor: bytes are not one I" + std::to_string(plan.def.cat) +
+                                 "/" + plan.items[idx].def->id + " item");
+    splice(r, idx, bytes);
+}
+
+void BlockEditor::put(size_t r, const DecodedItem& item) {
+    (void)view_.records.at(r);
+    const CategoryPlan& plan = *view_.plan;
+    const ItemIndex idx = plan.findItem(item.item_id);
+    if (idx == kNoItem)
+        throw std::runtime_error("BlockEditor: unknown item " + item.item_id);
+    if (!item.wire.empty()) {
+        put(r, idx, item.wire);
+        return;
+    }
+
+    encoded_.clear();
+    BitWriter bw{std::move(encoded_)};
+    codec_->encodeItem(*plan.items[idx].def, item, bw);
+    encoded_ = bw.take();
+    put(r, idx, encoded_);
+}
+
+bool BlockEditor::erase(size_t r, ItemIndex idx) {
+    const ViewRecord&   rec  = view_.records.at(r);
+    const CategoryPlan& plan = *view_.plan;
+    if (idx >= plan.items.size() || view_.spans[rec.spans_first + idx].length == 0)
+        return false;
+    if (plan.mandatory_mask.test(idx)) // the record would no longer be valid
+        throw std::runtime_error("BlockEditor: I" + std::to_string(plan.def.cat) + "/" +
+                                 plan.items[idx].def->id + " is mandatory and cannot be erased");
+    splice(r, idx, {});
+    return true;
+}
+
+void BlockEditor::splice(size_t r, ItemIndex idx, std::span<const uint8_t> bytes) {
+    ViewRecord&          rec  = view_.records.at(r);
+    const CategoryPlan&  plan = *view_.plan;
+    const PlanVariation& uap  = plan.variations[rec.variation];
+    checkEditable(idx);
+
+    const ItemSpan* old = view_.spans.data() + rec.spans_first;
+    const auto present = [&](ItemIndex i) { return i == idx ? !bytes.empty() : old[i].length != 0; };
+
+    size_t slot_of = uap.slots.size();
+    size_t last    = 0; // last present slot + 1
+    for (size_t slot = 0; slot < uap.slots.size(); ++slot) {
+        const ItemIndex i = uap.slots[slot];
+        if (i == idx) slot_of = slot;
+        if (i < plan.items.size() && present(i)) last = slot + 1;
+    }
+    if (slot_of == uap.slots.size())
+        throw std::runtime_error("BlockEditor: UAP " + *uap.name + " of category " +
+                                 std::to_string(plan.def.cat) + " has no slot for " +
+                                 plan.items[idx].def->id);
+
+    // ── Rebuild the record: FSPEC, then items in slot order ──────────────────
+    const size_t fspec_bytes = std::max<size_t>((last + 6) / 7, 1);
+    record_.assign(fspec_bytes, 0);
+    spans_.assign(plan.items.size(), ItemSpan{});
+    const uint8_t* rec_bytes = bytes_.data() + rec.offset;
+    for (size_t slot = 0; slot < last; ++slot) {
+        const ItemIndex i = uap.slots[slot];
+        if (i >= plan.items.size() || !present(i)) continue;
+        record_[slot / 7] |= static_cast<uint8_t>(0x80u >> (slot % 7));
+
+        const std::span<const uint8_t> src =
+            i == idx ? bytes : std::span<const uint8_t>(rec_bytes + old[i].offset, old[i].length);
+        spans_[i] = {static_cast<uint16_t>(record_.size()), static_cast<uint16_t>(src.size())};
+        record_.insert(record_.end(), src.begin(), src.end());
+    }
+    for (size_t b = 0; b + 1 < fspec_bytes; ++b) record_[b] |= 0x01u; // FX
+
+    // ── Swap it in, then fix up offsets and LEN ──────────────────────────────
+    const size_t new_len = bytes_.size() - rec.length + record_.size();
+    if (new_len > 0xFFFF) throw std::runtime_error("BlockEditor: Data Block would exceed 65535 bytes");
+
+    const auto at = bytes_.begin() + rec.offset;
+    if (record_.size() > rec.length) {
+        std::copy(record_.begin(), record_.begin() + rec.length, at);
+        bytes_.insert(at + rec.length, record_.begin() + rec.length, record_.end());
+    } else {
+        std::copy(record_.begin(), record_.end(), at);
+        bytes_.erase(at + static_cast<std::ptrdiff_t>(record_.size()), at + rec.length);
+    }
+
+    const auto delta = static_cast<int32_t>(record_.size()) - static_cast<int32_t>(rec.length);
+    rec.length = static_cast<uint16_t>(record_.size());
+    std::copy(spans_.begin(), spans_.end(), view_.spans.begin() + rec.spans_first);
+    for (size_t k = r + 1; k < view_.records.size(); ++k)
+        view_.records[k].offset = static_cast<uint32_t>(view_.records[k].offset + delta);
+
+    view_.length = static_cast<uint16_t>(new_len);
+    bytes_[1]    = static_cast<uint8_t>(new_len >> 8);
+    bytes_[2]    = static_cast<uint8_t>(new_len);
+    view_.bytes  = bytes_;
+}
+
+} // namespace asterix
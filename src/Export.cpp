@@ -0,0 +1,380 @@
+// Export.cpp – Token tables and the JSON / CSV emitters.
+
+#include "ASTERIXCodec/Export.hpp"
+#include "Walker.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace asterix {
+
+namespace {
+
+constexpr char kHex[] = "0123456789abcdef";
+
+void appendJsonEscaped(std::string& out, std::string_view s) {
+    for (char c : s) {
+        const auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20) {
+            out += "\\u00";
+            out += kHex[u >> 4];
+            out += kHex[u & 0xF];
+        } else {
+            out += c;
+        }
+    }
+}
+
+// "s": – an object key.
+std::string jsonKey(std::string_view s) {
+    std::string key = "\"";
+    appendJsonEscaped(key, s);
+    key += "\":";
+    return key;
+}
+
+// s as one CSV cell: quoted, quotes doubled, if it holds sep, a quote or a
+// line break.
+std::string csvCell(std::string_view s, char sep) {
+    if (s.find_first_of(std::string{sep, '"', '\n', '\r'}) == std::string_view::npos) return std::string(s);
+    std::string cell = "\"";
+    for (char c : s) {
+        if (c == '"') cell += '"';
+        cell += c;
+    }
+    cell += '"';
+    return cell;
+}
+
+template <class T>
+void appendNumber(std::string& out, T v) {
+    char buf[32];
+    const auto res = std::to_chars(buf, buf + sizeof buf, v);
+    out.append(buf, res.ptr);
+}
+
+} // namespace
+
+// ─── Item emitter ─────────────────────────────────────────────────────────────
+// Writes ,"id":<value> for one item: driven by walkItem() for a RecordView
+// (it is an item sink, see Walker.hpp) and by write() for a CompactRecord.
+struct RecordExporter::ItemWriter {
+    RecordExporter& x;
+    char close{0};           // '}' or ']' ending the item; 0 for a payload
+    bool in_sub{false};      // a Compound sub-item object is open
+    bool in_group{false};    // a group object is open
+    bool item_first{true};   // nothing written yet at item level
+    bool inner_first{true};  // nothing written yet in the open sub-item / group
+
+    ItemWriter(RecordExporter& exporter, ItemIndex idx) : x(exporter) {
+        x.out_ += ',';
+        x.out_ += x.item_key_[idx];
+        switch (x.plan_->items[idx].type) {
+        case ItemType::Repetitive:
+        case ItemType::RepetitiveGroup:
+        case ItemType::RepetitiveGroupFX: close = ']'; break;
+        case ItemType::Explicit:
+        case ItemType::SP:                close = 0; break;
+        default:                          close = '}';
+        }
+        if (close) x.out_ += close == ']' ? '[' : '{';
+    }
+
+    void separate() {
+        bool& first = in_sub || in_group ? inner_first : item_first;
+        if (!first) x.out_ += ',';
+        first = false;
+    }
+    void endInner() {
+        if (in_sub || in_group) x.out_ += '}';
+        in_sub = in_group = false;
+    }
+
+    // ── Item sink ────────────────────────────────────────────────────────────
+    void field(const PlanElement& e, uint64_t raw) { member(e.field, raw); }
+    void repetition(const PlanElement& e, uint64_t raw) { element(e.field, raw); }
+    void beginGroup() {
+        endInner();
+        separate();
+        x.out_ += '{';
+        in_group    = true;
+        inner_first = true;
+    }
+    void beginSubItem(const PlanSubItem& si) { subItem(static_cast<uint32_t>(&si - x.plan_->sub_items.data())); }
+    void payload(std::span<const uint8_t> bytes) {
+        x.out_ += '"';
+        for (uint8_t b : bytes) {
+            x.out_ += kHex[b >> 4];
+            x.out_ += kHex[b & 0xF];
+        }
+        x.out_ += '"';
+    }
+
+    // ── Compact path ─────────────────────────────────────────────────────────
+    void member(FieldId f, uint64_t raw) {
+        if (f >= x.selected_.size() || !x.selected_[f]) return;
+        separate();
+        x.out_ += x.field_key_[f];
+        x.value(f, raw);
+    }
+    void element(FieldId f, uint64_t raw) {
+        if (f >= x.selected_.size() || !x.selected_[f]) return;
+        separate();
+        x.value(f, raw);
+    }
+    void subItem(uint32_t s) {
+        endInner();
+        if (x.sub_key_[s].empty()) return; // none of its fields selected
+        separate();
+        x.out_ += x.sub_key_[s];
+        x.out_ += '{';
+        in_sub      = true;
+        inner_first = true;
+    }
+    void end() {
+        endInner();
+        if (close) x.out_ += close;
+    }
+};
+
+// First value of each CSV column in a walked item.
+struct RecordExporter::RowSink {
+    RecordExporter& x;
+
+    void set(FieldId f, uint64_t raw) {
+        const uint32_t c = f < x.column_of_.size() ? x.column_of_[f] : kNoColumn;
+        if (c == kNoColumn || x.row_set_[c]) return;
+        x.row_values_[c] = raw;
+        x.row_set_[c]    = 1;
+    }
+    void field(const PlanElement& e, uint64_t raw) { set(e.field, raw); }
+    void repetition(const PlanElement& e, uint64_t raw) { set(e.field, raw); }
+    void beginGroup() {}
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t>) {}
+};
+
+// ─── Construction ─────────────────────────────────────────────────────────────
+
+RecordExporter::RecordExporter(const CategoryPlan& plan, ExportOptions opts)
+    : plan_(&plan), opts_(std::move(opts)), conv_(plan), selected_(plan.fields.size(), 0),
+      column_of_(plan.fields.size(), kNoColumn) {
+    if (opts_.items.empty()) {
+        for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) items_[idx] = true;
+        for (FieldId id = 0; id < plan.fields.size(); ++id) columns_.push_back(id);
+    } else {
+        columns_ = resolveSelection(plan, opts_.items);
+        for (const auto& sel : opts_.items) items_[plan.findItem(sel.item)] = true;
+    }
+    for (uint32_t c = 0; c < columns_.size(); ++c) {
+        selected_[columns_[c]]  = 1;
+        column_of_[columns_[c]] = c;
+    }
+    build();
+}
+
+void RecordExporter::build() {
+    const CategoryPlan& plan = *plan_;
+
+    field_sub_.assign(plan.fields.size(), kNoSub);
+    sub_key_.assign(plan.sub_items.size(), std::string{});
+    for (uint32_t s = 0; s < plan.sub_items.size(); ++s) {
+        const PlanSubItem& si = plan.sub_items[s];
+        bool any = false;
+        for (uint32_t e = si.elements.first; e < si.elements.end(); ++e) {
+            const FieldId f = plan.elements[e].field;
+            if (plan.elements[e].is_spare || f == kNoField) continue;
+            field_sub_[f] = s;
+            any |= selected_[f] != 0;
+        }
+        if (any && si.def) sub_key_[s] = jsonKey(si.def->name);
+    }
+
+    record_open_ = "{\"cat\":" + std::to_string(plan.def.cat);
+    variation_.clear();
+    if (plan.variations.size() > 1)
+        for (const auto& v : plan.variations) {
+            std::string token = ",\"uap\":\"";
+            appendJsonEscaped(token, *v.name);
+            variation_.push_back(token + '"');
+        }
+    item_key_.clear();
+    for (const auto& item : plan.items) item_key_.push_back(jsonKey(item.def->id));
+    field_key_.clear();
+    for (const auto& fi : plan.def.fields) field_key_.push_back(jsonKey(fi.name));
+
+    column_name_.clear();
+    for (FieldId id : columns_) {
+        const FieldInfo& fi = plan.def.fields[id];
+        column_name_.push_back(csvCell(fi.item_id + '.' + (fi.sub_item.empty() ? "" : fi.sub_item + '.') + fi.name,
+                                       opts_.separator));
+    }
+    row_values_.assign(columns_.size(), 0);
+    row_set_.assign(columns_.size(), 0);
+}
+
+void RecordExporter::checkPlan(const CategoryPlan* plan) const {
+    if (plan != plan_)
+        throw std::runtime_error("RecordExporter: record not decoded with the " + catName(plan_->def.cat) +
+                                 " plan of this exporter");
+}
+
+// ─── Values ───────────────────────────────────────────────────────────────────
+
+void RecordExporter::value(FieldId id, uint64_t raw) {
+    if (opts_.physical) {
+        const FieldConverter& c = conv_[id];
+        switch (c.encoding()) {
+        case Encoding::UnsignedQuantity:
+        case Encoding::SignedQuantity:
+            appendNumber(out_, c.physical(raw));
+            return;
+        case Encoding::StringOctal: {
+            char digits[22];
+            const unsigned n = std::min<unsigned>((c.bits() + 2u) / 3u, sizeof digits);
+            for (unsigned i = n; i-- > 0; raw >>= 3) digits[i] = static_cast<char>('0' + (raw & 7u));
+            const bool quote = opts_.format == ExportFormat::Json;
+            if (quote) out_ += '"';
+            out_.append(digits, n);
+            if (quote) out_ += '"';
+            return;
+        }
+        default:
+            break;
+        }
+    }
+    appendNumber(out_, raw);
+}
+
+// ─── Records ──────────────────────────────────────────────────────────────────
+
+void RecordExporter::header() {
+    if (opts_.format != ExportFormat::Csv) return;
+    for (size_t c = 0; c < column_name_.size(); ++c) {
+        if (c) out_ += opts_.separator;
+        out_ += column_name_[c];
+    }
+    out_ += '\n';
+}
+
+void RecordExporter::csvRow() {
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        if (c) out_ += opts_.separator;
+        if (row_set_[c]) value(columns_[c], row_values_[c]);
+    }
+    out_ += '\n';
+}
+
+void RecordExporter::beginRecord(uint16_t variation, bool valid, std::string_view error) {
+    out_ += record_open_;
+    if (variation < variation_.size()) out_ += variation_[variation];
+    if (!valid) {
+        out_ += ",\"error\":\"";
+        appendJsonEscaped(out_, error);
+        out_ += '"';
+    }
+}
+
+void RecordExporter::write(const CompactRecord& rec) {
+    checkPlan(rec.plan);
+    const CategoryPlan& plan = *plan_;
+
+    if (opts_.format == ExportFormat::Csv) {
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            row_set_[c]    = rec.has(columns_[c]);
+            row_values_[c] = rec.values[columns_[c]];
+        }
+        csvRow();
+        return;
+    }
+
+    beginRecord(rec.variation, rec.valid, rec.error);
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        if (!items_[idx] || !rec.hasItem(idx)) continue;
+        const PlanItem&    pi = plan.items[idx];
+        const CompactItem& ci = rec.items[idx];
+        const PlanRange    r  = pi.fields;
+        ItemWriter w{*this, idx};
+        switch (pi.type) {
+        case ItemType::Repetitive:
+            for (size_t rep = 0; rep < ci.rep_count; ++rep)
+                for (FieldId f = static_cast<FieldId>(r.first); f < r.end(); ++f)
+                    w.element(f, rec.rep_values[ci.rep_first + rep * pi.columns + plan.fields[f].column]);
+            break;
+        case ItemType::RepetitiveGroup:
+        case ItemType::RepetitiveGroupFX:
+            for (size_t rep = 0; rep < ci.rep_count; ++rep) {
+                w.beginGroup();
+                for (FieldId f = static_cast<FieldId>(r.first); f < r.end(); ++f)
+                    w.member(f, rec.rep_values[ci.rep_first + rep * pi.columns + plan.fields[f].column]);
+            }
+            break;
+        case ItemType::Explicit:
+        case ItemType::SP:
+            w.payload(rec.item(idx).payload());
+            break;
+        case ItemType::Compound: {
+            uint32_t sub = kNoSub;
+            for (FieldId f = static_cast<FieldId>(r.first); f < r.end(); ++f) {
+                if (!rec.has(f)) continue;
+                if (field_sub_[f] != sub) w.subItem(sub = field_sub_[f]);
+                w.member(f, rec.values[f]);
+            }
+            break;
+        }
+        default:
+            for (FieldId f = static_cast<FieldId>(r.first); f < r.end(); ++f)
+                if (rec.has(f)) w.member(f, rec.values[f]);
+        }
+        w.end();
+    }
+    out_ += "}\n";
+}
+
+void RecordExporter::write(const RecordView& rec) {
+    checkPlan(&rec.plan());
+    const CategoryPlan& plan = *plan_;
+    size_t      consumed = 0;
+    DecodeError err;
+
+    if (opts_.format == ExportFormat::Csv) {
+        std::fill(row_set_.begin(), row_set_.end(), 0);
+        RowSink sink{*this};
+        for (ItemIndex idx = 0; idx < plan.items.size(); ++idx)
+            if (items_[idx] && rec.hasItem(idx))
+                (void)detail::walkItem(plan, plan.items[idx], rec.item(idx).bytes(), consumed, sink, err);
+        csvRow();
+        return;
+    }
+
+    beginRecord(rec.variation(), rec.valid(), rec.error());
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        if (!items_[idx] || !rec.hasItem(idx)) continue;
+        const PlanItem& pi = plan.items[idx];
+        ItemWriter w{*this, idx};
+        if (pi.type == ItemType::Explicit || pi.type == ItemType::SP)
+            w.payload(rec.item(idx).payload());
+        else
+            (void)detail::walkItem(plan, pi, rec.item(idx).bytes(), consumed, w, err); // lengths known good
+        w.end();
+    }
+    out_ += "}\n";
+}
+
+void RecordExporter::write(const CompactBlock& block) {
+    for (const auto& rec : block.records) write(rec);
+}
+
+void RecordExporter::write(const BlockView& block) {
+    if (block.records.empty()) return;
+    checkPlan(block.plan);
+    for (size_t r = 0; r < block.size(); ++r) write(block.record(r));
+}
+
+} // namespace asterix
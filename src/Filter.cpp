@@ -0,0 +1,190 @@
+// Filter.cpp – Compilation and byte-level evaluation of RecordFilter.
+
+#include "ASTERIXCodec/Filter.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+#include "Walker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+RecordFilter::RecordFilter(const CategoryPlan& plan)
+    : plan_(&plan), terms_(1), last_ref_(plan.variations.size(), 0) {
+    // The discriminator is always walked, so that the variation is known
+    // before any tested item is located.
+    if (plan.uap_case) (void)itemSlot(plan.items[plan.uap_case->item].def->id);
+}
+
+// Slot of item in items_, adding it (and extending the walk) if new.
+uint8_t RecordFilter::itemSlot(std::string_view item) {
+    const std::string where = "RecordFilter for category " + std::to_string(plan_->def.cat) + ": ";
+    const ItemIndex idx = plan_->findItem(item);
+    if (idx == kNoItem) throw std::runtime_error(where + "unknown item " + std::string(item));
+
+    for (size_t i = 0; i < items_.size(); ++i)
+        if (items_[i] == idx) return static_cast<uint8_t>(i);
+    if (items_.size() == kMaxFilterItems)
+        throw std::runtime_error(where + "more than " + std::to_string(kMaxFilterItems) + " items tested");
+
+    items_.push_back(idx);
+    for (size_t v = 0; v < plan_->variations.size(); ++v) {
+        const auto& slots = plan_->variations[v].slots;
+        for (size_t s = 0; s < slots.size(); ++s)
+            if (slots[s] == idx) last_ref_[v] = std::max(last_ref_[v], static_cast<uint16_t>(s + 1));
+    }
+    return static_cast<uint8_t>(items_.size() - 1);
+}
+
+RecordFilter::Clause RecordFilter::fieldClause(std::string_view item, std::string_view field, Op op) {
+    const std::string where = "RecordFilter for category " + std::to_string(plan_->def.cat) + ": ";
+    Clause c;
+    c.op   = op;
+    c.slot = itemSlot(item);
+
+    const PlanItem& pi = plan_->items[items_[c.slot]];
+    if (pi.type != ItemType::Fixed)
+        throw std::runtime_error(where + "item " + std::string(item) + " is not Fixed");
+    const FieldId id = findField(plan_->def, item, field);
+    if (id == kNoField)
+        throw std::runtime_error(where + "item " + std::string(item) + " has no field " + std::string(field));
+
+    const PlanElement& e = plan_->elements[plan_->fields[id].element];
+    c.bit_offset = e.bit_offset;
+    c.bits       = e.bits;
+    return c;
+}
+
+RecordFilter& RecordFilter::equals(std::string_view item, std::string_view field, uint64_t value) {
+    return between(item, field, value, value);
+}
+
+RecordFilter& RecordFilter::oneOf(std::string_view item, std::string_view field,
+                                  std::vector<uint64_t> values) {
+    Clause c = fieldClause(item, field, Op::OneOf);
+    std::sort(values.begin(), values.end());
+    c.values = std::move(values);
+    terms_.back().push_back(std::move(c));
+    return *this;
+}
+
+RecordFilter& RecordFilter::between(std::string_view item, std::string_view field, uint64_t lo,
+                                    uint64_t hi) {
+    Clause c = fieldClause(item, field, Op::Range);
+    c.lo = lo;
+    c.hi = hi;
+    terms_.back().push_back(std::move(c));
+    return *this;
+}
+
+RecordFilter& RecordFilter::present(std::string_view item) {
+    Clause c;
+    c.op   = Op::Present;
+    c.slot = itemSlot(item);
+    terms_.back().push_back(std::move(c));
+    return *this;
+}
+
+RecordFilter& RecordFilter::absent(std::string_view item) {
+    Clause c;
+    c.op   = Op::Absent;
+    c.slot = itemSlot(item);
+    terms_.back().push_back(std::move(c));
+    return *this;
+}
+
+RecordFilter& RecordFilter::orElse() {
+    if (!terms_.back().empty()) terms_.emplace_back();
+    return *this;
+}
+
+// ─── Evaluation ───────────────────────────────────────────────────────────────
+
+bool RecordFilter::matches(std::span<const uint8_t> record) const noexcept {
+    return match(record, nullptr);
+}
+
+bool RecordFilter::matches(std::span<const uint8_t> record, size_t& length) const noexcept {
+    length = 0;
+    return match(record, &length);
+}
+
+bool RecordFilter::match(std::span<const uint8_t> record, size_t* length) const noexcept {
+    if (empty()) return true;
+    if (record.empty()) return false;
+    const CategoryPlan& plan = *plan_;
+
+    // ── Locate the tested items (same slot order and UAP switch as walkRecord) ──
+    std::array<std::span<const uint8_t>, kMaxFilterItems> found{};
+    std::array<bool, kMaxFilterItems>                     seen{};
+
+    const detail::Fspec fspec = detail::readFspec(record);
+    uint16_t  variation     = plan.default_variation;
+    ItemIndex discriminator = kNoItem;
+    if (plan.uap_case) {
+        if (plan.uap_case->leading) discriminator = plan.uap_case->item;
+        else variation = detail::presetVariation(plan, record, fspec);
+    }
+    detail::SlotCursor cursor{plan.variations[variation], fspec};
+    size_t pos = fspec.bytes.size();
+
+    PlanSlot s;
+    bool     more = cursor.next(s);
+    for (; more && s.slot < last_ref_[variation]; more = cursor.next(s)) {
+        const ItemIndex idx = s.item;
+        if (idx == kUnknownItem) return false;
+
+        DecodeError err;
+        const size_t len = detail::measureItem(plan, plan.items[idx], record.subspan(pos), err);
+        if (len == 0) return false;
+        const auto item_bytes = record.subspan(pos, len);
+
+        const auto it = std::find(items_.begin(), items_.end(), idx);
+        if (it != items_.end()) {
+            const size_t k = static_cast<size_t>(it - items_.begin());
+            found[k] = item_bytes;
+            seen[k]  = true;
+        }
+        if (idx == discriminator) {
+            variation = detail::resolveVariation(plan, item_bytes);
+            cursor.switchTo(plan.variations[variation]);
+        }
+        pos += len;
+    }
+
+    // ── Evaluate the terms ─────────────────────────────────────────────────
+    for (const auto& term : terms_) {
+        if (term.empty()) continue; // a trailing orElse()
+        bool all = true;
+        for (const Clause& c : term) {
+            if (c.op == Op::Present) all = seen[c.slot];
+            else if (c.op == Op::Absent) all = !seen[c.slot];
+            else if (!seen[c.slot]) all = false;
+            else {
+                BitReader br{found[c.slot]}; // Fixed: measured at full length
+                br.skipUnchecked(c.bit_offset);
+                const uint64_t v = br.readUnchecked(c.bits);
+                all = c.op == Op::Range ? (v >= c.lo && v <= c.hi)
+                                        : std::binary_search(c.values.begin(), c.values.end(), v);
+            }
+            if (!all) break;
+        }
+        if (all) return true;
+    }
+
+    // ── Rejected: measure the rest of the record, from where the walk stopped ──
+    if (!length) return false;
+    for (; more; more = cursor.next(s)) {
+        if (s.item == kUnknownItem) return false;
+        DecodeError err;
+        const size_t len = detail::measureItem(plan, plan.items[s.item], record.subspan(pos), err);
+        if (len == 0) return false;
+        pos += len;
+    }
+    *length = pos;
+    return false;
+}
+
+} // namespace asterix
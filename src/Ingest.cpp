@@ -0,0 +1,384 @@
+// Ingest.cpp – recvmmsg() receiver, per-source routing and decode workers.
+
+#include "ASTERIXCodec/Ingest.hpp"
+#include "ASTERIXCodec/StreamDecoder.hpp"
+#include "Prometheus.hpp"
+#include "SpscRing.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+
+namespace asterix {
+
+namespace {
+
+constexpr int kPollMs = 20; // receiver wake-up to notice stop()
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error("UdpIngest: " + what + ": " + std::strerror(errno));
+}
+
+in_addr parseAddress(const std::string& text, const char* what) {
+    in_addr a{};
+    if (inet_pton(AF_INET, text.c_str(), &a) != 1)
+        throw std::runtime_error(std::string("UdpIngest: bad ") + what + " address '" + text + "'");
+    return a;
+}
+
+// One queued datagram; data points at its max_datagram buffer in the slab.
+struct Slot {
+    uint8_t*                              data{nullptr};
+    uint32_t                              length{0};
+    uint32_t                              source{0};
+    uint16_t                              port{0};
+    std::chrono::steady_clock::time_point received;
+};
+
+// Counters written by one thread, read by stats() from any other.
+struct Counter {
+    std::atomic<uint64_t> v{0};
+    void add(uint64_t n) noexcept { v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void max(uint64_t n) noexcept { if (n > v.load(std::memory_order_relaxed)) v.store(n, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t get() const noexcept { return v.load(std::memory_order_relaxed); }
+};
+
+struct Worker {
+    explicit Worker(size_t slots, size_t max_datagram) : ring(slots) {
+        slab.resize(ring.capacity() * max_datagram);
+        for (size_t i = 0; i < ring.capacity(); ++i) ring.slot(i).data = slab.data() + i * max_datagram;
+    }
+
+    detail::SpscRing<Slot> ring;
+    std::vector<uint8_t>   slab;
+    size_t                 pending{0}; // filled by the receiver, not yet published
+    std::thread            thread;
+
+    alignas(64) Counter datagrams, blocks, bytes_skipped, handler_errors, high_water;
+};
+
+} // namespace
+
+struct UdpIngest::Impl {
+    const Codec*  codec;
+    IngestOptions opts;
+    Handler       handler;
+    int           fd{-1};
+    uint16_t      port{0};
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::thread       receiver;
+    std::atomic<bool> running{false};
+    bool              started{false};
+
+    // Receive slab: batch × max_datagram, with one header / iovec / address /
+    // control buffer per datagram.
+    std::vector<uint8_t>     slab;
+    std::vector<mmsghdr>     msgs;
+    std::vector<iovec>       iovs;
+    std::vector<sockaddr_in> names;
+    std::vector<uint8_t>     control;
+    size_t                   control_len{CMSG_SPACE(sizeof(uint32_t))};
+
+    Counter datagrams, bytes, batches, truncated, ring_drops, kernel_drops;
+
+    ~Impl() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    void open();
+    void receive();
+    void route(const mmsghdr& m, std::span<const uint8_t> bytes, std::chrono::steady_clock::time_point now);
+    void work(unsigned index);
+};
+
+void UdpIngest::Impl::open() {
+    fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) fail("socket");
+
+    const int on = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on) != 0) fail("SO_REUSEADDR");
+    if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof on) != 0) fail("SO_RXQ_OVFL");
+    if (opts.socket_buffer > 0 &&
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &opts.socket_buffer, sizeof opts.socket_buffer) != 0)
+        fail("SO_RCVBUF");
+
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(opts.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (!opts.bind_address.empty()) addr.sin_addr = parseAddress(opts.bind_address, "bind");
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0) fail("bind");
+
+    socklen_t len = sizeof addr;
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) fail("getsockname");
+    port = ntohs(addr.sin_port);
+
+    for (const auto& group : opts.groups) {
+        ip_mreq req{};
+        req.imr_multiaddr        = parseAddress(group, "group");
+        req.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (!opts.interface.empty()) req.imr_interface = parseAddress(opts.interface, "interface");
+        if (::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &req, sizeof req) != 0)
+            fail("joining " + group);
+    }
+}
+
+// ─── Receiver ─────────────────────────────────────────────────────────────────
+
+void UdpIngest::Impl::receive() {
+    const size_t batch = msgs.size();
+    while (running.load(std::memory_order_relaxed)) {
+        pollfd p{fd, POLLIN, 0};
+        if (::poll(&p, 1, kPollMs) <= 0) continue;
+
+        for (size_t i = 0; i < batch; ++i) {
+            msghdr& h        = msgs[i].msg_hdr;
+            h.msg_namelen    = sizeof(sockaddr_in);
+            h.msg_controllen = control_len;
+            h.msg_flags      = 0;
+        }
+        const int n = ::recvmmsg(fd, msgs.data(), static_cast<unsigned>(batch), MSG_DONTWAIT, nullptr);
+        if (n <= 0) continue; // EAGAIN / EINTR
+        const auto now = std::chrono::steady_clock::now();
+        batches.add(1);
+
+        for (int i = 0; i < n; ++i) {
+            const mmsghdr& m = msgs[i];
+            for (cmsghdr* c = CMSG_FIRSTHDR(&m.msg_hdr); c; c = CMSG_NXTHDR(const_cast<msghdr*>(&m.msg_hdr), c))
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t dropped = 0; // running total for the socket
+                    std::memcpy(&dropped, CMSG_DATA(c), sizeof dropped);
+                    kernel_drops.max(dropped);
+                }
+            if (m.msg_hdr.msg_flags & MSG_TRUNC) {
+                truncated.add(1);
+                continue;
+            }
+            route(m, {static_cast<const uint8_t*>(iovs[i].iov_base), m.msg_len}, now);
+        }
+        for (auto& w : workers)
+            if (w->pending != 0) {
+                w->ring.publish(w->pending);
+                w->pending = 0;
+            }
+    }
+}
+
+void UdpIngest::Impl::route(const mmsghdr& m, std::span<const uint8_t> bytes,
+                            std::chrono::steady_clock::time_point now) {
+    const auto*    from   = static_cast<const sockaddr_in*>(m.msg_hdr.msg_name);
+    const uint32_t source = ntohl(from->sin_addr.s_addr);
+    const uint16_t sport  = ntohs(from->sin_port);
+    // Same source → same worker, so each feed stays in order
+    const uint64_t h = (uint64_t{source} << 16 | sport) * 0x9E3779B97F4A7C15ull;
+    Worker& w = *workers[(h >> 32) % workers.size()];
+
+    while (w.ring.writable() <= w.pending) {
+        if (opts.drop_when_full) {
+            ring_drops.add(1);
+            return;
+        }
+        if (w.pending != 0) { // let the worker see what is already queued
+            w.ring.publish(w.pending);
+            w.pending = 0;
+        }
+        if (!running.load(std::memory_order_relaxed)) return;
+        std::this_thread::yield();
+    }
+
+    Slot& s    = w.ring.slot(w.pending++);
+    s.length   = static_cast<uint32_t>(bytes.size());
+    s.source   = source;
+    s.port     = sport;
+    s.received = now;
+    std::memcpy(s.data, bytes.data(), bytes.size());
+    datagrams.add(1);
+    this->bytes.add(bytes.size());
+}
+
+// ─── Workers ──────────────────────────────────────────────────────────────────
+
+void UdpIngest::Impl::work(unsigned index) {
+    Worker&       w = *workers[index];
+    StreamDecoder stream{*codec};
+    DecodeContext ctx;
+    BlockView     view;
+    const Projection* proj = opts.projection;
+    uint64_t skipped = 0;
+
+    for (;;) {
+        const uint32_t seq = w.ring.sequence();
+        const size_t   n   = w.ring.readable();
+        if (n == 0) {
+            if (w.ring.closed()) break;
+            w.ring.wait(seq);
+            continue;
+        }
+        w.high_water.max(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const Slot& s = w.ring.front(i);
+            IngestedBlock b;
+            b.worker   = index;
+            b.source   = s.source;
+            b.port     = s.port;
+            b.received = s.received;
+            stream.feed({s.data, s.length}, [&](std::span<const uint8_t> block) {
+                b.bytes = block;
+                switch (opts.decode) {
+                case IngestDecode::Raw:     break;
+                case IngestDecode::View:    codec->view(block, view); b.view = &view; break;
+                case IngestDecode::Decoded:
+                    b.decoded = proj ? &codec->decodeInto(block, ctx, *proj) : &codec->decodeInto(block, ctx);
+                    break;
+                case IngestDecode::Compact:
+                    b.compact = proj ? &codec->decodeCompactInto(block, ctx, *proj)
+                                     : &codec->decodeCompactInto(block, ctx);
+                    break;
+                }
+                try {
+                    handler(b);
+                } catch (...) {
+                    w.handler_errors.add(1);
+                }
+                w.blocks.add(1);
+            });
+            (void)stream.finish(); // a datagram carries whole blocks
+        }
+        w.ring.release(n);
+        w.datagrams.add(n);
+        w.bytes_skipped.add(stream.stats().bytes_skipped - skipped);
+        skipped = stream.stats().bytes_skipped;
+    }
+}
+
+// ─── Public surface ───────────────────────────────────────────────────────────
+
+UdpIngest::UdpIngest(const Codec& codec, IngestOptions opts, Handler handler)
+    : impl_(std::make_unique<Impl>()) {
+    Impl& im   = *impl_;
+    im.codec   = &codec;
+    im.opts    = std::move(opts);
+    im.handler = std::move(handler);
+    if (im.opts.workers == 0 || im.opts.batch == 0 || im.opts.max_datagram == 0)
+        throw std::runtime_error("UdpIngest: workers, batch and max_datagram must be non-zero");
+    im.open();
+
+    for (unsigned i = 0; i < im.opts.workers; ++i)
+        im.workers.push_back(std::make_unique<Worker>(im.opts.ring_slots, im.opts.max_datagram));
+
+    const size_t batch = im.opts.batch;
+    im.slab.resize(batch * im.opts.max_datagram);
+    im.msgs.resize(batch);
+    im.iovs.resize(batch);
+    im.names.resize(batch);
+    im.control.resize(batch * im.control_len);
+    for (size_t i = 0; i < batch; ++i) {
+        im.iovs[i] = {im.slab.data() + i * im.opts.max_datagram, im.opts.max_datagram};
+        msghdr& h     = im.msgs[i].msg_hdr;
+        h.msg_name    = &im.names[i];
+        h.msg_iov     = &im.iovs[i];
+        h.msg_iovlen  = 1;
+        h.msg_control = im.control.data() + i * im.control_len;
+    }
+}
+
+UdpIngest::~UdpIngest() { stop(); }
+
+void UdpIngest::start() {
+    Impl& im = *impl_;
+    if (im.started) return;
+    im.started = true;
+    im.running.store(true);
+    for (unsigned i = 0; i < im.workers.size(); ++i)
+        im.workers[i]->thread = std::thread([&im, i] { im.work(i); });
+    im.receiver = std::thread([&im] { im.receive(); });
+}
+
+void UdpIngest::stop() {
+    Impl& im = *impl_;
+    if (!im.running.exchange(false)) return;
+    im.receiver.join();
+    for (auto& w : im.workers) {
+        w->ring.close();
+        w->thread.join();
+    }
+}
+
+uint16_t UdpIngest::port() const noexcept { return impl_->port; }
+
+IngestStats UdpIngest::stats() const {
+    const Impl& im = *impl_;
+    IngestStats s;
+    s.datagrams    = im.datagrams.get();
+    s.bytes        = im.bytes.get();
+    s.batches      = im.batches.get();
+    s.truncated    = im.truncated.get();
+    s.ring_drops   = im.ring_drops.get();
+    s.kernel_drops = im.kernel_drops.get();
+    for (const auto& w : im.workers) {
+        IngestWorkerStats& ws = s.workers.emplace_back();
+        ws.datagrams        = w->datagrams.get();
+        ws.blocks           = w->blocks.get();
+        ws.bytes_skipped    = w->bytes_skipped.get();
+        ws.handler_errors   = w->handler_errors.get();
+        ws.queue_depth      = w->ring.depth();
+        ws.queue_high_water = w->high_water.get();
+    }
+    return s;
+}
+
+// ─── Prometheus text format ───────────────────────────────────────────────────
+
+void writePrometheus(std::string& out, const IngestStats& s) {
+    using detail::header;
+    using detail::sample;
+
+    const auto total = [&](const char* name, const char* help, uint64_t value) {
+        header(out, name, "counter", help);
+        sample(out, name, {}, value);
+    };
+    total("asterix_ingest_datagrams_total", "Datagrams queued to a decode worker.", s.datagrams);
+    total("asterix_ingest_bytes_total", "Bytes of the queued datagrams.", s.bytes);
+    total("asterix_ingest_batches_total", "recvmmsg() calls that returned datagrams.", s.batches);
+    total("asterix_ingest_truncated_total", "Datagrams longer than max_datagram, dropped.", s.truncated);
+    total("asterix_ingest_ring_drops_total", "Datagrams dropped because a worker ring was full.",
+          s.ring_drops);
+    total("asterix_ingest_kernel_drops_total", "Datagrams dropped by the kernel (socket buffer full).",
+          s.kernel_drops);
+
+    const auto per_worker = [&](const char* name, const char* type, const char* help,
+                                uint64_t IngestWorkerStats::*value) {
+        header(out, name, type, help);
+        for (size_t i = 0; i < s.workers.size(); ++i)
+            sample(out, name, "worker=\"" + std::to_string(i) + "\"", s.workers[i].*value);
+    };
+    per_worker("asterix_ingest_worker_datagrams_total", "counter", "Datagrams decoded by the worker.",
+               &IngestWorkerStats::datagrams);
+    per_worker("asterix_ingest_worker_blocks_total", "counter", "Data Blocks handed to the handler.",
+               &IngestWorkerStats::blocks);
+    per_worker("asterix_ingest_worker_skipped_bytes_total", "counter",
+               "Datagram bytes not framed as Data Blocks.", &IngestWorkerStats::bytes_skipped);
+    per_worker("asterix_ingest_worker_handler_errors_total", "counter",
+               "Exceptions thrown by the handler.", &IngestWorkerStats::handler_errors);
+    per_worker("asterix_ingest_queue_depth", "gauge", "Datagrams waiting in the worker ring.",
+               &IngestWorkerStats::queue_depth);
+    per_worker("asterix_ingest_queue_high_water", "gauge", "Most datagrams seen waiting at once.",
+               &IngestWorkerStats::queue_high_water);
+}
+
+} // namespace asterix
@@ -0,0 +1,141 @@
+// Metrics.cpp – Counter snapshots and Prometheus text export.
+
+#include "ASTERIXCodec/Metrics.hpp"
+#include "ASTERIXCodec/Codec.hpp"
+#include "Counters.hpp"
+#include "Prometheus.hpp"
+
+#include <cstdio>
+#include <string>
+
+namespace asterix {
+
+const char* metricLabel(DecodeErrc code) noexcept {
+    switch (code) {
+    case DecodeErrc::None:                return "none";
+    case DecodeErrc::ShortHeader:         return "short_header";
+    case DecodeErrc::BadBlockLength:      return "bad_block_length";
+    case DecodeErrc::UnknownCategory:     return "unknown_category";
+    case DecodeErrc::StaleProjection:     return "stale_projection";
+    case DecodeErrc::UnknownItem:         return "unknown_item";
+    case DecodeErrc::NoProgress:          return "no_progress";
+    case DecodeErrc::FixedTruncated:      return "fixed_truncated";
+    case DecodeErrc::ExtendedTruncated:   return "extended_truncated";
+    case DecodeErrc::RepetitiveTruncated: return "repetitive_truncated";
+    case DecodeErrc::GroupCountTruncated: return "group_count_truncated";
+    case DecodeErrc::GroupTruncated:      return "group_truncated";
+    case DecodeErrc::GroupFXTruncated:    return "group_fx_truncated";
+    case DecodeErrc::ExplicitEmpty:       return "explicit_empty";
+    case DecodeErrc::ExplicitLength:      return "explicit_length";
+    case DecodeErrc::PsfTruncated:        return "psf_truncated";
+    case DecodeErrc::SubItemTruncated:    return "sub_item_truncated";
+    case DecodeErrc::UnsupportedType:     return "unsupported_type";
+    case DecodeErrc::MandatoryMissing:    return "mandatory_missing";
+    case DecodeErrc::OutOfRange:          return "out_of_range";
+    }
+    return "unknown";
+}
+
+// ─── Codec snapshot ───────────────────────────────────────────────────────────
+
+CodecMetrics Codec::metrics() const {
+    CodecMetrics m;
+    if constexpr (!kMetricsEnabled) return m;
+
+    using detail::CategoryCounters;
+    for (size_t i = 0; i < kDecodeErrcCount; ++i)
+        m.rejected[i] = rejected_->total(CategoryCounters::kFaults + i);
+
+    registry_.forEach([&](const CategoryPlan& plan) {
+        const CategoryCounters& c = *plan.counters;
+        CategoryMetrics& cm = m.categories.emplace_back();
+        cm.cat     = plan.def.cat;
+        cm.plan    = &plan;
+        cm.blocks  = c.total(CategoryCounters::kBlocks);
+        cm.records = c.total(CategoryCounters::kRecords);
+        cm.bytes   = c.total(CategoryCounters::kBytes);
+        cm.items.resize(c.items());
+        for (size_t i = 0; i < cm.items.size(); ++i)
+            cm.items[i] = c.total(CategoryCounters::kItems + i);
+        for (size_t i = 0; i < kDecodeErrcCount; ++i)
+            cm.faults[i] = c.total(CategoryCounters::kFaults + i);
+        for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i)
+            cm.latency.counts[i] = c.total(CategoryCounters::kBuckets + i);
+        cm.latency.sum_ns = c.total(CategoryCounters::kLatencySum);
+    });
+    return m;
+}
+
+void Codec::resetMetrics() {
+    if constexpr (!kMetricsEnabled) return;
+    rejected_->reset();
+    registry_.forEach([](const CategoryPlan& plan) { plan.counters->reset(); });
+}
+
+// ─── Prometheus text format ───────────────────────────────────────────────────
+
+namespace {
+
+using detail::header;
+using detail::sample;
+
+std::string catLabel(uint8_t cat) { return "cat=\"" + std::to_string(cat) + "\""; }
+
+// Seconds with enough digits for a nanosecond count.
+std::string seconds(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.9g", static_cast<double>(ns) * 1e-9);
+    return buf;
+}
+
+} // namespace
+
+void writePrometheus(std::string& out, const CodecMetrics& m) {
+    if (!m.enabled) return;
+
+    const auto per_category = [&](const char* name, const char* help, uint64_t CategoryMetrics::*value) {
+        header(out, name, "counter", help);
+        for (const auto& c : m.categories) sample(out, name, catLabel(c.cat), c.*value);
+    };
+    per_category("asterix_blocks_total", "Data Blocks decoded.", &CategoryMetrics::blocks);
+    per_category("asterix_records_total", "Data Records decoded.", &CategoryMetrics::records);
+    per_category("asterix_bytes_total", "Data Block bytes decoded, headers included.",
+                 &CategoryMetrics::bytes);
+
+    header(out, "asterix_items_total", "counter", "Data Items decoded.");
+    for (const auto& c : m.categories)
+        for (size_t i = 0; i < c.items.size(); ++i)
+            sample(out, "asterix_items_total",
+                   catLabel(c.cat) + ",item=\"" + c.plan->items[i].def->id + "\"", c.items[i]);
+
+    header(out, "asterix_faults_total", "counter", "Decode faults by reason.");
+    for (const auto& c : m.categories)
+        for (size_t r = 1; r < kDecodeErrcCount; ++r)
+            if (c.faults[r] != 0)
+                sample(out, "asterix_faults_total",
+                       catLabel(c.cat) + ",reason=\"" + metricLabel(static_cast<DecodeErrc>(r)) + "\"",
+                       c.faults[r]);
+
+    header(out, "asterix_rejected_blocks_total", "counter",
+           "Data Blocks rejected before their category was known.");
+    for (DecodeErrc r : {DecodeErrc::ShortHeader, DecodeErrc::BadBlockLength, DecodeErrc::UnknownCategory})
+        sample(out, "asterix_rejected_blocks_total", std::string("reason=\"") + metricLabel(r) + "\"",
+               m.rejected[static_cast<size_t>(r)]);
+
+    header(out, "asterix_block_decode_seconds", "histogram", "Time spent decoding one Data Block.");
+    for (const auto& c : m.categories) {
+        const std::string cat = catLabel(c.cat);
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < LatencyHistogram::kBuckets; ++b) {
+            cumulative += c.latency.counts[b];
+            const std::string le = b + 1 < LatencyHistogram::kBuckets
+                ? seconds(LatencyHistogram::upperBoundNs(b)) : std::string("+Inf");
+            sample(out, "asterix_block_decode_seconds_bucket", cat + ",le=\"" + le + "\"", cumulative);
+        }
+        out.append("asterix_block_decode_seconds_sum{").append(cat).append("} ")
+           .append(seconds(c.latency.sum_ns)).append("\n");
+        sample(out, "asterix_block_decode_seconds_count", cat, cumulative);
+    }
+}
+
+} // namespace asterix
@@ -0,0 +1,118 @@
+// Packer.cpp – Record accumulation, block closing and the output ring.
+
+#include "ASTERIXCodec/Packer.hpp"
+#include "ASTERIXCodec/BitStream.hpp"
+#include "Walker.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+namespace {
+
+// Record sink that only applies the length rules (pre-encoded records).
+struct MeasureRecordSink {
+    detail::SkipItemSink skip;
+
+    bool decodes(ItemIndex) const { return false; }
+    detail::SkipItemSink& beginItem(ItemIndex, const PlanItem&) { return skip; }
+    void endItem(ItemIndex, std::span<const uint8_t>) {}
+    void variation(uint16_t) {}
+    void invalid(const DecodeError&) {}
+};
+
+} // namespace
+
+BlockPacker::BlockPacker(const Codec& codec, uint8_t cat, PackerOptions opts, Sink sink)
+    : codec_(&codec), plan_(&codec.plan(cat)), opts_(opts), sink_(std::move(sink)) {
+    if (opts_.max_block_bytes < 4 || opts_.max_block_bytes > 0xFFFF)
+        throw std::runtime_error("BlockPacker: max_block_bytes must be 4–65535, got " +
+                                 std::to_string(opts_.max_block_bytes));
+    if (opts_.ring_size == 0) throw std::runtime_error("BlockPacker: ring_size must be at least 1");
+    ring_.resize(opts_.ring_size);
+    for (auto& buf : ring_) buf.reserve(opts_.max_block_bytes);
+    open();
+}
+
+void BlockPacker::open() {
+    std::vector<uint8_t>& out = ring_[cur_];
+    out.assign({plan_->def.cat, 0, 0}); // LEN patched on close
+    out.insert(out.end(), carry_.begin(), carry_.end());
+    carry_.clear();
+}
+
+// ─── Adding records ───────────────────────────────────────────────────────────
+
+void BlockPacker::add(const DecodedRecord& rec) {
+    std::vector<uint8_t>& out = ring_[cur_];
+    const size_t at = out.size();
+    BitWriter bw{std::move(out)};
+    try {
+        codec_->encodeRecord(rec, *plan_, bw);
+    } catch (...) {
+        out = bw.take();
+        out.resize(at);
+        throw;
+    }
+    out = bw.take();
+    placed(at);
+}
+
+void BlockPacker::add(std::span<const uint8_t> record) {
+    MeasureRecordSink sink;
+    DecodeError err;
+    if (record.empty() || detail::walkRecord(*plan_, record, sink, err) != record.size())
+        throw std::runtime_error("BlockPacker: bytes are not one category " +
+                                 std::to_string(plan_->def.cat) + " record");
+    std::vector<uint8_t>& out = ring_[cur_];
+    const size_t at = out.size();
+    out.insert(out.end(), record.begin(), record.end());
+    placed(at);
+}
+
+void BlockPacker::placed(size_t at) {
+    std::vector<uint8_t>& out = ring_[cur_];
+    if (out.size() - at + 3 > 0xFFFF) {
+        out.resize(at);
+        throw std::runtime_error("BlockPacker: record does not fit a Data Block");
+    }
+    if (out.size() > opts_.max_block_bytes && records_ != 0) close(at); // the record opens the next block
+    if (records_++ == 0) opened_ = Clock::now();
+    if (ring_[cur_].size() >= opts_.max_block_bytes) close(ring_[cur_].size()); // nothing more fits
+}
+
+// ─── Closing blocks ───────────────────────────────────────────────────────────
+
+bool BlockPacker::poll(Clock::time_point now) {
+    if (records_ == 0 || now - opened_ < opts_.max_delay) return false;
+    flush();
+    return true;
+}
+
+void BlockPacker::flush() {
+    if (records_ != 0) close(ring_[cur_].size());
+}
+
+void BlockPacker::close(size_t length) {
+    std::vector<uint8_t>& out = ring_[cur_];
+    carry_.assign(out.begin() + static_cast<std::ptrdiff_t>(length), out.end());
+    out.resize(length);
+    out[1] = static_cast<uint8_t>(length >> 8);
+    out[2] = static_cast<uint8_t>(length);
+
+    const size_t done = cur_;
+    cur_     = (cur_ + 1) % ring_.size();
+    records_ = 0;
+    ++blocks_;
+    if (cur_ != done) open();
+    try {
+        sink_(ring_[done]);
+    } catch (...) {
+        if (cur_ == done) open(); // single buffer: reuse it even if the sink failed
+        throw;
+    }
+    if (cur_ == done) open();
+}
+
+} // namespace asterix
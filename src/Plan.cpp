@@ -0,0 +1,378 @@
+// Plan.cpp – Compiles a CategoryDef into its flat, index-based decode plan.
+
+#include "ASTERIXCodec/Plan.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+#include "Counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace asterix {
+
+// ─── Lookups ──────────────────────────────────────────────────────────────────
+
+ItemIndex CategoryPlan::findItem(std::string_view id) const noexcept {
+    // items[] follows CategoryDef::items order, i.e. sorted by ID.
+    auto it = std::lower_bound(items.begin(), items.end(), id,
+                               [](const PlanItem& pi, std::string_view key) {
+                                   return std::string_view(pi.def->id) < key;
+                               });
+    if (it == items.end() || it->def->id != id) return kNoItem;
+    return static_cast<ItemIndex>(it - items.begin());
+}
+
+uint16_t CategoryPlan::findVariation(std::string_view name) const noexcept {
+    for (size_t i = 0; i < variations.size(); ++i)
+        if (*variations[i].name == name) return static_cast<uint16_t>(i);
+    return default_variation;
+}
+
+// ─── Element packing ──────────────────────────────────────────────────────────
+
+static PlanRange packElements(const std::vector<ElementDef>& elems,
+                              std::vector<PlanElement>& out) {
+    PlanRange r{static_cast<uint32_t>(out.size()), static_cast<uint32_t>(elems.size())};
+    uint16_t offset = 0;
+    for (const auto& e : elems) {
+        if (!e.is_spare && (e.bits == 0 || e.bits > 64))
+            throw std::runtime_error("Element " + e.name + ": bit width must be 1–64");
+        PlanElement pe;
+        pe.def        = &e;
+        pe.bits       = e.bits;
+        pe.bit_offset = offset;
+        pe.is_spare   = e.is_spare;
+        pe.field      = e.field_id;
+        out.push_back(pe);
+        offset = static_cast<uint16_t>(offset + e.bits);
+    }
+    return r;
+}
+
+// Bits spanned by a packed range.
+static uint32_t rangeBits(const CategoryPlan& plan, PlanRange r) {
+    if (r.count == 0) return 0;
+    const PlanElement& last = plan.elements[r.end() - 1];
+    return static_cast<uint32_t>(last.bit_offset) + last.bits;
+}
+
+// The walker reads element ranges without bounds checks once it has checked
+// the item length, so every range must fit the bytes that length covers.
+static void checkFits(const CategoryPlan& plan, const std::string& what,
+                      PlanRange r, uint32_t capacity_bits) {
+    const uint32_t need = rangeBits(plan, r);
+    if (need > capacity_bits)
+        throw std::runtime_error(what + ": elements span " + std::to_string(need) +
+                                 " bits but only " + std::to_string(capacity_bits) +
+                                 " are available");
+}
+
+static void compileItem(const DataItemDef& def, CategoryPlan& plan) {
+    PlanItem pi;
+    pi.def         = &def;
+    pi.type        = def.type;
+    pi.mandatory   = def.presence == Presence::Mandatory;
+    pi.fixed_bytes = def.fixed_bytes;
+
+    switch (def.type) {
+    case ItemType::Fixed:
+        pi.elements = packElements(def.elements, plan.elements);
+        break;
+
+    case ItemType::Extended:
+        pi.octets = {static_cast<uint32_t>(plan.octets.size()),
+                     static_cast<uint32_t>(def.octets.size())};
+        for (const auto& oct : def.octets)
+            plan.octets.push_back(packElements(oct.elements, plan.elements));
+        break;
+
+    case ItemType::Repetitive: {
+        PlanElement pe;
+        pe.def      = &def.rep_element;
+        pe.bits     = 7;
+        pe.is_spare = def.rep_element.is_spare;
+        pe.field    = def.rep_element.field_id;
+        pi.elements = {static_cast<uint32_t>(plan.elements.size()), 1};
+        pi.columns  = 1;
+        plan.elements.push_back(pe);
+        break;
+    }
+
+    case ItemType::RepetitiveGroup:
+        pi.elements    = packElements(def.rep_group_elements, plan.elements);
+        pi.group_bytes = static_cast<uint16_t>(def.rep_group_bits / 8);
+        break;
+
+    case ItemType::RepetitiveGroupFX:
+        pi.elements    = packElements(def.rep_group_elements, plan.elements);
+        pi.group_bytes = static_cast<uint16_t>((def.rep_group_bits + 1) / 8);
+        break;
+
+    case ItemType::Explicit:
+    case ItemType::SP:
+        break;
+
+    case ItemType::Compound:
+        pi.sub_items = {static_cast<uint32_t>(plan.sub_items.size()),
+                        static_cast<uint32_t>(def.compound_sub_items.size())};
+        for (const auto& si : def.compound_sub_items) {
+            PlanSubItem ps;
+            ps.def         = &si;
+            ps.unused      = si.name == "-";
+            ps.fixed_bytes = si.fixed_bytes;
+            if (!ps.unused) ps.elements = packElements(si.elements, plan.elements);
+            plan.sub_items.push_back(ps);
+        }
+        break;
+    }
+
+    if (pi.group_bytes != 0)
+        for (const auto& e : def.rep_group_elements)
+            if (!e.is_spare) ++pi.columns;
+
+    const std::string what = "Item " + def.id;
+    switch (pi.type) {
+    case ItemType::Fixed:
+        checkFits(plan, what, pi.elements, pi.fixed_bytes * 8u);
+        break;
+    case ItemType::Extended:
+        for (uint32_t o = pi.octets.first; o < pi.octets.end(); ++o)
+            checkFits(plan, what + " octet " + std::to_string(o - pi.octets.first + 1),
+                      plan.octets[o], 8);
+        break;
+    case ItemType::RepetitiveGroup:
+        checkFits(plan, what, pi.elements, pi.group_bytes * 8u);
+        break;
+    case ItemType::RepetitiveGroupFX:
+        if (pi.group_bytes == 0)
+            throw std::runtime_error(what + ": RepetitiveGroupFX group is empty");
+        checkFits(plan, what, pi.elements, pi.group_bytes * 8u - 1u); // last bit is FX
+        break;
+    case ItemType::Compound:
+        for (uint32_t i = pi.sub_items.first; i < pi.sub_items.end(); ++i) {
+            const PlanSubItem& ps = plan.sub_items[i];
+            if (!ps.unused)
+                checkFits(plan, what + "/" + ps.def->name, ps.elements, ps.fixed_bytes * 8u);
+        }
+        break;
+    default:
+        break;
+    }
+
+    plan.items.push_back(pi);
+}
+
+// Record, for every interned field, the item and repetition column it lives
+// in, and for every item the range of its FieldIds.
+static void locateFields(CategoryPlan& plan) {
+    plan.fields.assign(plan.def.fields.size(), PlanField{});
+    auto place = [&](ItemIndex idx, PlanRange r) {
+        uint16_t column = 0;
+        for (uint32_t i = r.first; i < r.end(); ++i) {
+            const PlanElement& pe = plan.elements[i];
+            if (pe.is_spare || pe.field >= plan.fields.size()) continue;
+            plan.fields[pe.field] = {idx, column++, i};
+        }
+    };
+    for (size_t idx = 0; idx < plan.items.size(); ++idx) {
+        const PlanItem& pi = plan.items[idx];
+        const auto item    = static_cast<ItemIndex>(idx);
+        place(item, pi.elements);
+        for (uint32_t o = pi.octets.first; o < pi.octets.end(); ++o)
+            place(item, plan.octets[o]);
+        for (uint32_t s = pi.sub_items.first; s < pi.sub_items.end(); ++s)
+            place(item, plan.sub_items[s].elements);
+    }
+    for (FieldId f = 0; f < plan.fields.size(); ++f) {
+        const ItemIndex idx = plan.fields[f].item;
+        if (idx >= plan.items.size()) continue;
+        PlanRange& r = plan.items[idx].fields;
+        if (r.count == 0) r.first = f;
+        r.count = f - r.first + 1; // consecutive: internFields() numbers fields item by item
+    }
+}
+
+// ─── Value ranges ─────────────────────────────────────────────────────────────
+
+// Physical bound / scale as a raw bound, rounded inwards and clamped to int64.
+static int64_t rawBound(double physical, double scale, bool upper) {
+    const double raw = physical / scale;
+    const double r   = upper ? std::floor(raw + 1e-9) : std::ceil(raw - 1e-9);
+    if (r <= -9.2e18) return std::numeric_limits<int64_t>::min();
+    if (r >= 9.2e18) return std::numeric_limits<int64_t>::max();
+    return static_cast<int64_t>(r);
+}
+
+// Compile the min / max of every ranged Raw or quantity element into
+// plan.limits, one contiguous run per item.
+static void compileLimits(CategoryPlan& plan) {
+    auto add = [&](PlanRange r) {
+        for (uint32_t i = r.first; i < r.end(); ++i) {
+            const PlanElement& pe = plan.elements[i];
+            const ElementDef&  e  = *pe.def;
+            if (pe.is_spare || !e.has_range || e.scale <= 0) continue;
+            if (e.encoding != Encoding::Raw && e.encoding != Encoding::UnsignedQuantity &&
+                e.encoding != Encoding::SignedQuantity)
+                continue;
+            plan.limits.push_back({i, e.encoding == Encoding::SignedQuantity,
+                                   rawBound(e.min_val, e.scale, false),
+                                   rawBound(e.max_val, e.scale, true)});
+        }
+    };
+    for (PlanItem& pi : plan.items) {
+        pi.limits.first = static_cast<uint32_t>(plan.limits.size());
+        add(pi.elements);
+        for (uint32_t o = pi.octets.first; o < pi.octets.end(); ++o) add(plan.octets[o]);
+        for (uint32_t s = pi.sub_items.first; s < pi.sub_items.end(); ++s)
+            add(plan.sub_items[s].elements);
+        pi.limits.count = static_cast<uint32_t>(plan.limits.size()) - pi.limits.first;
+    }
+}
+
+// ─── FSPEC dispatch ───────────────────────────────────────────────────────────
+
+// Fill pv's dispatch table from its slots: one 128-entry block per FSPEC octet.
+static void compileDispatch(PlanVariation& pv) {
+    const size_t octets = (pv.slots.size() + 6) / 7;
+    pv.dispatch.resize(octets * 128);
+    for (size_t o = 0; o < octets; ++o) {
+        for (unsigned bits = 0; bits < 128; ++bits) {
+            PlanRange& r = pv.dispatch[o * 128 + bits];
+            r.first = static_cast<uint32_t>(pv.dispatch_slots.size());
+            for (size_t k = 0; k < 7; ++k) {
+                const size_t slot = o * 7 + k;
+                if (slot < pv.slots.size() && pv.slots[slot] != kNoItem && ((bits >> (6 - k)) & 1u))
+                    pv.dispatch_slots.push_back({pv.slots[slot], static_cast<uint16_t>(slot)});
+            }
+            r.count = static_cast<uint32_t>(pv.dispatch_slots.size()) - r.first;
+        }
+    }
+}
+
+// ─── UAP discriminator ────────────────────────────────────────────────────────
+
+static PlanUapCase compileUapCase(const UapCase& uc, const CategoryPlan& plan) {
+    const std::string where = "Category " + std::to_string(plan.def.cat) + " UAP case ";
+
+    PlanUapCase pc;
+    pc.item = plan.findItem(uc.item_id);
+    if (pc.item == kNoItem)
+        throw std::runtime_error(where + "references unknown item " + uc.item_id);
+
+    const PlanItem& pi = plan.items[pc.item];
+    bool found = false;
+    auto scan = [&](PlanRange r, uint16_t base) {
+        for (uint32_t i = r.first; i < r.end() && !found; ++i) {
+            const PlanElement& pe = plan.elements[i];
+            if (!pe.is_spare && pe.def->name == uc.field) {
+                pc.bit_offset = static_cast<uint16_t>(base + pe.bit_offset);
+                pc.bits       = pe.bits;
+                found         = true;
+            }
+        }
+    };
+    if (pi.type == ItemType::Fixed) {
+        scan(pi.elements, 0);
+    } else if (pi.type == ItemType::Extended) {
+        for (uint32_t o = 0; o < pi.octets.count && !found; ++o)
+            scan(plan.octets[pi.octets.first + o], static_cast<uint16_t>(o * 8));
+    } else {
+        throw std::runtime_error(where + "item " + uc.item_id +
+                                 " must be Fixed or Extended");
+    }
+    if (!found)
+        throw std::runtime_error(where + "field " + uc.item_id + "/" + uc.field +
+                                 " not defined");
+
+    for (const PlanVariation& pv : plan.variations) {
+        const auto at = std::find(pv.slots.begin(), pv.slots.end(), pc.item);
+        pc.slots.push_back(at == pv.slots.end() ? PlanUapCase::kAbsent
+                                                : static_cast<uint16_t>(at - pv.slots.begin()));
+    }
+    const auto& def_slots = plan.variations[plan.default_variation].slots;
+    const uint16_t def_at = pc.slots[plan.default_variation];
+    pc.leading = def_at != PlanUapCase::kAbsent;
+
+    for (const auto& [value, var_name] : uc.value_to_variation) {
+        for (size_t v = 0; v < plan.variations.size(); ++v) {
+            if (*plan.variations[v].name == var_name) {
+                pc.value_to_variation.emplace_back(value, static_cast<uint16_t>(v));
+                // One pass only if the slots up to the discriminator's agree
+                const auto& slots = plan.variations[v].slots;
+                pc.leading = pc.leading && slots.size() > def_at &&
+                             std::equal(def_slots.begin(), def_slots.begin() + def_at + 1,
+                                        slots.begin());
+                break;
+            }
+        }
+    }
+    return pc; // value_to_variation inherits std::map ordering → sorted
+}
+
+// ─── Public entry point ───────────────────────────────────────────────────────
+
+std::shared_ptr<const CategoryPlan> compilePlan(CategoryDef def) {
+    static std::atomic<uint64_t> next_id{1};
+    auto plan = std::make_shared<CategoryPlan>();
+    plan->id  = next_id.fetch_add(1, std::memory_order_relaxed);
+    plan->def = std::move(def);
+    if (plan->def.fields.empty()) internFields(plan->def); // hand-built definition
+    const CategoryDef& cat = plan->def;
+
+    if (cat.items.size() > kMaxPlanItems)
+        throw std::runtime_error("Category " + std::to_string(cat.cat) + " has too many items");
+
+    for (const auto& [id, item] : cat.items) {
+        compileItem(item, *plan);
+        if (item.presence == Presence::Mandatory) {
+            plan->mandatory.push_back(static_cast<ItemIndex>(plan->items.size() - 1));
+            plan->mandatory_mask.set(plan->items.size() - 1);
+        }
+    }
+
+    bool have_default = false;
+    for (const auto& [name, refs] : cat.uap_variations) {
+        PlanVariation pv;
+        pv.name = &name;
+        pv.refs = &refs;
+        pv.slots.reserve(refs.size());
+        for (const auto& ref : refs) {
+            if (ref == "-" || ref == "rfs") {
+                pv.slots.push_back(kNoItem);
+                continue;
+            }
+            ItemIndex idx = plan->findItem(ref);
+            pv.slots.push_back(idx == kNoItem ? kUnknownItem : idx);
+        }
+        compileDispatch(pv);
+        if (name == cat.default_variation) {
+            plan->default_variation = static_cast<uint16_t>(plan->variations.size());
+            have_default = true;
+        }
+        plan->variations.push_back(std::move(pv));
+    }
+    if (!have_default)
+        throw std::runtime_error("Category " + std::to_string(cat.cat) +
+                                 ": default UAP variation '" + cat.default_variation +
+                                 "' is not defined");
+
+    locateFields(*plan);
+    compileLimits(*plan);
+
+    if (cat.uap_case.has_value())
+        plan->uap_case = compileUapCase(*cat.uap_case, *plan);
+
+    if constexpr (kMetricsEnabled)
+        plan->counters = std::make_shared<detail::CategoryCounters>(plan->items.size());
+
+    return plan;
+}
+
+std::string catName(uint8_t cat) {
+    return "CAT" + std::to_string(cat);
+}
+
+} // namespace asterix
@@ -0,0 +1,78 @@
+// Projection.cpp – Compile item / field selections against a category plan.
+
+#include "ASTERIXCodec/Projection.hpp"
+
+#include <stdexcept>
+
+namespace asterix {
+
+std::vector<FieldId> resolveSelection(const CategoryPlan& plan, const std::vector<ItemSelection>& items) {
+    const std::string where = "Selection for category " + std::to_string(plan.def.cat) + ": ";
+
+    std::vector<FieldId> ids;
+    std::vector<uint8_t> taken(plan.def.fields.size(), 0);
+    for (const auto& sel : items) {
+        if (plan.findItem(sel.item) == kNoItem)
+            throw std::runtime_error(where + "unknown item " + sel.item);
+
+        auto take = [&](auto&& match) {
+            bool matched = false;
+            for (FieldId id = 0; id < plan.def.fields.size(); ++id) {
+                const FieldInfo& fi = plan.def.fields[id];
+                if (fi.item_id != sel.item || !match(fi)) continue;
+                if (!taken[id]) ids.push_back(id); // not selected twice
+                taken[id] = 1;
+                matched   = true;
+            }
+            return matched;
+        };
+        if (sel.fields.empty()) {
+            (void)take([](const FieldInfo&) { return true; });
+            continue;
+        }
+        for (const auto& name : sel.fields)
+            if (!take([&](const FieldInfo& fi) { return fi.name == name || fi.sub_item == name; }))
+                throw std::runtime_error(where + "item " + sel.item + " has no field " + name);
+    }
+    return ids;
+}
+
+Projection& Projection::select(const CategoryPlan& plan, const std::vector<ItemSelection>& items) {
+    CategoryProjection cp;
+    cp.cat     = plan.def.cat;
+    cp.plan_id = plan.id;
+    cp.fields.assign((plan.fields.size() + 63) / 64, 0);
+
+    for (FieldId id : resolveSelection(plan, items)) cp.fields[id / 64] |= uint64_t{1} << (id % 64);
+    for (const auto& sel : items) {
+        const ItemIndex idx = plan.findItem(sel.item);
+        cp.items[idx] = true;
+        if (!sel.fields.empty()) cp.filtered[idx] = true;
+    }
+
+    CategoryProjection& slot = entry(plan);
+    if (slot.plan_id == plan.id) cp.filter = std::move(slot.filter); // keep its filter
+    slot = std::move(cp);
+    return *this;
+}
+
+Projection& Projection::filter(RecordFilter f) {
+    const CategoryPlan& plan = f.plan();
+    CategoryProjection& slot = entry(plan);
+    if (slot.plan_id != plan.id) { // no selection yet: every item
+        slot         = {};
+        slot.cat     = plan.def.cat;
+        slot.plan_id = plan.id;
+        for (size_t i = 0; i < plan.items.size(); ++i) slot.items[i] = true;
+    }
+    slot.filter = std::move(f);
+    return *this;
+}
+
+CategoryProjection& Projection::entry(const CategoryPlan& plan) {
+    for (auto& c : cats_)
+        if (c.cat == plan.def.cat) return c;
+    return cats_.emplace_back();
+}
+
+} // namespace asterix
@@ -0,0 +1,20 @@
+#pragma once
+// Prometheus.hpp – Internal: text exposition format helpers.
+
+#include <cstdint>
+#include <string>
+
+namespace asterix::detail {
+
+inline void header(std::string& out, const char* name, const char* type, const char* help) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+inline void sample(std::string& out, const char* name, const std::string& labels, uint64_t value) {
+    out.append(name);
+    if (!labels.empty()) out.append("{").append(labels).append("}");
+    out.append(" ").append(std::to_string(value)).append("\n");
+}
+
+} // namespace asterix::detail
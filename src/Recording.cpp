@@ -0,0 +1,403 @@
+// Recording.cpp – File mapping, block iteration and the .asxi index.
+//
+// Index file layout (all integers little-endian):
+//   "ASXI" | u16 version | u8 format | u32 stride | u64 file size | u64 mtime
+//   | 32B time categories | u64 blocks | u64 trailing | u32 count | entries
+// entry = u64 offset | f64 time | u8 timed | 32B categories.  Bitsets are
+// stored as 256 bits, category 0 first, LSB first within a byte.
+
+#include "ASTERIXCodec/Recording.hpp"
+#include "Walker.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace asterix {
+
+namespace fs = std::filesystem;
+
+static constexpr char     kIndexMagic[4] = {'A', 'S', 'X', 'I'};
+static constexpr uint16_t kIndexVersion  = 1;
+
+static constexpr size_t kFinalHeader  = 8;
+static constexpr size_t kFinalPadding = 4;
+
+static constexpr double kDay     = 86400.0;
+static constexpr double kHalfDay = 43200.0;
+
+// Category → item carrying its time of day (1/128 s, 3 bytes).
+struct TimeSource {
+    uint8_t     cat;
+    const char* item;
+};
+static constexpr TimeSource kTimeSources[] = {
+    {2, "030"}, {34, "030"}, {48, "140"}, {62, "070"},
+};
+
+static uint32_t be16(const uint8_t* p) { return (uint32_t{p[0]} << 8) | p[1]; }
+static uint32_t be24(const uint8_t* p) { return (uint32_t{p[0]} << 16) | (uint32_t{p[1]} << 8) | p[2]; }
+
+// ─── Mapping ──────────────────────────────────────────────────────────────────
+
+RecordingReader::RecordingReader(const fs::path& path, const Codec& codec, RecordingOptions opts)
+    : stride_(std::max<uint32_t>(opts.index_stride, 1)) {
+    std::fill(std::begin(time_item_), std::end(time_item_), kNoItem);
+    std::bitset<256> timed_cats;
+    for (const TimeSource& src : kTimeSources) {
+        if (!codec.hasCategory(src.cat)) continue;
+        const CategoryPlan& plan = codec.plan(src.cat);
+        const ItemIndex idx = plan.findItem(src.item);
+        if (idx == kNoItem || plan.items[idx].type != ItemType::Fixed ||
+            plan.items[idx].fixed_bytes != 3)
+            continue;
+        plans_[src.cat]     = &plan;
+        time_item_[src.cat] = idx;
+        timed_cats.set(src.cat);
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open recording '" + path.string() + "'");
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ > 0) {
+        mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_)
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+    CloseHandle(file);
+    if (size_ > 0 && !data_) {
+        if (mapping_) CloseHandle(mapping_);
+        throw std::runtime_error("Cannot map recording '" + path.string() + "'");
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open recording '" + path.string() + "'");
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat recording '" + path.string() + "'");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map recording '" + path.string() + "'");
+        }
+        data_    = static_cast<const uint8_t*>(p);
+        mapping_ = p;
+    }
+    ::close(fd);
+#endif
+
+    format_ = opts.format;
+    if (format_ == RecordingFormat::Auto) {
+        // A Final packet: plausible byte count ending in the A5 padding
+        format_ = RecordingFormat::Raw;
+        if (size_ >= kFinalHeader + kFinalPadding) {
+            const size_t count = be16(data_);
+            if (count >= kFinalHeader + kFinalPadding && count <= size_ &&
+                std::all_of(data_ + count - kFinalPadding, data_ + count,
+                            [](uint8_t b) { return b == 0xA5; }))
+                format_ = RecordingFormat::Final;
+        }
+    }
+
+    fs::path index_path = opts.index_path;
+    if (index_path.empty()) {
+        index_path = path;
+        index_path += ".asxi";
+    }
+    std::error_code ec;
+    const auto mtime = fs::last_write_time(path, ec);
+    const uint64_t stamp = ec ? 0 : static_cast<uint64_t>(mtime.time_since_epoch().count());
+
+    if (opts.persist_index && !ec && loadIndex(index_path, stamp, timed_cats)) {
+        index_loaded_ = true;
+        return;
+    }
+    buildIndex();
+    if (opts.persist_index && !ec) saveIndex(index_path, stamp, timed_cats);
+}
+
+RecordingReader::~RecordingReader() {
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+#else
+    ::munmap(mapping_, size_);
+#endif
+}
+
+// ─── Iteration ────────────────────────────────────────────────────────────────
+
+namespace {
+
+// Captures the bytes of one item of the first record.
+struct TimeRecordSink {
+    ItemIndex                want;
+    std::span<const uint8_t> found;
+    detail::SkipItemSink     skip;
+
+    bool decodes(ItemIndex) const { return false; }
+    detail::SkipItemSink& beginItem(ItemIndex, const PlanItem&) { return skip; }
+    void endItem(ItemIndex idx, std::span<const uint8_t> item_bytes) {
+        if (idx == want) found = item_bytes;
+    }
+    void variation(uint16_t) {}
+    void invalid(const DecodeError&) {}
+};
+
+} // namespace
+
+bool RecordingReader::blockTime(std::span<const uint8_t> block, double& tod) const {
+    const CategoryPlan* plan = plans_[block[0]];
+    if (!plan) return false;
+    TimeRecordSink sink{time_item_[block[0]], {}, {}};
+    DecodeError err;
+    (void)detail::walkRecord(*plan, block.subspan(3), sink, err);
+    if (sink.found.size() < 3) return false;
+    tod = be24(sink.found.data()) / 128.0;
+    return true;
+}
+
+RecordingReader::iterator::iterator(const RecordingReader& r, const RecordingIndexEntry& from)
+    : r_(&r), pos_(from.offset), latest_(from.time), latest_known_(from.timed), done_(false) {
+    advance();
+}
+
+void RecordingReader::iterator::advance() {
+    const uint8_t* data  = r_->data_;
+    const uint64_t size  = r_->size_;
+    const bool     final = r_->format_ == RecordingFormat::Final;
+
+    for (;;) {
+        at_mark_ = !in_packet_;
+        if (at_mark_) {
+            mark_ = {pos_, latest_, latest_known_, {}};
+            if (final) {
+                if (size - pos_ < kFinalHeader + kFinalPadding) break;
+                const uint64_t count = be16(data + pos_);
+                if (count < kFinalHeader + kFinalPadding || count > size - pos_) break;
+                packet_end_  = pos_ + count - kFinalPadding;
+                packet_time_ = be24(data + pos_ + 5) / 100.0;
+                pos_ += kFinalHeader;
+                in_packet_ = true;
+            } else {
+                packet_end_ = size;
+            }
+        }
+
+        const uint64_t room = packet_end_ - pos_;
+        const uint64_t len  = room >= 3 ? be16(data + pos_ + 1) : 0;
+        if (len < 3 || len > room) {
+            if (!final) break;
+            // Empty or damaged packet: go on with the next one
+            pos_       = packet_end_ + kFinalPadding;
+            in_packet_ = false;
+            continue;
+        }
+
+        block_.bytes  = {data + pos_, static_cast<size_t>(len)};
+        block_.offset = pos_;
+        block_.cat    = data[pos_];
+        pos_ += len;
+        if (final && pos_ == packet_end_) {
+            pos_ += kFinalPadding;
+            in_packet_ = false;
+        }
+
+        double tod = 0;
+        block_.timed = r_->blockTime(block_.bytes, tod);
+        if (!block_.timed && final) {
+            tod          = packet_time_;
+            block_.timed = true;
+        }
+        if (block_.timed) {
+            // Unwrap midnight against the latest time seen
+            double t = latest_known_ ? std::floor(latest_ / kDay) * kDay + tod : tod;
+            if (latest_known_ && t < latest_ - kHalfDay) t += kDay;
+            else if (latest_known_ && t > latest_ + kHalfDay && t >= kDay) t -= kDay;
+            block_.time   = t;
+            latest_       = latest_known_ ? std::max(latest_, t) : t;
+            latest_known_ = true;
+        } else {
+            block_.time = latest_;
+        }
+        return;
+    }
+    done_ = true;
+}
+
+RecordingReader::iterator RecordingReader::seek(double t) const {
+    // index_ times never decrease and index_[0] is untimed, so pp > begin
+    const auto pp = std::partition_point(index_.begin(), index_.end(),
+        [t](const RecordingIndexEntry& e) { return !e.timed || e.time < t; });
+    iterator it(*this, *(pp - 1));
+    while (it != end() && it->time < t) ++it;
+    return it;
+}
+
+// ─── Index ────────────────────────────────────────────────────────────────────
+
+void RecordingReader::buildIndex() {
+    index_.assign(1, RecordingIndexEntry{});
+    blocks_ = 0;
+    uint64_t since = 0;
+    iterator it(*this, index_[0]);
+    for (; it != end(); ++it) {
+        if (since >= stride_ && it.at_mark_) {
+            index_.push_back(it.mark_);
+            since = 0;
+        }
+        index_.back().categories.set(it->cat);
+        ++since;
+        ++blocks_;
+    }
+    trailing_ = size_ - it.pos_;
+}
+
+namespace {
+
+void putUint(std::vector<uint8_t>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+void putBits(std::vector<uint8_t>& out, const std::bitset<256>& bits) {
+    for (size_t byte = 0; byte < 32; ++byte) {
+        uint8_t v = 0;
+        for (size_t b = 0; b < 8; ++b) v |= static_cast<uint8_t>(bits[byte * 8 + b]) << b;
+        out.push_back(v);
+    }
+}
+
+// Bounds-checked little-endian reads; ok turns false on a short file.
+struct IndexReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool           ok{true};
+
+    uint64_t uint(int bytes) {
+        if (end - p < bytes) {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= uint64_t{p[i]} << (8 * i);
+        p += bytes;
+        return v;
+    }
+    std::bitset<256> bits() {
+        std::bitset<256> out;
+        for (size_t byte = 0; byte < 32; ++byte) {
+            const uint64_t v = uint(1);
+            for (size_t b = 0; b < 8; ++b) out[byte * 8 + b] = (v >> b) & 1u;
+        }
+        return out;
+    }
+};
+
+} // namespace
+
+bool RecordingReader::loadIndex(const fs::path& path, uint64_t stamp,
+                                const std::bitset<256>& timed_cats) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return false;
+    std::vector<uint8_t> buf(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    if (!f || buf.size() < sizeof kIndexMagic ||
+        !std::equal(std::begin(kIndexMagic), std::end(kIndexMagic), buf.begin()))
+        return false;
+
+    IndexReader in{buf.data() + sizeof kIndexMagic, buf.data() + buf.size()};
+    if (in.uint(2) != kIndexVersion || in.uint(1) != static_cast<uint8_t>(format_) ||
+        in.uint(4) != stride_ || in.uint(8) != size_ || in.uint(8) != stamp ||
+        in.bits() != timed_cats || !in.ok)
+        return false; // another recording, layout or codec: rebuild
+
+    const uint64_t blocks   = in.uint(8);
+    const uint64_t trailing = in.uint(8);
+    const size_t   count    = static_cast<size_t>(in.uint(4));
+    constexpr size_t kEntryBytes = 8 + 8 + 1 + 32;
+    if (!in.ok || count == 0 || count > static_cast<size_t>(in.end - in.p) / kEntryBytes) return false;
+
+    std::vector<RecordingIndexEntry> index(count);
+    for (auto& e : index) {
+        e.offset     = in.uint(8);
+        e.time       = std::bit_cast<double>(in.uint(8));
+        e.timed      = in.uint(1) != 0;
+        e.categories = in.bits();
+        if (e.offset > size_) return false;
+    }
+    if (!in.ok || in.p != in.end || index[0].offset != 0 || index[0].timed) return false;
+
+    index_    = std::move(index);
+    blocks_   = blocks;
+    trailing_ = trailing;
+    return true;
+}
+
+void RecordingReader::saveIndex(const fs::path& path, uint64_t stamp,
+                                const std::bitset<256>& timed_cats) const {
+    std::vector<uint8_t> out(std::begin(kIndexMagic), std::end(kIndexMagic));
+    putUint(out, kIndexVersion, 2);
+    putUint(out, static_cast<uint8_t>(format_), 1);
+    putUint(out, stride_, 4);
+    putUint(out, size_, 8);
+    putUint(out, stamp, 8);
+    putBits(out, timed_cats);
+    putUint(out, blocks_, 8);
+    putUint(out, trailing_, 8);
+    putUint(out, index_.size(), 4);
+    for (const auto& e : index_) {
+        putUint(out, e.offset, 8);
+        putUint(out, std::bit_cast<uint64_t>(e.time), 8);
+        putUint(out, e.timed ? 1 : 0, 1);
+        putBits(out, e.categories);
+    }
+
+    // Via a temporary file, so a concurrent reader never sees half an index.
+    // An index that cannot be written is simply rebuilt next time.
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!f) {
+            f.close();
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) fs::remove(tmp, ec);
+}
+
+} // namespace asterix
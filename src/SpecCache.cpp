@@ -0,0 +1,343 @@
+// SpecCache.cpp – CategoryDef ⇄ *.asxb serialisation and cached directory loads.
+//
+// File layout (all integers little-endian):
+//   "ASXB" | u16 version | CategoryDef
+// Strings are u32 length + bytes, containers u32 count + elements, doubles
+// their IEEE-754 bit pattern as u64.  Every field of Types.hpp is stored, in
+// declaration order, so a cached CategoryDef is identical to the parsed one.
+
+#include "ASTERIXCodec/SpecCache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace asterix {
+
+static constexpr char     kMagic[4] = {'A', 'S', 'X', 'B'};
+static constexpr uint16_t kVersion  = 2; // bump on any change to Types.hpp definitions
+
+namespace fs = std::filesystem;
+
+// ─── Writer ───────────────────────────────────────────────────────────────────
+
+namespace {
+
+class CacheWriter {
+public:
+    std::vector<uint8_t> out;
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u16(uint16_t v) { uint(v, 2); }
+    void u32(uint32_t v) { uint(v, 4); }
+    void u64(uint64_t v) { uint(v, 8); }
+    void f64(double v) { u64(std::bit_cast<uint64_t>(v)); }
+    void flag(bool v) { u8(v ? 1 : 0); }
+    void count(size_t n) { u32(static_cast<uint32_t>(n)); }
+    void str(const std::string& s) {
+        count(s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    void element(const ElementDef& e) {
+        str(e.name);
+        u16(e.bits);
+        u8(static_cast<uint8_t>(e.encoding));
+        flag(e.is_spare);
+        u16(e.field_id);
+        count(e.table.size());
+        for (const auto& [raw, text] : e.table) {
+            u64(raw);
+            str(text);
+        }
+        f64(e.scale);
+        str(e.unit);
+        f64(e.min_val);
+        f64(e.max_val);
+        flag(e.has_range);
+    }
+    void elements(const std::vector<ElementDef>& v) {
+        count(v.size());
+        for (const auto& e : v) element(e);
+    }
+
+    void item(const DataItemDef& d) {
+        str(d.id);
+        str(d.name);
+        u8(static_cast<uint8_t>(d.type));
+        u8(static_cast<uint8_t>(d.presence));
+        elements(d.elements);
+        count(d.octets.size());
+        for (const auto& o : d.octets) elements(o.elements);
+        element(d.rep_element);
+        elements(d.rep_group_elements);
+        u16(d.rep_group_bits);
+        u16(d.fixed_bytes);
+        count(d.compound_sub_items.size());
+        for (const auto& si : d.compound_sub_items) {
+            str(si.name);
+            elements(si.elements);
+            u16(si.fixed_bytes);
+        }
+    }
+
+    void category(const CategoryDef& c) {
+        out.insert(out.end(), std::begin(kMagic), std::end(kMagic));
+        u16(kVersion);
+        u8(c.cat);
+        str(c.name);
+        str(c.edition);
+        str(c.date);
+        count(c.items.size());
+        for (const auto& [id, d] : c.items) item(d);
+        count(c.uap_variations.size());
+        for (const auto& [name, slots] : c.uap_variations) {
+            str(name);
+            count(slots.size());
+            for (const auto& s : slots) str(s);
+        }
+        str(c.default_variation);
+        flag(c.uap_case.has_value());
+        if (c.uap_case) {
+            str(c.uap_case->item_id);
+            str(c.uap_case->field);
+            count(c.uap_case->value_to_variation.size());
+            for (const auto& [v, name] : c.uap_case->value_to_variation) {
+                u64(v);
+                str(name);
+            }
+        }
+        count(c.fields.size());
+        for (const auto& f : c.fields) {
+            str(f.item_id);
+            str(f.sub_item);
+            str(f.name);
+        }
+    }
+
+private:
+    void uint(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+};
+
+// ─── Reader ───────────────────────────────────────────────────────────────────
+
+class CacheReader {
+public:
+    CacheReader(const std::vector<uint8_t>& buf, const fs::path& path)
+        : p_(buf.data()), end_(buf.data() + buf.size()), path_(path) {}
+
+    uint8_t  u8() { return static_cast<uint8_t>(uint(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(uint(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(uint(4)); }
+    uint64_t u64() { return uint(8); }
+    double   f64() { return std::bit_cast<double>(u64()); }
+    bool     flag() { return u8() != 0; }
+    // Element count; every element takes at least one byte, which bounds
+    // reserve() on a corrupt file.
+    size_t count() {
+        const size_t n = u32();
+        if (n > static_cast<size_t>(end_ - p_)) fail("truncated");
+        return n;
+    }
+    std::string str() {
+        const size_t n = count();
+        std::string s(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+        return s;
+    }
+
+    template <class E>
+    E enumeration(E last) {
+        const uint8_t v = u8();
+        if (v > static_cast<uint8_t>(last)) fail("bad enum value");
+        return static_cast<E>(v);
+    }
+
+    ElementDef element() {
+        ElementDef e;
+        e.name     = str();
+        e.bits     = u16();
+        e.encoding = enumeration(Encoding::Spare);
+        e.is_spare = flag();
+        e.field_id = u16();
+        for (size_t n = count(); n > 0; --n) {
+            const uint64_t raw = u64();
+            e.table.emplace_hint(e.table.end(), raw, str());
+        }
+        e.scale     = f64();
+        e.unit      = str();
+        e.min_val   = f64();
+        e.max_val   = f64();
+        e.has_range = flag();
+        return e;
+    }
+    std::vector<ElementDef> elements() {
+        std::vector<ElementDef> v(count());
+        for (auto& e : v) e = element();
+        return v;
+    }
+
+    DataItemDef item() {
+        DataItemDef d;
+        d.id       = str();
+        d.name     = str();
+        d.type     = enumeration(ItemType::Compound);
+        d.presence = enumeration(Presence::Optional);
+        d.elements = elements();
+        d.octets.resize(count());
+        for (auto& o : d.octets) o.elements = elements();
+        d.rep_element        = element();
+        d.rep_group_elements = elements();
+        d.rep_group_bits     = u16();
+        d.fixed_bytes        = u16();
+        d.compound_sub_items.resize(count());
+        for (auto& si : d.compound_sub_items) {
+            si.name        = str();
+            si.elements    = elements();
+            si.fixed_bytes = u16();
+        }
+        return d;
+    }
+
+    CategoryDef category() {
+        if (static_cast<size_t>(end_ - p_) < sizeof kMagic ||
+            !std::equal(std::begin(kMagic), std::end(kMagic), p_))
+            fail("not a spec cache");
+        p_ += sizeof kMagic;
+        if (const uint16_t v = u16(); v != kVersion)
+            fail("format version " + std::to_string(v) + " (expected " +
+                 std::to_string(kVersion) + ")");
+
+        CategoryDef c;
+        c.cat     = u8();
+        c.name    = str();
+        c.edition = str();
+        c.date    = str();
+        for (size_t n = count(); n > 0; --n) {
+            DataItemDef d = item();
+            std::string id = d.id;
+            c.items.emplace_hint(c.items.end(), std::move(id), std::move(d));
+        }
+        for (size_t n = count(); n > 0; --n) {
+            std::string name = str();
+            std::vector<std::string> slots(count());
+            for (auto& s : slots) s = str();
+            c.uap_variations.emplace_hint(c.uap_variations.end(), std::move(name), std::move(slots));
+        }
+        c.default_variation = str();
+        if (flag()) {
+            UapCase uc;
+            uc.item_id = str();
+            uc.field   = str();
+            for (size_t n = count(); n > 0; --n) {
+                const uint64_t v = u64();
+                uc.value_to_variation.emplace_hint(uc.value_to_variation.end(), v, str());
+            }
+            c.uap_case = std::move(uc);
+        }
+        c.fields.resize(count());
+        for (auto& f : c.fields) {
+            f.item_id  = str();
+            f.sub_item = str();
+            f.name     = str();
+        }
+        if (p_ != end_) fail("trailing bytes");
+        return c;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw SpecLoadError("Spec cache '" + path_.string() + "': " + what);
+    }
+    uint64_t uint(int bytes) {
+        if (end_ - p_ < bytes) fail("truncated");
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= uint64_t{p_[i]} << (8 * i);
+        p_ += bytes;
+        return v;
+    }
+
+    const uint8_t*  p_;
+    const uint8_t*  end_;
+    const fs::path& path_;
+};
+
+} // namespace
+
+// ─── Public entry points ──────────────────────────────────────────────────────
+
+void saveSpecCache(const CategoryDef& cat, const fs::path& path) {
+    CacheWriter w;
+    w.category(cat);
+
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(w.out.data()),
+                static_cast<std::streamsize>(w.out.size()));
+        if (!f) throw SpecLoadError("Cannot write spec cache '" + tmp.string() + "'");
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        throw SpecLoadError("Cannot write spec cache '" + path.string() + "'");
+    }
+}
+
+CategoryDef loadSpecCache(const fs::path& path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) throw SpecLoadError("Cannot open spec cache '" + path.string() + "'");
+    std::vector<uint8_t> buf(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    if (!f) throw SpecLoadError("Cannot read spec cache '" + path.string() + "'");
+    return CacheReader(buf, path).category();
+}
+
+std::vector<CategoryDef> loadSpecDirectory(const fs::path& dir, const fs::path& cache_dir) {
+    std::vector<fs::path> specs;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("CAT") && entry.path().extension() == ".xml")
+            specs.push_back(entry.path());
+    }
+    std::sort(specs.begin(), specs.end());
+
+    const fs::path& caches = cache_dir.empty() ? dir : cache_dir;
+    std::vector<CategoryDef> out;
+    out.reserve(specs.size());
+    for (const auto& xml : specs) {
+        const fs::path cache = caches / xml.filename().replace_extension(".asxb");
+
+        std::error_code ec;
+        const auto cache_time = fs::last_write_time(cache, ec);
+        if (!ec && cache_time >= fs::last_write_time(xml)) {
+            try {
+                out.push_back(loadSpecCache(cache));
+                continue;
+            } catch (const SpecLoadError&) {
+                // Stale format or damaged file: rebuild it from the XML
+            }
+        }
+
+        out.push_back(loadSpec(xml));
+        try {
+            fs::create_directories(caches, ec);
+            saveSpecCache(out.back(), cache);
+        } catch (const SpecLoadError&) {
+            // Read-only cache location: keep working from the XML
+        }
+    }
+    return out;
+}
+
+} // namespace asterix
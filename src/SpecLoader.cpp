@@ -302,6 +302,42 @@ static void parseUAPs(pugi::xml_node node, CategoryDef& cat) {
     }
 }
 
+// ─── Field interning ──────────────────────────────────────────────────────────
+
+static void internElement(ElementDef& e, const std::string& item_id,
+                          const std::string& sub_item, CategoryDef& cat) {
+    if (e.is_spare) { e.field_id = kNoField; return; }
+    if (cat.fields.size() >= kNoField)
+        throw SpecLoadError("Category " + std::to_string(cat.cat) + " has too many fields");
+    e.field_id = static_cast<FieldId>(cat.fields.size());
+    cat.fields.push_back({item_id, sub_item, e.name});
+}
+
+void internFields(CategoryDef& cat) {
+    const std::string none;
+    cat.fields.clear();
+    for (auto& [id, item] : cat.items) {
+        for (auto& e : item.elements) internElement(e, id, none, cat);
+        for (auto& oct : item.octets)
+            for (auto& e : oct.elements) internElement(e, id, none, cat);
+        if (item.type == ItemType::Repetitive)
+            internElement(item.rep_element, id, none, cat);
+        for (auto& e : item.rep_group_elements) internElement(e, id, none, cat);
+        for (auto& si : item.compound_sub_items)
+            for (auto& e : si.elements) internElement(e, id, si.name, cat);
+    }
+}
+
+FieldId findField(const CategoryDef& cat, std::string_view item_id,
+                  std::string_view name, std::string_view sub_item) {
+    for (size_t i = 0; i < cat.fields.size(); ++i) {
+        const FieldInfo& f = cat.fields[i];
+        if (f.item_id == item_id && f.name == name && f.sub_item == sub_item)
+            return static_cast<FieldId>(i);
+    }
+    return kNoField;
+}
+
 // ─── Public entry point ───────────────────────────────────────────────────────
 
 CategoryDef loadSpec(const std::filesystem::path& xml_path) {
@@ -339,6 +375,7 @@ CategoryDef loadSpec(const std::filesystem::path& xml_path) {
     if (cat.uap_variations.empty())
         throw SpecLoadError("Category " + std::to_string(cat.cat) + " has no UAP variations");
 
+    internFields(cat);
     return cat;
 }
 
@@ -0,0 +1,92 @@
+#pragma once
+// SpscRing.hpp – Internal: bounded single-producer / single-consumer ring.
+//
+// Slots are preallocated and reused in place: the producer fills slot(i) for
+// i < writable() and publishes them in one go, the consumer reads front(i)
+// for i < readable() and releases them.  Head and tail sit on their own cache
+// lines and each side caches the other's index, so a steady stream costs one
+// acquire load per batch rather than per element.
+//
+// The consumer sleeps in wait() (std::atomic::wait); every publish() and
+// close() bumps a sequence number so a wake-up is never lost.
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace asterix::detail {
+
+template <class T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two.
+    explicit SpscRing(size_t capacity)
+        : slots_(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)), mask_(slots_.size() - 1) {}
+
+    [[nodiscard]] size_t capacity() const noexcept { return slots_.size(); }
+
+    // ── Producer ─────────────────────────────────────────────────────────────
+    [[nodiscard]] size_t writable() noexcept {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ == slots_.size())
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+        return slots_.size() - static_cast<size_t>(head - tail_cache_);
+    }
+    [[nodiscard]] T& slot(size_t i) noexcept {
+        return slots_[(head_.load(std::memory_order_relaxed) + i) & mask_];
+    }
+    void publish(size_t n) noexcept {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        signal();
+    }
+    // No more elements will be published; wakes the consumer.
+    void close() noexcept {
+        closed_.store(true, std::memory_order_release);
+        signal();
+    }
+
+    // ── Consumer ─────────────────────────────────────────────────────────────
+    [[nodiscard]] size_t readable() noexcept {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_cache_ == tail) head_cache_ = head_.load(std::memory_order_acquire);
+        return static_cast<size_t>(head_cache_ - tail);
+    }
+    [[nodiscard]] T& front(size_t i) noexcept {
+        return slots_[(tail_.load(std::memory_order_relaxed) + i) & mask_];
+    }
+    void release(size_t n) noexcept {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // Sequence number to pass to wait(): read it before checking readable().
+    [[nodiscard]] uint32_t sequence() const noexcept { return seq_.load(std::memory_order_acquire); }
+    // Sleep until something was published or the ring closed since seq.
+    void wait(uint32_t seq) const noexcept { seq_.wait(seq, std::memory_order_acquire); }
+    [[nodiscard]] bool closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+    // Elements published and not yet released (either side; approximate).
+    [[nodiscard]] size_t depth() const noexcept {
+        return static_cast<size_t>(head_.load(std::memory_order_relaxed) -
+                                   tail_.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t         mask_;
+
+    alignas(64) std::atomic<uint64_t> head_{0}; // written by the producer
+    uint64_t                          tail_cache_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0}; // written by the consumer
+    uint64_t                          head_cache_{0};
+    alignas(64) std::atomic<uint32_t> seq_{0};
+    std::atomic<bool>                 closed_{false};
+
+    void signal() noexcept {
+        seq_.fetch_add(1, std::memory_order_release);
+        seq_.notify_one();
+    }
+};
+
+} // namespace asterix::detail
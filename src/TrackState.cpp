@@ -0,0 +1,151 @@
+// TrackState.cpp – Track lookup, item byte comparison and field diffs.
+
+#include "ASTERIXCodec/TrackState.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace asterix {
+
+namespace {
+
+void setBit(std::vector<uint64_t>& bits, size_t i) { bits[i / 64] |= uint64_t{1} << (i % 64); }
+
+} // namespace
+
+TrackStore::TrackStore(const Codec& codec, uint8_t cat, std::string_view track_item)
+    : codec_(&codec), plan_(&codec.plan(cat)), cat_(cat) {
+    sac_      = findField(plan_->def, "010", "SAC");
+    sic_      = findField(plan_->def, "010", "SIC");
+    sac_item_ = plan_->findItem("010");
+    if (sac_ == kNoField || sic_ == kNoField)
+        throw std::runtime_error("TrackStore: " + catName(cat) + " has no I010 SAC / SIC");
+
+    if (track_item.empty()) {
+        if (cat == 62)      track_item = "040";
+        else if (cat == 48) track_item = "161";
+        else throw std::runtime_error("TrackStore: no default track number item for " + catName(cat));
+    }
+    track_item_ = plan_->findItem(track_item);
+    if (track_item_ == kNoItem || plan_->items[track_item_].fields.count == 0)
+        throw std::runtime_error("TrackStore: " + catName(cat) + " has no item I" + std::string(track_item) +
+                                 " with a field");
+    track_ = static_cast<FieldId>(plan_->items[track_item_].fields.first);
+
+    changed_items_.assign((plan_->items.size() + 63) / 64, 0);
+    changed_fields_.assign((plan_->fields.size() + 63) / 64, 0);
+}
+
+void TrackStore::decode(std::span<const uint8_t> bytes, CompactRecord& rec) const {
+    DecodeError err;
+    (void)codec_->decodeCompactRecord(bytes, *plan_, rec, nullptr, BorrowMode::Copy,
+                                      Validation::Mandatory, err, false);
+}
+
+// ─── Updates ──────────────────────────────────────────────────────────────────
+
+const TrackUpdate* TrackStore::update(const BlockView& block, size_t r) {
+    if (block.plan != plan_)
+        throw std::runtime_error("TrackStore: block not viewed with the " + catName(cat_) + " plan of this store");
+    const ViewRecord& vr = block.records.at(r);
+    const RecordView  view = block.record(r);
+    if (!vr.valid || !view.hasItem(sac_item_) || !view.hasItem(track_item_)) return nullptr;
+
+    const TrackKey key{static_cast<uint8_t>(view.field(sac_)), static_cast<uint8_t>(view.field(sic_)),
+                       static_cast<uint16_t>(view.field(track_))};
+    const std::span<const uint8_t>  bytes = view.bytes();
+    const std::span<const ItemSpan> spans{block.spans.data() + vr.spans_first, plan_->items.size()};
+    std::fill(changed_items_.begin(), changed_items_.end(), 0);
+    std::fill(changed_fields_.begin(), changed_fields_.end(), 0);
+    update_ = {key, false, nullptr, nullptr, changed_items_, changed_fields_};
+
+    const auto [it, inserted] = index_.try_emplace(key.packed(), static_cast<uint32_t>(tracks_.size()));
+    if (inserted) {
+        Track& t = tracks_.emplace_back();
+        t.key = key;
+        t.bytes.assign(bytes.begin(), bytes.end());
+        t.spans.assign(spans.begin(), spans.end());
+        decode(bytes, t.rec);
+        std::copy(t.rec.item_bits.begin(), t.rec.item_bits.end(), changed_items_.begin());
+        std::copy(t.rec.field_bits.begin(), t.rec.field_bits.end(), changed_fields_.begin());
+        update_.created = true;
+        update_.record  = &t.rec;
+        return &update_;
+    }
+
+    // Items whose bytes are the same are unchanged, fields and all.
+    Track& t = tracks_[it->second];
+    bool any = false;
+    for (ItemIndex idx = 0; idx < spans.size(); ++idx) {
+        const ItemSpan was = t.spans[idx];
+        const ItemSpan now = spans[idx];
+        if (was.length == now.length &&
+            (now.length == 0 || std::memcmp(t.bytes.data() + was.offset, bytes.data() + now.offset, now.length) == 0))
+            continue;
+        setBit(changed_items_, idx);
+        any = true;
+    }
+    if (!any && vr.variation == t.rec.variation) {
+        update_.record   = &t.rec;
+        update_.previous = &t.rec;
+        return &update_;
+    }
+
+    decode(bytes, scratch_);
+    for (ItemIndex idx = 0; idx < spans.size(); ++idx)
+        if (update_.itemChanged(idx)) diffFields(idx, t.rec, scratch_);
+    std::swap(t.rec, scratch_);
+    t.bytes.assign(bytes.begin(), bytes.end());
+    t.spans.assign(spans.begin(), spans.end());
+    update_.record   = &t.rec;
+    update_.previous = &scratch_;
+    return &update_;
+}
+
+void TrackStore::diffFields(ItemIndex idx, const CompactRecord& before, const CompactRecord& after) {
+    const CompactItemView was = before.item(idx);
+    const CompactItemView now = after.item(idx);
+    const size_t reps = std::max(was.repetitions(), now.repetitions());
+    const PlanRange range = plan_->items[idx].fields;
+    for (FieldId f = static_cast<FieldId>(range.first); f < range.end(); ++f) {
+        if (plan_->fields[f].item != idx) continue;
+        bool changed = before.has(f) != after.has(f) || before.field(f) != after.field(f);
+        if (!changed && reps > 1) {
+            changed = was.repetitions() != now.repetitions();
+            for (size_t rep = 1; !changed && rep < reps; ++rep)
+                changed = was.field(f, rep) != now.field(f, rep);
+        }
+        if (changed) setBit(changed_fields_, f);
+    }
+}
+
+// ─── Lookup ───────────────────────────────────────────────────────────────────
+
+const CompactRecord* TrackStore::find(TrackKey key) const {
+    const auto it = index_.find(key.packed());
+    return it == index_.end() ? nullptr : &tracks_[it->second].rec;
+}
+
+bool TrackStore::erase(TrackKey key) {
+    const auto it = index_.find(key.packed());
+    if (it == index_.end()) return false;
+    const uint32_t slot = it->second;
+    index_.erase(it);
+    if (slot + 1 != tracks_.size()) {
+        std::swap(tracks_[slot], tracks_.back());
+        index_[tracks_[slot].key.packed()] = slot;
+    }
+    tracks_.pop_back();
+    return true;
+}
+
+void TrackStore::clear() {
+    tracks_.clear();
+    index_.clear();
+}
+
+} // namespace asterix
@@ -0,0 +1,551 @@
+// Traffic.cpp – Target kinematics, report scheduling and record building for
+// TrafficGenerator.
+
+#include "ASTERIXCodec/Traffic.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace asterix {
+
+// What a bound field carries.  Physical quantities are computed in SI units
+// (m, m/s, m/s², s) or degrees, then converted to the element's unit / scale.
+enum class detail::TrafficQuantity : uint8_t {
+    Sac, Sic, TrackNumber, Mode3A, Address, Callsign, Detection, MessageType, // raw
+    TimeOfDay, Range, Azimuth, X, Y, Latitude, Longitude, GroundSpeed, Heading,
+    Vx, Vy, Ax, Ay, Altitude, Climb,
+    SectorAzimuth, RotationPeriod, SensorLatitude, SensorLongitude,
+};
+
+namespace {
+
+using Quantity = detail::TrafficQuantity;
+
+constexpr double kDay       = 86400.0;
+constexpr double kNm        = 1852.0;
+constexpr double kFt        = 0.3048;
+constexpr double kEarth     = 6371000.0; // m, spherical earth for WGS-84 items
+constexpr double kRateOne   = 3.0;       // deg/s, standard turn
+constexpr double kDegToRad  = std::numbers::pi / 180.0;
+
+// ─── Random stream (splitmix64) ───────────────────────────────────────────────
+
+uint64_t nextRandom(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+double uniform(uint64_t& state) noexcept { // [0, 1)
+    return static_cast<double>(nextRandom(state) >> 11) * 0x1p-53;
+}
+double uniform(uint64_t& state, double lo, double hi) noexcept {
+    return lo + (hi - lo) * uniform(state);
+}
+uint64_t randomBits(uint64_t& state, unsigned bits) noexcept {
+    return bits >= 64 ? nextRandom(state) : nextRandom(state) & ((uint64_t{1} << bits) - 1);
+}
+
+// ─── Field bindings per category ──────────────────────────────────────────────
+
+struct BindingDef {
+    uint8_t          cat;
+    std::string_view item;
+    std::string_view sub_item; // Compound sub-item, empty otherwise
+    std::string_view field;
+    Quantity         quantity;
+};
+
+// clang-format off
+constexpr BindingDef kBindings[] = {
+    {34, "010", "", "SAC", Quantity::Sac},
+    {34, "010", "", "SIC", Quantity::Sic},
+    {34, "000", "", "MT",  Quantity::MessageType},
+    {34, "030", "", "TOD", Quantity::TimeOfDay},
+    {34, "020", "", "SN",  Quantity::SectorAzimuth},
+    {34, "041", "", "ARS", Quantity::RotationPeriod},
+    {34, "120", "", "LAT", Quantity::SensorLatitude},
+    {34, "120", "", "LON", Quantity::SensorLongitude},
+
+    {48, "010", "", "SAC",    Quantity::Sac},
+    {48, "010", "", "SIC",    Quantity::Sic},
+    {48, "140", "", "TOD",    Quantity::TimeOfDay},
+    {48, "020", "", "TYP",    Quantity::Detection},
+    {48, "040", "", "RHO",    Quantity::Range},
+    {48, "040", "", "THETA",  Quantity::Azimuth},
+    {48, "070", "", "MODE3A", Quantity::Mode3A},
+    {48, "090", "", "FL",     Quantity::Altitude},
+    {48, "220", "", "ADR",    Quantity::Address},
+    {48, "240", "", "IDENT",  Quantity::Callsign},
+    {48, "161", "", "TRN",    Quantity::TrackNumber},
+    {48, "042", "", "X",      Quantity::X},
+    {48, "042", "", "Y",      Quantity::Y},
+    {48, "200", "", "GSP",    Quantity::GroundSpeed},
+    {48, "200", "", "HDG",    Quantity::Heading},
+
+    {62, "010", "",    "SAC",    Quantity::Sac},
+    {62, "010", "",    "SIC",    Quantity::Sic},
+    {62, "070", "",    "TOT",    Quantity::TimeOfDay},
+    {62, "105", "",    "LAT",    Quantity::Latitude},
+    {62, "105", "",    "LON",    Quantity::Longitude},
+    {62, "100", "",    "X",      Quantity::X},
+    {62, "100", "",    "Y",      Quantity::Y},
+    {62, "185", "",    "VX",     Quantity::Vx},
+    {62, "185", "",    "VY",     Quantity::Vy},
+    {62, "210", "",    "AX",     Quantity::Ax},
+    {62, "210", "",    "AY",     Quantity::Ay},
+    {62, "060", "",    "MODE3A", Quantity::Mode3A},
+    {62, "245", "",    "CHR",    Quantity::Callsign},
+    {62, "380", "ADR", "ADR",    Quantity::Address},
+    {62, "380", "ID",  "ID",     Quantity::Callsign},
+    {62, "380", "MHG", "MHG",    Quantity::Heading},
+    {62, "380", "GS",  "GS",     Quantity::GroundSpeed},
+    {62, "040", "",    "TN",     Quantity::TrackNumber},
+    {62, "136", "",    "MFL",    Quantity::Altitude},
+    {62, "130", "",    "ALT",    Quantity::Altitude},
+    {62, "135", "",    "CTB",    Quantity::Altitude},
+    {62, "220", "",    "ROCD",   Quantity::Climb},
+    {62, "340", "SID", "SAC",    Quantity::Sac},
+    {62, "340", "SID", "SIC",    Quantity::Sic},
+    {62, "340", "POS", "RHO",    Quantity::Range},
+    {62, "340", "POS", "THETA",  Quantity::Azimuth},
+};
+// clang-format on
+
+bool isRaw(Quantity q) noexcept { return q <= Quantity::MessageType; }
+bool wraps(Quantity q) noexcept {
+    return q == Quantity::TimeOfDay || q == Quantity::Azimuth || q == Quantity::Heading ||
+           q == Quantity::SectorAzimuth;
+}
+
+// Size of one element unit in SI units (degrees for angles).
+double unitSize(const ElementDef& e) {
+    static constexpr std::pair<std::string_view, double> kUnits[] = {
+        {"",     1.0},  {"m",  1.0},        {"NM",     kNm},     {"ft",  kFt},
+        {"FL",   100 * kFt}, {"m/s", 1.0},  {"kt",     kNm / 3600}, {"NM/s", kNm},
+        {"ft/min", kFt / 60}, {"deg", 1.0}, {"s",      1.0},     {"m/s2", 1.0},
+    };
+    for (const auto& [unit, size] : kUnits)
+        if (e.unit == unit) return size * e.scale;
+    throw std::runtime_error("TrafficGenerator: unit '" + e.unit + "' of " + e.name + " not supported");
+}
+
+// Representable raw values of e, two's complement for SignedQuantity.
+std::pair<double, double> rawRange(const ElementDef& e) noexcept {
+    if (e.encoding == Encoding::SignedQuantity)
+        return {-std::ldexp(1.0, e.bits - 1), std::ldexp(1.0, e.bits - 1) - 1};
+    return {0.0, std::ldexp(1.0, e.bits) - 1};
+}
+
+// Raw value of e for a value in LSBs: wrapped modulo the element's range
+// (angles, time of day) or clamped to it.
+uint64_t rawOf(const ElementDef& e, double lsbs, bool wrap) noexcept {
+    const uint64_t mask = e.bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << e.bits) - 1;
+    double v = std::round(lsbs);
+    if (!wrap) {
+        const auto [lo, hi] = rawRange(e);
+        v = std::clamp(v, lo, hi);
+    }
+    return static_cast<uint64_t>(static_cast<int64_t>(v)) & mask;
+}
+
+uint64_t toRaw(const ElementDef& e, double si, bool wrap) { return rawOf(e, si / unitSize(e), wrap); }
+
+// A value of e drawn from the spec: a table entry, a value within min / max,
+// or random bits.
+uint64_t fillValue(const ElementDef& e, uint64_t& rng) {
+    if (e.encoding == Encoding::Table && !e.table.empty()) {
+        auto it = e.table.begin();
+        std::advance(it, static_cast<std::ptrdiff_t>(nextRandom(rng) % e.table.size()));
+        return it->first;
+    }
+    if (e.has_range && (e.encoding == Encoding::UnsignedQuantity ||
+                        e.encoding == Encoding::SignedQuantity)) {
+        const auto [raw_lo, raw_hi] = rawRange(e);
+        const double lo = std::isfinite(e.min_val) ? e.min_val / e.scale : raw_lo;
+        const double hi = std::isfinite(e.max_val) ? e.max_val / e.scale : raw_hi;
+        return rawOf(e, uniform(rng, std::ceil(lo), std::floor(hi)), false);
+    }
+    return randomBits(rng, e.bits);
+}
+
+void fillElements(const std::vector<ElementDef>& elems, std::map<std::string, uint64_t>& out,
+                  uint64_t& rng) {
+    for (const auto& e : elems)
+        if (!e.is_spare) out[e.name] = fillValue(e, rng);
+}
+
+// Spec-driven values for one item (see Traffic.hpp).  bound: sub-items that
+// carry a binding, always present.
+void fillItem(const DataItemDef& def, DecodedItem& di, uint64_t& rng,
+              const std::vector<std::string_view>& bound) {
+    di.item_id = def.id;
+    di.type    = def.type;
+    const auto count = [&](size_t most) { return 1 + nextRandom(rng) % most; };
+
+    switch (def.type) {
+    case ItemType::Fixed:
+        fillElements(def.elements, di.fields, rng);
+        break;
+    case ItemType::Extended: {
+        const size_t octets = std::min(def.octets.size(), nextRandom(rng) % 4 == 0 ? size_t{2} : size_t{1});
+        for (size_t o = 0; o < octets; ++o) fillElements(def.octets[o].elements, di.fields, rng);
+        break;
+    }
+    case ItemType::Repetitive:
+        for (size_t i = count(3); i-- > 0;) di.repetitions.push_back(fillValue(def.rep_element, rng));
+        break;
+    case ItemType::RepetitiveGroup:
+    case ItemType::RepetitiveGroupFX:
+        for (size_t i = count(3); i-- > 0;)
+            fillElements(def.rep_group_elements, di.group_repetitions.emplace_back(), rng);
+        break;
+    case ItemType::Explicit:
+    case ItemType::SP:
+        for (size_t i = count(6); i-- > 0;) di.raw_bytes.push_back(static_cast<uint8_t>(nextRandom(rng)));
+        break;
+    case ItemType::Compound: {
+        for (const auto& si : def.compound_sub_items) {
+            if (si.name == "-") continue;
+            const bool is_bound = std::find(bound.begin(), bound.end(), si.name) != bound.end();
+            if (is_bound || nextRandom(rng) % 2 == 0) fillElements(si.elements, di.compound_sub_fields[si.name], rng);
+        }
+        if (di.compound_sub_fields.empty())
+            for (const auto& si : def.compound_sub_items)
+                if (si.name != "-") {
+                    fillElements(si.elements, di.compound_sub_fields[si.name], rng);
+                    break;
+                }
+        break;
+    }
+    }
+}
+
+const ElementDef* findElement(const std::vector<ElementDef>& elems, std::string_view name) {
+    for (const auto& e : elems)
+        if (!e.is_spare && e.name == name) return &e;
+    return nullptr;
+}
+
+const ElementDef* findElement(const DataItemDef& def, std::string_view sub_item, std::string_view name) {
+    if (!sub_item.empty()) {
+        for (const auto& si : def.compound_sub_items)
+            if (si.name == sub_item) return findElement(si.elements, name);
+        return nullptr;
+    }
+    if (const ElementDef* e = findElement(def.elements, name)) return e;
+    for (const auto& oct : def.octets)
+        if (const ElementDef* e = findElement(oct.elements, name)) return e;
+    return nullptr;
+}
+
+// ICAO 6-bit characters of a callsign, left-aligned and space-padded to 8.
+uint64_t icaoCallsign(std::string_view text) noexcept {
+    uint64_t out = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        const char c = i < text.size() ? text[i] : ' ';
+        const uint64_t code = (c >= 'A' && c <= 'Z') ? static_cast<uint64_t>(c - 'A' + 1)
+                                                     : static_cast<uint64_t>(c); // digits, space
+        out = (out << 6) | (code & 0x3F);
+    }
+    return out;
+}
+
+// Signed difference b − a of two bearings, in (−180, 180].
+double bearingDelta(double a, double b) noexcept {
+    double d = std::fmod(b - a, 360.0);
+    if (d <= -180) d += 360;
+    if (d > 180) d -= 360;
+    return d;
+}
+
+double azimuthOf(double x, double y) noexcept {
+    const double az = std::atan2(x, y) / kDegToRad;
+    return az < 0 ? az + 360 : az;
+}
+
+} // namespace
+
+// ─── Default item mixes ───────────────────────────────────────────────────────
+
+std::vector<TrafficItem> defaultTrafficItems(uint8_t cat) {
+    switch (cat) {
+    case 34:
+        return {{"010"}, {"000"}, {"030"}, {"020"}, {"041"},
+                {"050", 0.5}, {"060", 0.5}, {"070", 0.25}, {"120", 0.25}};
+    case 48:
+        return {{"010"}, {"140"}, {"020"}, {"040"}, {"070"}, {"090"}, {"161"}, {"042"}, {"200"}, {"170"},
+                {"220", 0.8}, {"240", 0.8}, {"230", 0.8}, {"130", 0.5}, {"250", 0.3}, {"030", 0.05}};
+    case 62:
+        return {{"010"}, {"015"}, {"070"}, {"105"}, {"100"}, {"185"}, {"060"}, {"040"}, {"080"},
+                {"290"}, {"200"}, {"136"}, {"135"}, {"220"}, {"340"},
+                {"245", 0.8}, {"380", 0.8}, {"295", 0.8}, {"210", 0.5}, {"130", 0.5}, {"500", 0.5},
+                {"390", 0.4}, {"510", 0.2}, {"270", 0.1}};
+    default:
+        throw std::runtime_error("TrafficGenerator: no traffic model for category " + std::to_string(cat));
+    }
+}
+
+// ─── Construction ─────────────────────────────────────────────────────────────
+
+TrafficGenerator::TrafficGenerator(const Codec& codec, TrafficOptions opts)
+    : codec_(&codec), opts_(std::move(opts)) {
+    const CategoryPlan&      plan = codec.plan(opts_.cat);
+    std::vector<TrafficItem> mix  = defaultTrafficItems(opts_.cat); // throws without a model
+    if (!opts_.items.empty()) mix = opts_.items;
+    if (opts_.targets == 0) throw std::runtime_error("TrafficGenerator: targets must be at least 1");
+    if (opts_.records_per_block == 0)
+        throw std::runtime_error("TrafficGenerator: records_per_block must be at least 1");
+    if (!(opts_.period > 0)) throw std::runtime_error("TrafficGenerator: period must be positive");
+
+    variation_ = *plan.variations[plan.default_variation].name;
+    const auto& uap = plan.def.uap_variations.at(variation_);
+    for (const auto& item : mix)
+        if (std::find(uap.begin(), uap.end(), item.id) == uap.end())
+            throw std::runtime_error("TrafficGenerator: item " + item.id + " is not in the UAP of category " +
+                                     std::to_string(opts_.cat));
+
+    targets_.resize(opts_.targets);
+    uint64_t rng = opts_.seed;
+    for (uint32_t i = 0; i < opts_.targets; ++i) {
+        Target& t = targets_[i];
+        t.index = i;
+        t.rng   = nextRandom(rng);
+        buildTarget(t, plan, mix);
+    }
+    const size_t most = std::min<size_t>(opts_.records_per_block, targets_.size());
+    block_.reserve(most);
+    batch_.reserve(most);
+    scan_.reserve(targets_.size());
+
+    period_start_ = opts_.start_time - opts_.period;
+    startPeriod();
+}
+
+void TrafficGenerator::buildTarget(Target& t, const CategoryPlan& plan, const std::vector<TrafficItem>& mix) {
+    static constexpr std::string_view kAirlines[] = {"AFR", "BAW", "DLH", "EZY", "RYR", "KLM",
+                                                     "SWR", "IBE", "AZA", "TAP", "SAS", "AUA"};
+    uint64_t& rng = t.rng;
+
+    // Kinematic state, uniform over the coverage disc (away from the sensor)
+    State& s = t.state;
+    const double r  = std::max(5 * kNm, opts_.max_range * std::sqrt(uniform(rng)));
+    const double az = uniform(rng, 0, 360) * kDegToRad;
+    s.x          = r * std::sin(az);
+    s.y          = r * std::cos(az);
+    s.heading    = uniform(rng, 0, 360);
+    s.speed      = uniform(rng, 70, 250);
+    s.altitude   = std::round(uniform(rng, 30, 400) / 10) * 1000 * kFt;
+    s.target_alt = s.altitude;
+    s.at         = opts_.start_time;
+
+    // Identity
+    t.address = static_cast<uint32_t>(((t.index + 1) * 0x5DEECDull ^ opts_.seed) & 0xFFFFFF);
+    t.callsign = icaoCallsign(std::string(kAirlines[nextRandom(rng) % std::size(kAirlines)]) +
+                              std::to_string(1 + nextRandom(rng) % 9999));
+    do t.squawk = static_cast<uint16_t>(randomBits(rng, 12));
+    while (t.squawk == 07500 || t.squawk == 07600 || t.squawk == 07700);
+
+    // Items: mandatory ones, then those of the mix whose share is above the draw
+    const double draw = uniform(rng);
+    DecodedRecord& rec = t.rec;
+    rec.uap_variation  = variation_;
+    std::vector<std::string_view> bound;
+    const auto carry = [&](const DataItemDef& def) {
+        if (rec.items.count(def.id)) return;
+        bound.clear();
+        for (const BindingDef& b : kBindings)
+            if (b.cat == opts_.cat && b.item == def.id && !b.sub_item.empty()) bound.push_back(b.sub_item);
+        fillItem(def, rec.items[def.id], rng, bound);
+    };
+    for (ItemIndex idx : plan.mandatory) carry(*plan.items[idx].def);
+    for (const auto& item : mix)
+        if (draw < item.share) carry(plan.def.items.at(item.id));
+    t.mode_s = rec.items.count(opts_.cat == 48 ? "220" : "380") != 0;
+
+    // Bindings into the record's value nodes (stable for the record's life)
+    for (const BindingDef& b : kBindings) {
+        if (b.cat != opts_.cat) continue;
+        auto it = rec.items.find(std::string(b.item));
+        if (it == rec.items.end()) continue;
+        const ElementDef* e = findElement(plan.def.items.at(it->first), b.sub_item, b.field);
+        if (!e) continue;
+        DecodedItem& di = it->second;
+        uint64_t* value;
+        if (b.sub_item.empty()) {
+            value = &di.fields[e->name];
+        } else {
+            auto sub = di.compound_sub_fields.find(std::string(b.sub_item));
+            if (sub == di.compound_sub_fields.end()) continue;
+            value = &sub->second[e->name];
+        }
+        if (!isRaw(b.quantity)) (void)unitSize(*e); // rejects a unit without a conversion
+        t.bindings.push_back({value, e, b.quantity});
+    }
+}
+
+// ─── Scheduling ───────────────────────────────────────────────────────────────
+
+void TrafficGenerator::startPeriod() {
+    period_start_ += opts_.period;
+    scan_.clear();
+    cursor_ = 0;
+    const double n = static_cast<double>(targets_.size());
+    for (const Target& t : targets_) {
+        double at = period_start_;
+        if (opts_.cat == 48)
+            at += azimuthOf(t.state.x, t.state.y) / 360 * opts_.period;
+        else if (opts_.cat == 34)
+            at += t.index / n * opts_.period;
+        scan_.emplace_back(at, t.index);
+    }
+    if (opts_.cat == 48) std::sort(scan_.begin(), scan_.end());
+}
+
+double TrafficGenerator::nextTime() const noexcept { return scan_[cursor_].first; }
+
+uint32_t TrafficGenerator::advance() {
+    const auto [at, index] = scan_[cursor_++];
+    time_ = at;
+    Target& t = targets_[index];
+    move(t, at);
+    update(t);
+    ++records_;
+    if (cursor_ == scan_.size()) startPeriod();
+    return index;
+}
+
+const DecodedRecord& TrafficGenerator::next() { return targets_[advance()].rec; }
+
+// ─── Kinematics ───────────────────────────────────────────────────────────────
+
+void TrafficGenerator::move(Target& t, double to) const {
+    State& s = t.state;
+    const double dt = to - s.at;
+    if (opts_.cat == 34 || dt <= 0) {
+        s.at = std::max(s.at, to);
+        return;
+    }
+    uint64_t& rng = t.rng;
+
+    // Turns: back inside max_range, else now and then a rate-one turn
+    const double range = std::hypot(s.x, s.y);
+    if (range > opts_.max_range) {
+        const double inbound = bearingDelta(s.heading, azimuthOf(-s.x, -s.y));
+        s.turn_rate = std::abs(inbound) < 10 ? 0 : std::copysign(kRateOne, inbound);
+    } else if (uniform(rng) < dt / 90) {
+        s.turn_rate = s.turn_rate != 0 ? 0 : (nextRandom(rng) % 2 ? kRateOne : -kRateOne);
+    }
+
+    // Climbs and descents between flight levels
+    if (std::abs(s.target_alt - s.altitude) < 1) {
+        s.altitude = s.target_alt;
+        s.climb    = 0;
+        if (uniform(rng) < dt / 600) {
+            s.target_alt = std::round(uniform(rng, 30, 400) / 10) * 1000 * kFt;
+            s.climb = std::copysign(uniform(rng, 1000, 2500) * kFt / 60, s.target_alt - s.altitude);
+        }
+    }
+    const double climbed = s.climb * dt;
+    s.altitude = std::abs(climbed) >= std::abs(s.target_alt - s.altitude) ? s.target_alt : s.altitude + climbed;
+
+    // Constant speed along a straight line or a circular arc
+    const double h0 = s.heading * kDegToRad;
+    const double w  = s.turn_rate * kDegToRad;
+    if (w == 0) {
+        s.x += s.speed * dt * std::sin(h0);
+        s.y += s.speed * dt * std::cos(h0);
+    } else {
+        const double h1 = h0 + w * dt;
+        s.x += s.speed / w * (std::cos(h0) - std::cos(h1));
+        s.y += s.speed / w * (std::sin(h1) - std::sin(h0));
+        s.heading = std::fmod(s.heading + s.turn_rate * dt + 360, 360);
+    }
+    s.at = to;
+}
+
+void TrafficGenerator::update(Target& t) const {
+    const State& s   = t.state;
+    const double h   = s.heading * kDegToRad;
+    const double w   = s.turn_rate * kDegToRad;
+    const double lat = opts_.latitude * kDegToRad;
+
+    for (const Binding& b : t.bindings) {
+        const ElementDef& e = *b.element;
+        const uint64_t mask = e.bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << e.bits) - 1;
+        double si = 0;
+        switch (b.quantity) {
+        case Quantity::Sac:         *b.value = opts_.sac; continue;
+        case Quantity::Sic:         *b.value = opts_.sic; continue;
+        case Quantity::TrackNumber: *b.value = (t.index + 1) & mask; continue;
+        case Quantity::Mode3A:      *b.value = t.squawk & mask; continue;
+        case Quantity::Address:     *b.value = t.address & mask; continue;
+        case Quantity::Callsign:    *b.value = t.callsign & mask; continue;
+        case Quantity::Detection:   *b.value = t.mode_s ? 5 : 2; continue; // Mode S Roll-Call / SSR
+        case Quantity::MessageType: *b.value = t.index == 0 ? 1 : 2; continue; // north marker / sector
+        case Quantity::TimeOfDay:   si = std::fmod(time_, kDay); break;
+        case Quantity::Range:       si = std::hypot(s.x, s.y); break;
+        case Quantity::Azimuth:     si = azimuthOf(s.x, s.y); break;
+        case Quantity::X:           si = s.x; break;
+        case Quantity::Y:           si = s.y; break;
+        case Quantity::Latitude:    si = opts_.latitude + s.y / kEarth / kDegToRad; break;
+        case Quantity::Longitude:   si = opts_.longitude + s.x / (kEarth * std::cos(lat)) / kDegToRad; break;
+        case Quantity::GroundSpeed: si = s.speed; break;
+        case Quantity::Heading:     si = s.heading; break;
+        case Quantity::Vx:          si = s.speed * std::sin(h); break;
+        case Quantity::Vy:          si = s.speed * std::cos(h); break;
+        case Quantity::Ax:          si = s.speed * w * std::cos(h); break;
+        case Quantity::Ay:          si = -s.speed * w * std::sin(h); break;
+        case Quantity::Altitude:    si = s.altitude; break;
+        case Quantity::Climb:       si = s.climb; break;
+        case Quantity::SectorAzimuth:   si = 360.0 * t.index / static_cast<double>(targets_.size()); break;
+        case Quantity::RotationPeriod:  si = opts_.period; break;
+        case Quantity::SensorLatitude:  si = opts_.latitude; break;
+        case Quantity::SensorLongitude: si = opts_.longitude; break;
+        }
+        *b.value = toRaw(e, si, wraps(b.quantity));
+    }
+}
+
+// ─── Blocks ───────────────────────────────────────────────────────────────────
+
+template <class Encode>
+void TrafficGenerator::encodeNext(Encode&& encode) {
+    const size_t n = std::min(opts_.records_per_block, scan_.size() - cursor_);
+    block_.resize(n);
+    batch_.clear();
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t index = advance();
+        block_[i].uap_variation = variation_;
+        block_[i].items.swap(targets_[index].rec.items);
+        batch_.push_back(index);
+    }
+    const auto restore = [&] {
+        for (size_t i = 0; i < n; ++i) block_[i].items.swap(targets_[batch_[i]].rec.items);
+    };
+    try {
+        encode(block_);
+    } catch (...) {
+        restore();
+        throw;
+    }
+    restore();
+    ++blocks_;
+}
+
+size_t TrafficGenerator::nextBlock(std::span<uint8_t> out) {
+    size_t length = 0;
+    encodeNext([&](const std::vector<DecodedRecord>& recs) { length = codec_->encodeInto(opts_.cat, recs, out); });
+    return length;
+}
+
+void TrafficGenerator::nextBlock(std::vector<uint8_t>& out) {
+    encodeNext([&](const std::vector<DecodedRecord>& recs) { codec_->encodeAppend(opts_.cat, recs, out); });
+}
+
+} // namespace asterix
@@ -0,0 +1,87 @@
+// View.cpp – Lazy field extraction for ItemView.
+//
+// Every accessor re-walks the item's own bytes with a probe sink (see
+// Walker.hpp) that keeps only the value asked for; the rest of the record is
+// never touched.
+
+#include "ASTERIXCodec/View.hpp"
+#include "Walker.hpp"
+
+namespace asterix {
+
+namespace {
+
+// Captures one field value: `rep` selects the repetition for group / REP
+// items and must be 0 otherwise.
+struct FieldProbe {
+    FieldId  want;
+    size_t   rep;
+    size_t   groups{0}; // RepetitiveGroup[FX] repetitions started
+    size_t   reps{0};   // Repetitive values seen
+    bool     found{false};
+    uint64_t value{0};
+
+    void field(const PlanElement& e, uint64_t raw) {
+        if (found || e.field != want) return;
+        if (groups == 0 ? rep != 0 : groups != rep + 1) return;
+        found = true;
+        value = raw;
+    }
+    void repetition(const PlanElement& e, uint64_t raw) {
+        if (!found && e.field == want && reps == rep) {
+            found = true;
+            value = raw;
+        }
+        ++reps;
+    }
+    void beginGroup() { ++groups; }
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t>) {}
+};
+
+} // namespace
+
+static FieldProbe probe(const CategoryPlan& plan, ItemIndex idx,
+                        std::span<const uint8_t> bytes, FieldId id, size_t rep) {
+    FieldProbe p{id, rep};
+    if (bytes.empty() || id >= plan.fields.size() || plan.fields[id].item != idx) return p;
+    size_t consumed = 0;
+    DecodeError err; // bytes were measured by Codec::view()
+    (void)detail::walkItem(plan, plan.items[idx], bytes, consumed, p, err);
+    return p;
+}
+
+bool ItemView::has(FieldId id) const {
+    return probe(*plan_, idx_, bytes_, id, 0).found;
+}
+
+uint64_t ItemView::field(FieldId id) const {
+    return probe(*plan_, idx_, bytes_, id, 0).value;
+}
+
+uint64_t ItemView::field(FieldId id, size_t rep) const {
+    return probe(*plan_, idx_, bytes_, id, rep).value;
+}
+
+size_t ItemView::repetitions() const {
+    if (bytes_.empty()) return 0;
+    const PlanItem& item = plan_->items[idx_];
+    switch (item.type) {
+    case ItemType::Repetitive:        return bytes_.size();
+    case ItemType::RepetitiveGroup:   return bytes_[0];
+    case ItemType::RepetitiveGroupFX: return bytes_.size() / item.group_bytes;
+    default:                          return 0;
+    }
+}
+
+uint64_t ItemView::repetition(size_t rep) const {
+    if (rep >= bytes_.size() || plan_->items[idx_].type != ItemType::Repetitive) return 0;
+    return (bytes_[rep] >> 1) & 0x7Fu; // top 7 bits; bit 0 is FX
+}
+
+std::span<const uint8_t> ItemView::payload() const noexcept {
+    if (bytes_.empty() || plan_->items[idx_].type != ItemType::SP) return {};
+    return bytes_.subspan(1);
+}
+
+} // namespace asterix
@@ -0,0 +1,551 @@
+#pragma once
+// Walker.hpp – Plan-driven traversal of ASTERIX items and records (internal).
+//
+// walkItem() applies the per-type length rules of a Data Item and reports
+// every leaf value to an item sink; walkRecord() does the same for a whole
+// record (FSPEC, UAP slots, discriminator, mandatory check).  Each decoded
+// representation – the std::map-based DecodedRecord, the interned
+// CompactRecord – is just a different sink, so the wire rules live in one
+// place.  Nothing here throws: a length-rule violation is returned as a
+// DecodeError (see DecodeError.hpp) and turned into text only by the caller.
+//
+// Item sink:
+//   void field(const PlanElement& e, uint64_t raw);      // Fixed / Extended / group / sub-item leaf
+//   void repetition(const PlanElement& e, uint64_t raw); // one Repetitive (FX) value
+//   void beginGroup();                                   // next RepetitiveGroup[FX] repetition
+//   void beginSubItem(const PlanSubItem& si);            // Compound sub-item follows
+//   void payload(std::span<const uint8_t> bytes);        // Explicit / SP payload
+//
+// Record sink:
+//   bool      decodes(ItemIndex idx);                    // false → item is only measured
+//   ItemSink& beginItem(ItemIndex idx, const PlanItem& item);
+//   void      endItem(ItemIndex idx, std::span<const uint8_t> item_bytes);
+//   void      variation(uint16_t var);                   // resolved UAP variation
+//   void      invalid(const DecodeError& fault);         // MandatoryMissing / OutOfRange
+
+#include "ASTERIXCodec/BitStream.hpp"
+#include "ASTERIXCodec/DecodeError.hpp"
+#include "ASTERIXCodec/Plan.hpp"
+#include "ASTERIXCodec/Projection.hpp"
+#include "Counters.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+namespace asterix::detail {
+
+// ─── UAP selection ────────────────────────────────────────────────────────────
+
+// Read the discriminator field straight from the discriminator item's bytes
+// and map it to a variation index.  Falls back to the default variation when
+// the field lies beyond the octets actually present or the value is unmapped.
+inline uint16_t resolveVariation(const CategoryPlan& plan,
+                                 std::span<const uint8_t> item_bytes) {
+    const PlanUapCase& uc = *plan.uap_case;
+    if (static_cast<size_t>(uc.bit_offset) + uc.bits > item_bytes.size() * 8)
+        return plan.default_variation;
+
+    BitReader br{item_bytes};
+    br.skipUnchecked(uc.bit_offset); // range checked above
+    const uint64_t value = br.readUnchecked(uc.bits);
+
+    for (const auto& [v, var] : uc.value_to_variation)
+        if (v == value) return var;
+    return plan.default_variation;
+}
+
+// ─── Item-level traversal ─────────────────────────────────────────────────────
+
+// Record a length-rule violation; returns false (0 for the measuring paths).
+inline bool fail(DecodeError& err, DecodeErrc code, uint16_t sub = 0) noexcept {
+    err.code = code;
+    err.sub  = sub;
+    return false;
+}
+
+// Report a packed element range to the sink.  Spares are skipped.
+// br must cover the whole range: the caller checks the item length, and
+// compilePlan() guarantees that every range fits its octet / group / item.
+template <class Sink>
+void walkElements(const CategoryPlan& plan, PlanRange range, BitReader& br, Sink& sink) {
+    for (uint32_t i = range.first; i < range.end(); ++i) {
+        const PlanElement& e = plan.elements[i];
+        if (e.is_spare) {
+            br.skipUnchecked(e.bits);
+            continue;
+        }
+        sink.field(e, br.readUnchecked(e.bits));
+    }
+}
+
+// Walk one item starting at item_buf[0]; sets consumed to its byte length.
+// Returns false with err.code (and err.sub) set if the bytes break the item's
+// length rules; the sink may then have seen part of the item.
+template <class Sink>
+bool walkItem(const CategoryPlan& plan, const PlanItem& item,
+              std::span<const uint8_t> item_buf, size_t& consumed, Sink& sink,
+              DecodeError& err) {
+    switch (item.type) {
+
+    // ── Fixed ─────────────────────────────────────────────────────────────
+    case ItemType::Fixed: {
+        if (item_buf.size() < item.fixed_bytes)
+            return fail(err, DecodeErrc::FixedTruncated);
+        BitReader br{item_buf.subspan(0, item.fixed_bytes)};
+        walkElements(plan, item.elements, br, sink);
+        consumed = item.fixed_bytes;
+        break;
+    }
+
+    // ── Extended ──────────────────────────────────────────────────────────
+    case ItemType::Extended: {
+        // Read octets until FX=0.  Each raw octet = 7 data bits + 1 FX bit.
+        size_t offset = 0;
+        for (size_t oct_idx = 0; ; ++oct_idx) {
+            if (offset >= item_buf.size())
+                return fail(err, DecodeErrc::ExtendedTruncated);
+            uint8_t raw_byte = item_buf[offset];
+            bool    fx       = (raw_byte & 0x01u) != 0;
+            ++offset;
+
+            if (oct_idx < item.octets.count) {
+                // Wrap this single byte in a reader (7 data bits; FX not reported)
+                BitReader br{item_buf.subspan(offset - 1, 1)};
+                walkElements(plan, plan.octets[item.octets.first + oct_idx], br, sink);
+            }
+            // Octets beyond the spec definition are skipped but honour FX
+            if (!fx) break;
+        }
+        consumed = offset;
+        break;
+    }
+
+    // ── Repetitive FX ─────────────────────────────────────────────────────
+    case ItemType::Repetitive: {
+        const PlanElement& e = plan.elements[item.elements.first];
+        size_t offset = 0;
+        do {
+            if (offset >= item_buf.size())
+                return fail(err, DecodeErrc::RepetitiveTruncated);
+            uint8_t raw_byte = item_buf[offset++];
+            bool    fx       = (raw_byte & 0x01u) != 0;
+            sink.repetition(e, (raw_byte >> 1) & 0x7Fu); // top 7 bits
+            if (!fx) break;
+        } while (true);
+        consumed = offset;
+        break;
+    }
+
+    // ── Repetitive count-prefixed (structured group) ───────────────────────
+    case ItemType::RepetitiveGroup: {
+        if (item_buf.empty())
+            return fail(err, DecodeErrc::GroupCountTruncated);
+        uint8_t rep_count   = item_buf[0];
+        size_t  group_bytes = item.group_bytes;
+        size_t  total_need  = 1 + static_cast<size_t>(rep_count) * group_bytes;
+        if (item_buf.size() < total_need)
+            return fail(err, DecodeErrc::GroupTruncated);
+
+        size_t offset = 1;
+        for (uint8_t i = 0; i < rep_count; ++i) {
+            sink.beginGroup();
+            BitReader br{item_buf.subspan(offset, group_bytes)};
+            walkElements(plan, item.elements, br, sink);
+            offset += group_bytes;
+        }
+        consumed = total_need;
+        break;
+    }
+
+    // ── Repetitive FX with structured group ───────────────────────────────
+    // Each group is (rep_group_bits + 1) / 8 bytes wide.
+    // The last bit of each group is the FX flag (1 = more groups follow).
+    case ItemType::RepetitiveGroupFX: {
+        size_t group_bytes = item.group_bytes;
+        size_t offset = 0;
+        do {
+            if (offset + group_bytes > item_buf.size())
+                return fail(err, DecodeErrc::GroupFXTruncated);
+            sink.beginGroup();
+            BitReader br{item_buf.subspan(offset, group_bytes)};
+            walkElements(plan, item.elements, br, sink);
+            bool fx = br.readUnchecked(1) != 0; // FX is the last bit of the group
+            offset += group_bytes;
+            if (!fx) break;
+        } while (true);
+        consumed = offset;
+        break;
+    }
+
+    // ── Explicit / SP ─────────────────────────────────────────────────────
+    case ItemType::SP: {
+        if (item_buf.empty())
+            return fail(err, DecodeErrc::ExplicitEmpty);
+        uint8_t len = item_buf[0]; // first byte = payload length (including itself per ASTERIX spec)
+        // len field includes itself: payload = len-1 bytes
+        if (len < 1 || item_buf.size() < static_cast<size_t>(len))
+            return fail(err, DecodeErrc::ExplicitLength);
+        sink.payload(item_buf.subspan(1, len - 1u));
+        consumed = len;
+        break;
+    }
+
+    // ── Compound ──────────────────────────────────────────────────────────
+    // Wire format: PSF byte(s) [same FX-extension as outer FSPEC] followed by
+    // the fixed-size payload of each sub-item whose PSF slot bit is set.
+    // PSF bit mapping: bit 7 = sub-item 0, bit 6 = sub-item 1, … bit 1 = sub-item 6.
+    // bit 0 of each PSF byte is the FX continuation flag.
+    case ItemType::Compound: {
+        // Walk PSF byte(s) in place
+        size_t offset = 0;
+        do {
+            if (offset >= item_buf.size())
+                return fail(err, DecodeErrc::PsfTruncated);
+        } while (item_buf[offset++] & 0x01u); // FX=1 means more PSF bytes follow
+        const size_t psf_len = offset;
+
+        // Decode each sub-item whose PSF slot is set
+        for (uint32_t slot = 0; slot < item.sub_items.count; ++slot) {
+            const PlanSubItem& si = plan.sub_items[item.sub_items.first + slot];
+            size_t psf_byte = slot / 7;
+            size_t psf_bit  = 7 - (slot % 7); // bit 7 = slot 0, bit 1 = slot 6
+            bool   present  = (psf_byte < psf_len) &&
+                              ((item_buf[psf_byte] >> psf_bit) & 0x01u);
+            if (!present || si.unused) continue;
+
+            if (offset + si.fixed_bytes > item_buf.size())
+                return fail(err, DecodeErrc::SubItemTruncated, static_cast<uint16_t>(slot));
+            sink.beginSubItem(si);
+            BitReader br{item_buf.subspan(offset, si.fixed_bytes)};
+            walkElements(plan, si.elements, br, sink);
+            offset += si.fixed_bytes;
+        }
+        consumed = offset;
+        break;
+    }
+
+    default:
+        return fail(err, DecodeErrc::UnsupportedType);
+    }
+    return true;
+}
+
+// ─── Length-only traversal ────────────────────────────────────────────────────
+
+// Byte length of one item starting at item_buf[0], applying the same length
+// rules (and reporting the same errors) as walkItem() without reading values.
+// Returns 0 on error (every item is at least one byte long).
+inline size_t measureItem(const CategoryPlan& plan, const PlanItem& item,
+                          std::span<const uint8_t> item_buf, DecodeError& err) {
+
+    switch (item.type) {
+
+    case ItemType::Fixed:
+        if (item_buf.size() < item.fixed_bytes)
+            return fail(err, DecodeErrc::FixedTruncated);
+        return item.fixed_bytes;
+
+    case ItemType::Extended:
+    case ItemType::Repetitive: {
+        // FX chain: one octet per step, FX = bit 0
+        size_t offset = 0;
+        do {
+            if (offset >= item_buf.size())
+                return fail(err, item.type == ItemType::Extended
+                                     ? DecodeErrc::ExtendedTruncated
+                                     : DecodeErrc::RepetitiveTruncated);
+        } while (item_buf[offset++] & 0x01u);
+        return offset;
+    }
+
+    case ItemType::RepetitiveGroup: {
+        if (item_buf.empty())
+            return fail(err, DecodeErrc::GroupCountTruncated);
+        const size_t total_need = 1 + static_cast<size_t>(item_buf[0]) * item.group_bytes;
+        if (item_buf.size() < total_need)
+            return fail(err, DecodeErrc::GroupTruncated);
+        return total_need;
+    }
+
+    case ItemType::RepetitiveGroupFX: {
+        // FX is the last bit of each group, i.e. bit 0 of its last byte
+        size_t offset = 0;
+        do {
+            if (offset + item.group_bytes > item_buf.size())
+                return fail(err, DecodeErrc::GroupFXTruncated);
+            offset += item.group_bytes;
+        } while (item_buf[offset - 1] & 0x01u);
+        return offset;
+    }
+
+    case ItemType::SP: {
+        if (item_buf.empty())
+            return fail(err, DecodeErrc::ExplicitEmpty);
+        const uint8_t len = item_buf[0];
+        if (len < 1 || item_buf.size() < static_cast<size_t>(len))
+            return fail(err, DecodeErrc::ExplicitLength);
+        return len;
+    }
+
+    case ItemType::Compound: {
+        size_t offset = 0;
+        do {
+            if (offset >= item_buf.size())
+                return fail(err, DecodeErrc::PsfTruncated);
+        } while (item_buf[offset++] & 0x01u);
+        const size_t psf_len = offset;
+
+        for (uint32_t slot = 0; slot < item.sub_items.count && slot / 7 < psf_len; ++slot) {
+            const PlanSubItem& si = plan.sub_items[item.sub_items.first + slot];
+            if (si.unused || !((item_buf[slot / 7] >> (7 - slot % 7)) & 0x01u)) continue;
+            if (offset + si.fixed_bytes > item_buf.size())
+                return fail(err, DecodeErrc::SubItemTruncated, static_cast<uint16_t>(slot));
+            offset += si.fixed_bytes;
+        }
+        return offset;
+    }
+
+    default:
+        return fail(err, DecodeErrc::UnsupportedType);
+    }
+}
+
+// Item sink that ignores everything (for record sinks that only measure items).
+struct SkipItemSink {
+    void field(const PlanElement&, uint64_t) {}
+    void repetition(const PlanElement&, uint64_t) {}
+    void beginGroup() {}
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t>) {}
+};
+
+// Checks leaf values against the item's PlanLimits (Validation::Full); the
+// first value out of range is kept in fault.
+struct LimitItemSink {
+    const CategoryPlan& plan;
+    const PlanItem&     item;
+    DecodeError         fault;
+
+    void field(const PlanElement& e, uint64_t raw) {
+        if (fault) return;
+        const auto element = static_cast<uint32_t>(&e - plan.elements.data());
+        for (uint32_t i = item.limits.first; i < item.limits.end(); ++i) {
+            const PlanLimit& l = plan.limits[i];
+            if (l.element != element) continue;
+            const int64_t v = l.is_signed && e.bits < 64 && ((raw >> (e.bits - 1)) & 1u)
+                                  ? static_cast<int64_t>(raw | (~uint64_t{0} << e.bits))
+                                  : static_cast<int64_t>(raw);
+            if (v < l.lo || v > l.hi) {
+                fault.code  = DecodeErrc::OutOfRange;
+                fault.sub   = e.field;
+                fault.value = static_cast<uint32_t>(raw);
+            }
+            return;
+        }
+    }
+    void repetition(const PlanElement& e, uint64_t raw) { field(e, raw); }
+    void beginGroup() {}
+    void beginSubItem(const PlanSubItem&) {}
+    void payload(std::span<const uint8_t>) {}
+};
+
+// ─── FSPEC ────────────────────────────────────────────────────────────────────
+
+// The presence octets at the start of a record, walked in place.
+// Slot k (0-based) is bit 7 - k % 7 of octet k / 7; bit 0 of each octet is FX.
+struct Fspec {
+    std::span<const uint8_t> bytes;
+
+    [[nodiscard]] bool present(size_t slot) const noexcept {
+        return slot / 7 < bytes.size() && ((bytes[slot / 7] >> (7 - slot % 7)) & 0x01u) != 0;
+    }
+};
+
+// FSPEC of the record at buf[0]: up to and including the first octet with
+// FX = 0, or all of buf if every octet has FX set.
+inline Fspec readFspec(std::span<const uint8_t> buf) noexcept {
+    size_t n = 0;
+    while (n < buf.size())
+        if ((buf[n++] & 0x01u) == 0) break; // FX=0 → last FSPEC byte
+    return {buf.first(n)};
+}
+
+// The present, occupied slots of a record, in UAP order, read octet by octet
+// through the variation's dispatch table (PlanVariation::dispatch): no slot
+// is tested on its own.  FSPEC bits past the variation's slots are ignored.
+class SlotCursor {
+public:
+    SlotCursor(const PlanVariation& uap, Fspec fspec) noexcept : uap_(&uap), fspec_(fspec) {
+        load(0);
+    }
+
+    // Next present slot; false at the end of the FSPEC.
+    bool next(PlanSlot& out) noexcept {
+        while (i_ == end_) {
+            if (octet_ + 1 >= fspec_.bytes.size() || octet_ + 1 >= uap_->octets()) return false;
+            load(octet_ + 1);
+        }
+        out  = uap_->dispatch_slots[i_++];
+        last_ = out.slot;
+        return true;
+    }
+
+    // Carry on after the slot just returned with another variation.
+    void switchTo(const PlanVariation& uap) noexcept {
+        uap_ = &uap;
+        const unsigned after = (fspec_.bytes[octet_] >> 1) & ((1u << (6 - last_ % 7)) - 1);
+        range(after);
+    }
+
+private:
+    const PlanVariation* uap_;
+    Fspec    fspec_;
+    size_t   octet_{0};
+    uint32_t i_{0}, end_{0};
+    uint16_t last_{0};
+
+    void load(size_t octet) noexcept {
+        octet_ = octet;
+        range(fspec_.bytes.empty() ? 0u : fspec_.bytes[octet] >> 1);
+    }
+    void range(unsigned bits) noexcept {
+        if (octet_ >= uap_->octets()) {
+            i_ = end_ = 0;
+            return;
+        }
+        const PlanRange r = uap_->dispatch[octet_ * 128 + bits];
+        i_   = r.first;
+        end_ = r.end();
+    }
+};
+
+// Variation of a record whose discriminator is not in the leading slots
+// (PlanUapCase::leading false): the first candidate, default one first, whose
+// discriminator – located by measuring the items before it with the
+// candidate's slots – selects the candidate itself.
+inline uint16_t presetVariation(const CategoryPlan& plan, std::span<const uint8_t> buf,
+                                Fspec fspec) noexcept {
+    const PlanUapCase& uc = *plan.uap_case;
+    const auto selects = [&](uint16_t var) {
+        if (uc.slots[var] == PlanUapCase::kAbsent) return false;
+        SlotCursor cursor{plan.variations[var], fspec};
+        size_t   pos = fspec.bytes.size();
+        PlanSlot s;
+        while (cursor.next(s) && s.slot <= uc.slots[var]) {
+            if (s.item == kUnknownItem) return false;
+            DecodeError err;
+            const size_t len = measureItem(plan, plan.items[s.item], buf.subspan(pos), err);
+            if (len == 0) return false;
+            if (s.item == uc.item) return resolveVariation(plan, buf.subspan(pos, len)) == var;
+            pos += len;
+        }
+        return false; // absent from this record
+    };
+    if (selects(plan.default_variation)) return plan.default_variation;
+    for (size_t i = 0; i < uc.value_to_variation.size(); ++i) {
+        const uint16_t var = uc.value_to_variation[i].second;
+        bool tried = var == plan.default_variation;
+        for (size_t j = 0; j < i && !tried; ++j) tried = uc.value_to_variation[j].second == var;
+        if (!tried && selects(var)) return var;
+    }
+    return plan.default_variation;
+}
+
+// ─── Record-level traversal ───────────────────────────────────────────────────
+
+// With several UAPs, the variation comes from the discriminator item (see
+// PlanUapCase).  CAT01's I010 and I020 sit in slots 1 and 2 of both
+// variations, so the walk starts with the default variation and switches
+// after I020; for a discriminator further in, the variation is settled first
+// (presetVariation()) and the record walked once with it.  The resolved
+// variation is reported to the sink for the caller's use.
+//
+// validation selects the record-level checks reported to sink.invalid()
+// (Mandatory: missing mandatory items; Full: also values out of range).
+//
+// Returns the number of bytes consumed, or 0 with err set (err.item = failing
+// item, err.offset = its position in buf).  An empty buffer also returns 0.
+template <class RecordSink>
+size_t walkRecord(const CategoryPlan& plan, std::span<const uint8_t> buf, RecordSink& sink,
+                  DecodeError& err, Validation validation = Validation::Mandatory) {
+    if (buf.empty()) return 0;
+
+    // ── Step 1: Read FSPEC ──────────────────────────────────────────────────
+    const Fspec fspec = readFspec(buf);
+    size_t pos = fspec.bytes.size();
+
+    // ── Step 2: UAP variation ────────────────────────────────────────────────
+    // The default one, switched after the discriminator item when it sits in
+    // the leading slots; otherwise resolved up front.
+    uint16_t  variation     = plan.default_variation;
+    ItemIndex discriminator = kNoItem;
+    if (plan.uap_case) {
+        if (plan.uap_case->leading) discriminator = plan.uap_case->item;
+        else variation = presetVariation(plan, buf, fspec);
+    }
+    SlotCursor cursor{plan.variations[variation], fspec};
+
+    // Item-index presence, for the mandatory check below
+    std::bitset<kMaxPlanItems> seen;
+
+    // ── Step 3: Decode the present items in UAP order ────────────────────────
+    PlanSlot s;
+    while (cursor.next(s)) {
+        const ItemIndex idx = s.item;
+
+        if (idx == kUnknownItem) {
+            err.code   = DecodeErrc::UnknownItem;
+            err.sub    = s.slot;
+            err.value  = variation;
+            err.offset = static_cast<uint32_t>(pos);
+            return 0;
+        }
+
+        const PlanItem& item = plan.items[idx];
+        size_t item_consumed = 0;
+        const bool decoded = sink.decodes(idx);
+        const bool ok = decoded
+            ? walkItem(plan, item, buf.subspan(pos), item_consumed, sink.beginItem(idx, item), err)
+            : (item_consumed = measureItem(plan, item, buf.subspan(pos), err)) != 0;
+        if (!ok) {
+            err.item   = idx;
+            err.offset = static_cast<uint32_t>(pos);
+            return 0;
+        }
+        const auto item_bytes = buf.subspan(pos, item_consumed);
+        sink.endItem(idx, item_bytes);
+        if constexpr (kMetricsEnabled)
+            if (decoded && plan.counters) plan.counters->item(idx);
+        if (validation == Validation::Full && item.limits.count != 0) {
+            LimitItemSink limits{plan, item, {}};
+            size_t        len = 0;
+            DecodeError   unused;
+            (void)walkItem(plan, item, item_bytes, len, limits, unused); // lengths known good
+            if (limits.fault) {
+                limits.fault.item = idx;
+                sink.invalid(limits.fault);
+            }
+        }
+
+        // After the discriminator item, carry on with the variation it
+        // selects (the slots so far are the same in every variation).
+        if (idx == discriminator) {
+            variation = resolveVariation(plan, item_bytes);
+            cursor.switchTo(plan.variations[variation]);
+        }
+
+        pos += item_consumed;
+        seen[idx] = true;
+    }
+    sink.variation(variation);
+
+    // ── Step 4: Mandatory item validation ────────────────────────────────────
+    if (validation != Validation::Structural && (plan.mandatory_mask & ~seen).any())
+        for (ItemIndex idx : plan.mandatory)
+            if (!seen[idx]) sink.invalid({DecodeErrc::MandatoryMissing, idx});
+
+    return pos;
+}
+
+} // namespace asterix::detail
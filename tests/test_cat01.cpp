@@ -4,15 +4,22 @@
 //   cmake -B build && cmake --build build
 //   ./build/test_cat01
 
+#include "ASTERIXCodec/BitStream.hpp"
 #include "ASTERIXCodec/Codec.hpp"
+#include "ASTERIXCodec/Convert.hpp"
+#include "ASTERIXCodec/SpecCache.hpp"
 #include "ASTERIXCodec/SpecLoader.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -558,46 +565,30 @@ static void testMultiRecord(const Codec& codec) {
 //  Pretty-printer: renders a DecodedBlock with physical values and table lookups
 // ─────────────────────────────────────────────────────────────────────────────
 
-static std::string fmtOctal(uint64_t raw, int bits) {
-    int digits = (bits + 2) / 3;
-    std::ostringstream oss;
-    oss << std::oct << std::setw(digits) << std::setfill('0') << raw;
-    return oss.str();
-}
-
 static std::string fmtElement(const ElementDef& e, uint64_t raw) {
+    const FieldConverter conv(e);
+    std::ostringstream s;
     switch (e.encoding) {
-    case Encoding::Raw:
-        return std::to_string(raw) + " (0x" + [&]{
-            std::ostringstream s; s << std::hex << raw; return s.str();
-        }() + ")";
     case Encoding::Table: {
-        auto it = e.table.find(raw);
-        std::string m = (it != e.table.end()) ? it->second : "?";
-        return std::to_string(raw) + " [" + m + "]";
-    }
-    case Encoding::UnsignedQuantity: {
-        std::ostringstream s;
-        s << std::fixed << std::setprecision(4) << raw * e.scale << " " << e.unit
-          << "  (raw=" << raw << ")";
-        return s.str();
-    }
-    case Encoding::SignedQuantity: {
-        int64_t sv;
-        if (e.bits > 0 && e.bits < 64 && ((raw >> (e.bits - 1)) & 1u))
-            sv = static_cast<int64_t>(raw | (~uint64_t{0} << e.bits));
-        else
-            sv = static_cast<int64_t>(raw);
-        std::ostringstream s;
-        s << std::fixed << std::setprecision(4) << sv * e.scale << " " << e.unit
-          << "  (raw=" << sv << ")";
-        return s.str();
+        const std::string_view m = conv.text(raw);
+        s << raw << " [" << (m.empty() ? "?" : m) << "]";
+        break;
     }
+    case Encoding::UnsignedQuantity:
+    case Encoding::SignedQuantity:
+        s << std::fixed << std::setprecision(4) << conv.physical(raw) << " " << conv.unit()
+          << "  (raw=" << conv.signedValue(raw) << ")";
+        break;
     case Encoding::StringOctal:
-        return fmtOctal(raw, e.bits);
+        s << std::setw((e.bits + 2) / 3) << std::setfill('0') << conv.octal(raw);
+        break;
+    case Encoding::Raw:
+        s << raw << " (0x" << std::hex << raw << std::dec << ")";
+        break;
     default:
-        return std::to_string(raw);
+        s << raw;
     }
+    return s.str();
 }
 
 // Search for an ElementDef by name in Fixed element list or Extended octets.
@@ -914,6 +905,247 @@ static void testFullRoundTrip(const Codec& codec) {
     checkItemsMatch(rec.items, src.items, "CAT01");
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 9: Bit I/O – every BitReader (offset, width) pair must match a
+//          bit-by-bit reference; every BitWriter mode must round-trip.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testBitReader() {
+    std::cout << "\n=== Test: BitReader word-at-a-time reads ===\n";
+
+    std::vector<uint8_t> buf(13);
+    uint32_t x = 0x12345678u;
+    for (auto& b : buf) { x = x * 1103515245u + 12345u; b = static_cast<uint8_t>(x >> 24); }
+
+    auto reference = [&](size_t pos, size_t n) {
+        uint64_t v = 0;
+        for (size_t i = pos; i < pos + n; ++i)
+            v = (v << 1) | ((buf[i / 8] >> (7 - i % 8)) & 1u);
+        return v;
+    };
+
+    const size_t total = buf.size() * 8;
+    bool match = true;
+    for (size_t pos = 0; pos < total; ++pos) {
+        for (size_t n = 1; n <= 64 && pos + n <= total; ++n) {
+            BitReader checked{buf};
+            BitReader unchecked{buf};
+            for (size_t left = pos; left > 0; left -= std::min<size_t>(left, 64))
+                checked.skip(std::min<size_t>(left, 64)); // skip() takes 1–64 bits
+            unchecked.skipUnchecked(pos);
+            const uint64_t want = reference(pos, n);
+            match &= checked.readU(n) == want && unchecked.readUnchecked(n) == want;
+            match &= checked.bitsRead() == pos + n && unchecked.bitsRead() == pos + n;
+        }
+    }
+    CHECK(match, "readU / readUnchecked match the reference for all offsets and widths");
+
+    BitReader br{buf};
+    br.skipUnchecked(total - 3);
+    bool threw = false;
+    try { (void)br.readU(4); } catch (const std::out_of_range&) { threw = true; }
+    CHECK(threw,                 "checked readU past the end throws");
+    CHECK(br.readU(3) == (buf.back() & 0x7u), "last 3 bits still readable");
+
+    BitReader sr{buf};
+    CHECK(sr.readS(4) == static_cast<int64_t>(reference(0, 4) >= 8 ? reference(0, 4) - 16
+                                                                     : reference(0, 4)),
+          "readS sign-extends through the fast path");
+}
+
+static void testBitWriter() {
+    std::cout << "\n=== Test: BitWriter growing / fixed-capacity modes ===\n";
+
+    // Mixed widths and offsets, including byte-aligned bulk writes
+    std::vector<std::pair<uint64_t, size_t>> fields;
+    uint32_t x = 0xC0FFEEu;
+    for (size_t i = 0; i < 200; ++i) {
+        x = x * 1103515245u + 12345u;
+        const size_t n = 1 + (x >> 8) % 64;
+        fields.emplace_back((uint64_t{x} << 32) ^ (x * 2654435761u), n);
+    }
+    auto fill = [&](BitWriter& bw) {
+        for (const auto& [v, n] : fields) bw.writeU(v, n);
+        bw.writeBit(true);
+        bw.writeBytes(std::vector<uint8_t>{0xDE, 0xAD}); // unaligned: per byte
+        while (!bw.byteAligned()) bw.writeBit(false);
+        bw.writeBytes(std::vector<uint8_t>{0xBE, 0xEF}); // aligned: memcpy
+    };
+
+    BitWriter grow;
+    fill(grow);
+    const std::vector<uint8_t> bytes = grow.take();
+
+    BitReader br{bytes};
+    bool match = true;
+    for (const auto& [v, n] : fields)
+        match &= br.readU(n) == (n < 64 ? v & ((uint64_t{1} << n) - 1u) : v);
+    match &= br.readBit() && br.readU(16) == 0xDEADu;
+    br.alignToByte();
+    match &= br.readU(16) == 0xBEEFu;
+    CHECK(match, "growing writer round-trips through BitReader");
+
+    std::vector<uint8_t> fixed_buf(bytes.size());
+    BitWriter fixed{std::span<uint8_t>(fixed_buf)};
+    fill(fixed);
+    CHECK(fixed_buf == bytes, "fixed-capacity writer produces the same bytes");
+
+    bool threw = false;
+    try { fixed.writeByte(0); } catch (const std::out_of_range&) { threw = true; }
+    CHECK(threw, "fixed-capacity writer throws when full");
+
+    BitWriter append{std::vector<uint8_t>{0x11}};
+    append.writeU(0x22, 8);
+    CHECK(append.take() == (std::vector<uint8_t>{0x11, 0x22}), "appending writer keeps prior bytes");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 10: Plan compilation rejects element ranges that overrun their item
+//           (the decoder reads them unchecked once the item length is known).
+// ─────────────────────────────────────────────────────────────────────────────
+static void testPlanBoundsValidation(const Codec& codec) {
+    std::cout << "\n=== Test: plan rejects elements wider than their item ===\n";
+
+    CategoryDef def = codec.category(1);
+    def.items.at("010").fixed_bytes = 1; // SAC + SIC need 16 bits
+    Codec other;
+    bool threw = false;
+    try { other.registerCategory(std::move(def)); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "Fixed item shorter than its elements is rejected");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 11: Binary spec cache – a cached CategoryDef decodes and re-caches
+//           identically, and loadSpecDirectory() uses a cache only while it
+//           is at least as new as its XML.
+// ─────────────────────────────────────────────────────────────────────────────
+static std::vector<char> fileBytes(const fs::path& p) {
+    std::ifstream f(p, std::ios::binary);
+    return {std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+}
+
+static void testSpecCache(const Codec& codec, const fs::path& spec_path) {
+    std::cout << "\n=== Test: binary spec cache ===\n";
+
+    const fs::path tmp = fs::temp_directory_path() / "asterix_test_spec_cache";
+    fs::remove_all(tmp);
+    fs::create_directories(tmp / "specs");
+    fs::copy_file(spec_path, tmp / "specs" / "CAT01.xml");
+    {
+        std::ofstream(tmp / "specs" / "README.txt") << "not a spec\n";
+    }
+
+    // Save → load → save is byte-identical, and the reloaded def decodes the same
+    saveSpecCache(codec.category(1), tmp / "a.asxb");
+    CategoryDef cached = loadSpecCache(tmp / "a.asxb");
+    saveSpecCache(cached, tmp / "b.asxb");
+    CHECK(fileBytes(tmp / "a.asxb") == fileBytes(tmp / "b.asxb"), "cache round-trips byte-exact");
+    CHECK(cached.fields.size() == codec.category(1).fields.size() && cached.uap_case &&
+          cached.items.at("020").octets.size() == codec.category(1).items.at("020").octets.size(),
+          "cached def carries fields, UAP case and octets");
+    Codec from_cache;
+    from_cache.registerCategory(std::move(cached));
+    const std::vector<uint8_t> raw = {0x01, 0x00, 0x07, 0xC0, 0x05, 0x12, 0x10}; // plot, Test 2
+    const DecodedBlock want = codec.decode(raw);
+    const DecodedBlock got  = from_cache.decode(raw);
+    CHECK(got.valid && want.valid && got.records.size() == 1 && want.records.size() == 1,
+          "cached codec decodes");
+    for (size_t i = 0; i < std::min(got.records.size(), want.records.size()); ++i)
+        checkItemsMatch(got.records[i].items, want.records[i].items, "cache");
+
+    // Directory load: first call writes the cache next to nothing but CAT*.xml
+    auto defs = loadSpecDirectory(tmp / "specs", tmp / "cache");
+    CHECK(defs.size() == 1 && defs[0].cat == 1, "directory: one CAT*.xml loaded");
+    CHECK(fs::exists(tmp / "cache" / "CAT01.asxb"), "directory: cache written");
+
+    // A fresh cache is used as is (the marker name proves it)…
+    CategoryDef marked = codec.category(1);
+    marked.name = "from cache";
+    saveSpecCache(marked, tmp / "cache" / "CAT01.asxb");
+    CHECK(loadSpecDirectory(tmp / "specs", tmp / "cache").at(0).name == "from cache",
+          "directory: fresh cache used");
+
+    // …a stale one is rebuilt from the XML…
+    fs::last_write_time(tmp / "specs" / "CAT01.xml",
+                        fs::last_write_time(tmp / "cache" / "CAT01.asxb") + std::chrono::hours(1));
+    CHECK(loadSpecDirectory(tmp / "specs", tmp / "cache").at(0).name == codec.category(1).name,
+          "directory: stale cache ignored");
+    CHECK(loadSpecCache(tmp / "cache" / "CAT01.asxb").name == codec.category(1).name,
+          "directory: stale cache rewritten");
+
+    // …and so is a damaged one
+    fs::resize_file(tmp / "cache" / "CAT01.asxb", 40);
+    fs::last_write_time(tmp / "cache" / "CAT01.asxb",
+                        fs::last_write_time(tmp / "specs" / "CAT01.xml") + std::chrono::hours(1));
+    bool threw = false;
+    try { (void)loadSpecCache(tmp / "cache" / "CAT01.asxb"); } catch (const SpecLoadError&) { threw = true; }
+    CHECK(threw, "truncated cache throws SpecLoadError");
+    CHECK(loadSpecDirectory(tmp / "specs", tmp / "cache").at(0).name == codec.category(1).name,
+          "directory: damaged cache falls back to the XML");
+
+    fs::remove_all(tmp);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 12: Late discriminator – with I020 moved behind a slot the two UAPs
+//           disagree on, records are located with the default variation,
+//           then walked once with the one I020 selects.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testLateDiscriminator(const Codec& codec) {
+    std::cout << "\n=== Test: discriminator outside the leading slots ===\n";
+
+    CHECK(codec.plan(1).uap_case->leading, "CAT01 as specified: one pass");
+
+    // plot: 010 040 020 070 …   track: 010 161 020 040 …
+    CategoryDef def = codec.category(1);
+    for (auto& [name, refs] : def.uap_variations) std::swap(refs[1], refs[2]);
+    Codec late;
+    late.registerCategory(std::move(def));
+    const CategoryPlan& plan = late.plan(1);
+    CHECK(!plan.uap_case->leading && plan.uap_case->slots[plan.default_variation] == 2,
+          "reordered CAT01: two-pass");
+
+    const auto record = [](uint64_t typ, bool with_161) {
+        DecodedRecord r;
+        r.uap_variation = typ ? "track" : "plot";
+        r.items["010"] = {"010", ItemType::Fixed, {{"SAC", 1}, {"SIC", 2}}};
+        r.items["020"] = {"020", ItemType::Extended,
+                          {{"TYP", typ}, {"SIM", 0}, {"SSRPSR", 3}, {"ANT", 0}, {"SPI", 0}, {"RAB", 0}}};
+        // RHO 0x3280: read as a plot, the track's I020 would hold TYP = 1
+        r.items["040"] = {"040", ItemType::Fixed, {{"RHO", 0x3280}, {"THETA", 16384}}};
+        if (with_161) r.items["161"] = {"161", ItemType::Fixed, {{"TRKNO", 42}}};
+        return r;
+    };
+    const std::vector<DecodedRecord> recs = {record(1, true), record(0, false), record(1, false)};
+    const std::vector<uint8_t> raw = late.encode(1, recs);
+
+    const DecodedBlock block = late.decode(raw);
+    CHECK(block.valid && block.records.size() == 3, "block decodes");
+    if (block.records.size() == 3) {
+        CHECK(block.records[0].uap_variation == "track" && block.records[1].uap_variation == "plot" &&
+              block.records[2].uap_variation == "track", "variations resolved");
+        CHECK(block.records[0].items.at("161").fields.at("TRKNO") == 42 &&
+              block.records[0].items.at("040").fields.at("RHO") == 0x3280, "track items");
+        CHECK(block.records[1].items.at("040").fields.at("THETA") == 16384 &&
+              !block.records[1].items.count("161"), "plot items");
+    }
+    CHECK(late.encode(1, block.records) == raw, "decode → encode byte-exact");
+
+    // The one-pass walk would have read the track's I161 as a plot I040
+    const DecodedBlock wrong = codec.decode(raw);
+    CHECK(!wrong.valid || wrong.records.empty() || !wrong.records[0].items.count("161"),
+          "the CAT01 layout does not fit");
+
+    // Views and filters locate items the same way
+    const BlockView view = late.view(raw);
+    CHECK(view.size() == 3 && view.record(0).item(plan.findItem("161")).present() &&
+          view.record(1).item(plan.findItem("040")).present(), "view");
+    Projection proj;
+    proj.filter(RecordFilter{plan}.equals("161", "TRKNO", 42));
+    const DecodedBlock only = late.decode(raw, proj);
+    CHECK(only.valid && only.records.size() == 1 && only.records[0].uap_variation == "track",
+          "filter on an item behind the discriminator");
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  main
 // ─────────────────────────────────────────────────────────────────────────────
@@ -925,6 +1157,9 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Using spec: " << spec_path << '\n';
 
+    testBitReader();
+    testBitWriter();
+
     Codec codec;
     testSpecLoad(codec, spec_path);
 
@@ -937,6 +1172,9 @@ int main(int argc, char* argv[]) {
         testMultiRecord(codec);
         testRealMessage(codec);
         testFullRoundTrip(codec);
+        testPlanBoundsValidation(codec);
+        testSpecCache(codec, spec_path);
+        testLateDiscriminator(codec);
     }
 
     std::cout << "\n──────────────────────────────────\n";
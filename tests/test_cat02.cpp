@@ -5,6 +5,7 @@
 //   ./build/test_cat02
 
 #include "ASTERIXCodec/Codec.hpp"
+#include "ASTERIXCodec/Convert.hpp"
 #include "ASTERIXCodec/SpecLoader.hpp"
 
 #include <cassert>
@@ -523,25 +524,19 @@ static void testRoundTripCollimationAndWindow(const Codec& codec) {
 // ─────────────────────────────────────────────────────────────────────────────
 
 static std::string fmtElem(const ElementDef& e, uint64_t raw) {
+    const FieldConverter conv(e);
     std::ostringstream s;
     switch (e.encoding) {
     case Encoding::Table: {
-        auto it = e.table.find(raw);
-        s << raw << " [" << (it != e.table.end() ? it->second : "?") << "]";
+        const std::string_view m = conv.text(raw);
+        s << raw << " [" << (m.empty() ? "?" : m) << "]";
         break;
     }
     case Encoding::UnsignedQuantity:
-        s << std::fixed << std::setprecision(4) << raw * e.scale << " " << e.unit
-          << "  (raw=" << raw << ")";
+    case Encoding::SignedQuantity:
+        s << std::fixed << std::setprecision(4) << conv.physical(raw) << " " << conv.unit()
+          << "  (raw=" << conv.signedValue(raw) << ")";
         break;
-    case Encoding::SignedQuantity: {
-        int64_t sv = (e.bits < 64 && ((raw >> (e.bits-1)) & 1u))
-                     ? static_cast<int64_t>(raw | (~uint64_t{0} << e.bits))
-                     : static_cast<int64_t>(raw);
-        s << std::fixed << std::setprecision(4) << sv * e.scale << " " << e.unit
-          << "  (raw=" << sv << ")";
-        break;
-    }
     default:
         s << raw << " (0x" << std::hex << raw << std::dec << ")";
     }
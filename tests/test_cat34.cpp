@@ -7,7 +7,11 @@
 
 #include "ASTERIXCodec/Codec.hpp"
 #include "ASTERIXCodec/SpecLoader.hpp"
+#ifdef ASTERIX_HAVE_GENERATED
+#include "asterix_gen/cat034.hpp"
+#endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <filesystem>
@@ -778,9 +782,7 @@ static void testMultiRecord(const Codec& codec) {
 //    • RepetitiveGroup  (I070)
 //    • SP               (raw payload)
 // ─────────────────────────────────────────────────────────────────────────────
-static void testFullRoundTrip(const Codec& codec) {
-    std::cout << "\n=== Test: CAT34 full encode-decode round-trip ===\n";
-
+static DecodedRecord buildFullRecord() {
     DecodedRecord src;
     src.uap_variation = "default";
 
@@ -853,6 +855,14 @@ static void testFullRoundTrip(const Codec& codec) {
       di.raw_bytes = {0xAB, 0xCD};
       src.items["SP"] = std::move(di); }
 
+    return src;
+}
+
+static void testFullRoundTrip(const Codec& codec) {
+    std::cout << "\n=== Test: CAT34 full encode-decode round-trip ===\n";
+
+    const DecodedRecord src = buildFullRecord();
+
     // ── Encode ────────────────────────────────────────────────────────────────
     auto encoded = codec.encode(34, {src});
     hexdump(encoded, "CAT34 full RT encoded");
@@ -873,6 +883,45 @@ static void testFullRoundTrip(const Codec& codec) {
     checkItemsMatch(rec.items, src.items, "CAT34");
 }
 
+#ifdef ASTERIX_HAVE_GENERATED
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 12: Generated codec – asterix_gen/cat034.hpp must decode and encode
+//           exactly like the interpreted codec.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testGeneratedCodec(const Codec& codec) {
+    std::cout << "\n=== Test: CAT34 generated codec vs. interpreted codec ===\n";
+    namespace g34 = gen::cat034;
+
+    DecodedRecord north;
+    north.uap_variation = "default";
+    north.items["010"] = buildFullRecord().items.at("010");
+    north.items["000"] = buildFullRecord().items.at("000");
+    const auto encoded = codec.encode(34, {buildFullRecord(), north});
+    const DecodedBlock ref = codec.decode(encoded);
+
+    std::vector<g34::Record> recs;
+    CHECK(g34::decodeBlock(encoded, recs),          "gen: block decodes");
+    CHECK(recs.size() == ref.records.size(),        "gen: same record count");
+    for (size_t i = 0; i < std::min(recs.size(), ref.records.size()); ++i) {
+        const DecodedRecord got = g34::toDecoded(recs[i]);
+        CHECK(got.items.size() == ref.records[i].items.size(), "gen: same item count");
+        checkItemsMatch(got.items, ref.records[i].items, "gen[" + std::to_string(i) + "]");
+    }
+    CHECK(!recs.empty() && recs[0].i050 && recs[0].i050->PSR &&
+          recs[0].i050->PSR->CHAB == 3,             "gen: typed I050/PSR/CHAB");
+
+    std::vector<uint8_t> out;
+    g34::encodeBlock(recs, out);
+    CHECK(out == encoded,                           "gen: decode → encode is byte-exact");
+
+    std::vector<g34::Record> from;
+    for (const auto& r : ref.records) from.push_back(g34::fromDecoded(r));
+    out.clear();
+    g34::encodeBlock(from, out);
+    CHECK(out == encoded,                           "gen: fromDecoded() encodes like encode()");
+}
+#endif
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  main
 // ─────────────────────────────────────────────────────────────────────────────
@@ -897,6 +946,9 @@ int main(int argc, char* argv[]) {
         testRoundTrip3DPosition(codec);
         testMultiRecord(codec);
         testFullRoundTrip(codec);
+#ifdef ASTERIX_HAVE_GENERATED
+        testGeneratedCodec(codec);
+#endif
     }
 
     std::cout << "\n──────────────────────────────────\n";
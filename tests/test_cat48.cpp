@@ -5,14 +5,41 @@
 //   ./build/test_cat48
 
 #include "ASTERIXCodec/Codec.hpp"
+#include "ASTERIXCodec/Convert.hpp"
+#include "ASTERIXCodec/Editor.hpp"
+#include "ASTERIXCodec/Filter.hpp"
+#include "ASTERIXCodec/Packer.hpp"
+#include "ASTERIXCodec/Recording.hpp"
 #include "ASTERIXCodec/SpecLoader.hpp"
-
+#include "ASTERIXCodec/StreamDecoder.hpp"
+#ifdef ASTERIX_HAVE_GENERATED
+#include "asterix_gen/cat048.hpp"
+#endif
+#ifdef ASTERIX_INGEST
+#include "ASTERIXCodec/Ingest.hpp"
+#include <arpa/inet.h>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -29,6 +56,17 @@ static void hexdump(const std::vector<uint8_t>& v, const std::string& label) {
 
 static int failures = 0;
 
+// ─── Heap allocation counter (global operator new replacement) ──────────────
+static std::atomic<size_t> g_allocations{0}; // atomic: batch tests decode on threads
+
+void* operator new(std::size_t n) {
+    ++g_allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
 #define CHECK(cond, msg)                                                  \
     do {                                                                   \
         if (!(cond)) {                                                     \
@@ -121,6 +159,51 @@ static void checkItemsMatch(const std::map<std::string, DecodedItem>& got,
     }
 }
 
+// ─── Compact ↔ map comparison helper ─────────────────────────────────────────
+// Every value of the map-based record must be reachable through the
+// interned-field accessors of the compact record, and vice versa for items.
+static int compactMismatches(const CategoryPlan& plan,
+                             const DecodedRecord& want,
+                             const CompactRecord& got,
+                             const std::string& label) {
+    const CategoryDef& def = plan.def;
+    int bad = 0;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok) { std::cerr << "FAIL [compact] " << label << " " << what << '\n'; ++bad; }
+    };
+    expect(got.valid == want.valid,                   "valid");
+    expect(got.variationName() == want.uap_variation, "variation");
+
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        const std::string& id = plan.items[idx].def->id;
+        auto it = want.items.find(id);
+        expect(got.hasItem(idx) == (it != want.items.end()), "I" + id + " presence");
+        if (it == want.items.end()) continue;
+
+        const DecodedItem& di = it->second;
+        const auto item = got.item(idx);
+        for (const auto& [name, val] : di.fields)
+            expect(item.field(findField(def, id, name)) == val, "I" + id + "." + name);
+        for (const auto& [sub, fields] : di.compound_sub_fields)
+            for (const auto& [name, val] : fields)
+                expect(item.field(findField(def, id, name, sub)) == val,
+                       "I" + id + "/" + sub + "." + name);
+        const size_t reps = di.repetitions.empty() ? di.group_repetitions.size()
+                                                   : di.repetitions.size();
+        expect(item.repetitions() == reps, "I" + id + " repetitions");
+        for (size_t r = 0; r < di.repetitions.size(); ++r)
+            expect(item.repetition(r) == di.repetitions[r], "I" + id + "[" + std::to_string(r) + "]");
+        for (size_t r = 0; r < di.group_repetitions.size(); ++r)
+            for (const auto& [name, val] : di.group_repetitions[r])
+                expect(item.field(findField(def, id, name), r) == val,
+                       "I" + id + "[" + std::to_string(r) + "]." + name);
+        const auto payload = item.payload();
+        expect(std::equal(payload.begin(), payload.end(),
+                          di.raw_bytes.begin(), di.raw_bytes.end()), "I" + id + " payload");
+    }
+    return bad;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Test 1: XML spec loads without error; item types and UAP are correct
 // ─────────────────────────────────────────────────────────────────────────────
@@ -881,51 +964,53 @@ static void testMultiRecord(const Codec& codec) {
 //    I161: TRN=0xDB=219
 //    I200: GSP=0x0803=2051, HDG=0x96D4=38612
 // ─────────────────────────────────────────────────────────────────────────────
+// clang-format off
+static const std::vector<uint8_t> kRealFrame = {
+    // Header
+    0x30, 0x01, 0x3e,
+    // Record 0
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x72, 0xba, 0xd1, 0x6e,
+    0x04, 0x62, 0x05, 0xc8, 0x60, 0x02, 0xc0, 0x48, 0x4f, 0x6d, 0x51, 0x20,
+    0x75, 0xdf, 0x0c, 0x60, 0x00, 0xdb, 0x08, 0x03, 0x96, 0xd4, 0x40,
+    // Record 1
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xed, 0xa8, 0x49, 0x8f, 0xd7, 0x58,
+    0x0b, 0x49, 0x05, 0x52, 0x60, 0x02, 0xc2, 0x4d, 0x23, 0x5a, 0x15, 0x71,
+    0xf3, 0x55, 0x98, 0x20, 0x02, 0xed, 0x08, 0x80, 0x33, 0x79, 0x40,
+    // Record 2
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe6, 0xa8, 0x69, 0xc6, 0xd5, 0xb9,
+    0x02, 0x00, 0x01, 0xc5, 0x60, 0x02, 0xb5, 0xab, 0xaf, 0x47, 0x18, 0x46,
+    0x32, 0xc6, 0x08, 0x20, 0x07, 0xb6, 0x05, 0xe4, 0xb0, 0xd0, 0x40,
+    // Record 3
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xda, 0xa8, 0x8a, 0x7a, 0xd2, 0x9c,
+    0x0a, 0xed, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x4d, 0x21, 0xfe, 0x49, 0x94,
+    0xb3, 0x0c, 0x28, 0x20, 0x01, 0xee, 0x07, 0xb4, 0x1e, 0xcd, 0x40,
+    // Record 4
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe0, 0xa8, 0xc4, 0xa1, 0xd3, 0x83,
+    0x0c, 0xe7, 0x04, 0x38, 0x60, 0x06, 0xba, 0x40, 0x09, 0xd8, 0x08, 0x15,
+    0xf3, 0xdb, 0x26, 0x60, 0x04, 0xd3, 0x08, 0x5d, 0x68, 0x26, 0x40,
+    // Record 5
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd9, 0xa8, 0x66, 0xf7, 0xd2, 0x88,
+    0x02, 0x00, 0x01, 0xb8, 0x60, 0x02, 0xba, 0x39, 0xd3, 0x06, 0x51, 0x61,
+    0xb9, 0xd4, 0xc5, 0x60, 0x07, 0x98, 0x05, 0xee, 0xb8, 0x73, 0x40,
+    // Record 6
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xec, 0xa8, 0xa8, 0xcd, 0xd6, 0xfc,
+    0x0b, 0xe0, 0x05, 0xa0, 0x60, 0x02, 0xba, 0x4d, 0x22, 0x8f, 0x49, 0x94,
+    0xb6, 0xe5, 0x63, 0xa0, 0x03, 0x76, 0x06, 0x39, 0xe3, 0xc2, 0x40,
+    // Record 7
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd8, 0xa8, 0xb8, 0x49, 0xd2, 0x39,
+    0x01, 0x5b, 0x04, 0x9f, 0x60, 0x02, 0xb7, 0x40, 0x0c, 0xeb, 0x08, 0x15,
+    0xf1, 0xd3, 0x13, 0x60, 0x00, 0x27, 0x09, 0x42, 0x69, 0xad, 0x40,
+    // Record 8
+    0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x73, 0xe9, 0xd1, 0x63,
+    0x0d, 0xea, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x48, 0x41, 0xaa, 0x51, 0x20,
+    0x78, 0xd9, 0x58, 0x20, 0x03, 0x5a, 0x06, 0xa5, 0xee, 0xa4, 0x40,
+};
+// clang-format on
+
 static void testRealFrame(const Codec& codec) {
     std::cout << "\n=== Test: Decode real CAT48 operational frame (318 B, 9 records) ===\n";
 
-    // clang-format off
-    std::vector<uint8_t> frame = {
-        // Header
-        0x30, 0x01, 0x3e,
-        // Record 0
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x72, 0xba, 0xd1, 0x6e,
-        0x04, 0x62, 0x05, 0xc8, 0x60, 0x02, 0xc0, 0x48, 0x4f, 0x6d, 0x51, 0x20,
-        0x75, 0xdf, 0x0c, 0x60, 0x00, 0xdb, 0x08, 0x03, 0x96, 0xd4, 0x40,
-        // Record 1
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xed, 0xa8, 0x49, 0x8f, 0xd7, 0x58,
-        0x0b, 0x49, 0x05, 0x52, 0x60, 0x02, 0xc2, 0x4d, 0x23, 0x5a, 0x15, 0x71,
-        0xf3, 0x55, 0x98, 0x20, 0x02, 0xed, 0x08, 0x80, 0x33, 0x79, 0x40,
-        // Record 2
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe6, 0xa8, 0x69, 0xc6, 0xd5, 0xb9,
-        0x02, 0x00, 0x01, 0xc5, 0x60, 0x02, 0xb5, 0xab, 0xaf, 0x47, 0x18, 0x46,
-        0x32, 0xc6, 0x08, 0x20, 0x07, 0xb6, 0x05, 0xe4, 0xb0, 0xd0, 0x40,
-        // Record 3
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xda, 0xa8, 0x8a, 0x7a, 0xd2, 0x9c,
-        0x0a, 0xed, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x4d, 0x21, 0xfe, 0x49, 0x94,
-        0xb3, 0x0c, 0x28, 0x20, 0x01, 0xee, 0x07, 0xb4, 0x1e, 0xcd, 0x40,
-        // Record 4
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xe0, 0xa8, 0xc4, 0xa1, 0xd3, 0x83,
-        0x0c, 0xe7, 0x04, 0x38, 0x60, 0x06, 0xba, 0x40, 0x09, 0xd8, 0x08, 0x15,
-        0xf3, 0xdb, 0x26, 0x60, 0x04, 0xd3, 0x08, 0x5d, 0x68, 0x26, 0x40,
-        // Record 5
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd9, 0xa8, 0x66, 0xf7, 0xd2, 0x88,
-        0x02, 0x00, 0x01, 0xb8, 0x60, 0x02, 0xba, 0x39, 0xd3, 0x06, 0x51, 0x61,
-        0xb9, 0xd4, 0xc5, 0x60, 0x07, 0x98, 0x05, 0xee, 0xb8, 0x73, 0x40,
-        // Record 6
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xec, 0xa8, 0xa8, 0xcd, 0xd6, 0xfc,
-        0x0b, 0xe0, 0x05, 0xa0, 0x60, 0x02, 0xba, 0x4d, 0x22, 0x8f, 0x49, 0x94,
-        0xb6, 0xe5, 0x63, 0xa0, 0x03, 0x76, 0x06, 0x39, 0xe3, 0xc2, 0x40,
-        // Record 7
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd8, 0xa8, 0xb8, 0x49, 0xd2, 0x39,
-        0x01, 0x5b, 0x04, 0x9f, 0x60, 0x02, 0xb7, 0x40, 0x0c, 0xeb, 0x08, 0x15,
-        0xf1, 0xd3, 0x13, 0x60, 0x00, 0x27, 0x09, 0x42, 0x69, 0xad, 0x40,
-        // Record 8
-        0xff, 0xd6, 0x08, 0x01, 0x65, 0x7a, 0xd7, 0xa8, 0x73, 0xe9, 0xd1, 0x63,
-        0x0d, 0xea, 0x05, 0xf0, 0x60, 0x02, 0xba, 0x48, 0x41, 0xaa, 0x51, 0x20,
-        0x78, 0xd9, 0x58, 0x20, 0x03, 0x5a, 0x06, 0xa5, 0xee, 0xa4, 0x40,
-    };
-    // clang-format on
+    const std::vector<uint8_t>& frame = kRealFrame;
 
     hexdump(frame, "real frame");
     DecodedBlock block = codec.decode(frame);
@@ -1159,6 +1244,1414 @@ static void testFullRoundTrip(const Codec& codec) {
     checkItemsMatch(rec.items, src.items, "CAT48");
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 13: Interned-field decode of the real frame – decodeCompact() must
+//           expose exactly the values decode() produces, record by record.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testCompactDecode(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 interned-field (compact) decode ===\n";
+
+    DecodedBlock ref  = codec.decode(kRealFrame);
+    CompactBlock cblk = codec.decodeCompact(kRealFrame);
+    CHECK(cblk.valid,                                "compact block valid");
+    CHECK(cblk.length == 318,                        "compact block length == 318");
+    CHECK(cblk.records.size() == ref.records.size(), "compact record count matches");
+    if (cblk.records.size() != ref.records.size()) return;
+
+    const CategoryPlan& plan = codec.plan(48);
+    int bad = 0;
+    for (size_t i = 0; i < ref.records.size(); ++i)
+        bad += compactMismatches(plan, ref.records[i], cblk.records[i],
+                                 "rec[" + std::to_string(i) + "]");
+    CHECK(bad == 0, "all 9 compact records match map records");
+
+    // Name → ID lookup then O(1) access
+    const CategoryDef& def = codec.category(48);
+    const FieldId   tod  = findField(def, "140", "TOD");
+    const FieldId   sam  = findField(def, "130", "SAM", "SAM");
+    const ItemIndex i140 = plan.findItem("140");
+    CHECK(tod != kNoField && sam != kNoField,                      "TOD / SAM interned");
+    CHECK(cblk.records[0].item(i140).field(tod) == 0x657AD7u,      "r0 I140.TOD via FieldId");
+    CHECK(cblk.records[0].field(sam) == 0xC0u,                     "r0 I130/SAM via FieldId");
+    CHECK(!cblk.records[0].item(plan.findItem("250")).present(),   "r0 I250 absent");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 14: Reusable decode context – decodeInto() / decodeCompactInto() must
+//           match decode() and stop allocating once warmed up.
+// ─────────────────────────────────────────────────────────────────────────────
+static bool sameRecords(const DecodedBlock& a, const DecodedBlock& b) {
+    if (a.valid != b.valid || a.records.size() != b.records.size()) return false;
+    for (size_t i = 0; i < a.records.size(); ++i) {
+        const DecodedRecord& ra = a.records[i];
+        const DecodedRecord& rb = b.records[i];
+        if (ra.uap_variation != rb.uap_variation || ra.valid != rb.valid ||
+            ra.items.size() != rb.items.size())
+            return false;
+        for (auto ia = ra.items.begin(), ib = rb.items.begin(); ia != ra.items.end(); ++ia, ++ib) {
+            const DecodedItem& x = ia->second;
+            const DecodedItem& y = ib->second;
+            if (ia->first != ib->first || x.item_id != y.item_id || x.type != y.type ||
+                x.fields != y.fields || x.repetitions != y.repetitions ||
+                x.group_repetitions != y.group_repetitions ||
+                x.compound_sub_fields != y.compound_sub_fields || x.raw_bytes != y.raw_bytes)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void testDecodeInto(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 decodeInto() with a reusable context ===\n";
+
+    // Three shapes: the 9-record real frame, a single record re-encoded from
+    // it (fewer records, different item set) and a truncated header.
+    const DecodedBlock ref_big = codec.decode(kRealFrame);
+    const std::vector<uint8_t> small = codec.encode(48, {ref_big.records[4]});
+    const DecodedBlock ref_small = codec.decode(small);
+    const std::vector<uint8_t> bad = {48, 0x00};
+    const std::vector<const std::vector<uint8_t>*> feed = {&kRealFrame, &small, &bad, &small};
+
+    DecodeContext ctx;
+    bool match = true;
+    for (int round = 0; round < 2; ++round) {
+        match &= sameRecords(codec.decodeInto(kRealFrame, ctx), ref_big);
+        match &= sameRecords(codec.decodeInto(small, ctx), ref_small);
+        match &= !codec.decodeInto(bad, ctx).valid && ctx.block().records.empty();
+        (void)codec.decodeCompactInto(kRealFrame, ctx);
+        (void)codec.decodeCompactInto(small, ctx);
+        (void)codec.decodeCompactInto(bad, ctx);
+    }
+    CHECK(match, "decodeInto() results match decode() across block shapes");
+
+    const size_t before = g_allocations;
+    size_t records = 0;
+    for (int i = 0; i < 100; ++i)
+        for (const auto* frame : feed) {
+            records += codec.decodeInto(*frame, ctx).records.size();
+            records += codec.decodeCompactInto(*frame, ctx).records.size();
+        }
+    const size_t allocs = g_allocations - before;
+    std::cout << "  " << records << " records decoded, " << allocs << " allocations\n";
+    CHECK(allocs == 0, "no heap allocation after warm-up");
+
+    const size_t before_fresh = g_allocations;
+    (void)codec.decode(kRealFrame);
+    CHECK(g_allocations > before_fresh, "decode() allocates (counter is live)");
+
+    // The context still produces correct results after the measured loop.
+    CHECK(sameRecords(codec.decodeInto(kRealFrame, ctx), ref_big), "decodeInto() still matches decode()");
+    const CompactBlock& cblk = codec.decodeCompactInto(kRealFrame, ctx);
+    int bad_compact = 0;
+    for (size_t i = 0; i < ref_big.records.size() && i < cblk.records.size(); ++i)
+        bad_compact += compactMismatches(codec.plan(48), ref_big.records[i], cblk.records[i],
+                                         "rec[" + std::to_string(i) + "]");
+    CHECK(cblk.records.size() == 9 && bad_compact == 0, "decodeCompactInto() matches decode()");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 15: Lazy view of the real frame – record boundaries and item bytes
+//           found by length-only parsing agree with a full decode.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testLazyView(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 lazy view of the real frame ===\n";
+
+    const DecodedBlock ref  = codec.decode(kRealFrame);
+    const BlockView    view = codec.view(kRealFrame);
+    CHECK(view.valid && view.length == 318, "view valid, length == 318");
+    CHECK(view.size() == ref.records.size(), "view record count matches");
+    if (view.size() != ref.records.size()) return;
+
+    const CategoryPlan& plan = codec.plan(48);
+    bool items_match = true, values_match = true;
+    for (size_t r = 0; r < view.size(); ++r) {
+        const RecordView rec = view.record(r);
+        items_match &= rec.variationName() == ref.records[r].uap_variation;
+        for (ItemIndex idx = 0; idx < plan.items.size(); ++idx)
+            items_match &= rec.hasItem(idx) == (ref.records[r].items.count(plan.items[idx].def->id) != 0);
+        for (const auto& [id, di] : ref.records[r].items)
+            for (const auto& [name, val] : di.fields)
+                values_match &= rec.item(id).field(findField(plan.def, id, name)) == val;
+    }
+    CHECK(items_match,  "item presence and variation match decode()");
+    CHECK(values_match, "lazily read values match decode()");
+    const ItemView unknown = view.record(0).item("999");
+    CHECK(unknown.repetitions() == 0 && unknown.repetition(0) == 0 && unknown.payload().empty(),
+          "an unknown item reads as absent");
+
+    BlockView reused;
+    codec.view(kRealFrame, reused);
+    codec.view(kRealFrame, reused);
+    CHECK(reused.size() == 9 && reused.spans.size() == 9 * plan.items.size(),
+          "view() into an existing BlockView resets it");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 16: Projection – only I010, I140, I040/RHO, I070 and I130/SAM of the
+//           real frame are decoded; everything else is skipped.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testProjection(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 projected decode ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    Projection proj;
+    proj.select(plan, {{"010"}, {"140"}, {"040", {"RHO"}}, {"070"}, {"130", {"SAM"}}});
+
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    const DecodedBlock got = codec.decode(kRealFrame, proj);
+    CHECK(got.valid && got.records.size() == ref.records.size(), "projected block valid, 9 records");
+    if (got.records.size() != ref.records.size()) return;
+
+    bool only_selected = true, values_match = true, filtered = true;
+    for (size_t r = 0; r < ref.records.size(); ++r) {
+        const DecodedRecord& want = ref.records[r];
+        const DecodedRecord& rec  = got.records[r];
+        only_selected &= rec.valid == want.valid && rec.uap_variation == want.uap_variation;
+        for (const auto& [id, di] : rec.items)
+            only_selected &= id == "010" || id == "140" || id == "040" || id == "070" || id == "130";
+        for (const char* id : {"010", "140", "070"}) {
+            auto it = want.items.find(id);
+            if (it == want.items.end()) { only_selected &= !rec.items.count(id); continue; }
+            values_match &= rec.items.count(id) && rec.items.at(id).fields == it->second.fields;
+        }
+        if (auto it = want.items.find("040"); it != want.items.end()) {
+            const auto& fields = rec.items.at("040").fields;
+            filtered     &= fields.size() == 1;
+            values_match &= fields.at("RHO") == it->second.fields.at("RHO");
+        }
+        if (auto it = want.items.find("130"); it != want.items.end()) {
+            const auto& subs = rec.items.at("130").compound_sub_fields;
+            filtered &= subs.size() == (it->second.compound_sub_fields.count("SAM") ? 1u : 0u);
+            if (!subs.empty())
+                values_match &= subs.at("SAM") == it->second.compound_sub_fields.at("SAM");
+        }
+    }
+    CHECK(only_selected, "only selected items are materialised");
+    CHECK(values_match,  "selected values match a full decode");
+    CHECK(filtered,      "I040 keeps only RHO, I130 only its SAM sub-item");
+
+    // Compact output honours the same selection
+    const CompactBlock cblk = codec.decodeCompact(kRealFrame, proj);
+    const FieldId rho   = findField(plan.def, "040", "RHO");
+    const FieldId theta = findField(plan.def, "040", "THETA");
+    bool compact_ok = cblk.records.size() == ref.records.size();
+    for (size_t r = 0; compact_ok && r < cblk.records.size(); ++r) {
+        const CompactRecord& rec = cblk.records[r];
+        compact_ok &= !rec.hasItem(plan.findItem("220")) && !rec.has(theta);
+        if (ref.records[r].items.count("040"))
+            compact_ok &= rec.field(rho) == ref.records[r].items.at("040").fields.at("RHO");
+    }
+    CHECK(compact_ok, "decodeCompact() with projection matches");
+
+    // Other categories, or a plan that was not selected, decode in full
+    Projection none;
+    CHECK(codec.decode(kRealFrame, none).records[0].items.size() == ref.records[0].items.size(),
+          "empty projection decodes everything");
+
+    bool threw = false;
+    try { Projection p; p.select(plan, {{"999"}}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown item rejected");
+    threw = false;
+    try { Projection p; p.select(plan, {{"040", {"NOPE"}}}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown field rejected");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 17: In-place encode – encodeInto() / encodeAppend() produce the same
+//           bytes as encode() and do not allocate once the buffer is warm.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testEncodeInto(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 encodeInto() / encodeAppend() ===\n";
+
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    const std::vector<uint8_t> want = codec.encode(48, ref.records);
+    CHECK(want == kRealFrame, "encode() reproduces the real frame");
+
+    std::vector<uint8_t> buf(512, 0xAA);
+    const size_t len = codec.encodeInto(48, ref.records, buf);
+    CHECK(len == want.size() && std::equal(want.begin(), want.end(), buf.begin()),
+          "encodeInto() writes the same bytes");
+
+    bool threw = false;
+    try { (void)codec.encodeInto(48, ref.records, std::span<uint8_t>(buf).first(100)); }
+    catch (const std::out_of_range&) { threw = true; }
+    CHECK(threw, "encodeInto() into a short buffer throws out_of_range");
+
+    std::vector<uint8_t> out = {0x01, 0x02};
+    codec.encodeAppend(48, ref.records, out);
+    CHECK(out.size() == 2 + want.size() && std::equal(want.begin(), want.end(), out.begin() + 2),
+          "encodeAppend() appends after existing bytes");
+
+    std::vector<DecodedRecord> bad = {ref.records[0]};
+    bad[0].uap_variation = "nope";
+    const size_t before_bad = out.size();
+    threw = false;
+    try { codec.encodeAppend(48, bad, out); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw && out.size() == before_bad, "failed encodeAppend() leaves out unchanged");
+
+    // Steady state: the same buffer, cleared between blocks
+    const size_t before = g_allocations;
+    for (int i = 0; i < 100; ++i) {
+        out.clear();
+        codec.encodeAppend(48, ref.records, out);
+        (void)codec.encodeInto(48, ref.records, buf);
+    }
+    const size_t allocs = g_allocations - before;
+    std::cout << "  " << allocs << " allocations over 200 block encodes\n";
+    CHECK(allocs == 0,  "no heap allocation once the output buffer is warm");
+    CHECK(out == want,  "steady-state output unchanged");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 18: Stream framing – concatenated blocks with garbage and a corrupt
+//           header, fed whole and in chunks of every size.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testStreamDecoder(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 StreamDecoder framing and resync ===\n";
+
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    const std::vector<uint8_t> small = codec.encode(48, {ref.records[2]});
+
+    std::vector<uint8_t> stream = {0xFF, 0x00};                     // junk, unknown CATs
+    stream.insert(stream.end(), kRealFrame.begin(), kRealFrame.end());
+    stream.insert(stream.end(), small.begin(), small.end());
+    stream.insert(stream.end(), {48, 0x00, 0x01});                  // LEN = 1: corrupt
+    stream.insert(stream.end(), kRealFrame.begin(), kRealFrame.end());
+    const std::vector<std::vector<uint8_t>> want = {kRealFrame, small, kRealFrame};
+
+    std::vector<std::vector<uint8_t>> got;
+    auto collect = [&](std::span<const uint8_t> block) { got.emplace_back(block.begin(), block.end()); };
+
+    StreamDecoder whole{codec};
+    whole.feed(stream, collect);
+    CHECK(got == want,                        "single chunk: three blocks framed");
+    CHECK(whole.stats().bytes_copied == 0,    "single chunk: nothing copied");
+    CHECK(whole.stats().bytes_skipped == 5,   "single chunk: 5 junk bytes skipped");
+    CHECK(whole.stats().resyncs == 2,         "single chunk: two resyncs");
+    CHECK(whole.finish() == 0,                "single chunk: nothing left over");
+
+    bool all_sizes = true;
+    for (size_t step = 1; step <= stream.size(); ++step) {
+        got.clear();
+        StreamDecoder sd{codec};
+        for (size_t pos = 0; pos < stream.size(); pos += step)
+            sd.feed(std::span<const uint8_t>(stream).subspan(pos, std::min(step, stream.size() - pos)),
+                    collect);
+        all_sizes &= got == want && sd.stats().bytes_skipped == 5 && sd.finish() == 0;
+    }
+    CHECK(all_sizes, "chunks of every size frame the same blocks");
+
+    StreamDecoder split{codec};
+    got.clear();
+    split.feed(std::span<const uint8_t>(kRealFrame).first(100), collect);
+    CHECK(got.empty() && split.buffered() == 100, "partial block is buffered");
+    split.feed(std::span<const uint8_t>(kRealFrame).subspan(100), collect);
+    CHECK(got.size() == 1 && split.stats().bytes_copied == kRealFrame.size(),
+          "straddling block is copied once and emitted");
+
+    size_t records = 0;
+    bool   valid   = true;
+    StreamDecoder dec{codec};
+    dec.feedDecoded(stream, [&](const DecodedBlock& block) {
+        valid   &= block.valid;
+        records += block.records.size();
+    });
+    CHECK(valid && records == 9 + 1 + 9, "feedDecoded() decodes every framed block");
+
+    StreamDecoder tail{codec};
+    tail.feed(std::span<const uint8_t>(kRealFrame).first(10), collect);
+    CHECK(tail.finish() == 10, "finish() drops an incomplete trailing block");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 19: Parallel batch decode – results in input order and identical to
+//           decode(), whatever the thread count and chunk size.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testDecodeBatch(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 decodeBatch() on a thread pool ===\n";
+
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    std::vector<std::vector<uint8_t>> frames;
+    for (size_t i = 0; i < ref.records.size(); ++i)
+        frames.push_back(codec.encode(48, {ref.records[i]}));
+    frames.push_back(kRealFrame);
+    frames.push_back({48, 0x00});                       // truncated header
+
+    std::vector<std::span<const uint8_t>> batch;
+    for (int copy = 0; copy < 50; ++copy)
+        for (const auto& f : frames) batch.emplace_back(f);
+
+    std::vector<DecodedBlock> want;
+    for (auto b : batch) want.push_back(codec.decode(b));
+
+    bool ordered = true;
+    for (unsigned threads : {1u, 2u, 4u, 7u}) {
+        for (size_t chunk : {size_t{0}, size_t{1}, size_t{5}, size_t{1000}}) {
+            const auto got = codec.decodeBatch(batch, {threads, chunk});
+            ordered &= got.size() == want.size();
+            for (size_t i = 0; ordered && i < got.size(); ++i)
+                ordered &= sameRecords(got[i], want[i]) && got[i].error == want[i].error;
+        }
+    }
+    CHECK(ordered, "decodeBatch() matches decode() for 1/2/4/7 threads, all chunk sizes");
+
+    const auto compact = codec.decodeCompactBatch(batch, {4, 3});
+    int bad = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        bad += compact[i].records.size() != want[i].records.size();
+        for (size_t r = 0; r < std::min(compact[i].records.size(), want[i].records.size()); ++r)
+            bad += compactMismatches(codec.plan(48), want[i].records[r], compact[i].records[r],
+                                     "batch[" + std::to_string(i) + "]");
+    }
+    CHECK(bad == 0, "decodeCompactBatch() matches decode()");
+
+    std::vector<std::atomic<int>> seen(batch.size());
+    std::atomic<size_t> records{0};
+    codec.forEachDecoded(batch, [&](size_t i, const DecodedBlock& block) {
+        seen[i].fetch_add(1);
+        records += block.records.size();
+    }, {4, 2});
+    size_t want_records = 0;
+    for (const auto& w : want) want_records += w.records.size();
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const auto& n) { return n == 1; }),
+          "forEachDecoded() visits every block exactly once");
+    CHECK(records == want_records, "forEachDecoded() sees every record");
+
+    Projection proj;
+    proj.select(codec.plan(48), {{"010"}, {"140"}});
+    BatchOptions popts{3, 4, &proj};
+    const auto projected = codec.decodeBatch(batch, popts);
+    bool only = true;
+    for (const auto& block : projected)
+        for (const auto& rec : block.records)
+            only &= rec.items.size() <= 2 && rec.items.count("140") == 1;
+    CHECK(only, "decodeBatch() honours BatchOptions::projection");
+
+    bool rethrown = false;
+    try {
+        codec.forEachDecoded(batch, [](size_t i, const DecodedBlock&) {
+            if (i == 123) throw std::runtime_error("stop");
+        }, {4, 1});
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    CHECK(rethrown, "a callback exception is rethrown on the calling thread");
+    CHECK(codec.decodeBatch({}).empty(), "empty batch");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 20: Structured errors – every failure carries a DecodeError whose
+//           describe() text is the error string; with error text off a
+//           context decodes bad traffic without allocating.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testDecodeErrors(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 structured decode errors ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    const DecodedBlock  ref  = codec.decode(kRealFrame);
+
+    // One record cut one byte short: its last item is truncated
+    std::vector<uint8_t> cut = codec.encode(48, {ref.records[0]});
+    cut.pop_back();
+    cut[2] = static_cast<uint8_t>(cut.size());
+    const DecodedBlock bad = codec.decode(cut);
+    CHECK(!bad.valid && bad.fault,                      "truncated: fault set");
+    CHECK(bad.fault.code != DecodeErrc::NoProgress &&
+          bad.fault.code != DecodeErrc::UnknownItem,    "truncated: item-level reason");
+    CHECK(bad.fault.item < plan.items.size(),           "truncated: failing item recorded");
+    CHECK(bad.fault.offset > 3 && bad.fault.offset <= cut.size(), "truncated: offset within the block");
+    CHECK(bad.error == describe(bad.fault, &plan),      "truncated: error == describe(fault)");
+    CHECK(bad.error.find("Item " + plan.items[bad.fault.item].def->id + ": ") != std::string::npos,
+          "truncated: message names the item");
+
+    const std::vector<uint8_t> unknown = {0x99, 0x00, 0x03};
+    const DecodedBlock ub = codec.decode(unknown);
+    CHECK(ub.fault.code == DecodeErrc::UnknownCategory && ub.fault.value == 0x99, "unknown CAT");
+    CHECK(ub.error == "Category 153 not registered", "unknown CAT message unchanged");
+
+    const DecodedBlock lb = codec.decode(std::vector<uint8_t>{48, 0x00, 0x02});
+    CHECK(lb.fault.code == DecodeErrc::BadBlockLength && lb.fault.value == 2, "bad LEN");
+    CHECK(lb.error == "Data Block LEN field (2) is invalid", "bad LEN message unchanged");
+
+    if (!plan.mandatory.empty()) {
+        const ItemIndex m = plan.mandatory.front();
+        DecodedRecord rec = ref.records[0];
+        rec.items.erase(plan.items[m].def->id);
+        const DecodedBlock mb = codec.decode(codec.encode(48, {rec}));
+        CHECK(mb.valid && mb.records.size() == 1, "mandatory missing: record kept");
+        const DecodeError& f = mb.records[0].fault;
+        CHECK(f.code == DecodeErrc::MandatoryMissing && f.item == m && f.offset == 3,
+              "mandatory missing: record fault");
+        CHECK(mb.records[0].error == describe(f, &plan), "mandatory missing: error == describe(fault)");
+    }
+
+    // Error text off: same faults, no strings, no allocation once warm
+    DecodeContext ctx;
+    ctx.setErrorText(false);
+    const DecodedBlock& quiet = codec.decodeInto(cut, ctx);
+    CHECK(!quiet.valid && quiet.error.empty(), "text off: no error string");
+    CHECK(quiet.fault.code == bad.fault.code && quiet.fault.item == bad.fault.item &&
+          quiet.fault.offset == bad.fault.offset, "text off: same fault");
+    for (int i = 0; i < 3; ++i) {
+        (void)codec.decodeInto(cut, ctx);
+        (void)codec.decodeInto(unknown, ctx);
+        (void)codec.decodeCompactInto(cut, ctx);
+    }
+    const size_t before = g_allocations;
+    bool faults = true;
+    for (int i = 0; i < 100; ++i) {
+        faults &= codec.decodeInto(cut, ctx).fault.code == bad.fault.code;
+        faults &= codec.decodeInto(unknown, ctx).fault.code == DecodeErrc::UnknownCategory;
+        faults &= codec.decodeCompactInto(cut, ctx).fault.code == bad.fault.code;
+    }
+    CHECK(faults, "text off: faults reported on every call");
+    CHECK(g_allocations == before, "text off: bad traffic decodes without allocating");
+    CHECK(std::string(toString(DecodeErrc::FixedTruncated)) == "buffer too short for Fixed",
+          "toString() reason phrase");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 21: Columnar decode – decodeColumns() fills one column per selected
+//           field with the values decodeCompact() reports, across blocks.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testColumnarDecode(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 columnar (struct-of-arrays) decode ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    ColumnarBatch cols(plan, {{"040", {"RHO", "THETA"}}, {"090"}, {"130"}, {"250"}, {"220"}});
+    const FieldId rho = findField(plan.def, "040", "RHO");
+    CHECK(cols.columns().size() >= 5 && cols.column(0).field == rho, "columns in selection order");
+    CHECK(cols.column(0).name == "040.RHO" && cols.column(0).bits == 16, "column name / width");
+
+    for (int i = 0; i < 3; ++i)
+        CHECK(!codec.decodeColumns(kRealFrame, cols), "real frame appended");
+    const CompactBlock ref = codec.decodeCompact(kRealFrame);
+    CHECK(cols.rows() == 3 * ref.records.size(), "one row per record, across blocks");
+
+    bool match = cols.rows() == 3 * ref.records.size();
+    for (const Column& col : cols.columns()) {
+        size_t nulls = 0;
+        for (size_t r = 0; match && r < cols.rows(); ++r) {
+            const CompactRecord& rec = ref.records[r % ref.records.size()];
+            match = col.valid(r) == rec.has(col.field) && col.values[r] == rec.field(col.field);
+            nulls += !col.valid(r);
+        }
+        match = match && col.values.size() == cols.rows() &&
+                col.validity.size() == (cols.rows() + 7) / 8 && col.null_count == nulls;
+    }
+    CHECK(match, "column values / validity match decodeCompact()");
+    CHECK(cols.find(rho) && cols.find(rho)->null_count == 0 &&
+          !cols.find(findField(plan.def, "010", "SAC")), "find() by FieldId");
+
+    // A record error keeps the rows before it; other categories add nothing
+    std::vector<uint8_t> cut(kRealFrame.begin(), kRealFrame.end() - 1);
+    cut[1] = static_cast<uint8_t>(cut.size() >> 8);
+    cut[2] = static_cast<uint8_t>(cut.size());
+    cols.clear();
+    const DecodeError err = codec.decodeColumns(cut, cols);
+    CHECK(err && err.code == codec.decode(cut).fault.code, "truncated block: fault returned");
+    CHECK(cols.rows() == ref.records.size() - 1, "truncated block: earlier rows kept");
+    const std::vector<uint8_t> other = {62, 0x00, 0x04, 0x00};
+    CHECK(codec.decodeColumns(other, cols).code == DecodeErrc::UnknownCategory &&
+          cols.rows() == ref.records.size() - 1, "other category: no rows");
+
+    bool threw = false;
+    try { ColumnarBatch bad(plan, {{"040", {"NOPE"}}}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown field throws");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 22: Conversions – CategoryConverters turn raw values into physical
+//           values, table text and octal codes, one at a time or in batches.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testConversions(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 physical-value conversion ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    const CategoryDef&  def  = plan.def;
+    const CategoryConverters conv(plan);
+    CHECK(conv.size() == def.fields.size(), "one converter per field");
+
+    const FieldId rho  = findField(def, "040", "RHO");
+    const FieldId fl   = findField(def, "090", "FL");
+    const FieldId m3a  = findField(def, "070", "MODE3A");
+    const FieldId typ  = findField(def, "020", "TYP");
+    const ElementDef& rho_def = def.items.at("040").elements[0];
+    CHECK(conv[rho].encoding() == Encoding::UnsignedQuantity && conv[rho].unit() == rho_def.unit,
+          "RHO: unsigned quantity with its unit");
+    CHECK(conv[rho].physical(512) == 512 * rho_def.scale, "RHO: scale × raw");
+    CHECK(conv[fl].signedValue(0x3FFF) == -1 && conv[fl].physical(0x3FFF) == -conv[fl].scale(),
+          "FL: 14-bit sign extension");
+    CHECK(conv[fl].physical(0x1FFF) == 0x1FFF * conv[fl].scale(), "FL: positive stays positive");
+    CHECK(conv[m3a].octal(0xF82) == 7602 && conv[m3a].octal(0) == 0, "MODE3A: octal digits");
+
+    bool tables = true;
+    for (const auto& [raw, text] : def.items.at("020").octets[0].elements[0].table)
+        tables &= conv[typ].text(raw) == text;
+    CHECK(tables && conv[typ].text(7 + 100).empty(), "TYP: dense table lookup");
+    CHECK(conv[rho].text(1).empty() && conv[kNoField].physical(3) == 3.0, "no table / unknown field");
+
+    ElementDef wide;
+    wide.bits     = 16;
+    wide.encoding = Encoding::Table;
+    wide.table    = {{1000, "far"}, {7, "near"}};
+    const FieldConverter wide_conv(wide);
+    CHECK(wide_conv.text(1000) == "far" && wide_conv.text(7) == "near" && wide_conv.text(8).empty(),
+          "16-bit table: map lookup");
+
+    // Batches: a columnar decode of the real frame, converted in one call each
+    ColumnarBatch cols(plan, std::vector<FieldId>{rho, fl, m3a});
+    (void)codec.decodeColumns(kRealFrame, cols);
+    std::vector<double>   nm(cols.rows()), flight_level(cols.rows());
+    std::vector<uint32_t> squawk(cols.rows());
+    conv[rho].toPhysical(cols.column(0).values, nm);
+    conv[fl].toPhysical(cols.column(1).values, flight_level);
+    conv[m3a].toOctal(cols.column(2).values, squawk);
+    bool batch = cols.rows() > 0;
+    for (size_t r = 0; r < cols.rows(); ++r)
+        batch &= nm[r] == conv[rho].physical(cols.column(0).values[r]) &&
+                 flight_level[r] == conv[fl].physical(cols.column(1).values[r]) &&
+                 squawk[r] == conv[m3a].octal(cols.column(2).values[r]);
+    CHECK(batch, "batch conversion == per-value conversion");
+
+    const std::vector<uint64_t> negative = {0x3FFF, 0x2000, 4};
+    std::vector<double> fls(3);
+    conv[fl].toPhysical(negative, fls);
+    CHECK(fls[0] == -conv[fl].scale() && fls[1] == -8192 * conv[fl].scale() &&
+          fls[2] == 4 * conv[fl].scale(), "batch sign extension");
+
+    bool threw = false;
+    try { conv[rho].toPhysical(negative, std::span<double>(fls).first(2)); }
+    catch (const std::invalid_argument&) { threw = true; }
+    CHECK(threw, "short output throws");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 23: Metrics – per-category counters, faults, rejected headers and the
+//           latency histogram (only populated when built with ASTERIX_METRICS).
+// ─────────────────────────────────────────────────────────────────────────────
+static void testMetrics(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 decode metrics ===\n";
+
+    Codec local; // fresh counters
+    local.registerCategory(codec.category(48));
+
+    CodecMetrics m = local.metrics();
+    CHECK(m.enabled == kMetricsEnabled, "metrics().enabled follows ASTERIX_METRICS");
+    if constexpr (!kMetricsEnabled) {
+        CHECK(m.categories.empty(), "no counters without ASTERIX_METRICS");
+        std::string text;
+        writePrometheus(text, m);
+        CHECK(text.empty(), "nothing exported without ASTERIX_METRICS");
+        return;
+    }
+
+    const CategoryPlan& plan = local.plan(48);
+    const ItemIndex i010 = plan.findItem("010");
+
+    DecodeContext ctx;
+    (void)local.decode(kRealFrame);
+    (void)local.decodeCompact(kRealFrame);
+    (void)local.decodeInto(kRealFrame, ctx);
+    (void)local.view(kRealFrame); // walked, items only measured
+
+    std::vector<uint8_t> cut = kRealFrame; // LEN ends inside the first record
+    cut[1] = 0x00;
+    cut[2] = 0x14;
+    (void)local.decode(cut);
+    (void)local.decode(std::vector<uint8_t>{0x99, 0x00, 0x03}); // unregistered CAT
+    (void)local.decode(std::vector<uint8_t>{48});               // short header
+
+    m = local.metrics();
+    const CategoryMetrics* c = m.find(48);
+    CHECK(c != nullptr && m.categories.size() == 1, "one CategoryMetrics per registered category");
+    if (!c) return;
+    CHECK(c->blocks == 5, "blocks counted by every whole-block entry point");
+    CHECK(c->records == 4 * 9, "records of the good blocks");
+    CHECK(c->bytes == 4 * kRealFrame.size() + 0x14, "bytes = Data Block LENs");
+    CHECK(i010 < c->items.size() && c->items[i010] == 3 * 9 + 1,
+          "I010 counted per extracted record, the truncated one included");
+    uint64_t faults = 0;
+    for (uint64_t n : c->faults) faults += n;
+    CHECK(faults == 1, "truncated record counted as one fault");
+    CHECK(m.rejected[static_cast<size_t>(DecodeErrc::UnknownCategory)] == 1, "unregistered CAT rejected");
+    CHECK(m.rejected[static_cast<size_t>(DecodeErrc::ShortHeader)] == 1, "short header rejected");
+    CHECK(c->latency.count() == c->blocks, "one latency sample per block");
+    CHECK(LatencyHistogram::bucket(256) == 0 && LatencyHistogram::bucket(257) == 1 &&
+          LatencyHistogram::bucket(UINT64_MAX) == LatencyHistogram::kBuckets - 1,
+          "latency buckets are log2 upper bounds");
+
+    // Worker threads add to their own shards; the snapshot sums them.
+    std::vector<std::span<const uint8_t>> batch(64, std::span<const uint8_t>(kRealFrame));
+    (void)local.decodeBatch(batch, {4, 1});
+    m = local.metrics();
+    CHECK(m.find(48)->blocks == 5 + 64 && m.find(48)->records == (4 + 64) * 9,
+          "parallel decodes counted exactly");
+
+    std::string text;
+    writePrometheus(text, m);
+    CHECK(text.find("asterix_blocks_total{cat=\"48\"} 69\n") != std::string::npos, "Prometheus block counter");
+    CHECK(text.find("asterix_items_total{cat=\"48\",item=\"010\"} 604\n") != std::string::npos,
+          "Prometheus item counter");
+    CHECK(text.find("asterix_rejected_blocks_total{reason=\"unknown_category\"} 1\n") != std::string::npos,
+          "Prometheus rejected counter");
+    CHECK(text.find("asterix_block_decode_seconds_bucket{cat=\"48\",le=\"+Inf\"} 69\n") != std::string::npos &&
+          text.find("asterix_block_decode_seconds_count{cat=\"48\"} 69\n") != std::string::npos,
+          "Prometheus latency histogram");
+
+    local.resetMetrics();
+    m = local.metrics();
+    CHECK(m.find(48)->blocks == 0 && m.find(48)->items[i010] == 0 && m.rejected[static_cast<size_t>(DecodeErrc::UnknownCategory)] == 0,
+          "resetMetrics() clears every counter");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 24: Recording files – mmap iteration, I140 times across midnight,
+//           seek by time, persisted index, Final packets.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testRecording(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 RecordingReader ===\n";
+
+    const fs::path dir = fs::temp_directory_path() / "asterix_test_recording";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    // Block i: one record with TOD = 86000 + i/2 s (wrapping past midnight);
+    // every 100th block is followed by an untimed block of category 240.
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    const size_t n = 2000;
+    std::vector<std::vector<uint8_t>> blocks;
+    std::vector<double> times;
+    for (size_t i = 0; i < n; ++i) {
+        DecodedRecord rec = ref.records[i % ref.records.size()];
+        const double t = 86000.0 + static_cast<double>(i) * 0.5;
+        rec.items.at("140").fields.at("TOD") = static_cast<uint64_t>(std::fmod(t, 86400.0) * 128);
+        blocks.push_back(codec.encode(48, {rec}));
+        times.push_back(t);
+        if (i % 100 == 99) {
+            blocks.push_back({240, 0x00, 0x05, 0xAB, 0xCD});
+            times.push_back(t); // carries the latest time
+        }
+    }
+
+    const fs::path raw = dir / "raw.ast";
+    {
+        std::ofstream f(raw, std::ios::binary);
+        for (const auto& b : blocks) f.write(reinterpret_cast<const char*>(b.data()), static_cast<std::streamsize>(b.size()));
+        f.put(0x30); // truncated tail
+    }
+
+    RecordingOptions opts;
+    opts.index_stride = 64;
+    {
+        RecordingReader rec{raw, codec, opts};
+        CHECK(rec.format() == RecordingFormat::Raw, "raw recording detected");
+        CHECK(!rec.indexLoaded() && fs::exists(dir / "raw.ast.asxi"), "index built and saved");
+        CHECK(rec.blocks() == blocks.size() && rec.trailing() == 1, "every block indexed, tail reported");
+        CHECK(rec.index().size() == (blocks.size() + 63) / 64, "one index entry per stride");
+        CHECK(rec.index()[0].categories.test(48) && rec.index()[1].categories.test(240),
+              "index entries carry their categories");
+
+        size_t i = 0;
+        uint64_t offset = 0;
+        bool same = true;
+        for (auto it = rec.begin(); it != rec.end(); ++it, ++i) {
+            same &= i < blocks.size() && it->offset == offset &&
+                    std::equal(it->bytes.begin(), it->bytes.end(), blocks[i].begin(), blocks[i].end()) &&
+                    it->time == times[i] && it->timed == (it->cat == 48);
+            offset += it->bytes.size();
+        }
+        CHECK(same && i == blocks.size(), "zero-copy iteration: bytes, offsets, unwrapped times");
+        CHECK(rec.bytes().data() + rec.begin()->offset == rec.begin()->bytes.data(), "blocks point into the mapping");
+
+        auto it = rec.seek(86500.0); // 00:01:40 on the next day
+        CHECK(it != rec.end() && it->time == 86500.0 && it->cat == 48, "seek() lands on the first block at t");
+        it = rec.seek(86000.25);
+        CHECK(it != rec.end() && it->time == 86000.5, "seek() between blocks");
+        CHECK(rec.seek(0)->offset == 0, "seek() before the start");
+        CHECK(rec.seek(1e9) == rec.end(), "seek() past the end");
+
+        size_t window = 0;
+        for (auto w = rec.seek(86100.0); w != rec.end() && w->time < 86200.0; ++w) window += w->cat == 48;
+        CHECK(window == 200, "time window replay");
+    }
+    {
+        RecordingReader rec{raw, codec, opts};
+        CHECK(rec.indexLoaded() && rec.blocks() == blocks.size(), "index reused on reopen");
+        auto it = rec.seek(86500.0);
+        CHECK(it != rec.end() && it->time == 86500.0, "seek() through the loaded index");
+    }
+    opts.index_stride = 32;
+    CHECK(!RecordingReader(raw, codec, opts).indexLoaded(), "index with another stride rebuilt");
+
+    // Final format: [count][failure][line][day][time 10 ms][blocks][A5×4];
+    // two blocks per packet, the second one untimed but for its packet time.
+    const fs::path final_path = dir / "final.ff";
+    {
+        std::ofstream f(final_path, std::ios::binary);
+        for (size_t p = 0; p < 10; ++p) {
+            std::vector<uint8_t> body = blocks[p];
+            body.insert(body.end(), {240, 0x00, 0x03});
+            const size_t count = 8 + body.size() + 4;
+            const uint32_t t10 = static_cast<uint32_t>(p * 100); // p s
+            const uint8_t hdr[8] = {static_cast<uint8_t>(count >> 8), static_cast<uint8_t>(count), 0, 1, 1,
+                                    static_cast<uint8_t>(t10 >> 16), static_cast<uint8_t>(t10 >> 8),
+                                    static_cast<uint8_t>(t10)};
+            f.write(reinterpret_cast<const char*>(hdr), 8);
+            f.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+            f.write("\xA5\xA5\xA5\xA5", 4);
+        }
+    }
+    RecordingOptions fopts;
+    fopts.persist_index = false;
+    RecordingReader fin{final_path, codec, fopts};
+    size_t fblocks = 0, packet_timed = 0;
+    for (const RecordedBlock& b : fin) {
+        ++fblocks;
+        packet_timed += b.cat == 240 && b.timed;
+    }
+    CHECK(fin.format() == RecordingFormat::Final && fin.blocks() == 20 && fblocks == 20,
+          "Final packets detected and unpacked");
+    CHECK(packet_timed == 10, "blocks without a time item take the packet time");
+    CHECK(!fs::exists(dir / "final.ff.asxi"), "persist_index = false writes nothing");
+
+    fs::remove_all(dir);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 25: Record filter – predicates on raw bytes; decode through a
+//           filtered Projection keeps exactly the matching records.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testRecordFilter(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 record filter (predicate pushdown) ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    const RecordIndex index = codec.scanRecords(kRealFrame);
+
+    const auto trn = [](const DecodedRecord& r) -> int64_t {
+        auto it = r.items.find("161");
+        return it == r.items.end() ? -1 : static_cast<int64_t>(it->second.fields.at("TRN"));
+    };
+    const auto expect = [&](auto&& pred) {
+        DecodedBlock want = ref;
+        want.records.clear();
+        for (const auto& r : ref.records)
+            if (pred(r)) want.records.push_back(r);
+        return want;
+    };
+    const auto agrees = [&](const RecordFilter& f, auto&& pred) {
+        for (size_t i = 0; i < index.records.size(); ++i) {
+            const RecordOffset& r = index.records[i];
+            const bool want = pred(ref.records[i]);
+            if (f.matches(std::span<const uint8_t>(kRealFrame).subspan(r.offset, r.length)) != want)
+                return false;
+            size_t len = 0; // a rejected record is measured to its end
+            if (f.matches(std::span<const uint8_t>(kRealFrame).subspan(r.offset), len) != want ||
+                len != (want ? 0 : r.length))
+                return false;
+        }
+        Projection proj;
+        proj.filter(f);
+        DecodeContext ctx;
+        const DecodedBlock want = expect(pred);
+        BatchOptions popts{2, 1, &proj};
+        return sameRecords(codec.decode(kRealFrame, proj), want) &&
+               sameRecords(codec.decodeInto(kRealFrame, ctx, proj), want) &&
+               codec.decodeCompact(kRealFrame, proj).records.size() == want.records.size() &&
+               sameRecords(codec.decodeParallel(kRealFrame, popts), want);
+    };
+
+    const int64_t t0 = trn(ref.records[0]);
+    const int64_t t4 = trn(ref.records[4]);
+    CHECK(t0 >= 0 && t4 >= 0 && t0 != t4, "real frame carries I161 track numbers");
+
+    RecordFilter all(plan);
+    CHECK(all.empty() && agrees(all, [](const DecodedRecord&) { return true; }), "empty filter keeps all");
+
+    RecordFilter sac(plan);
+    sac.equals("010", "SAC", ref.records[0].items.at("010").fields.at("SAC"));
+    CHECK(agrees(sac, [](const DecodedRecord&) { return true; }), "equals on I010/SAC");
+
+    RecordFilter none(plan);
+    none.equals("010", "SIC", 0xFF);
+    CHECK(agrees(none, [](const DecodedRecord&) { return false; }) &&
+          codec.decode(kRealFrame, [&] { Projection p; p.filter(none); return p; }()).valid,
+          "no match: empty but valid block");
+
+    RecordFilter tracks(plan);
+    tracks.oneOf("161", "TRN", {static_cast<uint64_t>(t4), static_cast<uint64_t>(t0)});
+    CHECK(agrees(tracks, [&](const DecodedRecord& r) { return trn(r) == t0 || trn(r) == t4; }),
+          "oneOf on I161/TRN");
+
+    RecordFilter range(plan);
+    range.between("161", "TRN", static_cast<uint64_t>(std::min(t0, t4)),
+                  static_cast<uint64_t>(std::max(t0, t4)));
+    CHECK(agrees(range, [&](const DecodedRecord& r) {
+              return trn(r) >= std::min(t0, t4) && trn(r) <= std::max(t0, t4);
+          }), "between on I161/TRN");
+
+    RecordFilter dnf(plan);
+    dnf.equals("161", "TRN", static_cast<uint64_t>(t0)).present("040")
+       .orElse().equals("161", "TRN", static_cast<uint64_t>(t4)).absent("250")
+       .orElse();
+    CHECK(agrees(dnf, [&](const DecodedRecord& r) {
+              return (trn(r) == t0 && r.items.count("040")) || (trn(r) == t4 && !r.items.count("250"));
+          }), "OR of ANDs with present / absent, trailing orElse()");
+
+    // Filter and field selection together, in either order
+    Projection both;
+    both.filter(tracks).select(plan, {{"010"}, {"161"}});
+    const DecodedBlock got = codec.decode(kRealFrame, both);
+    bool narrowed = got.records.size() == 2;
+    for (const auto& r : got.records) narrowed &= r.items.size() == 2 && r.items.count("161");
+    CHECK(narrowed, "select() after filter() keeps the filter");
+
+    bool threw = false;
+    try { RecordFilter f(plan); f.equals("130", "SRL", 1); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "field of a non-Fixed item rejected");
+    threw = false;
+    try { RecordFilter f(plan); f.equals("161", "NOPE", 1); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown field rejected");
+
+    const std::vector<uint8_t> truncated(kRealFrame.begin(), kRealFrame.begin() + 3 + 20);
+    std::vector<uint8_t> bad = truncated;
+    bad[1] = 0;
+    bad[2] = static_cast<uint8_t>(bad.size());
+    Projection pf;
+    pf.filter(tracks);
+    const DecodedBlock failed = codec.decode(bad, pf);
+    CHECK(!failed.valid && failed.fault.code == codec.decode(bad).fault.code,
+          "malformed skipped record still fails the block");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 26: Borrowed bytes – SP / RE payloads and item wire bytes as spans
+//           into the decoded buffer, re-encoded without a copy.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testBorrowedBytes(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 borrowed payloads / item passthrough ===\n";
+
+    DecodedRecord src;
+    src.items["010"].fields = {{"SAC", 8}, {"SIC", 1}};
+    src.items["140"].fields = {{"TOD", 4000000}};
+    for (int i = 0; i < 40; ++i) src.items["SP"].raw_bytes.push_back(static_cast<uint8_t>(i * 3));
+    src.items["RE"].raw_bytes = {0xAA, 0x55, 0x01};
+    const std::vector<uint8_t> frame = codec.encode(48, {src, src});
+
+    const auto inFrame = [&](std::span<const uint8_t> s) {
+        return !s.empty() && s.data() >= frame.data() && s.data() + s.size() <= frame.data() + frame.size();
+    };
+    const auto sameBytes = [](std::span<const uint8_t> a, const std::vector<uint8_t>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    };
+
+    // ── Payloads: spans instead of raw_bytes ────────────────────────────────
+    Projection payloads;
+    payloads.borrow(BorrowMode::Payloads);
+    const DecodedBlock pb = codec.decode(frame, payloads);
+    bool ok = pb.valid && pb.records.size() == 2;
+    for (const auto& r : pb.records)
+        for (const char* id : {"SP", "RE"}) {
+            const DecodedItem& di = r.items.at(id);
+            ok &= di.raw_bytes.empty() && inFrame(di.payload) && di.wire.empty() &&
+                  sameBytes(di.payload, src.items.at(id).raw_bytes);
+        }
+    CHECK(ok, "SP / RE payloads borrowed from the frame");
+    CHECK(codec.encode(48, pb.records) == frame, "borrowed payloads re-encode");
+
+    const DecodedBlock par = codec.decodeParallel(frame, BatchOptions{2, 1, &payloads});
+    CHECK(par.records.size() == 2 && inFrame(par.records[1].items.at("SP").payload),
+          "decodeParallel honours borrow()");
+
+    const CompactBlock cb = codec.decodeCompact(frame, payloads);
+    const CategoryPlan& plan = codec.plan(48);
+    const ItemIndex isp = plan.findItem("SP");
+    ok = cb.records.size() == 2;
+    for (const auto& r : cb.records)
+        ok &= r.raw.empty() && inFrame(r.bytes) && inFrame(r.item(isp).payload()) &&
+              sameBytes(r.item(isp).payload(), src.items.at("SP").raw_bytes);
+    CHECK(ok, "CompactRecord payloads borrowed from the frame");
+
+    // ── Items: whole wire bytes, passed through on encode ───────────────────
+    Projection items;
+    items.borrow(BorrowMode::Items).select(plan, {{"010"}, {"SP"}, {"RE"}});
+    DecodedBlock ib = codec.decode(frame, items);
+    ok = ib.records.size() == 2;
+    for (const auto& r : ib.records)
+        for (const auto& [id, di] : r.items) ok &= inFrame(di.wire);
+    const DecodedItem& sp = ib.records[0].items.at("SP");
+    CHECK(ok && sp.wire.size() == sp.payload.size() + 1 && sp.wire.data() + 1 == sp.payload.data(),
+          "every kept item carries its wire bytes");
+
+    DecodedRecord fwd = ib.records[0];
+    fwd.items["010"].fields.clear(); // values ignored: the wire bytes are written
+    DecodedRecord want = src;
+    want.items.erase("140");
+    CHECK(codec.encode(48, {fwd}) == codec.encode(48, {want}), "wire bytes encoded verbatim");
+
+    fwd.items["SP"].wire = ib.records[0].items.at("010").wire;
+    bool threw = false;
+    try { (void)codec.encode(48, {fwd}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "wire bytes that are not one item rejected");
+
+    // ── A context reused without borrowing drops the spans ──────────────────
+    DecodeContext ctx;
+    (void)codec.decodeInto(frame, ctx, items);
+    const DecodedBlock& copied = codec.decodeInto(frame, ctx);
+    const DecodedItem& csp = copied.records[0].items.at("SP");
+    CHECK(csp.payload.empty() && csp.wire.empty() && csp.raw_bytes == src.items.at("SP").raw_bytes,
+          "copy decode after a borrowed one owns its payloads");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 27: Block editor – SAC/SIC and I140 patched in place, items spliced
+//           in and out with FSPEC and LEN rebuilt.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testBlockEditor(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 block editor (patch / splice) ===\n";
+
+    const CategoryDef&  def  = codec.category(48);
+    const CategoryPlan& plan = codec.plan(48);
+    const DecodedBlock  ref  = codec.decode(kRealFrame);
+
+    BlockEditor ed{codec};
+    CHECK(!ed.load(kRealFrame) && ed.size() == ref.records.size() &&
+          std::equal(ed.bytes().begin(), ed.bytes().end(), kRealFrame.begin()), "load copies the block");
+
+    // ── In-place patches ────────────────────────────────────────────────────
+    DecodedBlock want = ref;
+    for (auto& r : want.records) {
+        r.items.at("010").fields = {{"SAC", 25}, {"SIC", 7}};
+        if (r.items.count("140")) r.items.at("140").fields.at("TOD") += 128;
+    }
+    const uint64_t tod0 = ref.records[0].items.at("140").fields.at("TOD");
+    CHECK(ed.set(findField(def, "010", "SAC"), 25) == ref.records.size() &&
+          ed.set(findField(def, "010", "SIC"), 7) == ref.records.size(), "I010 patched in every record");
+    bool timed = true;
+    for (size_t r = 0; r < ed.size(); ++r)
+        if (ref.records[r].items.count("140"))
+            timed &= ed.set(r, findField(def, "140", "TOD"),
+                            ref.records[r].items.at("140").fields.at("TOD") + 128);
+    CHECK(timed && ed.bytes().size() == kRealFrame.size() && sameRecords(codec.decode(ed.bytes()), want),
+          "in-place patches decode as the edited records");
+    CHECK(ed.record(0).item("140").field(findField(def, "140", "TOD")) == tod0 + 128,
+          "view follows the patched bytes");
+
+    bool threw = false;
+    try { (void)ed.set(0, findField(def, "130", "SRL", "SRL"), 1); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "Compound field cannot be patched in place");
+
+    // ── Splicing ────────────────────────────────────────────────────────────
+    // Remove I040 from record 1
+    const ItemIndex i040 = plan.findItem("040");
+    const size_t    len0 = ed.bytes().size();
+    const size_t    rec1 = ed.record(1).bytes().size();
+    const size_t    i040_len = ed.record(1).item(i040).bytes().size();
+    CHECK(i040_len != 0 && ed.erase(1, i040) && !ed.erase(1, i040), "I040 erased once");
+    want.records[1].items.erase("040");
+    DecodedBlock got = codec.decode(ed.bytes());
+    CHECK(got.valid && got.length == ed.bytes().size() && ed.bytes().size() == len0 - i040_len &&
+          ed.record(1).bytes().size() == rec1 - i040_len && sameRecords(got, want),
+          "erase shrinks record and LEN, others untouched");
+
+    threw = false;
+    try { (void)ed.erase(1, plan.findItem("010")); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw && ed.record(1).valid() && ed.record(1).hasItem(plan.findItem("010")), "mandatory I010 not erased");
+
+    // Insert an SP item into the last record (FSPEC grows to reach slot 27)
+    DecodedItem sp;
+    sp.item_id   = "SP";
+    sp.type      = ItemType::SP;
+    sp.raw_bytes = {0x10, 0x20, 0x30};
+    const size_t last = ed.size() - 1;
+    ed.put(last, sp);
+    want.records[last].items["SP"] = sp;
+    got = codec.decode(ed.bytes());
+    CHECK(got.valid && got.length == ed.bytes().size() && sameRecords(got, want), "SP spliced in");
+
+    // Replace I040 of record 0 with the wire bytes of record 2's
+    const auto i040_2 = ed.record(2).item(i040).bytes();
+    const std::vector<uint8_t> moved(i040_2.begin(), i040_2.end());
+    ed.put(0, i040, moved);
+    want.records[0].items.at("040") = want.records[2].items.at("040");
+    CHECK(sameRecords(codec.decode(ed.bytes()), want), "item replaced from raw bytes");
+
+    threw = false;
+    try { ed.put(0, i040, std::vector<uint8_t>{0x01}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "bytes that are not one item rejected");
+
+    std::vector<uint8_t> bad = kRealFrame;
+    bad[2] = static_cast<uint8_t>(bad[2] - 5);
+    CHECK(ed.load(bad) && ed.size() == 0 && ed.bytes().empty(), "invalid block refused");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 28: Block packer – records packed under a byte budget, closed on
+//           size / time / flush, in a ring of reused buffers.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testBlockPacker(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 block packer ===\n";
+
+    const DecodedBlock ref   = codec.decode(kRealFrame);
+    const RecordIndex  index = codec.scanRecords(kRealFrame);
+
+    std::vector<std::vector<uint8_t>> sent;
+    std::vector<const uint8_t*>       buffers;
+    const auto sink = [&](std::span<const uint8_t> b) {
+        sent.emplace_back(b.begin(), b.end());
+        if (std::find(buffers.begin(), buffers.end(), b.data()) == buffers.end()) buffers.push_back(b.data());
+    };
+    // Records of every sent block, in order, as one block
+    const auto received = [&] {
+        DecodedBlock all = ref;
+        all.records.clear();
+        for (const auto& b : sent) {
+            const DecodedBlock d = codec.decode(b);
+            if (!d.valid || d.length != b.size()) all.valid = false;
+            all.records.insert(all.records.end(), d.records.begin(), d.records.end());
+        }
+        return all;
+    };
+
+    // ── Byte budget: the first four records fit, the fifth opens a block ─────
+    size_t budget = 3;
+    for (size_t i = 0; i < 4; ++i) budget += index.records[i].length;
+    {
+        BlockPacker packer{codec, 48, {.max_block_bytes = budget, .ring_size = 2}, sink};
+        for (const auto& r : ref.records) packer.add(r);
+        CHECK(sent.size() == 2 && sent[0].size() == budget && packer.pending() == 1,
+              "block closed when full, next record carried over");
+        packer.flush();
+        packer.flush(); // nothing pending: no empty block
+        bool within = packer.blocks() == sent.size();
+        for (const auto& b : sent) within &= b.size() <= budget;
+        CHECK(within && sameRecords(received(), ref), "every record delivered once, in order");
+        CHECK(buffers.size() == 2, "output ring of two buffers reused");
+    }
+
+    // ── Pre-encoded records, one block under a large budget ──────────────────
+    sent.clear();
+    {
+        BlockPacker packer{codec, 48, {.max_delay = std::chrono::minutes(1)}, sink};
+        for (const auto& r : index.records)
+            packer.add(std::span<const uint8_t>(kRealFrame).subspan(r.offset, r.length));
+        CHECK(sent.empty() && packer.pendingBytes() == kRealFrame.size(), "records wait under budget");
+        CHECK(!packer.poll(BlockPacker::Clock::now()) && sent.empty(), "poll() before max_delay keeps the block");
+        CHECK(packer.poll(BlockPacker::Clock::now() + std::chrono::minutes(2)) && sent.size() == 1 &&
+              sent[0] == kRealFrame, "poll() after max_delay sends the byte-exact block");
+
+        bool threw = false;
+        try { packer.add(std::vector<uint8_t>{0x80}); } catch (const std::runtime_error&) { threw = true; }
+        CHECK(threw && packer.pending() == 0, "bytes that are not one record rejected");
+
+        DecodedRecord bad = ref.records[0];
+        bad.uap_variation = "nope";
+        threw = false;
+        packer.add(ref.records[1]);
+        try { packer.add(bad); } catch (const std::runtime_error&) { threw = true; }
+        CHECK(threw && packer.pending() == 1 && packer.pendingBytes() == 3 + index.records[1].length,
+              "failed encode leaves the open block as it was");
+    }
+
+    // ── Budget below one record: each record alone ────────────────────────────
+    sent.clear();
+    {
+        BlockPacker packer{codec, 48, {.max_block_bytes = 4, .ring_size = 1}, sink};
+        for (const auto& r : ref.records) packer.add(r);
+        CHECK(sent.size() == ref.records.size() && packer.pending() == 0 && sameRecords(received(), ref),
+              "oversize records sent one per block");
+    }
+
+    bool threw = false;
+    try { BlockPacker p{codec, 48, {.max_block_bytes = 70000}, sink}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "budget above 65535 rejected");
+}
+
+#ifdef ASTERIX_INGEST
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 29: UDP ingest – datagrams from two sources over loopback, routed to
+//           two workers, decoded in per-source order; drop counters.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testUdpIngest(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 UDP ingest pipeline ===\n";
+
+    const CategoryPlan& plan = codec.plan(48);
+    const FieldId  tod  = findField(codec.category(48), "140", "TOD");
+    const ItemIndex i140 = plan.findItem("140");
+
+    std::mutex mu;
+    std::map<uint16_t, std::vector<uint64_t>> seen; // source port → record 0 TOD, in arrival order
+    std::atomic<size_t> records{0};
+    UdpIngest ingest{codec,
+                     {.bind_address = "127.0.0.1", .workers = 2, .ring_slots = 256,
+                      .socket_buffer = 1 << 20, .decode = IngestDecode::Compact},
+                     [&](const IngestedBlock& b) {
+                         records += b.compact->records.size();
+                         const uint64_t t = b.compact->records[0].item(i140).field(tod);
+                         std::lock_guard lock{mu};
+                         seen[b.port].push_back(t);
+                     }};
+    ingest.start();
+
+    sockaddr_in to{};
+    to.sin_family      = AF_INET;
+    to.sin_port        = htons(ingest.port());
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const int senders[2] = {::socket(AF_INET, SOCK_DGRAM, 0), ::socket(AF_INET, SOCK_DGRAM, 0)};
+    const auto send = [&](int fd, std::span<const uint8_t> d) {
+        return ::sendto(fd, d.data(), d.size(), 0, reinterpret_cast<const sockaddr*>(&to), sizeof to) ==
+               static_cast<ssize_t>(d.size());
+    };
+
+    constexpr size_t kPerSource = 200;
+    BlockEditor ed{codec};
+    bool sent = ed.load(kRealFrame).code == DecodeErrc::None;
+    for (size_t i = 0; i < kPerSource; ++i) {
+        (void)ed.set(0, tod, 1000 + i);
+        for (int fd : senders) sent &= send(fd, ed.bytes());
+        if (i % 16 == 15) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const std::vector<uint8_t> junk{0xFF, 0x00, 0x01, 0x02};
+    const std::vector<uint8_t> huge(10000, 0x30);
+    sent &= send(senders[0], junk) && send(senders[0], huge);
+    CHECK(sent, "datagrams sent over loopback");
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    IngestStats st;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        st = ingest.stats();
+    } while (st.datagrams + st.truncated + st.ring_drops < 2 * kPerSource + 2 &&
+             std::chrono::steady_clock::now() < deadline);
+    ingest.stop();
+    for (int fd : senders) ::close(fd);
+    st = ingest.stats();
+
+    const uint64_t lost = st.ring_drops + st.kernel_drops;
+    CHECK(st.truncated == 1, "datagram above max_datagram counted as truncated");
+    CHECK(st.datagrams == 2 * kPerSource + 1 - lost && st.workers.size() == 2, "every datagram queued");
+    uint64_t decoded = 0, skipped = 0;
+    for (const auto& w : st.workers) {
+        decoded += w.datagrams;
+        skipped += w.bytes_skipped;
+    }
+    CHECK(decoded == st.datagrams && skipped == junk.size() && records == (st.datagrams - 1) * 9,
+          "workers drained the rings; junk skipped by framing");
+
+    bool ordered = seen.size() == 2;
+    for (const auto& [port, tods] : seen)
+        ordered &= std::is_sorted(tods.begin(), tods.end()) && (lost != 0 || tods.size() == kPerSource);
+    CHECK(ordered, "each source decoded in order");
+
+    std::string text;
+    writePrometheus(text, st);
+    CHECK(text.find("asterix_ingest_datagrams_total " + std::to_string(st.datagrams) + "\n") != std::string::npos &&
+          text.find("asterix_ingest_queue_high_water{worker=\"1\"}") != std::string::npos, "Prometheus export");
+
+    bool threw = false;
+    try { UdpIngest bad{codec, {.groups = {"not-an-address"}}, [](const IngestedBlock&) {}}; }
+    catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "bad multicast group rejected");
+}
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 30: Hot reload – CAT48 re-registered while threads decode; every block
+//           decodes with one whole plan, replaced plans stay readable until
+//           reclaimed, projections of a replaced plan report stale.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testHotReload(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 registry hot reload ===\n";
+
+    Codec live = codec; // a copy: later reloads stay local to it
+    const CategoryPlan* first  = &live.plan(48);
+    const CompactBlock  before = live.decodeCompact(kRealFrame);
+    const size_t        expect = before.records.size();
+    Projection          proj;
+    proj.select(live.plan(48), {{"010"}, {"140"}});
+    proj.filter(RecordFilter(live.plan(48)));
+
+    std::atomic<bool>     stop{false};
+    std::atomic<unsigned> bad{0}, decoded{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&] {
+            DecodeContext ctx;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const CompactBlock& b = live.decodeCompactInto(kRealFrame, ctx);
+                bool ok = b.valid && b.records.size() == expect;
+                for (const auto& r : b.records)
+                    ok &= r.plan == b.records.front().plan && !r.plan->def.edition.empty();
+                if (!ok) bad.fetch_add(1, std::memory_order_relaxed);
+                decoded.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+    CategoryDef edition = codec.category(48);
+    for (int i = 0; i < 50; ++i) {
+        edition.edition = "reload-" + std::to_string(i);
+        live.registerCategory(edition);
+    }
+    while (decoded.load() < 100) std::this_thread::yield();
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    CHECK(bad.load() == 0,                                "every block decoded with one plan");
+    CHECK(live.plan(48).def.edition == "reload-49",       "last reload is current");
+    CHECK(live.decodeCompact(kRealFrame).records.at(0).plan == &live.plan(48),
+          "new decodes use the new plan");
+    CHECK(first->def.edition == codec.category(48).edition && first != &live.plan(48),
+          "replaced plan still readable");
+    const CompactBlock now = codec.decodeCompact(kRealFrame);
+    CHECK(before.records.at(0).plan == first && before.records[0].values == now.records.at(0).values &&
+          before.records[0].variationName() == now.records[0].variationName(),
+          "older results still read through the old plan");
+    CHECK(&codec.plan(48) == first,                       "the original codec is unaffected");
+    CHECK(live.hasCategory(48) && !live.hasCategory(49),  "hasCategory");
+
+    CHECK(live.reclaimRetired() == 50 && live.reclaimRetired() == 0, "replaced plans reclaimed once");
+    CHECK(live.plan(48).def.edition == "reload-49" && live.decodeCompact(kRealFrame).valid,
+          "current plan kept");
+    CHECK(&codec.plan(48) == first && codec.decodeCompact(kRealFrame).valid,
+          "a plan shared with a copy outlives the reclaim");
+
+    CHECK(proj.stale(live.plan(48)) && !proj.find(live.plan(48)), "projection of a replaced plan is stale");
+    const DecodedBlock stale = live.decode(kRealFrame, proj);
+    CHECK(!stale.valid && stale.fault.code == DecodeErrc::StaleProjection && stale.fault.value == 48 &&
+          stale.records.empty() && !stale.error.empty(), "stale projection fails the block");
+    BatchOptions popts{2, 1, &proj};
+    const CompactBlock stale_par = live.decodeCompactParallel(kRealFrame, popts);
+    CHECK(!stale_par.valid && stale_par.fault.code == DecodeErrc::StaleProjection &&
+          stale_par.records.empty(), "stale projection fails a parallel decode");
+    proj.select(live.plan(48), {{"010"}, {"140"}});
+    const DecodedBlock fresh = live.decode(kRealFrame, proj);
+    CHECK(!proj.stale(live.plan(48)) && fresh.valid && fresh.records.size() == expect &&
+          fresh.records.at(0).items.size() == 2, "select() again after a reload");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 31: Validation levels – Structural skips the mandatory check, Full
+//           adds the spec's min / max (I140 TOD ≤ 86400 s).
+// ─────────────────────────────────────────────────────────────────────────────
+static void testValidationLevels(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 validation levels ===\n";
+
+    const CategoryDef&  def  = codec.category(48);
+    const CategoryPlan& plan = codec.plan(48);
+    const DecodedBlock  ref  = codec.decode(kRealFrame);
+    const ItemIndex     i140 = plan.findItem("140");
+    CHECK(plan.items[i140].limits.count == 1 && plan.items[plan.findItem("042")].limits.count == 2 &&
+          plan.items[plan.findItem("020")].limits.count == 0, "limits compiled from min / max");
+
+    Projection structural, full;
+    structural.validate(Validation::Structural);
+    full.validate(Validation::Full);
+    bool clean = true;
+    for (const auto& r : codec.decode(kRealFrame, full).records) clean &= r.valid;
+    CHECK(clean, "real frame passes Full");
+
+    std::vector<DecodedRecord> recs(ref.records.begin(), ref.records.begin() + 3);
+    recs[0].items.at("140").fields.at("TOD") = 0xFFFFFF; // 131072 s
+    recs[1].items.at("140").fields.at("TOD") = 86400 * 128;
+    recs[2].items.erase("010");
+    const std::vector<uint8_t> raw = codec.encode(48, recs);
+
+    const DecodedBlock mandatory = codec.decode(raw);
+    CHECK(mandatory.records.size() == 3 && mandatory.records[0].valid && mandatory.records[1].valid &&
+          mandatory.records[2].fault.code == DecodeErrc::MandatoryMissing, "default: mandatory only");
+    const RecordIndex index = codec.scanRecords(raw);
+    CHECK(codec.decodeRecordAt(raw, index, 2).fault.offset == mandatory.records[2].fault.offset &&
+          codec.decodeCompactRecordAt(raw, index, 2).fault.offset == mandatory.records[2].fault.offset &&
+          mandatory.records[2].fault.offset > 3, "decodeRecordAt(): fault offset from the Data Block");
+
+    bool lenient = true;
+    for (const auto& r : codec.decode(raw, structural).records) lenient &= r.valid;
+    CHECK(lenient, "Structural: no record checks");
+
+    const DecodedBlock strict = codec.decode(raw, full);
+    CHECK(strict.valid && strict.records.size() == 3, "Full: records kept");
+    if (strict.records.size() == 3) {
+        const DecodeError& f = strict.records[0].fault;
+        CHECK(!strict.records[0].valid && f.code == DecodeErrc::OutOfRange && f.item == i140 &&
+              f.sub == findField(def, "140", "TOD") && f.value == 0xFFFFFF && f.offset == 3,
+              "Full: TOD out of range");
+        CHECK(strict.records[0].error == describe(f, &plan) &&
+              strict.records[0].error.find("140/TOD") != std::string::npos, "Full: message");
+        CHECK(strict.records[1].valid, "Full: bound itself accepted");
+        CHECK(strict.records[2].fault.code == DecodeErrc::MandatoryMissing, "Full: mandatory still checked");
+        CHECK(strict.records[0].items.at("140").fields.at("TOD") == 0xFFFFFF, "Full: value still decoded");
+    }
+
+    const CompactBlock compact = codec.decodeCompact(raw, full);
+    DecodeContext ctx;
+    const CompactBlock& into = codec.decodeCompactInto(raw, ctx, full);
+    BatchOptions opts;
+    opts.projection = &full;
+    const std::span<const uint8_t> one[] = {raw};
+    const auto batch = codec.decodeBatch(one, opts);
+    CHECK(compact.records.size() == 3 && compact.records[0].fault.code == DecodeErrc::OutOfRange &&
+          into.records.size() == 3 && into.records[0].fault.code == DecodeErrc::OutOfRange &&
+          batch.at(0).records.at(0).fault.code == DecodeErrc::OutOfRange &&
+          codec.decodeParallel(raw, opts).records.at(0).fault.code == DecodeErrc::OutOfRange,
+          "Full through compact / into / batch / parallel");
+
+    // Signed quantities are compared sign-extended: X within ±1 NM
+    CategoryDef narrow = def;
+    for (auto& e : narrow.items.at("042").elements)
+        if (e.name == "X") e.min_val = -1, e.max_val = 1;
+    Codec other;
+    other.registerCategory(std::move(narrow));
+    const auto x_is = [&](uint64_t x) {
+        std::vector<DecodedRecord> one_rec = {ref.records[0]};
+        one_rec[0].items["042"] = {"042", ItemType::Fixed, {{"X", x}, {"Y", 0}}};
+        const DecodedBlock b = other.decode(other.encode(48, one_rec), full);
+        return b.records.size() == 1 && b.records[0].valid;
+    };
+    CHECK(x_is(0xFF80) && x_is(128) && !x_is(0x8000) && !x_is(129), "signed range: -1 / +1 NM accepted, beyond rejected");
+}
+
+#ifdef ASTERIX_HAVE_GENERATED
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 32: Generated codec – asterix_gen/cat048.hpp must decode and encode
+//           exactly like the interpreted codec.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testGeneratedCodec(const Codec& codec) {
+    std::cout << "\n=== Test: CAT48 generated codec vs. interpreted codec ===\n";
+    namespace g48 = gen::cat048;
+
+    const DecodedBlock ref = codec.decode(kRealFrame);
+    std::vector<g48::Record> recs;
+    CHECK(g48::decodeBlock(kRealFrame, recs),       "gen: real frame decodes");
+    CHECK(recs.size() == ref.records.size(),        "gen: same record count");
+
+    DecodedBlock bridged;
+    bridged.cat = 48;
+    for (const auto& r : recs) bridged.records.push_back(g48::toDecoded(r));
+    CHECK(sameRecords(bridged, ref),                "gen: toDecoded() == decode()");
+    CHECK(recs.at(0).i010 && recs[0].i010->SAC == ref.records[0].items.at("010").fields.at("SAC"),
+          "gen: typed I010/SAC");
+
+    std::vector<uint8_t> out;
+    g48::encodeBlock(recs, out);
+    CHECK(out == kRealFrame,                        "gen: decode → encode is byte-exact");
+
+    // From the interpreted representation: same bytes as Codec::encode()
+    std::vector<g48::Record> from;
+    for (const auto& r : ref.records) from.push_back(g48::fromDecoded(r));
+    out.clear();
+    g48::encodeBlock(from, out);
+    CHECK(out == codec.encode(48, ref.records),     "gen: fromDecoded() encodes like encode()");
+
+    // Length rules: a truncated frame is rejected
+    std::vector<uint8_t> cut(kRealFrame.begin(), kRealFrame.end() - 1);
+    cut[1] = static_cast<uint8_t>(cut.size() >> 8);
+    cut[2] = static_cast<uint8_t>(cut.size());
+    CHECK(!g48::decodeBlock(cut, recs) && !codec.decode(cut).valid, "gen: truncated frame rejected");
+    CHECK(recs.size() == ref.records.size() - 1,    "gen: records before the bad one kept");
+}
+#endif
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  main
 // ─────────────────────────────────────────────────────────────────────────────
@@ -1184,6 +2677,30 @@ int main(int argc, char* argv[]) {
         testMultiRecord(codec);
         testRealFrame(codec);
         testFullRoundTrip(codec);
+        testCompactDecode(codec);
+        testDecodeInto(codec);
+        testLazyView(codec);
+        testProjection(codec);
+        testEncodeInto(codec);
+        testStreamDecoder(codec);
+        testDecodeBatch(codec);
+        testDecodeErrors(codec);
+        testColumnarDecode(codec);
+        testConversions(codec);
+        testMetrics(codec);
+        testRecording(codec);
+        testRecordFilter(codec);
+        testBorrowedBytes(codec);
+        testBlockEditor(codec);
+        testBlockPacker(codec);
+#ifdef ASTERIX_INGEST
+        testUdpIngest(codec);
+#endif
+        testHotReload(codec);
+        testValidationLevels(codec);
+#ifdef ASTERIX_HAVE_GENERATED
+        testGeneratedCodec(codec);
+#endif
     }
 
     std::cout << "\n──────────────────────────────────\n";
@@ -4,14 +4,25 @@
 //   cmake -B build && cmake --build build
 //   ./build/test_cat62
 
+#include "ASTERIXCodec/Archive.hpp"
 #include "ASTERIXCodec/Codec.hpp"
+#include "ASTERIXCodec/Export.hpp"
 #include "ASTERIXCodec/SpecLoader.hpp"
+#include "ASTERIXCodec/TrackState.hpp"
+#include "ASTERIXCodec/Traffic.hpp"
+#ifdef ASTERIX_HAVE_GENERATED
+#include "asterix_gen/cat062.hpp"
+#endif
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -121,6 +132,51 @@ static void checkItemsMatch(const std::map<std::string, DecodedItem>& got,
     }
 }
 
+// ─── Compact ↔ map comparison helper ─────────────────────────────────────────
+// Every value of the map-based record must be reachable through the
+// interned-field accessors of the compact record, and vice versa for items.
+static int compactMismatches(const CategoryPlan& plan,
+                             const DecodedRecord& want,
+                             const CompactRecord& got,
+                             const std::string& label) {
+    const CategoryDef& def = plan.def;
+    int bad = 0;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok) { std::cerr << "FAIL [compact] " << label << " " << what << '\n'; ++bad; }
+    };
+    expect(got.valid == want.valid,                   "valid");
+    expect(got.variationName() == want.uap_variation, "variation");
+
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        const std::string& id = plan.items[idx].def->id;
+        auto it = want.items.find(id);
+        expect(got.hasItem(idx) == (it != want.items.end()), "I" + id + " presence");
+        if (it == want.items.end()) continue;
+
+        const DecodedItem& di = it->second;
+        const auto item = got.item(idx);
+        for (const auto& [name, val] : di.fields)
+            expect(item.field(findField(def, id, name)) == val, "I" + id + "." + name);
+        for (const auto& [sub, fields] : di.compound_sub_fields)
+            for (const auto& [name, val] : fields)
+                expect(item.field(findField(def, id, name, sub)) == val,
+                       "I" + id + "/" + sub + "." + name);
+        const size_t reps = di.repetitions.empty() ? di.group_repetitions.size()
+                                                   : di.repetitions.size();
+        expect(item.repetitions() == reps, "I" + id + " repetitions");
+        for (size_t r = 0; r < di.repetitions.size(); ++r)
+            expect(item.repetition(r) == di.repetitions[r], "I" + id + "[" + std::to_string(r) + "]");
+        for (size_t r = 0; r < di.group_repetitions.size(); ++r)
+            for (const auto& [name, val] : di.group_repetitions[r])
+                expect(item.field(findField(def, id, name), r) == val,
+                       "I" + id + "[" + std::to_string(r) + "]." + name);
+        const auto payload = item.payload();
+        expect(std::equal(payload.begin(), payload.end(),
+                          di.raw_bytes.begin(), di.raw_bytes.end()), "I" + id + " payload");
+    }
+    return bad;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  Test 1: XML spec loads and item types / UAP are correct
 // ─────────────────────────────────────────────────────────────────────────────
@@ -752,9 +808,7 @@ static void testMultiRecord(Codec& codec) {
 //    • RepetitiveGroupFX     (I510)
 //    • SP                    (raw payload)
 // ─────────────────────────────────────────────────────────────────────────────
-static void testFullRoundTrip(Codec& codec) {
-    std::cout << "\n=== Test: CAT62 full encode-decode round-trip ===\n";
-
+static DecodedRecord buildFullRecord() {
     DecodedRecord src;
     src.uap_variation = "default";
 
@@ -866,6 +920,14 @@ static void testFullRoundTrip(Codec& codec) {
       di.raw_bytes = {0xFF};
       src.items["SP"] = std::move(di); }
 
+    return src;
+}
+
+static void testFullRoundTrip(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 full encode-decode round-trip ===\n";
+
+    const DecodedRecord src = buildFullRecord();
+
     // ── Encode ────────────────────────────────────────────────────────────────
     auto encoded = codec.encode(62, {src});
     hexdump(encoded, "CAT62 full RT encoded");
@@ -886,6 +948,592 @@ static void testFullRoundTrip(Codec& codec) {
     checkItemsMatch(rec.items, src.items, "CAT62");
 }
 
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 12: Interned-field decode – decodeCompact() must expose exactly the
+//           values decode() produces, for every item type of the full record.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testCompactDecode(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 interned-field (compact) decode ===\n";
+
+    const CategoryDef& def = codec.category(62);
+    CHECK(!def.fields.empty(),                        "fields interned at load");
+    CHECK(findField(def, "010", "SAC") != kNoField,   "field I062/010.SAC has an ID");
+    CHECK(findField(def, "340", "RHO", "POS") != kNoField, "field I062/340/POS.RHO has an ID");
+    CHECK(findField(def, "010", "NOPE") == kNoField,  "unknown field → kNoField");
+
+    auto encoded = codec.encode(62, {buildFullRecord()});
+    DecodedBlock ref  = codec.decode(encoded);
+    CompactBlock cblk = codec.decodeCompact(encoded);
+    CHECK(cblk.valid,                                  "compact block valid");
+    CHECK(cblk.cat == 62 && cblk.length == ref.length, "compact header matches");
+    CHECK(cblk.records.size() == ref.records.size(),   "compact record count matches");
+    if (cblk.records.size() != 1 || ref.records.size() != 1) return;
+
+    const CategoryPlan& plan = codec.plan(62);
+    CHECK(compactMismatches(plan, ref.records[0], cblk.records[0], "CAT62") == 0,
+          "compact record matches map record");
+
+    // Direct accessor spot checks
+    const auto& rec = cblk.records[0];
+    const auto i510 = rec.item(plan.findItem("510"));
+    CHECK(i510.repetitions() == 2,                                      "I510 two groups");
+    CHECK(i510.field(findField(def, "510", "TRACK"), 1) == 0x7654,      "I510[1].TRACK");
+    CHECK(rec.item(plan.findItem("290")).field(findField(def, "290", "PSR", "PSR")) == 20,
+          "I290/PSR.PSR == 20");
+    CHECK(!rec.item(plan.findItem("245")).present(),                    "I245 absent");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 13: Lazy view – view() indexes item spans without decoding, and every
+//           value read through it matches decode().
+// ─────────────────────────────────────────────────────────────────────────────
+static int viewMismatches(const CategoryPlan& plan,
+                          const DecodedRecord& want,
+                          const RecordView& got,
+                          const std::string& label) {
+    const CategoryDef& def = plan.def;
+    int bad = 0;
+    auto expect = [&](bool ok, const std::string& what) {
+        if (!ok) { std::cerr << "FAIL [view] " << label << " " << what << '\n'; ++bad; }
+    };
+    expect(got.valid() == want.valid,                   "valid");
+    expect(got.variationName() == want.uap_variation,   "variation");
+
+    for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+        const std::string& id = plan.items[idx].def->id;
+        auto it = want.items.find(id);
+        expect(got.hasItem(idx) == (it != want.items.end()), "I" + id + " presence");
+        if (it == want.items.end()) continue;
+
+        const DecodedItem& di = it->second;
+        const ItemView item = got.item(idx);
+        for (const auto& [name, val] : di.fields)
+            expect(item.field(findField(def, id, name)) == val, "I" + id + "." + name);
+        for (const auto& [sub, fields] : di.compound_sub_fields)
+            for (const auto& [name, val] : fields)
+                expect(item.field(findField(def, id, name, sub)) == val,
+                       "I" + id + "/" + sub + "." + name);
+        const size_t reps = di.repetitions.empty() ? di.group_repetitions.size()
+                                                   : di.repetitions.size();
+        expect(item.repetitions() == reps, "I" + id + " repetitions");
+        for (size_t r = 0; r < di.repetitions.size(); ++r)
+            expect(item.repetition(r) == di.repetitions[r], "I" + id + "[" + std::to_string(r) + "]");
+        for (size_t r = 0; r < di.group_repetitions.size(); ++r)
+            for (const auto& [name, val] : di.group_repetitions[r])
+                expect(item.field(findField(def, id, name), r) == val,
+                       "I" + id + "[" + std::to_string(r) + "]." + name);
+        const auto payload = item.payload();
+        expect(std::equal(payload.begin(), payload.end(),
+                          di.raw_bytes.begin(), di.raw_bytes.end()), "I" + id + " payload");
+    }
+    return bad;
+}
+
+static void testLazyView(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 lazy BlockView / RecordView ===\n";
+
+    const CategoryDef&  def  = codec.category(62);
+    const CategoryPlan& plan = codec.plan(62);
+
+    DecodedRecord second;
+    second.uap_variation = "default";
+    { DecodedItem di; di.item_id = "010"; di.type = ItemType::Fixed;
+      di.fields["SAC"] = 9; di.fields["SIC"] = 8; second.items["010"] = std::move(di); }
+    { DecodedItem di; di.item_id = "040"; di.type = ItemType::Fixed;
+      di.fields["TN"] = 77; second.items["040"] = std::move(di); }
+
+    auto encoded = codec.encode(62, {buildFullRecord(), second});
+    DecodedBlock ref  = codec.decode(encoded);
+    BlockView    view = codec.view(encoded);
+    CHECK(view.valid,                             "view valid");
+    CHECK(view.cat == 62 && view.length == ref.length, "view header matches");
+    CHECK(view.size() == ref.records.size(),      "view record count matches");
+    if (view.size() != 2 || ref.records.size() != 2) return;
+
+    CHECK(viewMismatches(plan, ref.records[0], view.record(0), "rec[0]") == 0,
+          "full record: every value matches decode()");
+    CHECK(viewMismatches(plan, ref.records[1], view.record(1), "rec[1]") == 0,
+          "second record: every value matches decode()");
+
+    // Item spans tile each record after its FSPEC, in wire order
+    bool tiled = true;
+    size_t total = 0;
+    for (size_t r = 0; r < view.size(); ++r) {
+        const RecordView rec = view.record(r);
+        size_t fspec = 0;
+        while (rec.bytes()[fspec++] & 0x01u) {}
+        size_t covered = fspec;
+        for (ItemIndex idx = 0; idx < plan.items.size(); ++idx)
+            covered += rec.item(idx).bytes().size();
+        tiled &= covered == rec.bytes().size();
+        total += rec.bytes().size();
+    }
+    CHECK(tiled,                    "item spans + FSPEC cover each record exactly");
+    CHECK(3 + total == encoded.size(), "records cover the whole block");
+
+    const RecordView r0 = view.record(0);
+    CHECK(r0.item("185").field(findField(def, "185", "VY")) == 300,    "I185.VY by item ID");
+    CHECK(r0.field(findField(def, "010", "SIC")) == ref.records[0].items.at("010").fields.at("SIC"),
+          "I010.SIC by FieldId alone");
+    CHECK(r0.item(plan.findItem("290")).has(findField(def, "290", "PSR", "PSR")), "I290/PSR present");
+    CHECK(!view.record(1).item("185").present(),                        "rec[1] I185 absent");
+    CHECK(view.record(1).field(findField(def, "185", "VY")) == 0,       "absent field reads 0");
+
+    // Truncated block → same error as decode()
+    std::vector<uint8_t> cut(encoded.begin(), encoded.end() - 2);
+    cut[1] = static_cast<uint8_t>(cut.size() >> 8);
+    cut[2] = static_cast<uint8_t>(cut.size() & 0xFF);
+    BlockView    bad_view = codec.view(cut);
+    DecodedBlock bad_ref  = codec.decode(cut);
+    CHECK(!bad_view.valid && bad_view.error == bad_ref.error, "truncated block error matches decode()");
+    CHECK(bad_view.size() == bad_ref.records.size(),          "truncated block keeps good records");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 14: Record pre-scan – scanRecords() finds every record boundary of a
+//           large block without decoding; random access and intra-block
+//           parallel decode built on it must match decode().
+// ─────────────────────────────────────────────────────────────────────────────
+static void testRecordScan(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 record pre-scan and intra-block parallel decode ===\n";
+
+    // 150 records of two shapes: an SDPS-sized block
+    std::vector<DecodedRecord> records;
+    for (int i = 0; i < 150; ++i) {
+        DecodedRecord rec = buildFullRecord();
+        rec.items.at("040").fields.at("TN") = static_cast<uint64_t>(i);
+        if (i % 3 == 0) rec.items.erase("510");
+        records.push_back(std::move(rec));
+    }
+    const auto encoded = codec.encode(62, records);
+    const DecodedBlock ref = codec.decode(encoded);
+
+    const RecordIndex index = codec.scanRecords(encoded);
+    const BlockView view = codec.view(encoded);
+    CHECK(index.valid && index.cat == 62 && index.length == encoded.size(), "scan header");
+    CHECK(index.records.size() == 150, "scan finds 150 records");
+    bool same_bounds = index.records.size() == view.size();
+    for (size_t i = 0; same_bounds && i < view.size(); ++i)
+        same_bounds = index.records[i].offset == view.records[i].offset &&
+                      index.records[i].length == view.records[i].length;
+    CHECK(same_bounds, "scan offsets / lengths match view()");
+
+    const DecodedRecord r57 = codec.decodeRecordAt(encoded, index, 57);
+    CHECK(r57.items.at("040").fields.at("TN") == 57, "decodeRecordAt(57) is record 57");
+    CHECK(r57.items.size() == ref.records[57].items.size(), "record 57 item count");
+    checkItemsMatch(r57.items, ref.records[57].items, "rec[57]");
+    const FieldId tn = findField(codec.category(62), "040", "TN");
+    CHECK(codec.decodeCompactRecordAt(encoded, index, 57).field(tn) == 57,
+          "decodeCompactRecordAt(57) is record 57");
+
+    bool threw = false;
+    try { (void)codec.decodeRecordAt(encoded, index, 150); } catch (const std::out_of_range&) { threw = true; }
+    CHECK(threw, "decodeRecordAt() past the index throws");
+
+    const DecodedBlock par = codec.decodeParallel(encoded, {4, 7});
+    CHECK(par.valid && par.records.size() == ref.records.size(), "decodeParallel() record count");
+    bool par_match = true;
+    for (size_t i = 0; i < std::min(par.records.size(), ref.records.size()); ++i) {
+        const auto& got  = par.records[i].items;
+        const auto& want = ref.records[i].items;
+        par_match &= got.size() == want.size();
+        for (const auto& [id, item] : want)
+            par_match &= got.count(id) && got.at(id).fields == item.fields &&
+                         got.at(id).compound_sub_fields == item.compound_sub_fields &&
+                         got.at(id).group_repetitions == item.group_repetitions;
+    }
+    CHECK(par_match, "decodeParallel() records match decode()");
+    const CompactBlock cpar = codec.decodeCompactParallel(encoded, {3, 0});
+    int bad = 0;
+    for (size_t i = 0; i < std::min(cpar.records.size(), ref.records.size()); ++i)
+        bad += compactMismatches(codec.plan(62), ref.records[i], cpar.records[i],
+                                 "cpar[" + std::to_string(i) + "]");
+    CHECK(bad == 0 && cpar.records.size() == ref.records.size(), "decodeCompactParallel() matches");
+
+    // A block cut inside record 100: same records and error as decode()
+    std::vector<uint8_t> cut(encoded.begin(), encoded.begin() + index.records[100].offset + 5);
+    cut[1] = static_cast<uint8_t>(cut.size() >> 8);
+    cut[2] = static_cast<uint8_t>(cut.size());
+    const DecodedBlock ref_cut = codec.decode(cut);
+    const RecordIndex  idx_cut = codec.scanRecords(cut);
+    const DecodedBlock par_cut = codec.decodeParallel(cut, {4, 0});
+    CHECK(!idx_cut.valid && idx_cut.records.size() == ref_cut.records.size(),
+          "truncated: scan keeps the records before the error");
+    CHECK(!par_cut.valid && par_cut.error == ref_cut.error &&
+          par_cut.records.size() == ref_cut.records.size(),
+          "truncated: decodeParallel() reports what decode() reports");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 15: Traffic generator – tracks reported once per period in blocks of
+//           at most records_per_block, decoding cleanly (Full validation),
+//           positions following the simulated state, reproducible per seed.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testTrafficGenerator(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 traffic generator ===\n";
+
+    const TrafficOptions opts{.cat = 62, .targets = 40, .records_per_block = 16, .seed = 7};
+    TrafficGenerator gen{codec, opts};
+    std::vector<std::vector<uint8_t>> blocks;
+    while (gen.nextTime() < gen.startTime() + 5 * opts.period) gen.nextBlock(blocks.emplace_back());
+
+    Projection full;
+    full.validate(Validation::Full);
+    bool valid = true, sized = true, one_time = true, tracks = true;
+    bool has_510 = false, has_380 = false, has_080 = false;
+    std::vector<std::vector<uint64_t>> periods; // track numbers per TOT
+    std::vector<uint64_t> tots;
+    std::map<uint64_t, DecodedRecord> last;     // by track number
+    size_t records = 0;
+    for (const auto& b : blocks) {
+        const DecodedBlock d = codec.decode(b, full);
+        valid &= d.valid && d.length == b.size();
+        sized &= !d.records.empty() && d.records.size() <= opts.records_per_block;
+        for (const auto& r : d.records) {
+            valid &= r.valid;
+            const uint64_t tot = r.items.at("070").fields.at("TOT");
+            one_time &= tot == d.records[0].items.at("070").fields.at("TOT");
+            if (tots.empty() || tots.back() != tot) {
+                tots.push_back(tot);
+                periods.emplace_back();
+            }
+            const uint64_t tn = r.items.at("040").fields.at("TN");
+            periods.back().push_back(tn);
+            last[tn] = r;
+            has_510 |= r.items.count("510") && !r.items.at("510").group_repetitions.empty();
+            has_380 |= r.items.count("380") && r.items.at("380").compound_sub_fields.count("ADR");
+            has_080 |= r.items.count("080") != 0;
+            ++records;
+        }
+    }
+    for (auto& p : periods) {
+        std::sort(p.begin(), p.end());
+        tracks &= p.size() == opts.targets && p.front() == 1 && p.back() == opts.targets &&
+                  std::adjacent_find(p.begin(), p.end()) == p.end();
+    }
+    CHECK(valid, "every generated block and record decodes (Full validation)");
+    CHECK(sized && one_time, "blocks hold ≤ records_per_block reports of one period");
+    CHECK(periods.size() == 5 && tracks, "each period reports every track once");
+    CHECK(tots.size() == 5 && tots[1] - tots[0] == static_cast<uint64_t>(opts.period * 128) &&
+          tots[0] == static_cast<uint64_t>(opts.start_time * 128), "TOT steps by the period");
+    CHECK(records == gen.records() && blocks.size() == gen.blocks(), "record / block counters");
+    CHECK(has_510 && has_380 && has_080, "mix exercises RepetitiveGroupFX, Compound and Extended");
+
+    // The last report of each track carries its simulated position
+    bool follows = last.size() == opts.targets;
+    for (const auto& [tn, r] : last) {
+        const auto& s = gen.state(tn - 1);
+        const auto  signedX = static_cast<int32_t>(r.items.at("100").fields.at("X") << 8) >> 8;
+        const auto  signedY = static_cast<int32_t>(r.items.at("100").fields.at("Y") << 8) >> 8;
+        follows &= std::abs(signedX * 0.5 - s.x) <= 0.5 && std::abs(signedY * 0.5 - s.y) <= 0.5 &&
+                   std::hypot(s.x, s.y) < opts.max_range + s.speed * 4 * opts.period;
+    }
+    CHECK(follows, "I062/100 follows the simulated position, within range");
+
+    // Same seed, same bytes; the span form writes the same block
+    TrafficGenerator again{codec, opts};
+    std::vector<uint8_t> buf(0xFFFF);
+    const size_t n = again.nextBlock(std::span<uint8_t>(buf));
+    CHECK(std::equal(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(n), blocks[0].begin(),
+                     blocks[0].end()), "reproducible for a seed (encodeInto form)");
+    CHECK(again.next().items.at("040").fields.at("TN") == codec.decode(blocks[1]).records[0].items.at("040").fields.at("TN"),
+          "next() continues with the following report");
+
+    bool threw = false;
+    try { TrafficGenerator bad{codec, {.cat = 62, .items = {{"999"}}}}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "item outside the UAP rejected");
+    threw = false;
+    try { TrafficGenerator bad{codec, {.cat = 62, .targets = 0}}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "zero targets rejected");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 16: Track state – one entry per (SAC, SIC, TN); changed items found by
+//           byte comparison, changed fields match a value-by-value diff, and
+//           a repeated record changes nothing.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testTrackState(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 track state ===\n";
+
+    TrafficGenerator gen{codec, {.cat = 62, .targets = 30, .records_per_block = 30, .seed = 3}};
+    std::vector<uint8_t> first, second;
+    gen.nextBlock(first);
+    gen.nextBlock(second);
+
+    const CategoryPlan& plan = codec.plan(62);
+    const ItemIndex i010 = plan.findItem("010");
+    const ItemIndex i070 = plan.findItem("070");
+    const FieldId   sac  = findField(plan.def, "010", "SAC");
+    const FieldId   lat  = findField(plan.def, "105", "LAT");
+
+    TrackStore tracks{codec, 62};
+    BlockView  block;
+    codec.view(first, block);
+    bool created = block.size() == 30;
+    for (size_t r = 0; r < block.size(); ++r) {
+        const TrackUpdate* u = tracks.update(block, r);
+        created &= u && u->created && !u->previous && u->itemChanged(i010) && u->fieldChanged(sac);
+    }
+    CHECK(created && tracks.size() == 30, "first period creates one track per TN");
+
+    codec.view(second, block);
+    bool diffs = true, positions = true;
+    for (size_t r = 0; r < block.size(); ++r) {
+        const TrackUpdate* u = tracks.update(block, r);
+        if (!u || u->created || !u->previous || u->previous == u->record) {
+            diffs = false;
+            continue;
+        }
+        diffs &= !u->itemChanged(i010) && !u->fieldChanged(sac) && u->itemChanged(i070);
+        for (FieldId f = 0; f < plan.fields.size(); ++f) {
+            const ItemIndex idx = plan.fields[f].item;
+            if (u->record->item(idx).repetitions() > 1 || u->previous->item(idx).repetitions() > 1) continue;
+            const bool differs = u->record->has(f) != u->previous->has(f) ||
+                                 u->record->field(f) != u->previous->field(f);
+            diffs &= u->fieldChanged(f) == differs;
+        }
+        positions &= u->record->field(lat) == block.record(r).item("105").field(lat);
+    }
+    CHECK(diffs, "changed fields are exactly those whose values differ; I010 untouched, I070 changed");
+    CHECK(positions, "stored record holds the latest I062/105");
+
+    bool quiet = true;
+    for (size_t r = 0; r < block.size(); ++r) {
+        const TrackUpdate* u = tracks.update(block, r);
+        quiet &= u && !u->created && !u->changed() && u->previous == u->record;
+    }
+    CHECK(quiet, "a repeated record changes nothing");
+
+    const TrackKey key{static_cast<uint8_t>(block.record(0).field(sac)),
+                       static_cast<uint8_t>(block.record(0).field(findField(plan.def, "010", "SIC"))),
+                       static_cast<uint16_t>(block.record(0).field(findField(plan.def, "040", "TN")))};
+    CHECK(tracks.find(key) && tracks.erase(key) && !tracks.find(key) && tracks.size() == 29,
+          "erase() forgets a track");
+    CHECK(tracks.update(block, 0)->created && tracks.size() == 30, "an erased track comes back as created");
+
+    bool threw = false;
+    try { TrackStore bad{codec, 62, "999"}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown track number item rejected");
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 17: Columnar archive – blocks read back byte-identical (a record with
+//           a non-zero spare included), columns and records equal to a direct
+//           decode, chunk statistics bound the values, and a much smaller file.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testArchive(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 columnar archive ===\n";
+    const fs::path path = fs::temp_directory_path() / "test_cat62.asxa";
+
+    std::vector<std::vector<uint8_t>> blocks;
+    TrafficGenerator gen{codec, {.cat = 62, .targets = 50, .records_per_block = 50, .seed = 5}};
+    for (int i = 0; i < 40; ++i) gen.nextBlock(blocks.emplace_back());
+    blocks.push_back(codec.encode(62, {buildFullRecord()}));
+
+    // I010 + I060 with the spare bit of I060 set: decodes, but re-encodes with 0
+    DecodedRecord odd = buildFullRecord();
+    std::erase_if(odd.items, [](const auto& kv) { return kv.first != "010" && kv.first != "060"; });
+    blocks.push_back(codec.encode(62, {odd}));
+    blocks.back()[3 + 2 + 2] |= 0x10;
+
+    size_t raw_bytes = 0;
+    {
+        ArchiveWriter out{codec, path, {.chunk_rows = 1000}};
+        for (const auto& b : blocks) {
+            CHECK(!out.add(b), "block archived");
+            raw_bytes += b.size();
+        }
+        const std::vector<uint8_t> bad = {62, 0, 9, 0x80};
+        CHECK(out.add(bad) && out.rejected() == 1, "undecodable block rejected");
+        out.close();
+        CHECK(out.blocks() == blocks.size() && out.records() == 40 * 50 + 2, "blocks and records counted");
+        CHECK(out.verbatim() == 1, "only the record with a spare bit set is kept as wire bytes");
+    }
+    const auto archived = fs::file_size(path);
+    std::cout << "  " << raw_bytes << " raw bytes → " << archived << " archived\n";
+    CHECK(archived * 3 < raw_bytes, "archive under a third of the raw size");
+
+    ArchiveReader in{codec, path};
+    CHECK(in.chunks().size() == 3, "2002 records in chunks of 1000+ rows");
+
+    size_t n = 0;
+    bool same = true;
+    in.forEachBlock([&](std::span<const uint8_t> b) {
+        same &= n < blocks.size() && std::equal(b.begin(), b.end(), blocks[n].begin(), blocks[n].end());
+        ++n;
+    });
+    CHECK(same && n == blocks.size(), "every block read back byte-identical, in order");
+
+    const fs::path flat = fs::temp_directory_path() / "test_cat62_flat.asxa";
+    {
+        ArchiveWriter out{codec, flat, {.chunk_rows = 1000, .group_tracks = false}};
+        for (const auto& b : blocks) (void)out.add(b);
+    }
+    n    = 0;
+    same = true;
+    ArchiveReader{codec, flat}.forEachBlock([&](std::span<const uint8_t> b) {
+        same &= n < blocks.size() && std::equal(b.begin(), b.end(), blocks[n].begin(), blocks[n].end());
+        ++n;
+    });
+    CHECK(same && n == blocks.size(), "without track grouping too");
+    CHECK(archived < fs::file_size(flat), "grouping records by track makes the archive smaller");
+    fs::remove(flat);
+
+    // Records and statistics against a direct decode
+    std::vector<CompactRecord> expected, got;
+    for (const auto& b : blocks) {
+        CompactBlock cb = codec.decodeCompact(b);
+        for (auto& rec : cb.records) expected.push_back(std::move(rec));
+    }
+    const CategoryPlan& plan = codec.plan(62);
+    const FieldId  lat   = findField(plan.def, "105", "LAT");
+    const unsigned shift = 64 - plan.elements[plan.fields[lat].element].bits;
+    size_t row = 0;
+    bool records = true, stats = true;
+    for (size_t c = 0; c < in.chunks().size(); ++c) {
+        in.readRecords(c, got);
+        const ArchiveChunk& chunk = in.chunks()[c];
+        const ArchiveFieldStats* s = chunk.stats(lat);
+        size_t with_lat = 0;
+        for (const auto& rec : got) {
+            const CompactRecord& want = expected.at(row++);
+            records &= rec.variation == want.variation && rec.item_bits == want.item_bits &&
+                       rec.field_bits == want.field_bits;
+            for (FieldId f = 0; f < plan.fields.size(); ++f) records &= rec.field(f) == want.field(f);
+            for (ItemIndex idx = 0; idx < plan.items.size(); ++idx) {
+                records &= rec.item(idx).repetitions() == want.item(idx).repetitions();
+                const auto p = rec.item(idx).payload(), q = want.item(idx).payload();
+                records &= std::equal(p.begin(), p.end(), q.begin(), q.end());
+            }
+            if (!rec.has(lat)) continue;
+            const int64_t v = static_cast<int64_t>(rec.field(lat) << shift) >> shift; // two's complement
+            stats &= s && v >= s->min && v <= s->max;
+            ++with_lat;
+        }
+        stats &= (s ? s->count : 0) == with_lat;
+    }
+    CHECK(records && row == expected.size(), "readRecords() equals decodeCompact()");
+    CHECK(stats, "I105 LAT statistics bound every (signed) value");
+
+    const std::vector<ItemSelection> sel = {{"040"}, {"070"}, {"105", {"LAT"}}, {"295"}};
+    ColumnarBatch a(plan, sel), b(plan, sel);
+    for (size_t c = 0; c < in.chunks().size(); ++c) in.readColumns(c, a);
+    for (const auto& blk : blocks) (void)codec.decodeColumns(blk, b);
+    bool columns = a.rows() == b.rows();
+    for (size_t c = 0; columns && c < a.columns().size(); ++c)
+        columns = a.column(c).values == b.column(c).values && a.column(c).validity == b.column(c).validity &&
+                  a.column(c).null_count == b.column(c).null_count;
+    CHECK(columns, "readColumns() equals decodeColumns()");
+
+    bool threw = false;
+    try { Codec none; ArchiveReader bad{none, path}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "archive of an unregistered category rejected");
+    threw = false;
+    try { ArchiveReader bad{codec, fs::path(__FILE__)}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "non-archive file rejected");
+    fs::remove(path);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 18: JSON / CSV export – compact records and views give the same text,
+//           raw and physical values, selections and the plan check.
+// ─────────────────────────────────────────────────────────────────────────────
+static void testExport(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 JSON / CSV export ===\n";
+    std::vector<uint8_t> traffic;
+    TrafficGenerator gen{codec, {.cat = 62, .targets = 20, .records_per_block = 20, .seed = 9}};
+    gen.nextBlock(traffic);
+    auto full = codec.encode(62, {buildFullRecord()});
+
+    RecordExporter a{codec.plan(62)};
+    RecordExporter b{codec.plan(62)};
+    for (const auto* blk : {&full, &traffic}) {
+        a.write(codec.decodeCompact(*blk));
+        b.write(codec.view(*blk));
+    }
+    CHECK(a.text() == b.text(),                           "JSON: compact == view");
+    CHECK(std::count(a.text().begin(), a.text().end(), '\n') == 21, "JSON: one line per record");
+    CHECK(a.text().starts_with("{\"cat\":62,"),            "JSON: record opens with the category");
+    CHECK(a.text().find("\"010\":{\"SAC\":171,\"SIC\":205}") != std::string_view::npos, "JSON: I010 fields");
+    CHECK(a.text().find("\"040\":{\"TN\":22136}") != std::string_view::npos, "JSON: I040 TN");
+    CHECK(a.text().find("\"290\":{") != std::string_view::npos, "JSON: compound item");
+
+    RecordExporter phys{codec.plan(62), {.physical = true}};
+    phys.write(codec.view(full));
+    CHECK(phys.text().find("\"070\":{\"TOT\":32}") != std::string_view::npos, "JSON: physical TOT (s)");
+    const size_t capacity = phys.text().size();
+    phys.clear();
+    CHECK(phys.size() == 0 && capacity > 0,               "clear() empties the text");
+
+    ExportOptions csv_opts{.format = ExportFormat::Csv, .items = {{"010"}, {"040"}, {"290", {"PSR"}}}};
+    RecordExporter c{codec.plan(62), csv_opts};
+    RecordExporter d{codec.plan(62), csv_opts};
+    c.header();
+    d.header();
+    for (const auto* blk : {&full, &traffic}) {
+        c.write(codec.decodeCompact(*blk));
+        d.write(codec.view(*blk));
+    }
+    CHECK(c.text() == d.text(),                           "CSV: compact == view");
+    CHECK(c.columns().size() == 4,                        "CSV: selected columns");
+    CHECK(c.text().starts_with("010.SAC,010.SIC,040.TN,290.PSR.PSR\n171,205,22136,"), "CSV: header and first row");
+    CHECK(std::count(c.text().begin(), c.text().end(), '\n') == 22, "CSV: header + one line per record");
+
+    bool threw = false;
+    try { RecordExporter bad{codec.plan(62), {.items = {{"040", {"XYZ"}}}}}; } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "unknown field rejected");
+    threw = false;
+    try { a.write(CompactRecord{}); } catch (const std::runtime_error&) { threw = true; }
+    CHECK(threw, "record of another plan rejected");
+}
+
+#ifdef ASTERIX_HAVE_GENERATED
+// ─────────────────────────────────────────────────────────────────────────────
+//  Test 19: Generated codec – asterix_gen/cat062.hpp must decode and encode
+//           exactly like the interpreted codec, for every item type.
+// ─────────────────────────────────────────────────────────────────────────────
+static bool sameItem(const DecodedItem& x, const DecodedItem& y) {
+    return x.item_id == y.item_id && x.type == y.type && x.fields == y.fields &&
+           x.repetitions == y.repetitions && x.group_repetitions == y.group_repetitions &&
+           x.raw_bytes == y.raw_bytes && x.compound_sub_fields == y.compound_sub_fields;
+}
+
+static void testGeneratedCodec(Codec& codec) {
+    std::cout << "\n=== Test: CAT62 generated codec vs. interpreted codec ===\n";
+    namespace g62 = gen::cat062;
+
+    DecodedRecord partial = buildFullRecord();
+    for (const char* id : {"080", "290", "340", "SP"}) partial.items.erase(id);
+    const auto encoded = codec.encode(62, {buildFullRecord(), partial});
+    const DecodedBlock ref = codec.decode(encoded);
+
+    std::vector<g62::Record> recs;
+    CHECK(g62::decodeBlock(encoded, recs),          "gen: block decodes");
+    CHECK(recs.size() == ref.records.size(),        "gen: same record count");
+    bool match = recs.size() == ref.records.size();
+    for (size_t i = 0; match && i < recs.size(); ++i) {
+        const DecodedRecord got = g62::toDecoded(recs[i]);
+        const DecodedRecord& want = ref.records[i];
+        match = got.valid == want.valid && got.uap_variation == want.uap_variation &&
+                got.items.size() == want.items.size();
+        for (const auto& [id, item] : want.items)
+            match = match && got.items.count(id) && sameItem(got.items.at(id), item);
+    }
+    CHECK(match,                                    "gen: toDecoded() == decode()");
+    CHECK(recs.size() == 2 && recs[0].i290 && !recs[1].i290, "gen: optional items follow the FSPEC");
+
+    std::vector<uint8_t> out;
+    g62::encodeBlock(recs, out);
+    CHECK(out == encoded,                           "gen: decode → encode is byte-exact");
+
+    std::vector<g62::Record> from;
+    for (const auto& r : ref.records) from.push_back(g62::fromDecoded(r));
+    out.clear();
+    g62::encodeBlock(from, out);
+    CHECK(out == encoded,                           "gen: fromDecoded() encodes like encode()");
+}
+#endif
+
 // ─────────────────────────────────────────────────────────────────────────────
 //  main
 // ─────────────────────────────────────────────────────────────────────────────
@@ -909,6 +1557,16 @@ int main(int argc, char* argv[]) {
     testRoundTripI340(codec);
     testMultiRecord(codec);
     testFullRoundTrip(codec);
+    testCompactDecode(codec);
+    testLazyView(codec);
+    testRecordScan(codec);
+    testTrafficGenerator(codec);
+    testTrackState(codec);
+    testArchive(codec);
+    testExport(codec);
+#ifdef ASTERIX_HAVE_GENERATED
+    testGeneratedCodec(codec);
+#endif
 
     std::cout << "\n=== Summary: " << failures << " failure(s) ===\n";
     return failures == 0 ? 0 : 1;
@@ -0,0 +1,673 @@
+// asterix_codegen.cpp – Generate a specialised C++ codec from an XML spec.
+//
+//   asterix_codegen specs/CAT48.xml build/generated/asterix_gen/cat048.hpp
+//
+// The spec is loaded and compiled exactly as Codec::registerCategory() does,
+// then emitted as plain C++: one struct per Data Item, decode / encode with
+// every bit offset and width as a template argument (see Generated.hpp), and
+// toDecoded() / fromDecoded() bridges to DecodedRecord.  Only categories with
+// a single UAP variation are supported.
+
+#include "ASTERIXCodec/Plan.hpp"
+#include "ASTERIXCodec/SpecLoader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace asterix;
+
+namespace {
+
+// ─── Naming ───────────────────────────────────────────────────────────────────
+
+std::string ident(const std::string& name) {
+    static const std::set<std::string> kReserved = {
+        "and", "or", "not", "xor", "int", "char", "bool", "auto", "case", "class",
+        "default", "delete", "new", "this", "union", "struct", "switch", "values",
+        "groups", "payload", "octets"};
+    std::string out;
+    for (char c : name)
+        out += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    if (out.empty() || std::isdigit(static_cast<unsigned char>(out[0]))) out = "_" + out;
+    if (kReserved.count(out)) out += '_';
+    return out;
+}
+
+std::string lower(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+// Item IDs ("010", "SP") only need their separators replaced: the prefix
+// already makes them identifiers.
+std::string idPart(const std::string& id) {
+    std::string out;
+    for (char c : id) out += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    return out;
+}
+
+std::string structName(const DataItemDef& def) { return "I" + idPart(def.id); }
+std::string memberName(const DataItemDef& def) { return "i" + lower(idPart(def.id)); }
+
+const char* valueType(unsigned bits) {
+    return bits <= 8 ? "uint8_t" : bits <= 16 ? "uint16_t" : bits <= 32 ? "uint32_t" : "uint64_t";
+}
+
+const char* typeName(ItemType t) {
+    switch (t) {
+    case ItemType::Fixed:             return "Fixed";
+    case ItemType::Extended:          return "Extended";
+    case ItemType::Repetitive:        return "Repetitive";
+    case ItemType::RepetitiveGroup:   return "RepetitiveGroup";
+    case ItemType::RepetitiveGroupFX: return "RepetitiveGroupFX";
+    case ItemType::Explicit:          return "Explicit";
+    case ItemType::SP:                return "SP";
+    case ItemType::Compound:          return "Compound";
+    }
+    return "Fixed";
+}
+
+// FSPEC / PSF mask of a slot within its octet, as a C++ literal.
+std::string slotBit(size_t slot) {
+    char buf[8];
+    std::snprintf(buf, sizeof buf, "0x%02Xu", 1u << (7 - slot % 7));
+    return buf;
+}
+
+// ─── Packed fields ────────────────────────────────────────────────────────────
+
+// One non-spare element with its bit offset from the start of its container.
+struct Field {
+    std::string name;   // wire / DecodedItem name
+    std::string member; // C++ identifier, unique within the struct
+    unsigned    offset{0};
+    unsigned    bits{0};
+    unsigned    octet{0}; // Extended: octet index
+};
+
+// Lay out elems from bit `base`, assigning unique member names against used.
+void layout(const std::vector<ElementDef>& elems, unsigned base, unsigned octet,
+            std::set<std::string>& used, std::vector<Field>& out) {
+    unsigned off = base;
+    for (const auto& e : elems) {
+        if (!e.is_spare) {
+            std::string m = ident(e.name);
+            for (int n = 2; used.count(m); ++n) m = ident(e.name) + "_" + std::to_string(n);
+            used.insert(m);
+            out.push_back({e.name, m, off, e.bits, octet});
+        }
+        off += e.bits;
+    }
+}
+
+std::vector<Field> layout(const std::vector<ElementDef>& elems) {
+    std::set<std::string> used;
+    std::vector<Field> out;
+    layout(elems, 0, 0, used, out);
+    return out;
+}
+
+void emitMembers(std::ostream& os, const std::vector<Field>& fields, const std::string& indent) {
+    for (const auto& f : fields)
+        os << indent << valueType(f.bits) << ' ' << f.member << "{0}; // " << f.bits << " bits\n";
+}
+
+// v.<member> = getBits<…>(ptr);   one line per field
+void emitGets(std::ostream& os, const std::vector<Field>& fields, const std::string& v,
+              const std::string& ptr, const std::string& indent) {
+    for (const auto& f : fields)
+        os << indent << v << f.member << " = static_cast<" << valueType(f.bits)
+           << ">(detail::getBits<" << f.offset << ", " << f.bits << ">(" << ptr << "));\n";
+}
+
+void emitPuts(std::ostream& os, const std::vector<Field>& fields, const std::string& v,
+              const std::string& ptr, const std::string& indent) {
+    for (const auto& f : fields)
+        os << indent << "detail::putBits<" << f.offset << ", " << f.bits << ">(" << ptr << ", "
+           << v << f.member << ");\n";
+}
+
+void emitToMap(std::ostream& os, const std::vector<Field>& fields, const std::string& v,
+               const std::string& map, const std::string& indent) {
+    for (const auto& f : fields)
+        os << indent << map << "[\"" << f.name << "\"] = " << v << f.member << ";\n";
+}
+
+void emitFromMap(std::ostream& os, const std::vector<Field>& fields, const std::string& v,
+                 const std::string& map, const std::string& indent) {
+    for (const auto& f : fields)
+        os << indent << v << f.member << " = static_cast<" << valueType(f.bits)
+           << ">(detail::value(" << map << ", \"" << f.name << "\"));\n";
+}
+
+// ─── Items ────────────────────────────────────────────────────────────────────
+
+void emitItem(std::ostream& os, const CategoryPlan& plan, const PlanItem& item) {
+    const DataItemDef& def = *item.def;
+    const std::string  S   = structName(def);
+
+    os << "// ─── I" << def.id << " – " << def.name << " (" << typeName(item.type) << ")\n";
+
+    switch (item.type) {
+
+    case ItemType::Fixed: {
+        const auto fields = layout(def.elements);
+        os << "struct " << S << " {\n";
+        emitMembers(os, fields, "    ");
+        os << "};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) noexcept {\n"
+           << "    if (b.size() < " << item.fixed_bytes << ") return 0;\n";
+        emitGets(os, fields, "v.", "b.data()", "    ");
+        os << "    return " << item.fixed_bytes << ";\n}\n\n";
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n";
+        if (!fields.empty()) os << "    uint8_t* p = detail::grow(out, " << item.fixed_bytes << ");\n";
+        else                 os << "    (void)v;\n    (void)detail::grow(out, " << item.fixed_bytes << ");\n";
+        emitPuts(os, fields, "v.", "p", "    ");
+        os << "}\n\n";
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::Fixed;\n";
+        emitToMap(os, fields, "v.", "d.fields", "    ");
+        os << "    return d;\n}\n\n";
+
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n";
+        if (fields.empty()) os << "    (void)d;\n    (void)v;\n";
+        emitFromMap(os, fields, "v.", "d.fields", "    ");
+        os << "}\n\n";
+        break;
+    }
+
+    case ItemType::Extended: {
+        std::set<std::string> used;
+        std::vector<Field> fields;
+        for (unsigned o = 0; o < def.octets.size(); ++o)
+            layout(def.octets[o].elements, o * 8, o, used, fields);
+        const size_t n_oct = def.octets.size();
+
+        os << "struct " << S << " {\n";
+        emitMembers(os, fields, "    ");
+        os << "    uint8_t octets{1}; // octets on the wire (1–" << n_oct << "; FX chain)\n";
+        os << "};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) noexcept {\n"
+           << "    const size_t n = detail::fxLength(b);\n"
+           << "    if (n == 0) return 0;\n"
+           << "    v.octets = static_cast<uint8_t>(n < " << n_oct << " ? n : " << n_oct << ");\n";
+        for (unsigned o = 0; o < n_oct; ++o) {
+            std::vector<Field> oct;
+            for (const auto& f : fields) if (f.octet == o) oct.push_back(f);
+            const std::string indent = o == 0 ? "    " : "        ";
+            if (o != 0) os << "    if (n > " << o << ") {\n";
+            emitGets(os, oct, "v.", "b.data()", indent);
+            if (o != 0) os << "    }\n";
+        }
+        os << "    return n;\n}\n\n";
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n"
+           << "    const size_t n = v.octets < 1 ? 1 : v.octets > " << n_oct << " ? " << n_oct
+           << " : v.octets;\n"
+           << "    uint8_t* p = detail::grow(out, n);\n"
+           << "    for (size_t i = 0; i + 1 < n; ++i) p[i] |= 0x01u; // FX\n";
+        for (unsigned o = 0; o < n_oct; ++o) {
+            std::vector<Field> oct;
+            for (const auto& f : fields) if (f.octet == o) oct.push_back(f);
+            if (oct.empty()) continue;
+            const std::string indent = o == 0 ? "    " : "        ";
+            if (o != 0) os << "    if (n > " << o << ") {\n";
+            emitPuts(os, oct, "v.", "p", indent);
+            if (o != 0) os << "    }\n";
+        }
+        os << "}\n\n";
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::Extended;\n";
+        for (unsigned o = 0; o < n_oct; ++o) {
+            std::vector<Field> oct;
+            for (const auto& f : fields) if (f.octet == o) oct.push_back(f);
+            if (oct.empty()) continue;
+            const std::string indent = o == 0 ? "    " : "        ";
+            if (o != 0) os << "    if (v.octets > " << o << ") {\n";
+            emitToMap(os, oct, "v.", "d.fields", indent);
+            if (o != 0) os << "    }\n";
+        }
+        os << "    return d;\n}\n\n";
+
+        // Same octet count as Codec::encode(): up to the last non-zero octet
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n";
+        emitFromMap(os, fields, "v.", "d.fields", "    ");
+        os << "    v.octets = 1;\n";
+        for (unsigned o = 1; o < n_oct; ++o) {
+            std::vector<Field> oct;
+            for (const auto& f : fields) if (f.octet == o) oct.push_back(f);
+            if (oct.empty()) continue;
+            os << "    if (";
+            for (size_t i = 0; i < oct.size(); ++i)
+                os << (i ? " || " : "") << "v." << oct[i].member << " != 0";
+            os << ") v.octets = " << o + 1 << ";\n";
+        }
+        os << "}\n\n";
+        break;
+    }
+
+    case ItemType::Repetitive: {
+        os << "struct " << S << " {\n"
+           << "    std::vector<uint8_t> values; // " << def.rep_element.name
+           << ": 7 bits per FX-chained octet\n"
+           << "};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) {\n"
+           << "    const size_t n = detail::fxLength(b);\n"
+           << "    v.values.clear();\n"
+           << "    for (size_t i = 0; i < n; ++i) v.values.push_back(static_cast<uint8_t>(b[i] >> 1));\n"
+           << "    return n;\n}\n\n";
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n"
+           << "    const size_t n = v.values.empty() ? 1 : v.values.size();\n"
+           << "    uint8_t* p = detail::grow(out, n);\n"
+           << "    for (size_t i = 0; i < v.values.size(); ++i)\n"
+           << "        p[i] = static_cast<uint8_t>((v.values[i] & 0x7Fu) << 1 | (i + 1 < n ? 1u : 0u));\n"
+           << "}\n\n";
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::Repetitive;\n"
+           << "    d.repetitions.assign(v.values.begin(), v.values.end());\n"
+           << "    return d;\n}\n\n";
+
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n"
+           << "    v.values.clear();\n"
+           << "    for (uint64_t r : d.repetitions) v.values.push_back(static_cast<uint8_t>(r & 0x7Fu));\n"
+           << "}\n\n";
+        break;
+    }
+
+    case ItemType::RepetitiveGroup:
+    case ItemType::RepetitiveGroupFX: {
+        const bool fx     = item.type == ItemType::RepetitiveGroupFX;
+        const auto fields = layout(def.rep_group_elements);
+        const unsigned gb = item.group_bytes;
+
+        os << "struct " << S << " {\n    struct Group {\n";
+        emitMembers(os, fields, "        ");
+        os << "    };\n    std::vector<Group> groups;\n};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) {\n"
+           << "    v.groups.clear();\n";
+        if (fx) {
+            os << "    size_t pos = 0;\n"
+               << "    do {\n"
+               << "        if (pos + " << gb << " > b.size()) return 0;\n"
+               << "        const uint8_t* p = b.data() + pos;\n"
+               << "        auto& g = v.groups.emplace_back();\n";
+            emitGets(os, fields, "g.", "p", "        ");
+            os << "        pos += " << gb << ";\n"
+               << "    } while (b[pos - 1] & 0x01u); // FX: last bit of the group\n"
+               << "    return pos;\n}\n\n";
+        } else {
+            os << "    if (b.empty()) return 0;\n"
+               << "    const size_t count = b[0];\n"
+               << "    if (b.size() < 1 + count * " << gb << ") return 0;\n"
+               << "    for (size_t i = 0; i < count; ++i) {\n"
+               << "        const uint8_t* p = b.data() + 1 + i * " << gb << ";\n"
+               << "        auto& g = v.groups.emplace_back();\n";
+            emitGets(os, fields, "g.", "p", "        ");
+            os << "    }\n    return 1 + count * " << gb << ";\n}\n\n";
+        }
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n";
+        if (fx) {
+            os << "    const size_t n = v.groups.empty() ? 1 : v.groups.size();\n"
+               << "    uint8_t* base = detail::grow(out, n * " << gb << ");\n"
+               << "    for (size_t i = 0; i < v.groups.size(); ++i) {\n"
+               << "        uint8_t* p = base + i * " << gb << ";\n"
+               << "        const auto& g = v.groups[i];\n";
+            emitPuts(os, fields, "g.", "p", "        ");
+            os << "        if (i + 1 < n) p[" << gb - 1 << "] |= 0x01u; // FX\n"
+               << "    }\n}\n\n";
+        } else {
+            os << "    const size_t n = v.groups.size() < 255 ? v.groups.size() : 255;\n"
+               << "    uint8_t* base = detail::grow(out, 1 + n * " << gb << ");\n"
+               << "    base[0] = static_cast<uint8_t>(n);\n"
+               << "    for (size_t i = 0; i < n; ++i) {\n"
+               << "        uint8_t* p = base + 1 + i * " << gb << ";\n"
+               << "        const auto& g = v.groups[i];\n";
+            emitPuts(os, fields, "g.", "p", "        ");
+            os << "    }\n}\n\n";
+        }
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::" << typeName(item.type) << ";\n"
+           << "    for (const auto& g : v.groups) {\n"
+           << "        auto& m = d.group_repetitions.emplace_back();\n";
+        emitToMap(os, fields, "g.", "m", "        ");
+        os << "    }\n    return d;\n}\n\n";
+
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n"
+           << "    v.groups.clear();\n"
+           << "    for (const auto& m : d.group_repetitions) {\n"
+           << "        auto& g = v.groups.emplace_back();\n";
+        emitFromMap(os, fields, "g.", "m", "        ");
+        os << "    }\n}\n\n";
+        break;
+    }
+
+    case ItemType::Explicit:
+    case ItemType::SP: {
+        os << "struct " << S << " {\n"
+           << "    std::vector<uint8_t> payload; // length byte excluded\n"
+           << "};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) {\n"
+           << "    if (b.empty() || b[0] < 1 || b.size() < b[0]) return 0;\n"
+           << "    v.payload.assign(b.begin() + 1, b.begin() + b[0]);\n"
+           << "    return b[0];\n}\n\n";
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n"
+           << "    out.push_back(static_cast<uint8_t>(v.payload.size() + 1));\n"
+           << "    out.insert(out.end(), v.payload.begin(), v.payload.end());\n"
+           << "}\n\n";
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::" << typeName(item.type) << ";\n"
+           << "    d.raw_bytes = v.payload;\n"
+           << "    return d;\n}\n\n";
+
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n"
+           << "    v.payload = d.raw_bytes;\n}\n\n";
+        break;
+    }
+
+    case ItemType::Compound: {
+        struct Sub {
+            const PlanSubItem* si;
+            unsigned           slot;
+            std::string        type, member;
+            std::vector<Field> fields;
+        };
+        std::vector<Sub> subs;
+        std::set<std::string> used;
+        for (unsigned s = 0; s < item.sub_items.count; ++s) {
+            const PlanSubItem& si = plan.sub_items[item.sub_items.first + s];
+            if (si.unused) continue;
+            std::string m = ident(si.def->name);
+            for (int n = 2; used.count(m); ++n) m = ident(si.def->name) + "_" + std::to_string(n);
+            used.insert(m);
+            subs.push_back({&si, s, "Sub" + m, m, layout(si.def->elements)});
+        }
+        const unsigned n_slots = item.sub_items.count;
+        const unsigned n_psf   = std::max(1u, (n_slots + 6) / 7);
+
+        os << "struct " << S << " {\n";
+        for (const auto& s : subs) {
+            os << "    struct " << s.type << " {\n";
+            emitMembers(os, s.fields, "        ");
+            os << "    };\n";
+        }
+        for (const auto& s : subs)
+            os << "    std::optional<" << s.type << "> " << s.member << "; // PSF slot "
+               << s.slot + 1 << "\n";
+        os << "};\n\n";
+
+        os << "inline size_t decode(std::span<const uint8_t> b, " << S << "& v) noexcept {\n"
+           << "    const size_t psf = detail::fxLength(b);\n"
+           << "    if (psf == 0) return 0;\n"
+           << "    const auto spec = b.first(psf);\n"
+           << "    size_t pos = psf;\n";
+        for (const auto& s : subs) {
+            const unsigned fb = s.si->fixed_bytes;
+            os << "    v." << s.member << ".reset();\n"
+               << "    if (detail::slotSet(spec, " << s.slot << ")) {\n"
+               << "        if (pos + " << fb << " > b.size()) return 0;\n"
+               << "        const uint8_t* p = b.data() + pos;\n"
+               << "        auto& s = v." << s.member << ".emplace();\n";
+            emitGets(os, s.fields, "s.", "p", "        ");
+            if (s.fields.empty()) os << "        (void)p;\n        (void)s;\n";
+            os << "        pos += " << fb << ";\n    }\n";
+        }
+        os << "    return pos;\n}\n\n";
+
+        os << "inline void encode(const " << S << "& v, std::vector<uint8_t>& out) {\n"
+           << "    uint8_t psf[" << n_psf << "] = {};\n"
+           << "    size_t  last = 0;\n";
+        for (const auto& s : subs)
+            os << "    if (v." << s.member << ") { psf[" << s.slot / 7 << "] |= " << slotBit(s.slot)
+               << "; last = " << s.slot / 7 << "; }\n"; // slot order: last only grows
+        os << "    for (size_t i = 0; i < last; ++i) psf[i] |= 0x01u; // FX\n"
+           << "    out.insert(out.end(), psf, psf + last + 1);\n";
+        for (const auto& s : subs) {
+            os << "    if (v." << s.member << ") {\n"
+               << "        uint8_t* p = detail::grow(out, " << s.si->fixed_bytes << ");\n"
+               << "        const auto& s = *v." << s.member << ";\n";
+            emitPuts(os, s.fields, "s.", "p", "        ");
+            if (s.fields.empty()) os << "        (void)p;\n        (void)s;\n";
+            os << "    }\n";
+        }
+        os << "}\n\n";
+
+        os << "inline DecodedItem toDecoded(const " << S << "& v) {\n"
+           << "    DecodedItem d;\n    d.item_id = \"" << def.id << "\";\n"
+           << "    d.type    = ItemType::Compound;\n";
+        for (const auto& s : subs) {
+            os << "    if (v." << s.member << ") {\n"
+               << "        auto& m = d.compound_sub_fields[\"" << s.si->def->name << "\"];\n";
+            emitToMap(os, s.fields, "v." + s.member + "->", "m", "        ");
+            if (s.fields.empty()) os << "        (void)m;\n";
+            os << "    }\n";
+        }
+        os << "    return d;\n}\n\n";
+
+        os << "inline void fromDecoded(const DecodedItem& d, " << S << "& v) {\n";
+        for (const auto& s : subs) {
+            os << "    v." << s.member << ".reset();\n"
+               << "    if (auto it = d.compound_sub_fields.find(\"" << s.si->def->name
+               << "\"); it != d.compound_sub_fields.end()) {\n"
+               << "        auto& s = v." << s.member << ".emplace();\n";
+            emitFromMap(os, s.fields, "s.", "it->second", "        ");
+            if (s.fields.empty()) os << "        (void)s;\n";
+            os << "    }\n";
+        }
+        if (subs.empty()) os << "    (void)d;\n    (void)v;\n";
+        os << "}\n\n";
+        break;
+    }
+    }
+}
+
+// ─── Record and block ─────────────────────────────────────────────────────────
+
+void emitRecord(std::ostream& os, const CategoryPlan& plan) {
+    const PlanVariation& uap = plan.variations[plan.default_variation];
+    const size_t max_fspec   = std::max<size_t>((uap.slots.size() + 6) / 7, 1);
+
+    os << "// ─── Record (UAP \"" << *uap.name << "\")\n"
+       << "struct Record {\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        const DataItemDef& def = *plan.items[idx].def;
+        os << "    std::optional<" << structName(def) << "> " << memberName(def)
+           << "; // FRN " << s + 1 << "\n";
+    }
+    os << "};\n\n";
+
+    // decodeRecord
+    os << "// Bytes consumed, or 0 if the record breaks a length rule.\n"
+       << "inline size_t decodeRecord(std::span<const uint8_t> b, Record& r) {\n"
+       << "    const size_t fspec = detail::fxLength(b);\n"
+       << "    if (fspec == 0) return 0;\n"
+       << "    const auto spec = b.first(fspec);\n"
+       << "    size_t pos = fspec;\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem) continue;
+        if (idx == kUnknownItem) {
+            os << "    if (detail::slotSet(spec, " << s << ")) return 0; // undefined item "
+               << (*uap.refs)[s] << "\n";
+            continue;
+        }
+        const std::string m = memberName(*plan.items[idx].def);
+        os << "    r." << m << ".reset();\n"
+           << "    if (detail::slotSet(spec, " << s << ")) {\n"
+           << "        const size_t n = decode(b.subspan(pos), r." << m << ".emplace());\n"
+           << "        if (n == 0) return 0;\n"
+           << "        pos += n;\n    }\n";
+    }
+    os << "    return pos;\n}\n\n";
+
+    // encodeRecord
+    os << "inline void encodeRecord(const Record& r, std::vector<uint8_t>& out) {\n"
+       << "    uint8_t fspec[" << max_fspec << "] = {};\n"
+       << "    size_t  last = 0;\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        os << "    if (r." << memberName(*plan.items[idx].def) << ") { fspec[" << s / 7
+           << "] |= " << slotBit(s) << "; last = " << s / 7 << "; }\n";
+    }
+    os << "    for (size_t i = 0; i < last; ++i) fspec[i] |= 0x01u; // FX\n"
+       << "    out.insert(out.end(), fspec, fspec + last + 1);\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        const std::string m = memberName(*plan.items[idx].def);
+        os << "    if (r." << m << ") encode(*r." << m << ", out);\n";
+    }
+    os << "}\n\n";
+
+    // mandatoryPresent
+    os << "inline bool mandatoryPresent(const Record& r) noexcept {\n"
+       << "    (void)r;\n    return true";
+    for (ItemIndex idx : plan.mandatory) {
+        const bool in_uap = std::find(uap.slots.begin(), uap.slots.end(), idx) != uap.slots.end();
+        os << "\n        && " << (in_uap ? "r." + memberName(*plan.items[idx].def) + ".has_value()"
+                                         : std::string("false"));
+    }
+    os << ";\n}\n\n";
+
+    // Bridges
+    os << "inline DecodedRecord toDecoded(const Record& r) {\n"
+       << "    DecodedRecord d;\n"
+       << "    d.uap_variation = \"" << *uap.name << "\";\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        const DataItemDef& def = *plan.items[idx].def;
+        os << "    if (r." << memberName(def) << ") d.items[\"" << def.id << "\"] = toDecoded(*r."
+           << memberName(def) << ");\n";
+    }
+    os << "    d.valid = mandatoryPresent(r);\n"
+       << "    return d;\n}\n\n";
+
+    os << "inline Record fromDecoded(const DecodedRecord& d) {\n"
+       << "    Record r;\n";
+    for (size_t s = 0; s < uap.slots.size(); ++s) {
+        const ItemIndex idx = uap.slots[s];
+        if (idx == kNoItem || idx == kUnknownItem) continue;
+        const DataItemDef& def = *plan.items[idx].def;
+        os << "    if (auto it = d.items.find(\"" << def.id << "\"); it != d.items.end()) fromDecoded(it->second, r."
+           << memberName(def) << ".emplace());\n";
+    }
+    os << "    return r;\n}\n\n";
+
+    // Blocks
+    os << "// Decode a whole Data Block of this category into out; false on a bad\n"
+       << "// header or record (out then holds the records before it).\n"
+       << "inline bool decodeBlock(std::span<const uint8_t> b, std::vector<Record>& out) {\n"
+       << "    out.clear();\n"
+       << "    if (b.size() < 3 || b[0] != kCategory) return false;\n"
+       << "    const size_t len = static_cast<size_t>(b[1]) << 8 | b[2];\n"
+       << "    if (len < 3 || len > b.size()) return false;\n"
+       << "    for (size_t pos = 3; pos < len; ) {\n"
+       << "        const size_t n = decodeRecord(b.subspan(pos, len - pos), out.emplace_back());\n"
+       << "        if (n == 0) {\n"
+       << "            out.pop_back();\n"
+       << "            return false;\n"
+       << "        }\n"
+       << "        pos += n;\n"
+       << "    }\n"
+       << "    return true;\n}\n\n";
+
+    os << "// Append one Data Block holding records to out.\n"
+       << "// Throws std::runtime_error if it exceeds 65535 bytes (out is then unchanged).\n"
+       << "inline void encodeBlock(const std::vector<Record>& records, std::vector<uint8_t>& out) {\n"
+       << "    const size_t at = out.size();\n"
+       << "    out.insert(out.end(), {kCategory, 0, 0});\n"
+       << "    for (const auto& r : records) encodeRecord(r, out);\n"
+       << "    const size_t len = out.size() - at;\n"
+       << "    if (len > 0xFFFF) {\n"
+       << "        out.resize(at);\n"
+       << "        throw std::runtime_error(\"encodeBlock: Data Block length \" + std::to_string(len) +\n"
+       << "                                 \" exceeds 65535\");\n"
+       << "    }\n"
+       << "    out[at + 1] = static_cast<uint8_t>(len >> 8);\n"
+       << "    out[at + 2] = static_cast<uint8_t>(len);\n"
+       << "}\n\n";
+}
+
+std::string generate(const CategoryPlan& plan, const std::string& source) {
+    const CategoryDef& cat = plan.def;
+    if (plan.variations.size() != 1 || plan.uap_case)
+        throw std::runtime_error("category " + std::to_string(cat.cat) +
+                                 " has several UAP variations (not supported by asterix_codegen)");
+
+    char ns[8];
+    std::snprintf(ns, sizeof ns, "cat%03u", static_cast<unsigned>(cat.cat));
+
+    std::ostringstream os;
+    os << "// " << ns << ".hpp – Generated by asterix_codegen from " << source << ".\n"
+       << "// " << cat.name << " (edition " << cat.edition << ", " << cat.date << ").\n"
+       << "// Do not edit: the build regenerates this file from the XML spec.\n\n"
+       << "#pragma once\n\n"
+       << "#include \"ASTERIXCodec/Generated.hpp\"\n\n"
+       << "#include <cstddef>\n#include <cstdint>\n#include <optional>\n#include <span>\n"
+       << "#include <stdexcept>\n#include <string>\n#include <vector>\n\n"
+       << "namespace asterix::gen::" << ns << " {\n\n"
+       << "inline constexpr uint8_t kCategory = " << unsigned(cat.cat) << ";\n\n";
+
+    const PlanVariation& uap = plan.variations[0];
+    for (ItemIndex idx : uap.slots)
+        if (idx != kNoItem && idx != kUnknownItem) emitItem(os, plan, plan.items[idx]);
+    emitRecord(os, plan);
+
+    os << "} // namespace asterix::gen::" << ns << "\n";
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: asterix_codegen <spec.xml> <out.hpp>\n";
+        return 2;
+    }
+    try {
+        const std::filesystem::path spec = argv[1];
+        const auto plan = compilePlan(loadSpec(spec));
+        const std::string code = generate(*plan, spec.filename().string());
+
+        const std::filesystem::path out = argv[2];
+        if (out.has_parent_path()) std::filesystem::create_directories(out.parent_path());
+        std::ofstream f(out, std::ios::binary);
+        f << code;
+        if (!f) throw std::runtime_error("cannot write " + out.string());
+    } catch (const std::exception& ex) {
+        std::cerr << "asterix_codegen: " << ex.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+// asterix_traffic.cpp – Synthetic ASTERIX traffic to a file or a UDP socket.
+//
+//   asterix_traffic [options] <out.ast | udp://host:port>
+//
+// One TrafficGenerator (see Traffic.hpp) per --cat, sharing the sensor
+// options; their blocks are interleaved in time order.  A file receives the
+// Data Blocks back to back (a Raw recording, see Recording.hpp); a UDP
+// destination one datagram per block.  --rate paces the output in wall-clock
+// time, otherwise it is written as fast as it is generated.
+//
+// Options:
+//   --cat=<n>                 34, 48 or 62; repeat to interleave (default 48)
+//   --items=<id[:share],...>  item mix of the --cat before it (default per category)
+//   --targets=<n>             aircraft (default 100)
+//   --sectors=<n>             CAT034 sectors per rotation (default 32)
+//   --records-per-block=<n>   (default 16)
+//   --period=<s>              rotation / update period (default 4)
+//   --duration=<s>            simulated time to generate (default 60)
+//   --rate=<records/s>        output pace (default: unpaced)
+//   --sac=<n> --sic=<n> --seed=<n>
+//   --specs=<dir>             XML specs (default: specs/ of the source tree)
+
+#include "ASTERIXCodec/SpecLoader.hpp"
+#include "ASTERIXCodec/Traffic.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace asterix;
+
+namespace {
+
+[[noreturn]] void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [--cat=<n> [--items=<id[:share],...>]]... [--targets=<n>] [--sectors=<n>]\n"
+                 "       [--records-per-block=<n>] [--period=<s>] [--duration=<s>] [--rate=<records/s>]\n"
+                 "       [--sac=<n>] [--sic=<n>] [--seed=<n>] [--specs=<dir>] <out.ast | udp://host:port>\n",
+                 argv0);
+    std::exit(2);
+}
+
+// "010,040:0.5,220:0.8" → items
+std::vector<TrafficItem> parseItems(const std::string& list) {
+    std::vector<TrafficItem> items;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        const size_t end = std::min(list.find(',', pos), list.size());
+        const std::string entry = list.substr(pos, end - pos);
+        const size_t colon = entry.find(':');
+        if (!entry.empty())
+            items.push_back({entry.substr(0, colon),
+                             colon == std::string::npos ? 1.0 : std::stod(entry.substr(colon + 1))});
+        pos = end + 1;
+    }
+    return items;
+}
+
+// Where the blocks go: a file, or a connected UDP socket.
+class Output {
+public:
+    explicit Output(const std::string& dest) {
+        if (!dest.starts_with("udp://")) {
+            file_.open(dest, std::ios::binary);
+            if (!file_) throw std::runtime_error("cannot open " + dest);
+            return;
+        }
+#ifdef _WIN32
+        throw std::runtime_error("UDP output needs POSIX sockets");
+#else
+        const std::string hostport = dest.substr(6);
+        const size_t colon = hostport.rfind(':');
+        if (colon == std::string::npos) throw std::runtime_error("expected udp://host:port, got " + dest);
+        addrinfo hints{};
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* res = nullptr;
+        if (int rc = getaddrinfo(hostport.substr(0, colon).c_str(), hostport.substr(colon + 1).c_str(),
+                                 &hints, &res); rc != 0)
+            throw std::runtime_error(dest + ": " + gai_strerror(rc));
+        fd_ = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        const bool ok = fd_ >= 0 && connect(fd_, res->ai_addr, res->ai_addrlen) == 0;
+        freeaddrinfo(res);
+        if (!ok) throw std::runtime_error("cannot connect a UDP socket to " + dest);
+#endif
+    }
+    ~Output() {
+#ifndef _WIN32
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    Output(const Output&)            = delete;
+    Output& operator=(const Output&) = delete;
+
+    void write(std::span<const uint8_t> block) {
+#ifndef _WIN32
+        if (fd_ >= 0) {
+            // ECONNREFUSED: an earlier datagram found no listener (ICMP port
+            // unreachable); keep sending until one is started.
+            if (send(fd_, block.data(), block.size(), 0) < 0 && errno != ECONNREFUSED)
+                throw std::runtime_error("send() failed for a " + std::to_string(block.size()) + "-byte block");
+            return;
+        }
+#endif
+        file_.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+        if (!file_) throw std::runtime_error("write failed");
+    }
+
+private:
+    std::ofstream file_;
+    int           fd_{-1};
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TrafficOptions           common;
+    std::vector<uint8_t>     cats;
+    std::vector<std::vector<TrafficItem>> mixes;
+    uint32_t    sectors  = 32;
+    double      duration = 60;
+    double      rate     = 0;
+    fs::path    specs    = fs::path(__FILE__).parent_path().parent_path() / "specs";
+    std::string dest;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const size_t eq = arg.find('=');
+            const std::string key = arg.substr(0, eq);
+            const std::string val = eq == std::string::npos ? "" : arg.substr(eq + 1);
+            if (!arg.starts_with("--")) {
+                if (!dest.empty()) usage(argv[0]);
+                dest = arg;
+            } else if (key == "--cat") {
+                cats.push_back(static_cast<uint8_t>(std::stoul(val)));
+                mixes.emplace_back();
+            } else if (key == "--items") {
+                if (cats.empty()) usage(argv[0]);
+                mixes.back() = parseItems(val);
+            } else if (key == "--targets")           common.targets           = static_cast<uint32_t>(std::stoul(val));
+            else if (key == "--sectors")             sectors                  = static_cast<uint32_t>(std::stoul(val));
+            else if (key == "--records-per-block")   common.records_per_block = std::stoul(val);
+            else if (key == "--period")              common.period            = std::stod(val);
+            else if (key == "--duration")            duration                 = std::stod(val);
+            else if (key == "--rate")                rate                     = std::stod(val);
+            else if (key == "--sac")                 common.sac               = static_cast<uint8_t>(std::stoul(val));
+            else if (key == "--sic")                 common.sic               = static_cast<uint8_t>(std::stoul(val));
+            else if (key == "--seed")                common.seed              = std::stoull(val);
+            else if (key == "--specs")               specs                    = val;
+            else usage(argv[0]);
+        }
+    } catch (const std::logic_error&) { // stoul / stod
+        usage(argv[0]);
+    }
+    if (dest.empty()) usage(argv[0]);
+    if (cats.empty()) {
+        cats.push_back(48);
+        mixes.emplace_back();
+    }
+
+    try {
+        Codec codec;
+        std::vector<TrafficGenerator> gens;
+        for (size_t i = 0; i < cats.size(); ++i) {
+            char file[16];
+            std::snprintf(file, sizeof file, "CAT%02u.xml", cats[i]);
+            if (!codec.hasCategory(cats[i])) codec.registerCategory(loadSpec(specs / file));
+            TrafficOptions opts = common;
+            opts.cat   = cats[i];
+            opts.items = mixes[i];
+            opts.seed  = common.seed + i;
+            if (opts.cat == 34) opts.targets = sectors;
+            gens.emplace_back(codec, std::move(opts));
+        }
+
+        Output out{dest};
+        std::vector<uint8_t> block(0xFFFF);
+        const double end   = common.start_time + duration;
+        const auto   start = std::chrono::steady_clock::now();
+        uint64_t records = 0, blocks = 0, bytes = 0;
+        for (;;) {
+            auto gen = std::min_element(gens.begin(), gens.end(), [](const auto& a, const auto& b) {
+                return a.nextTime() < b.nextTime();
+            });
+            if (gen->nextTime() >= end) break;
+
+            const uint64_t before = gen->records();
+            size_t length = 0;
+            try {
+                length = gen->nextBlock(std::span<uint8_t>(block));
+            } catch (const std::out_of_range&) {
+                throw std::runtime_error("a block exceeds 65535 bytes: lower --records-per-block");
+            }
+            out.write(std::span<const uint8_t>(block).first(length));
+            records += gen->records() - before;
+            bytes   += length;
+            ++blocks;
+            if (rate > 0)
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                          std::chrono::duration<double>(records / rate)));
+        }
+
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "%llu records in %llu blocks, %llu bytes, %.0f s of traffic in %.2f s (%.0f records/s)\n",
+                     static_cast<unsigned long long>(records), static_cast<unsigned long long>(blocks),
+                     static_cast<unsigned long long>(bytes), duration, secs, secs > 0 ? records / secs : 0.0);
+    } catch (const std::exception& ex) {
+        std::cerr << "asterix_traffic: " << ex.what() << '\n';
+        return 1;
+    }
+    return 0;
+}